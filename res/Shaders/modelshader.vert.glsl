@@ -8,12 +8,16 @@ layout (location = 0) in vec3 vert_Position;
 layout (location = 1) in vec3 vert_Normal;
 layout (location = 2) in vec2 vert_Texture;
 
-// per-instance data
-layout (location = 3) in mat4 inst_ModelMatrix;
-layout (location = 7) in mat4 inst_NormalModelMatrix;
-layout (location = 11) in vec4 inst_MaterialVector;
-layout (location = 12) in vec4 inst_MaterialColor;
- 
+// per-instance data: the first three rows of the model matrix
+layout (location = 3) in mat3x4 inst_ModelMatrix;
+layout (location = 6) in vec4 inst_MaterialVector;
+layout (location = 7) in vec4 inst_MaterialColor;
+
+// per-model data: how to decode the vertices. When the w component of the
+// offset is 1, the normals are octahedral-encoded.
+layout (location = 8) in vec4 model_PositionOffset;
+layout (location = 9) in vec3 model_PositionScale;
+
 uniform mat4 _cameraMatrix;
 
 out vec3 vf_ModelPosition;
@@ -23,13 +27,34 @@ out vec2 vf_Texture;
 out vec4 vf_Material;
 out vec4 vf_Color;
 
+vec3 decodeNormal(vec3 normal) {
+	if (model_PositionOffset.w < 0.5) {
+		return normal;
+	}
+
+	vec3 decoded = vec3(normal.xy, 1.0 - abs(normal.x) - abs(normal.y));
+
+	if (decoded.z < 0.0) {
+		decoded.xy = (1.0 - abs(normal.yx)) * vec2(normal.x >= 0.0 ? 1.0 : -1.0, normal.y >= 0.0 ? 1.0 : -1.0);
+	}
+
+	return decoded;
+}
+
 void main(void) {
+	vec3 modelPosition = model_PositionOffset.xyz + model_PositionScale * vert_Position;
+
+	// the normal matrix is the inverse transpose of the linear part of the
+	// model matrix, which is its cofactor matrix divided by its determinant
+	mat3 linear = transpose(mat3(inst_ModelMatrix));
+	mat3 normalMatrix = mat3(cross(linear[1], linear[2]), cross(linear[2], linear[0]), cross(linear[0], linear[1]));
+
 	// calculate the position and normal vector
-	vec4 position = inst_ModelMatrix * vec4(vert_Position, 1.0);
-	vec4 normal = normalize(inst_NormalModelMatrix * vec4(vert_Normal, 0.0));
+	vec4 position = vec4(vec4(modelPosition, 1.0) * inst_ModelMatrix, 1.0);
+	vec3 normal = normalize(normalMatrix * decodeNormal(vert_Normal)) * sign(determinant(linear));
 
 	// set variables to be passed to the fragment shader
-	vf_ModelPosition = vert_Position.xyz;
+	vf_ModelPosition = modelPosition;
 	vf_Position = position.xyz;
 	vf_Normal = normal.xyz;
 	vf_Texture = vert_Texture;
@@ -6,14 +6,19 @@
 // per-vertex data
 layout (location = 0) in vec3 vert_Position;
 
-// per-instance data
-layout (location = 3) in mat4 inst_ModelMatrix;
- 
+// per-instance data: the first three rows of the model matrix
+layout (location = 3) in mat3x4 inst_ModelMatrix;
+
+// per-model data
+layout (location = 8) in vec4 model_PositionOffset;
+layout (location = 9) in vec3 model_PositionScale;
+
 uniform mat4 lightspaceMatrix;
 
 void main(void) {
 	// calculate the position
-	vec4 position = inst_ModelMatrix * vec4(vert_Position, 1.0);
+	vec3 modelPosition = model_PositionOffset.xyz + model_PositionScale * vert_Position;
+	vec4 position = vec4(vec4(modelPosition, 1.0) * inst_ModelMatrix, 1.0);
 
 	// set the position
 	gl_Position = lightspaceMatrix * position;
@@ -42,6 +42,21 @@ public:
 		return std::uintptr_t(_data.get());
 	}
 
+	/**
+	 * Replaces the contents of this asset with those of the other asset, in
+	 * place. All copies of this asset see the new contents, and the address
+	 * stays the same. This is used for hot reloading, and must only be done
+	 * while no other thread uses the asset.
+	 */
+	void ReplaceContents(Asset&& other) {
+		RequireNonNull();
+		other.RequireNonNull();
+
+		if (_data != other._data) {
+			*_data = std::move(*other._data);
+		}
+	}
+
 protected:
 	Asset() :
 			_data(std::make_shared<T>()) {}
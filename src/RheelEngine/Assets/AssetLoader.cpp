@@ -0,0 +1,36 @@
+/*
+ * Copyright (c) Levi van Rheenen. All rights reserved.
+ */
+#include "AssetLoader.h"
+
+#include <filesystem>
+
+namespace rheel {
+
+PreloadBatch AssetLoader::Preload(const AssetManifest& manifest, const std::vector<std::string>& paths) {
+	return PreloadBatch(_thread_pool, manifest.GetClosure(paths), [this](const std::string& path) { return _load(path); });
+}
+
+PreloadBatch AssetLoader::Preload(const AssetManifest& manifest) {
+	return PreloadBatch(_thread_pool, manifest.GetClosure(), [this](const std::string& path) { return _load(path); });
+}
+
+std::size_t AssetLoader::_load(const std::string& path) {
+	std::string extension = std::filesystem::path(path).extension().string();
+
+	if (extension == ".dae") {
+		return collada.Load(path).GetMemoryUsage();
+	} else if (extension == ".png") {
+		return png.Load(path).GetMemoryUsage();
+	} else if (extension == ".vox") {
+		return voxel.Load(path).GetMemoryUsage();
+	} else if (extension == ".glsl") {
+		return glsl.Load(path).GetMemoryUsage();
+	} else if (extension == ".rmesh") {
+		return mesh.Load(path).GetMemoryUsage();
+	}
+
+	throw std::runtime_error("No loader for asset " + path);
+}
+
+}
@@ -9,6 +9,9 @@
 #include "Loaders/PngLoader.h"
 #include "Loaders/VoxelLoader.h"
 #include "Loaders/GlslLoader.h"
+#include "Loaders/MeshLoader.h"
+#include "AssetManifest.h"
+#include "PreloadBatch.h"
 
 namespace rheel {
 
@@ -36,8 +39,50 @@ public:
 	 */
 	Loader<Shader, GlslLoader> glsl = Loader<Shader, GlslLoader>();
 
+	/**
+	 * Loader for binary mesh (.rmesh) model files
+	 */
+	Loader<Model, MeshLoader> mesh = Loader<Model, MeshLoader>();
+
+	/**
+	 * Preloads the given assets and everything they depend on according to the
+	 * manifest, in parallel on the thread pool of the game. Assets that are
+	 * shared by multiple assets are loaded once. All assets are loaded
+	 * concurrently, so a dependency does not necessarily finish before the
+	 * assets that use it. The loader for each asset is chosen by its file
+	 * extension (.dae, .png, .vox, .glsl or .rmesh). This method returns
+	 * immediately; use the returned batch to follow the progress.
+	 */
+	PreloadBatch Preload(const AssetManifest& manifest, const std::vector<std::string>& paths);
+
+	/**
+	 * Preloads all assets in the manifest, in parallel on the thread pool of
+	 * the game. This method returns immediately; use the returned batch to
+	 * follow the progress.
+	 */
+	PreloadBatch Preload(const AssetManifest& manifest);
+
 private:
-	AssetLoader() = default;
+	AssetLoader() {
+		collada._cache.SetName("AssetLoader::collada");
+		png._cache.SetName("AssetLoader::png");
+		voxel._cache.SetName("AssetLoader::voxel");
+		glsl._cache.SetName("AssetLoader::glsl");
+		mesh._cache.SetName("AssetLoader::mesh");
+	}
+
+	void _set_thread_pool(ThreadPool* thread_pool) {
+		_thread_pool = thread_pool;
+		collada._thread_pool = thread_pool;
+		png._thread_pool = thread_pool;
+		voxel._thread_pool = thread_pool;
+		glsl._thread_pool = thread_pool;
+		mesh._thread_pool = thread_pool;
+	}
+
+	std::size_t _load(const std::string& path);
+
+	std::atomic<ThreadPool*> _thread_pool = nullptr;
 
 };
 
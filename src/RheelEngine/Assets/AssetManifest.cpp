@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) Levi van Rheenen. All rights reserved.
+ */
+#include "AssetManifest.h"
+
+#include <algorithm>
+#include <unordered_set>
+
+#include "../Util/VirtualFileSystem.h"
+
+namespace rheel {
+
+void AssetManifest::Add(const std::string& path, const std::vector<std::string>& dependencies) {
+	auto[iter, inserted] = _dependencies.try_emplace(path);
+	if (inserted) {
+		_order.push_back(path);
+	}
+
+	// references to the elements of an unordered_map stay valid when it grows
+	auto& existing = iter->second;
+
+	for (const auto& dependency : dependencies) {
+		if (std::find(existing.begin(), existing.end(), dependency) == existing.end()) {
+			existing.push_back(dependency);
+		}
+
+		if (_dependencies.try_emplace(dependency).second) {
+			_order.push_back(dependency);
+		}
+	}
+}
+
+bool AssetManifest::Contains(const std::string& path) const {
+	return _dependencies.contains(path);
+}
+
+const std::vector<std::string>& AssetManifest::GetDependencies(const std::string& path) const {
+	auto iter = _dependencies.find(path);
+
+	if (iter == _dependencies.end()) {
+		throw std::runtime_error("Asset " + path + " is not in the manifest");
+	}
+
+	return iter->second;
+}
+
+std::vector<std::string> AssetManifest::GetAssets() const {
+	return _order;
+}
+
+std::vector<std::string> AssetManifest::GetClosure(const std::vector<std::string>& paths) const {
+	std::vector<std::string> closure;
+	std::unordered_set<std::string_view> visiting;
+	std::unordered_set<std::string_view> visited;
+
+	// depth-first search, which adds an asset after all of its dependencies
+	auto visit = [&](const std::string& path, auto& visit) -> void {
+		if (visited.contains(path)) {
+			return;
+		}
+
+		if (!visiting.insert(path).second) {
+			throw std::runtime_error("Asset " + path + " depends on itself");
+		}
+
+		if (auto iter = _dependencies.find(path); iter != _dependencies.end()) {
+			for (const auto& dependency : iter->second) {
+				visit(dependency, visit);
+			}
+		}
+
+		visiting.erase(path);
+		visited.insert(path);
+		closure.push_back(path);
+	};
+
+	for (const auto& path : paths) {
+		visit(path, visit);
+	}
+
+	return closure;
+}
+
+std::vector<std::string> AssetManifest::GetClosure() const {
+	return GetClosure(_order);
+}
+
+AssetManifest AssetManifest::Parse(std::string_view text) {
+	AssetManifest manifest;
+	std::size_t line_number = 0;
+
+	auto split = [](std::string_view text) {
+		std::vector<std::string> words;
+		std::size_t start = 0;
+
+		while ((start = text.find_first_not_of(" \t\r", start)) != std::string_view::npos) {
+			std::size_t end = std::min(text.find_first_of(" \t\r", start), text.size());
+			words.emplace_back(text.substr(start, end - start));
+			start = end;
+		}
+
+		return words;
+	};
+
+	while (!text.empty()) {
+		std::size_t line_end = std::min(text.find('\n'), text.size());
+		std::string_view line = text.substr(0, line_end);
+		text.remove_prefix(std::min(line_end + 1, text.size()));
+		line_number++;
+
+		line = line.substr(0, line.find('#'));
+
+		std::size_t colon = line.find(':');
+		std::vector<std::string> asset = split(line.substr(0, colon));
+		std::vector<std::string> dependencies = colon == std::string_view::npos ? std::vector<std::string>() : split(line.substr(colon + 1));
+
+		if (asset.empty() && dependencies.empty()) {
+			continue;
+		}
+
+		if (asset.size() != 1 || (colon != std::string_view::npos && line.find(':', colon + 1) != std::string_view::npos)) {
+			throw std::runtime_error("Invalid asset manifest at line " + std::to_string(line_number));
+		}
+
+		manifest.Add(asset[0], dependencies);
+	}
+
+	return manifest;
+}
+
+AssetManifest AssetManifest::Load(const std::string& path) {
+	virtual_file file = VirtualFileSystem::Open(path);
+	return Parse(std::string_view(reinterpret_cast<const char*>(file.bytes.data()), file.bytes.size()));
+}
+
+}
@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) Levi van Rheenen. All rights reserved.
+ */
+#ifndef RHEELENGINE_ASSETMANIFEST_H
+#define RHEELENGINE_ASSETMANIFEST_H
+#include "../_common.h"
+
+#include <unordered_map>
+
+namespace rheel {
+
+/**
+ * A list of assets and the assets they depend on, for example the images and
+ * shaders that the materials of a model use. The manifest is used to preload
+ * everything that a level needs in one batch, with
+ * AssetLoader::Preload(const AssetManifest&, ...).
+ *
+ * A manifest can be written as a text file, with one asset per line, followed
+ * by a colon and its dependencies, separated by whitespace:
+ *
+ *   # the forest level
+ *   res/models/tree.rmesh: res/textures/bark.png res/textures/leaves.png
+ *   res/shaders/wind.glsl: res/shaders/noise.glsl
+ *
+ * Paths cannot contain whitespace or colons, and everything after a '#' is a
+ * comment.
+ */
+class RE_API AssetManifest {
+
+public:
+	/**
+	 * Adds an asset to the manifest, together with the assets it depends on.
+	 * The dependencies are added as well, without dependencies of their own.
+	 * Adding an asset which is already in the manifest adds the dependencies to
+	 * it.
+	 */
+	void Add(const std::string& path, const std::vector<std::string>& dependencies = {});
+
+	/**
+	 * Returns whether the asset is in the manifest.
+	 */
+	bool Contains(const std::string& path) const;
+
+	/**
+	 * Returns the direct dependencies of the asset. Throws a runtime_error if
+	 * the asset is not in the manifest.
+	 */
+	const std::vector<std::string>& GetDependencies(const std::string& path) const;
+
+	/**
+	 * Returns all assets in the manifest.
+	 */
+	std::vector<std::string> GetAssets() const;
+
+	/**
+	 * Returns the given assets and everything they depend on, directly or
+	 * indirectly. Every asset occurs once, after all of its dependencies.
+	 * Assets that are not in the manifest are returned without dependencies.
+	 * Throws a runtime_error if the dependencies contain a cycle.
+	 */
+	std::vector<std::string> GetClosure(const std::vector<std::string>& paths) const;
+
+	/**
+	 * Returns all assets in the manifest, every asset after all of its
+	 * dependencies. Throws a runtime_error if the dependencies contain a cycle.
+	 */
+	std::vector<std::string> GetClosure() const;
+
+	/**
+	 * Parses a manifest from its text form. Throws a runtime_error if a line
+	 * is invalid.
+	 */
+	static AssetManifest Parse(std::string_view text);
+
+	/**
+	 * Loads a manifest file through the VirtualFileSystem.
+	 */
+	static AssetManifest Load(const std::string& path);
+
+private:
+	std::unordered_map<std::string, std::vector<std::string>> _dependencies;
+
+	// the assets in the order they were added, so closures do not depend on
+	// the order of the hash map
+	std::vector<std::string> _order;
+
+};
+
+}
+
+#endif
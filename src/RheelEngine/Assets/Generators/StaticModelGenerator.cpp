@@ -3,6 +3,8 @@
  */
 #include "StaticModelGenerator.h"
 
+#include "../MeshOptimizer.h"
+
 namespace rheel {
 
 Model StaticModelGenerator::operator()() {
@@ -12,7 +14,7 @@ Model StaticModelGenerator::operator()() {
 Model StaticModelGenerator::Generate() {
 	// generate the model
 	DoGenerate();
-	Model model(std::move(vertices), std::move(indices));
+	Model model = MeshOptimizer::Optimize(Model(std::move(vertices), std::move(indices)));
 
 	// reset the vectors
 	vertices = {};
@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) Levi van Rheenen. All rights reserved.
+ */
+#include "HotReloader.h"
+
+#include "../Game.h"
+#include "../Renderer/CustomShaderModelRenderer.h"
+
+namespace rheel {
+
+HotReloader::HotReloader(Game& game, const std::string& directory) :
+		_game(game),
+		_watcher(directory),
+		_thread(&HotReloader::_watch, this) {}
+
+HotReloader::~HotReloader() {
+	_stop_requested = true;
+	_thread.join();
+}
+
+void HotReloader::_watch() {
+	while (!_stop_requested) {
+		// wake up regularly to check whether the reloader is stopped
+		try {
+			for (const auto& path : _watcher.Poll(std::chrono::milliseconds(100))) {
+				_reload(path);
+			}
+		} catch (const std::exception& e) {
+			Log::Warning() << "Could not check for changed assets: " << e.what() << std::endl;
+		}
+	}
+}
+
+void HotReloader::_reload(const std::string& path) {
+	AssetLoader& assets = _game.GetAssetLoader();
+	std::string extension = std::filesystem::path(path).extension().string();
+
+	if (extension == ".png") {
+		_reload_asset(_game, assets.png, path, [](const Image& image) {
+			ImageTexture::Reload(image);
+		});
+	} else if (extension == ".dae") {
+		_reload_asset(_game, assets.collada, path, [&game = _game](const Model& model) {
+			game.GetRenderer().ReloadModel(model);
+		});
+	} else if (extension == ".rmesh") {
+		_reload_asset(_game, assets.mesh, path, [&game = _game](const Model& model) {
+			game.GetRenderer().ReloadModel(model);
+		});
+	} else if (extension == ".vox") {
+		_reload_asset(_game, assets.voxel, path, [&game = _game](const VoxelImage& image) {
+			game.GetRenderer().ReloadVoxelImage(image);
+		});
+	} else if (extension == ".glsl") {
+		_reload_asset(_game, assets.glsl, path, [](const Shader& shader) {
+			CustomShaderModelRenderer::ReloadShader(shader);
+		});
+	}
+}
+
+template<typename T, typename LoaderImpl, typename Refresh>
+AsyncTask<void> HotReloader::_reload_asset(Game& game, Loader<T, LoaderImpl>& loader, std::string path, Refresh refresh) {
+	// assets that are not in use do not have to be reloaded
+	if (!loader.IsCached(path)) {
+		co_return;
+	}
+
+	co_await game.GetThreadPool().Schedule();
+
+	std::optional<T> asset;
+
+	try {
+		asset = loader.LoadUncached(path);
+	} catch (const std::exception& e) {
+		Log::Warning() << "Could not reload " << path << ": " << e.what() << std::endl;
+		co_return;
+	}
+
+	// swap the asset at a frame boundary, when nothing else uses it
+	co_await game.NextFrame();
+
+	try {
+		if (auto cached = loader.ReplaceCached(path, std::move(*asset))) {
+			refresh(*cached);
+			Log::Info() << "Reloaded " << path << std::endl;
+		}
+	} catch (const std::exception& e) {
+		Log::Warning() << "Could not reload " << path << ": " << e.what() << std::endl;
+	}
+}
+
+}
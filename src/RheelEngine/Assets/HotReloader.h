@@ -0,0 +1,61 @@
+/*
+ * Copyright (c) Levi van Rheenen. All rights reserved.
+ */
+#ifndef RHEELENGINE_HOTRELOADER_H
+#define RHEELENGINE_HOTRELOADER_H
+#include "../_common.h"
+
+#include <thread>
+
+#include "AssetLoader.h"
+#include "../Util/FileWatcher.h"
+
+namespace rheel {
+
+class Game;
+
+/**
+ * Reloads assets when their files change on disk, so changes to images,
+ * models, voxel images and shaders show up without restarting the game. Only
+ * assets that are in the cache of one of the AssetLoader loaders are reloaded,
+ * with the same path as they were loaded with. The new asset is loaded on the
+ * thread pool, and swapped in at the start of the next frame: its contents
+ * replace those of the cached asset in place, so everything that uses the
+ * asset sees the new contents, and the GPU resources created for the asset
+ * (textures, model buffers and custom shader programs) are updated. Voxel
+ * images are meshed again by their voxel renderers.
+ *
+ * Files in mounted pack files are read from the pack file, so hot reloading
+ * is meant for development, with the assets on disk.
+ */
+class RE_API HotReloader {
+	RE_NO_COPY(HotReloader);
+	RE_NO_MOVE(HotReloader);
+
+public:
+	/**
+	 * Starts watching the directory (and its subdirectories) for changed
+	 * assets. Throws a runtime_error if the directory could not be watched.
+	 */
+	HotReloader(Game& game, const std::string& directory);
+
+	~HotReloader();
+
+private:
+	void _watch();
+	void _reload(const std::string& path);
+
+	template<typename T, typename LoaderImpl, typename Refresh>
+	static AsyncTask<void> _reload_asset(Game& game, Loader<T, LoaderImpl>& loader, std::string path, Refresh refresh);
+
+	Game& _game;
+	FileWatcher _watcher;
+
+	std::atomic_bool _stop_requested = false;
+	std::thread _thread;
+
+};
+
+}
+
+#endif
@@ -3,16 +3,192 @@
  */
 #include "Image.h"
 
+#include <bit>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define RE_IMAGE_SSE2
+#endif
+
+#if defined(__F16C__)
+#include <immintrin.h>
+#define RE_IMAGE_F16C
+#endif
+
 namespace rheel {
 
-Image::Image(unsigned width, unsigned height) :
-		Asset({ width, height, {} }) {
+static_assert(sizeof(Color) == 4 * sizeof(float), "Color must be four tightly packed floats");
+
+static std::uint16_t float_to_half(float value) {
+	constexpr std::uint32_t float_infinity = 255u << 23;
+	constexpr std::uint32_t half_overflow = (127u + 16u) << 23;
+	constexpr std::uint32_t denormal_magic = ((127u - 15u) + (23u - 10u) + 1u) << 23;
+
+	auto bits = std::bit_cast<std::uint32_t>(value);
+	std::uint32_t sign = bits & 0x80000000u;
+	bits ^= sign;
+
+	std::uint32_t half;
+
+	if (bits >= half_overflow) {
+		// infinity or NaN
+		half = bits > float_infinity ? 0x7e00u : 0x7c00u;
+	} else if (bits < (113u << 23)) {
+		// denormal or zero: let the float addition do the rounding
+		float denormal = std::bit_cast<float>(bits) + std::bit_cast<float>(denormal_magic);
+		half = std::bit_cast<std::uint32_t>(denormal) - denormal_magic;
+	} else {
+		// normal: rebias the exponent, and round the mantissa to nearest even
+		std::uint32_t odd_mantissa = (bits >> 13) & 1u;
+		bits += ((15u - 127u) << 23) + 0xfffu + odd_mantissa;
+		half = bits >> 13;
+	}
+
+	return std::uint16_t(half | (sign >> 16));
+}
+
+static float half_to_float(std::uint16_t half) {
+	constexpr std::uint32_t shifted_exponent = 0x7c00u << 13;
+	constexpr std::uint32_t magic = 113u << 23;
+
+	std::uint32_t bits = (half & 0x7fffu) << 13;
+	std::uint32_t exponent = bits & shifted_exponent;
+	bits += (127u - 15u) << 23;
+
+	if (exponent == shifted_exponent) {
+		// infinity or NaN
+		bits += (128u - 16u) << 23;
+	} else if (exponent == 0) {
+		// denormal or zero
+		bits += 1u << 23;
+		bits = std::bit_cast<std::uint32_t>(std::bit_cast<float>(bits) - std::bit_cast<float>(magic));
+	}
+
+	return std::bit_cast<float>(bits | (std::uint32_t(half & 0x8000u) << 16));
+}
+
+static std::uint8_t float_to_unorm8(float value) {
+	// NaN compares false, so it ends up as 0
+	if (!(value > 0.0f)) {
+		return 0;
+	}
+
+	if (value >= 1.0f) {
+		return 255;
+	}
+
+	return std::uint8_t(std::nearbyint(value * 255.0f));
+}
+
+static void decode_rgba8(const std::uint8_t* pixels, float* rgba, std::size_t count) {
+	std::size_t i = 0;
+
+#ifdef RE_IMAGE_SSE2
+	// four pixels per iteration: widen the 16 bytes to 32-bit integers, and
+	// convert those to normalized floats
+	const __m128i zero = _mm_setzero_si128();
+	const __m128 scale = _mm_set1_ps(1.0f / 255.0f);
+
+	for (; i + 4 <= count; i += 4) {
+		__m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels + 4 * i));
+		__m128i low = _mm_unpacklo_epi8(bytes, zero);
+		__m128i high = _mm_unpackhi_epi8(bytes, zero);
+
+		_mm_storeu_ps(rgba + 4 * i + 0, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(low, zero)), scale));
+		_mm_storeu_ps(rgba + 4 * i + 4, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(low, zero)), scale));
+		_mm_storeu_ps(rgba + 4 * i + 8, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(high, zero)), scale));
+		_mm_storeu_ps(rgba + 4 * i + 12, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(high, zero)), scale));
+	}
+#endif
+
+	for (; i < count; i++) {
+		for (std::size_t c = 0; c < 4; c++) {
+			rgba[4 * i + c] = float(pixels[4 * i + c]) * (1.0f / 255.0f);
+		}
+	}
+}
+
+static void encode_rgba8(const float* rgba, std::uint8_t* pixels, std::size_t count) {
+	std::size_t i = 0;
+
+#ifdef RE_IMAGE_SSE2
+	// four pixels per iteration: round to 32-bit integers, and narrow those
+	// with unsigned saturation, which clamps to [0 .. 255]
+	const __m128 scale = _mm_set1_ps(255.0f);
+
+	for (; i + 4 <= count; i += 4) {
+		__m128i p0 = _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(rgba + 4 * i + 0), scale));
+		__m128i p1 = _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(rgba + 4 * i + 4), scale));
+		__m128i p2 = _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(rgba + 4 * i + 8), scale));
+		__m128i p3 = _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(rgba + 4 * i + 12), scale));
+
+		__m128i bytes = _mm_packus_epi16(_mm_packs_epi32(p0, p1), _mm_packs_epi32(p2, p3));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(pixels + 4 * i), bytes);
+	}
+#endif
+
+	for (; i < count; i++) {
+		for (std::size_t c = 0; c < 4; c++) {
+			pixels[4 * i + c] = float_to_unorm8(rgba[4 * i + c]);
+		}
+	}
+}
+
+static void decode_rgba16f(const std::uint8_t* pixels, float* rgba, std::size_t count) {
+	const auto* halves = reinterpret_cast<const std::uint16_t*>(pixels);
+	std::size_t i = 0;
+
+#ifdef RE_IMAGE_F16C
+	// two pixels per iteration
+	for (; i + 2 <= count; i += 2) {
+		__m128i packed = _mm_loadu_si128(reinterpret_cast<const __m128i*>(halves + 4 * i));
+		_mm_storeu_ps(rgba + 4 * i, _mm_cvtph_ps(packed));
+		_mm_storeu_ps(rgba + 4 * i + 4, _mm_cvtph_ps(_mm_unpackhi_epi64(packed, packed)));
+	}
+#endif
+
+	for (i *= 4; i < 4 * count; i++) {
+		rgba[i] = half_to_float(halves[i]);
+	}
+}
+
+static void encode_rgba16f(const float* rgba, std::uint8_t* pixels, std::size_t count) {
+	auto* halves = reinterpret_cast<std::uint16_t*>(pixels);
+	std::size_t i = 0;
+
+#ifdef RE_IMAGE_F16C
+	// one pixel per iteration, rounding to nearest even
+	for (; i < count; i++) {
+		__m128i packed = _mm_cvtps_ph(_mm_loadu_ps(rgba + 4 * i), _MM_FROUND_TO_NEAREST_INT);
+		_mm_storel_epi64(reinterpret_cast<__m128i*>(halves + 4 * i), packed);
+	}
+#endif
+
+	for (i *= 4; i < 4 * count; i++) {
+		halves[i] = float_to_half(rgba[i]);
+	}
+}
+
+Image::Image(unsigned width, unsigned height, PixelFormat format) :
+		Asset({ width, height, format, {} }) {
 
-	GetRaw()->pixels.resize(width * height);
+	GetRaw()->pixels.resize(std::size_t(width) * height * GetPixelSize(format));
 }
 
-Image::Image(unsigned width, unsigned height, std::vector<Color> pixels) :
-		Asset({ width, height, std::move(pixels) }) {}
+Image::Image(unsigned width, unsigned height, const std::vector<Color>& pixels, PixelFormat format) :
+		Image(width, height, format) {
+
+	EncodePixels(format, reinterpret_cast<const float*>(pixels.data()), GetRaw()->pixels.data(), std::size_t(width) * height);
+}
+
+Image::Image(unsigned width, unsigned height, PixelFormat format, std::vector<std::uint8_t> pixels) :
+		Asset({ width, height, format, std::move(pixels) }) {
+
+	if (GetRaw()->pixels.size() != std::size_t(width) * height * GetPixelSize(format)) {
+		throw std::runtime_error("Image pixel data does not match its dimensions and format");
+	}
+}
 
 unsigned Image::GetWidth() const {
 	return GetRaw()->width;
@@ -22,33 +198,156 @@ unsigned Image::GetHeight() const {
 	return GetRaw()->height;
 }
 
-const Color& Image::At(unsigned x, unsigned y) const {
+PixelFormat Image::GetFormat() const {
+	return GetRaw()->format;
+}
+
+Color Image::GetPixel(unsigned x, unsigned y) const {
 	const auto* data = GetRaw();
-	return data->pixels[y * data->width + x];
+	std::size_t offset = (std::size_t(y) * data->width + x) * GetPixelSize(data->format);
+
+	float rgba[4];
+	DecodePixels(data->format, data->pixels.data() + offset, rgba, 1);
+	return Color(rgba[0], rgba[1], rgba[2], rgba[3]);
 }
 
-Color& Image::At(unsigned x, unsigned y) {
+void Image::SetPixel(unsigned x, unsigned y, const Color& color) {
 	auto* data = GetRaw();
-	return data->pixels[y * data->width + x];
+	std::size_t offset = (std::size_t(y) * data->width + x) * GetPixelSize(data->format);
+
+	float rgba[4] = { color.Red(), color.Green(), color.Blue(), color.Alpha() };
+	EncodePixels(data->format, rgba, data->pixels.data() + offset, 1);
+}
+
+std::span<const std::uint8_t> Image::GetData() const {
+	return GetRaw()->pixels;
+}
+
+std::span<std::uint8_t> Image::GetData() {
+	return GetRaw()->pixels;
 }
 
 Image Image::SubImage(unsigned x, unsigned y, unsigned width, unsigned height) const {
-	Image image(width, height);
-	for (unsigned i = 0; i < width; i++) {
-		for (unsigned j = 0; j < height; j++) {
-			image.At(i, j) = At(i + x, j + y);
-		}
+	const auto* data = GetRaw();
+	std::size_t pixel_size = GetPixelSize(data->format);
+
+	Image image(width, height, data->format);
+	auto* sub_data = image.GetRaw();
+
+	for (unsigned j = 0; j < height; j++) {
+		std::memcpy(sub_data->pixels.data() + std::size_t(j) * width * pixel_size,
+				data->pixels.data() + ((std::size_t(y) + j) * data->width + x) * pixel_size,
+				width * pixel_size);
 	}
 
 	return image;
 }
 
-const float* Image::GetRawColorData() const {
-	return reinterpret_cast<const float*>(GetRaw()->pixels.data());
+Image Image::ConvertTo(PixelFormat format) const {
+	const auto* data = GetRaw();
+
+	if (data->format == format) {
+		return Image(data->width, data->height, format, data->pixels);
+	}
+
+	std::vector<float> rgba = GetFloatData();
+
+	Image image(data->width, data->height, format);
+	EncodePixels(format, rgba.data(), image.GetRaw()->pixels.data(), std::size_t(data->width) * data->height);
+	return image;
+}
+
+std::vector<float> Image::GetFloatData() const {
+	const auto* data = GetRaw();
+	std::size_t count = std::size_t(data->width) * data->height;
+
+	std::vector<float> rgba(4 * count);
+	DecodePixels(data->format, data->pixels.data(), rgba.data(), count);
+	return rgba;
+}
+
+std::size_t Image::GetMemoryUsage() const {
+	if (IsNull()) {
+		return 0;
+	}
+
+	return sizeof(image_data) + GetRaw()->pixels.capacity();
 }
 
 Image Image::Null() {
 	return Image(nullptr);
 }
 
+std::size_t Image::GetPixelSize(PixelFormat format) {
+	switch (format) {
+		case PixelFormat::RGBA8: return 4;
+		case PixelFormat::RG8: return 2;
+		case PixelFormat::R8: return 1;
+		case PixelFormat::RGBA16F: return 8;
+	}
+
+	abort();
+}
+
+std::size_t Image::GetChannelCount(PixelFormat format) {
+	switch (format) {
+		case PixelFormat::RGBA8: return 4;
+		case PixelFormat::RG8: return 2;
+		case PixelFormat::R8: return 1;
+		case PixelFormat::RGBA16F: return 4;
+	}
+
+	abort();
+}
+
+void Image::DecodePixels(PixelFormat format, const std::uint8_t* pixels, float* rgba, std::size_t count) {
+	switch (format) {
+		case PixelFormat::RGBA8:
+			decode_rgba8(pixels, rgba, count);
+			break;
+		case PixelFormat::RGBA16F:
+			decode_rgba16f(pixels, rgba, count);
+			break;
+		case PixelFormat::RG8:
+		case PixelFormat::R8: {
+			std::size_t channels = GetChannelCount(format);
+
+			for (std::size_t i = 0; i < count; i++) {
+				for (std::size_t c = 0; c < 4; c++) {
+					if (c < channels) {
+						rgba[4 * i + c] = float(pixels[channels * i + c]) * (1.0f / 255.0f);
+					} else {
+						rgba[4 * i + c] = c == 3 ? 1.0f : 0.0f;
+					}
+				}
+			}
+
+			break;
+		}
+	}
+}
+
+void Image::EncodePixels(PixelFormat format, const float* rgba, std::uint8_t* pixels, std::size_t count) {
+	switch (format) {
+		case PixelFormat::RGBA8:
+			encode_rgba8(rgba, pixels, count);
+			break;
+		case PixelFormat::RGBA16F:
+			encode_rgba16f(rgba, pixels, count);
+			break;
+		case PixelFormat::RG8:
+		case PixelFormat::R8: {
+			std::size_t channels = GetChannelCount(format);
+
+			for (std::size_t i = 0; i < count; i++) {
+				for (std::size_t c = 0; c < channels; c++) {
+					pixels[channels * i + c] = float_to_unorm8(rgba[4 * i + c]);
+				}
+			}
+
+			break;
+		}
+	}
+}
+
 }
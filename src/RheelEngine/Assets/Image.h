@@ -5,15 +5,28 @@
 #define RHEELENGINE_IMAGE_H
 #include "../_common.h"
 
+#include <span>
+
 #include "Asset.h"
 #include "../Color.h"
 
 namespace rheel {
 
+/**
+ * The format in which the pixels of an image are stored. The 8-bit formats
+ * store normalized values in [0 .. 1], RGBA16F stores half-precision floats.
+ * When an image with less than four channels is read as colors, the missing
+ * color channels are 0 and the missing alpha channel is 1, like in OpenGL.
+ */
+enum class PixelFormat {
+	RGBA8, RG8, R8, RGBA16F
+};
+
 struct image_data {
 	unsigned width;
 	unsigned height;
-	std::vector<Color> pixels;
+	PixelFormat format;
+	std::vector<std::uint8_t> pixels;
 };
 
 class RE_API Image : public Asset<image_data> {
@@ -22,22 +35,54 @@ public:
 	/**
 	 * Creates an empty image with the given dimensions
 	 */
-	Image(unsigned width, unsigned height);
+	Image(unsigned width, unsigned height, PixelFormat format = PixelFormat::RGBA8);
 
 	/*
-	 * Creates an image with the given pixel data
+	 * Creates an image with the given pixel data, stored in the given format
 	 */
-	Image(unsigned width, unsigned height, std::vector<Color> pixels);
+	Image(unsigned width, unsigned height, const std::vector<Color>& pixels, PixelFormat format = PixelFormat::RGBA8);
+
+	/*
+	 * Creates an image with the given raw pixel data, which must be in the
+	 * given format, without padding between rows.
+	 */
+	Image(unsigned width, unsigned height, PixelFormat format, std::vector<std::uint8_t> pixels);
 
 	unsigned GetWidth() const;
 	unsigned GetHeight() const;
+	PixelFormat GetFormat() const;
 
-	const Color& At(unsigned x, unsigned y) const;
-	Color& At(unsigned x, unsigned y);
+	Color GetPixel(unsigned x, unsigned y) const;
+	void SetPixel(unsigned x, unsigned y, const Color& color);
+
+	/**
+	 * Returns the raw pixel data, in the format of the image, row by row
+	 * without padding.
+	 */
+	std::span<const std::uint8_t> GetData() const;
+
+	/**
+	 * Returns the raw pixel data, in the format of the image, row by row
+	 * without padding.
+	 */
+	std::span<std::uint8_t> GetData();
 
 	Image SubImage(unsigned x, unsigned y, unsigned width, unsigned height) const;
 
-	const float* GetRawColorData() const;
+	/**
+	 * Returns a copy of this image, stored in the given format.
+	 */
+	Image ConvertTo(PixelFormat format) const;
+
+	/**
+	 * Returns the pixels of this image as RGBA floats, four per pixel.
+	 */
+	std::vector<float> GetFloatData() const;
+
+	/**
+	 * Returns the approximate amount of memory used by the image, in bytes.
+	 */
+	std::size_t GetMemoryUsage() const;
 
 private:
 	Image() = default;
@@ -47,6 +92,26 @@ private:
 public:
 	static Image Null();
 
+	/**
+	 * Returns the size of a single pixel in the given format, in bytes.
+	 */
+	static std::size_t GetPixelSize(PixelFormat format);
+
+	/**
+	 * Returns the number of channels of a pixel in the given format.
+	 */
+	static std::size_t GetChannelCount(PixelFormat format);
+
+	/**
+	 * Converts count pixels in the given format to RGBA floats.
+	 */
+	static void DecodePixels(PixelFormat format, const std::uint8_t* pixels, float* rgba, std::size_t count);
+
+	/**
+	 * Converts count pixels from RGBA floats to the given format.
+	 */
+	static void EncodePixels(PixelFormat format, const float* rgba, std::uint8_t* pixels, std::size_t count);
+
 };
 
 }
@@ -5,6 +5,11 @@
 
 #include <cstring>
 
+#include "../MeshOptimizer.h"
+#include "../../Util/NumberParser.h"
+#include "../../Util/ParallelFor.h"
+#include "../../Util/VirtualFileSystem.h"
+
 namespace rheel {
 
 // TODO: we need a better collada loader
@@ -99,31 +104,44 @@ ColladaLoader::Geometry::Geometry(XmlNode geometry) {
 	std::vector<float> positions = ReadSource_(sources[vertices_inputs["POSITION"]]);
 	std::vector<float> normals = ReadSource_(sources[inputs["NORMAL"]]);
 	std::vector<float> texcoords = ReadSource_(sources[inputs["TEXCOORD"]]);
+	unsigned texcoord_stride = SourceStride_(sources[inputs["TEXCOORD"]], 2);
 
 	auto extract_vec_3 = [](const std::vector<float>& v, std::size_t i) {
 		return vec3(v[3 * i], v[3 * i + 1], v[3 * i + 2]);
 	};
 
+	auto extract_vec_2 = [](const std::vector<float>& v, std::size_t i, unsigned stride) {
+		return vec2(v[stride * i], v[stride * i + 1]);
+	};
+
 	unsigned position_offset = offsets["VERTEX"];
 	unsigned normal_offset = offsets["NORMAL"];
 	unsigned texcoord_offset = offsets["TEXCOORD"];
 
-	// assemble the mesh
-	XmlNode p = polylist.child("p");
-	assert(p);
-	auto p_list = _create_vector_unsigned(p);
+	// every vertex of a polygon has one index per input offset
+	unsigned stride = 0;
+	for (const auto&[semantic, offset] : offsets) {
+		stride = std::max(stride, offset + 1);
+	}
 
+	// assemble the mesh
 	auto polylist_count = polylist.attribute("count");
 	assert(polylist_count);
 	unsigned count = strtoul(polylist_count.value(), nullptr, 10);
 
-	unsigned stride = (p_list.size() / 3) / count;
-	assert(p_list.size() % stride == 0);
+	XmlNode p = polylist.child("p");
+	assert(p);
+	auto p_list = _create_vector_unsigned(p, count * 3 * stride);
+
+	// reserve for the worst case, where no vertices are shared
+	_vertices.reserve(count * 3);
+	_indices.reserve(count * 3);
+	_vertex_indices.reserve(count * 3);
 
 	for (unsigned i = 0; i < p_list.size(); i += stride) {
 		vec3 position = extract_vec_3(positions, p_list[i + position_offset]);
 		vec3 normal = extract_vec_3(normals, p_list[i + normal_offset]);
-		vec2 texcoord = extract_vec_3(texcoords, p_list[i + texcoord_offset]);
+		vec2 texcoord = extract_vec_2(texcoords, p_list[i + texcoord_offset], texcoord_stride);
 
 		model_vertex vertex{ position, normal, texcoord };
 
@@ -152,6 +170,16 @@ std::vector<float> ColladaLoader::Geometry::ReadSource_(XmlNode source) {
 	return _create_vector_float(float_array, strtoul(count.value(), nullptr, 10));
 }
 
+unsigned ColladaLoader::Geometry::SourceStride_(XmlNode source, unsigned default_stride) {
+	XmlAttribute stride = source.child("technique_common").child("accessor").attribute("stride");
+
+	if (!stride) {
+		return default_stride;
+	}
+
+	return strtoul(stride.value(), nullptr, 10);
+}
+
 void ColladaLoader::_parse_collada() const {
 	// get the up vector
 	XmlNode root = _xml_document->first_child();
@@ -168,9 +196,7 @@ void ColladaLoader::_parse_collada() const {
 	XmlNode library_geometries = root.child("library_geometries");
 	assert(library_geometries);
 
-	for (XmlNode geometry = library_geometries.child("geometry"); geometry; geometry = geometry.next_sibling("geometry")) {
-		_parse_geometry(geometry);
-	}
+	_parse_geometries(library_geometries);
 
 	// parse the scenes
 	XmlNode library_visual_scenes = root.child("library_visual_scenes");
@@ -183,11 +209,27 @@ void ColladaLoader::_parse_collada() const {
 	}
 }
 
-void ColladaLoader::_parse_geometry(XmlNode geometry) const {
-	XmlAttribute id = geometry.attribute("id");
-	assert(id);
+void ColladaLoader::_parse_geometries(XmlNode library_geometries) const {
+	// The geometries are independent of each other, so they are parsed in
+	// parallel.
+	std::vector<XmlNode> nodes;
+
+	for (XmlNode geometry = library_geometries.child("geometry"); geometry; geometry = geometry.next_sibling("geometry")) {
+		nodes.push_back(geometry);
+	}
+
+	std::vector<Geometry> geometries(nodes.size());
+
+	parallel_for(_thread_pool, nodes.size(), [&nodes, &geometries](std::size_t i) {
+		geometries[i] = Geometry(nodes[i]);
+	});
+
+	for (std::size_t i = 0; i < nodes.size(); i++) {
+		XmlAttribute id = nodes[i].attribute("id");
+		assert(id);
 
-	_geometries.insert({ "#" + std::string(id.value()), Geometry(geometry) });
+		_geometries.insert({ "#" + std::string(id.value()), std::move(geometries[i]) });
+	}
 }
 
 void ColladaLoader::_parse_scene(XmlNode scene) const {
@@ -234,13 +276,25 @@ void ColladaLoader::_add_geometry(const Geometry& geometry, const mat4& transfor
 	}
 }
 
+ColladaLoader::ColladaLoader(ThreadPool* thread_pool) :
+		_thread_pool(thread_pool) {}
+
 Model ColladaLoader::Load(const std::string& path) const {
+	virtual_file file = VirtualFileSystem::Open(path);
+
 	_xml_document = std::make_unique<XmlDocument>();
-	_xml_document->load_file(path.c_str());
+	_xml_document->load_buffer(file.bytes.data(), file.bytes.size());
 
 	_parse_collada();
 	Model model(std::move(_vertices), std::move(_indices));
 
+	mesh_statistics before = MeshOptimizer::Analyze(model);
+	model = MeshOptimizer::Optimize(model);
+	mesh_statistics after = MeshOptimizer::Analyze(model);
+
+	Log::Info() << "Optimized " << path << ": ACMR " << before.acmr << " -> " << after.acmr
+			<< ", ATVR " << before.atvr << " -> " << after.atvr << std::endl;
+
 	_xml_document.reset();
 
 	_geometries = {};
@@ -251,54 +305,26 @@ Model ColladaLoader::Load(const std::string& path) const {
 }
 
 std::vector<unsigned> ColladaLoader::_create_vector_unsigned(XmlNode node, int size) {
-	// create the vector
 	std::vector<unsigned> vec;
-
-	// parse the values
-	const char* values = node.child_value();
-	const char* tmp = values;
-	do {
-		int l = strcspn(tmp, " ");
-
-		if (l > 0) {
-			vec.push_back(strtoul(tmp, nullptr, 10));
-		}
-
-		tmp += l + 1;
-	} while (tmp[-1]);
+	parse_numbers(node.child_value(), vec, std::max(size, 0));
 
 	// assert that we read everything correctly
 	if (size >= 0) {
 		assert(vec.size() == (unsigned) size);
 	}
 
-	// return the vector
 	return vec;
 }
 
 std::vector<float> ColladaLoader::_create_vector_float(XmlNode node, int size) {
-	// create the vector
 	std::vector<float> vec;
-
-	// parse the values
-	const char* values = node.child_value();
-	const char* tmp = values;
-	do {
-		int l = strcspn(tmp, " ");
-
-		if (l > 0) {
-			vec.push_back(strtof(tmp, nullptr));
-		}
-
-		tmp += l + 1;
-	} while (tmp[-1]);
+	parse_numbers(node.child_value(), vec, std::max(size, 0));
 
 	// assert that we read everything correctly
 	if (size >= 0) {
 		assert(vec.size() == (unsigned) size);
 	}
 
-	// return the vector
 	return vec;
 }
 
@@ -31,7 +31,7 @@ private:
 	private:
 		struct vertex_hash {
 			constexpr std::size_t operator()(const model_vertex& v) const {
-				return hash_all(v.position, v.position, v.texture);
+				return hash_all(v.position, v.normal, v.texture);
 			}
 		};
 
@@ -47,15 +47,23 @@ private:
 
 	private:
 		static std::vector<float> ReadSource_(XmlNode source);
+		static unsigned SourceStride_(XmlNode source, unsigned default_stride);
 
 	};
 
 public:
+	/**
+	 * Creates a collada loader. If a thread pool is given, the geometries of a
+	 * file are parsed in parallel on the pool, as well as on the thread that
+	 * loads the file.
+	 */
+	explicit ColladaLoader(ThreadPool* thread_pool = nullptr);
+
 	Model Load(const std::string& path) const override;
 
 private:
 	void _parse_collada() const;
-	void _parse_geometry(XmlNode geometry) const;
+	void _parse_geometries(XmlNode library_geometries) const;
 	void _parse_scene(XmlNode scene) const;
 
 	void _add_geometry(const Geometry& geometry, const mat4& transform) const;
@@ -69,6 +77,8 @@ private:
 
 	mutable char _up = 'y';
 
+	ThreadPool* _thread_pool;
+
 private:
 	static std::vector<unsigned> _create_vector_unsigned(XmlNode node, int size = -1);
 	static std::vector<float> _create_vector_float(XmlNode node, int size = -1);
@@ -3,19 +3,13 @@
  */
 #include "GlslLoader.h"
 
-#include <fstream>
-#include <streambuf>
+#include "../../Util/VirtualFileSystem.h"
 
 namespace rheel {
 
 Shader rheel::GlslLoader::Load(const std::string& path) const {
-	std::ifstream f(path);
-
-	if (!f) {
-		throw std::runtime_error("Error while reading shader file: " + path);
-	}
-
-	return Shader(std::string((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>()));
+	virtual_file file = VirtualFileSystem::Open(path);
+	return Shader(std::string(reinterpret_cast<const char*>(file.bytes.data()), file.bytes.size()));
 }
 
 }
\ No newline at end of file
@@ -5,7 +5,8 @@
 #define RHEELENGINE_LOADER_H
 #include "../../_common.h"
 
-#include "../../Util/Cache.h"
+#include "../../ThreadPool.h"
+#include "../../Util/ShardedCache.h"
 
 namespace rheel {
 
@@ -38,27 +39,105 @@ public:
 	 * Loads an asset from the given path. The loader will ensure that the asset
 	 * is only loaded from disk once. This method is thread-safe.
 	 */
-	T Load(const std::string& path) {
-		return _cache.Get(path, _load);
+	T Load(std::string_view path) {
+		return _cache.GetCopy(path, [this](const std::string& p) { return _load(p); });
 	}
 
 	/**
 	 * Loads an asset from the given path. The loader will ensure that the asset
 	 * is only loaded from disk once. This method is thread-safe.
 	 */
-	void Preload(const std::string& path) {
-		_cache.Put(path, _load);
+	void Preload(std::string_view path) {
+		_cache.Put(path, [this](const std::string& p) { return _load(p); });
 	}
 
-private:
-	Cache<std::string, T, keep_policy, true> _cache;
+	/**
+	 * Loads an asset from the given path on a background thread of the thread
+	 * pool. The awaiting coroutine continues on that background thread once
+	 * the asset is loaded; use MainWindow::NextFrame() to get back to the main
+	 * thread.
+	 */
+	AsyncTask<T> LoadAsync(ThreadPool& pool, std::string path) {
+		co_await pool.Schedule();
+		co_return Load(path);
+	}
+
+	/**
+	 * Returns whether the asset for the given path is in the cache of this
+	 * loader.
+	 */
+	bool IsCached(std::string_view path) const {
+		return _cache.ContainsKey(path);
+	}
+
+	/**
+	 * Loads the asset from the given path, without looking in or adding to
+	 * the cache. Use ReplaceCached() to swap the result into the cache.
+	 */
+	T LoadUncached(const std::string& path) const {
+		return _load(path);
+	}
+
+	/**
+	 * Replaces the contents of the cached asset for the given path with those
+	 * of the given asset, in place, so everything that uses the cached asset
+	 * sees the new contents. Returns the cached asset, or an empty optional if
+	 * the path is not in the cache. This is used for hot reloading, and must
+	 * only be done while no other thread uses the asset.
+	 */
+	std::optional<T> ReplaceCached(std::string_view path, T asset) {
+		if (!_cache.ContainsKey(path)) {
+			return {};
+		}
+
+		T cached = _cache.GetCopy(path, [&asset](const std::string&) { return asset; });
+		cached.ReplaceContents(std::move(asset));
+
+		return cached;
+	}
+
+	/**
+	 * Sets the maximum amount of memory, in bytes, that the assets cached by
+	 * this loader may use. When the budget is exceeded, the least recently
+	 * used assets are evicted from the cache. Evicted assets stay valid for as
+	 * long as they are used elsewhere, but will be loaded from disk again when
+	 * requested. By default, the budget is unlimited.
+	 */
+	void SetMemoryBudget(std::size_t bytes) {
+		_cache.SetCapacity(bytes);
+	}
+
+	/**
+	 * Returns the maximum amount of memory, in bytes, that the assets cached
+	 * by this loader may use.
+	 */
+	std::size_t GetMemoryBudget() const {
+		return _cache.GetCapacity();
+	}
+
+	/**
+	 * Returns the amount of memory, in bytes, used by the assets cached by this
+	 * loader.
+	 */
+	std::size_t GetMemoryUsage() const {
+		return _cache.GetCost();
+	}
 
 private:
-	static T _load(const std::string& path) {
+	T _load(const std::string& path) const {
 		Log::Info() << "Loading asset " << path << std::endl;
-		return LoaderImpl().Load(path);
+
+		// loaders that can split up their work get the thread pool
+		if constexpr (std::is_constructible_v<LoaderImpl, ThreadPool*>) {
+			return LoaderImpl(_thread_pool).Load(path);
+		} else {
+			return LoaderImpl().Load(path);
+		}
 	}
 
+	ShardedCache<std::string, T, least_recently_used_policy, memory_cost> _cache;
+	std::atomic<ThreadPool*> _thread_pool = nullptr;
+
 };
 
 }
@@ -0,0 +1,183 @@
+/*
+ * Copyright (c) Levi van Rheenen. All rights reserved.
+ */
+#include "MeshLoader.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+#include "../../Util/VirtualFileSystem.h"
+
+namespace rheel {
+
+static_assert(std::endian::native == std::endian::little, "The binary mesh format is little-endian");
+static_assert(sizeof(model_vertex) == 8 * sizeof(float), "model_vertex must be tightly packed");
+static_assert(sizeof(model_lod) == 12, "model_lod must be tightly packed");
+
+static constexpr char mesh_magic[4] = { 'R', 'M', 'S', 'H' };
+static constexpr std::uint64_t mesh_alignment = 16;
+
+struct mesh_file_header {
+	char magic[4];
+	std::uint32_t version;
+	std::uint32_t render_type;
+	std::uint32_t lod_count;
+	std::uint64_t vertex_count;
+	std::uint64_t vertex_offset;
+	std::uint64_t index_count;
+	std::uint64_t index_offset;
+	std::uint64_t lod_offset;
+	float bounds_min[3];
+	float bounds_max[3];
+};
+
+static_assert(sizeof(mesh_file_header) == 80, "mesh_file_header must be tightly packed");
+
+static std::uint64_t align(std::uint64_t offset) {
+	return (offset + mesh_alignment - 1) / mesh_alignment * mesh_alignment;
+}
+
+// checks that count elements of the given size at the offset lie within the
+// file, without overflowing
+static bool in_file(std::uint64_t offset, std::uint64_t count, std::uint64_t element_size, std::uint64_t file_size) {
+	if (offset % alignof(float) != 0 || offset > file_size) {
+		return false;
+	}
+
+	return count <= (file_size - offset) / element_size;
+}
+
+Model MeshLoader::Load(const std::string& path) const {
+	virtual_file file = VirtualFileSystem::Open(path);
+
+	// the model refers to the file contents directly, which requires them to
+	// be aligned. Files on disk and uncompressed files in pack files always
+	// are, other data is copied.
+	if (reinterpret_cast<std::uintptr_t>(file.bytes.data()) % mesh_alignment != 0) {
+		auto copy = std::make_shared<std::vector<std::byte>>(file.bytes.begin(), file.bytes.end());
+		file = virtual_file{ copy, *copy };
+	}
+
+	const std::byte* data = file.bytes.data();
+	std::uint64_t size = file.bytes.size();
+
+	if (size < sizeof(mesh_file_header)) {
+		throw std::runtime_error("Mesh file " + path + " is too small");
+	}
+
+	mesh_file_header header;
+	std::memcpy(&header, data, sizeof(mesh_file_header));
+
+	if (std::memcmp(header.magic, mesh_magic, sizeof(mesh_magic)) != 0) {
+		throw std::runtime_error("File " + path + " is not a mesh file");
+	}
+
+	if (header.version != version) {
+		throw std::runtime_error("Mesh file " + path + " has unsupported version " + std::to_string(header.version));
+	}
+
+	if (header.render_type > std::uint32_t(RenderType::LINES)) {
+		throw std::runtime_error("Mesh file " + path + " has an invalid render type");
+	}
+
+	if (!in_file(header.vertex_offset, header.vertex_count, sizeof(model_vertex), size) ||
+			!in_file(header.index_offset, header.index_count, sizeof(unsigned), size) ||
+			!in_file(header.lod_offset, header.lod_count, sizeof(model_lod), size)) {
+		throw std::runtime_error("Mesh file " + path + " is corrupt");
+	}
+
+	std::vector<model_lod> lods(header.lod_count);
+	if (header.lod_count > 0) {
+		std::memcpy(lods.data(), data + header.lod_offset, header.lod_count * sizeof(model_lod));
+	}
+
+	for (const auto& lod : lods) {
+		if (lod.first_index > header.index_count || lod.index_count > header.index_count - lod.first_index) {
+			throw std::runtime_error("Mesh file " + path + " has an invalid level of detail");
+		}
+	}
+
+	std::span<const model_vertex> vertices(reinterpret_cast<const model_vertex*>(data + header.vertex_offset), header.vertex_count);
+	std::span<const unsigned> indices(reinterpret_cast<const unsigned*>(data + header.index_offset), header.index_count);
+
+	// the indices are used for rendering as they are, so an index outside of
+	// the vertices would read outside of the vertex buffer
+	if (!indices.empty() && *std::max_element(indices.begin(), indices.end()) >= header.vertex_count) {
+		throw std::runtime_error("Mesh file " + path + " has an index outside of its vertices");
+	}
+
+	model_bounds bounds{
+			vec3(header.bounds_min[0], header.bounds_min[1], header.bounds_min[2]),
+			vec3(header.bounds_max[0], header.bounds_max[1], header.bounds_max[2])
+	};
+
+	return Model(std::move(file.storage), vertices, indices, bounds, std::move(lods), RenderType(header.render_type));
+}
+
+void MeshLoader::Write(const Model& model, const std::string& path) {
+	auto vertices = model.GetVertices();
+	auto indices = model.GetIndices();
+	const auto& lods = model.GetLods();
+	const auto& bounds = model.GetBounds();
+
+	mesh_file_header header{};
+	std::memcpy(header.magic, mesh_magic, sizeof(mesh_magic));
+	header.version = version;
+	header.render_type = std::uint32_t(model.GetRenderType());
+	header.lod_count = lods.size();
+	header.vertex_count = vertices.size();
+	header.vertex_offset = align(sizeof(mesh_file_header));
+	header.index_count = indices.size();
+	header.index_offset = align(header.vertex_offset + vertices.size_bytes());
+	header.lod_offset = align(header.index_offset + indices.size_bytes());
+	header.bounds_min[0] = bounds.min.x;
+	header.bounds_min[1] = bounds.min.y;
+	header.bounds_min[2] = bounds.min.z;
+	header.bounds_max[0] = bounds.max.x;
+	header.bounds_max[1] = bounds.max.y;
+	header.bounds_max[2] = bounds.max.z;
+
+	// Models that were loaded from the file refer to its mapped contents, so
+	// the file must not be changed in place. Write a new file instead, and
+	// replace the old one with it.
+	std::string temporary_path = path + ".tmp";
+	std::error_code error;
+
+	{
+		std::ofstream output(temporary_path, std::ios::binary | std::ios::trunc);
+		if (!output) {
+			throw std::runtime_error("Could not open " + temporary_path + " for writing");
+		}
+
+		auto write_at = [&output](std::uint64_t offset, const void* data, std::size_t size) {
+			static constexpr char padding[mesh_alignment] = {};
+			output.write(padding, std::streamsize(offset - std::uint64_t(output.tellp())));
+			output.write(static_cast<const char*>(data), std::streamsize(size));
+		};
+
+		write_at(0, &header, sizeof(mesh_file_header));
+		write_at(header.vertex_offset, vertices.data(), vertices.size_bytes());
+		write_at(header.index_offset, indices.data(), indices.size_bytes());
+		write_at(header.lod_offset, lods.data(), lods.size() * sizeof(model_lod));
+
+		output.close();
+
+		if (!output) {
+			std::filesystem::remove(temporary_path, error);
+			throw std::runtime_error("Could not write mesh file " + path);
+		}
+	}
+
+	std::filesystem::rename(temporary_path, path, error);
+
+	if (error) {
+		std::string message = error.message();
+		std::filesystem::remove(temporary_path, error);
+		throw std::runtime_error("Could not replace mesh file " + path + ": " + message);
+	}
+}
+
+}
@@ -0,0 +1,45 @@
+/*
+ * Copyright (c) Levi van Rheenen. All rights reserved.
+ */
+#ifndef RHEELENGINE_MESHLOADER_H
+#define RHEELENGINE_MESHLOADER_H
+#include "../../_common.h"
+
+#include "Loader.h"
+#include "../Model.h"
+
+namespace rheel {
+
+/**
+ * Loader for the engine-native binary mesh format (.rmesh). The file consists
+ * of a fixed header, followed by the vertex blob, the index blob, and the
+ * level of detail table. The blobs have the exact memory layout of
+ * model_vertex and unsigned, so the file is memory-mapped and the model
+ * refers to the mapped data directly, without parsing or copying it.
+ *
+ * Use Write() or the MeshConverter tool to create .rmesh files from models
+ * in other formats. As loaded models refer to the mapped file, .rmesh files
+ * must not be modified in place while they are in use; replace them instead,
+ * as Write() does.
+ */
+class RE_API MeshLoader : public AbstractLoader<Model> {
+	friend class AssetLoader;
+
+public:
+	static constexpr std::uint32_t version = 1;
+
+	Model Load(const std::string& path) const override;
+
+	/**
+	 * Writes the model to the given path in the binary mesh format. The model
+	 * is written to a temporary file first, which then replaces the file at
+	 * the path, so models that are loaded from the old file stay valid.
+	 * Throws a runtime_error if the file could not be written.
+	 */
+	static void Write(const Model& model, const std::string& path);
+
+};
+
+}
+
+#endif
@@ -5,38 +5,60 @@
 
 #include <png.h>
 
-#include <fstream>
+#include <bit>
+#include <chrono>
+#include <cstring>
 
-#define FLOAT(x) ((x) / 255.0f)
+#include "../../Util/ParallelFor.h"
+#include "../../Util/VirtualFileSystem.h"
 
 namespace rheel {
 
-static bool validate_png(std::istream& input) {
-	// read the signature
-	std::array<png_byte, 8> signature{};
-	input.read(reinterpret_cast<char*>(signature.data()), 8); // NOLINT (safe)
+// the part of the file that libpng has not read yet
+struct png_input {
+	const std::byte* data;
+	std::size_t remaining;
+};
 
-	// check if reading went well
-	if (!input.good()) {
-		return false;
-	}
+PngLoader::PngLoader(ThreadPool* thread_pool) :
+		_thread_pool(thread_pool) {}
 
-	// compare the signature
-	return png_sig_cmp(signature.data(), 0, 8) == 0;
+Image PngLoader::Load(const std::string& path) const {
+	// the file is mapped instead of streamed, so libpng reads directly from
+	// the page cache without an extra copy per read call
+	return Decode(VirtualFileSystem::Open(path).bytes);
 }
 
-Image PngLoader::Load(const std::string& path) const {
-	std::ifstream f(path, std::ios::binary);
+png_batch PngLoader::LoadBatch(const std::vector<std::string>& paths) const {
+	auto start = std::chrono::steady_clock::now();
+
+	std::vector<Image> images(paths.size(), Image::Null());
+	std::atomic_size_t file_bytes = 0;
+
+	parallel_for(_thread_pool, paths.size(), [&paths, &images, &file_bytes](std::size_t i) {
+		virtual_file file = VirtualFileSystem::Open(paths[i]);
+		images[i] = Decode(file.bytes);
+		file_bytes.fetch_add(file.bytes.size(), std::memory_order_relaxed);
+	});
+
+	std::chrono::duration<double> duration = std::chrono::steady_clock::now() - start;
 
-	if (!f) {
-		throw std::runtime_error("Error while reading image file: " + path);
+	std::size_t decoded_bytes = 0;
+	for (const auto& image : images) {
+		decoded_bytes += image.GetData().size();
 	}
 
-	return _load_png(f);
+	double seconds = duration.count();
+	double throughput = seconds > 0.0 ? double(decoded_bytes) / seconds / 1e6 : 0.0;
+
+	Log::Info() << "Decoded " << paths.size() << " PNG files (" << file_bytes / 1000000.0 << " MB) into "
+			<< decoded_bytes / 1000000.0 << " MB in " << seconds << " s: " << throughput << " MB/s" << std::endl;
+
+	return png_batch{ std::move(images), file_bytes, decoded_bytes, seconds, throughput };
 }
 
-Image PngLoader::_load_png(std::istream& input) {
-	if (!validate_png(input)) {
+Image PngLoader::Decode(std::span<const std::byte> data) {
+	if (data.size() < 8 || png_sig_cmp(reinterpret_cast<png_const_bytep>(data.data()), 0, 8) != 0) {
 		throw std::runtime_error("An error occurred while reading PNG file: PNG signature not valid.");
 	}
 
@@ -49,30 +71,42 @@ Image PngLoader::_load_png(std::istream& input) {
 	// create the info struct
 	png_infop info_ptr = png_create_info_struct(png_ptr);
 	if (!info_ptr) {
+		png_destroy_read_struct(&png_ptr, nullptr, nullptr);
 		throw std::runtime_error("Failed to create png_info_struct.");
 	}
 
-	// declare the pointers for reading
-	png_bytep* rows = nullptr;
-	unsigned char* data = nullptr;
+	// The buffers live on the heap, so their state is well-defined when
+	// libpng jumps back to the setjmp below.
+	struct png_buffers {
+		std::vector<std::uint8_t> pixels;
+		std::vector<png_bytep> rows;
+	};
+
+	auto buffers = std::make_unique<png_buffers>();
+	png_input input{ data.data() + 8, data.size() - 8 };
 
 	// jump here if something goes wrong in the parsing.
 	if (setjmp(png_jmpbuf(png_ptr))) {
 		png_destroy_read_struct(&png_ptr, &info_ptr, nullptr);
-		delete[] rows;
-		delete[] data;
 		throw std::runtime_error("An error occurred while reading the PNG file.");
 	}
 
-	// set the custom read function
+	// read from memory, the signature has already been checked
 	png_set_read_fn(png_ptr, static_cast<png_voidp>(&input),
 			[](png_structp png_ptr, png_bytep data, png_size_t length) {
 
-				auto* stream = static_cast<std::istream*>(png_get_io_ptr(png_ptr));
-				stream->read(reinterpret_cast<char*>(data), length); // NOLINT (safe)
+				auto* input = static_cast<png_input*>(png_get_io_ptr(png_ptr));
+
+				if (length > input->remaining) {
+					png_error(png_ptr, "Unexpected end of PNG file.");
+				}
+
+				std::memcpy(data, input->data, length);
+				input->data += length;
+				input->remaining -= length;
 			});
 
-	// we've already read the header, so skip the first 8 bytes
+	// we've already checked the signature, so skip the first 8 bytes
 	png_set_sig_bytes(png_ptr, 8);
 
 	// read the info
@@ -85,9 +119,12 @@ Image PngLoader::_load_png(std::istream& input) {
 	auto bit_depth = png_get_bit_depth(png_ptr, info_ptr);
 	auto color_type = png_get_color_type(png_ptr, info_ptr);
 
-	// set the conversion to rgba with 8 bits per channel
-	if (bit_depth == 16) {
-		png_set_strip_16(png_ptr);
+	// 16-bit images keep their precision as half floats, all other images are
+	// converted to rgba with 8 bits per channel
+	PixelFormat format = bit_depth == 16 ? PixelFormat::RGBA16F : PixelFormat::RGBA8;
+
+	if (bit_depth == 16 && std::endian::native == std::endian::little) {
+		png_set_swap(png_ptr);
 	}
 
 	switch (color_type) {
@@ -110,50 +147,47 @@ Image PngLoader::_load_png(std::istream& input) {
 		png_set_tRNS_to_alpha(png_ptr);
 	}
 
-	// no alpha channel supplied: fill with 0xFF
+	// no alpha channel supplied: fill with the maximum value
 	if (color_type == PNG_COLOR_TYPE_RGB || color_type == PNG_COLOR_TYPE_GRAY || color_type == PNG_COLOR_TYPE_PALETTE) {
-		png_set_filler(png_ptr, 0xFF, PNG_FILLER_AFTER);
+		png_set_filler(png_ptr, bit_depth == 16 ? 0xFFFF : 0xFF, PNG_FILLER_AFTER);
 	}
 
 	png_read_update_info(png_ptr, info_ptr);
 
+	// decode the rows directly into the image storage
+	std::size_t stride = png_get_rowbytes(png_ptr, info_ptr);
+	if (stride != width * Image::GetPixelSize(format)) {
+		png_destroy_read_struct(&png_ptr, &info_ptr, nullptr);
+		throw std::runtime_error("Unexpected PNG row size.");
+	}
 
-#pragma clang diagnostic push
-#pragma ide diagnostic ignored "cppcoreguidelines-pro-bounds-pointer-arithmetic"
-
-	size_t stride = png_get_rowbytes(png_ptr, info_ptr);
-	rows = new png_bytep[height];
-	data = new unsigned char[height * stride];
+	buffers->pixels.resize(height * stride);
+	buffers->rows.resize(height);
 
 	for (unsigned i = 0; i < height; i++) {
-		rows[i] = static_cast<png_bytep>(data) + stride * i;
+		buffers->rows[i] = buffers->pixels.data() + stride * i;
 	}
 
-	// read the image
-	png_read_image(png_ptr, rows);
-
-	// create the actual image class storage
-	std::vector<Color> pixels;
-	pixels.resize(width * height);
-
-	// upload the data from the temporary buffer to the class storage
-	for (unsigned pixel = 0; pixel < width * height; pixel++) {
-		pixels[pixel] = {
-				FLOAT(data[4 * pixel + 0]),
-				FLOAT(data[4 * pixel + 1]),
-				FLOAT(data[4 * pixel + 2]),
-				FLOAT(data[4 * pixel + 3]),
-		};
-	}
+	png_read_image(png_ptr, buffers->rows.data());
+	png_destroy_read_struct(&png_ptr, &info_ptr, nullptr);
 
-#pragma clang diagnostic pop
+	// 16-bit channels are normalized integers, convert them to half floats in
+	// place, one row at a time
+	if (format == PixelFormat::RGBA16F) {
+		std::vector<float> row(4 * width);
 
-	// delete the png handle and the temporary buffers
-	png_destroy_read_struct(&png_ptr, &info_ptr, nullptr);
-	delete[] rows;
-	delete[] data;
+		for (unsigned i = 0; i < height; i++) {
+			const auto* channels = reinterpret_cast<const std::uint16_t*>(buffers->rows[i]);
+
+			for (std::size_t c = 0; c < row.size(); c++) {
+				row[c] = float(channels[c]) * (1.0f / 65535.0f);
+			}
+
+			Image::EncodePixels(format, row.data(), buffers->rows[i], width);
+		}
+	}
 
-	return Image(width, height, std::move(pixels));
+	return Image(width, height, format, std::move(buffers->pixels));
 }
 
 }
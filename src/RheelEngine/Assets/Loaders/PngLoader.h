@@ -5,22 +5,62 @@
 #define RHEELENGINE_PNGLOADER_H
 #include "../../_common.h"
 
+#include <span>
+
 #include "Loader.h"
 #include "../Image.h"
 
 namespace rheel {
 
+/**
+ * The result of decoding a batch of PNG files.
+ */
+struct png_batch {
+	// the decoded images, in the order of the paths
+	std::vector<Image> images;
+
+	// the total size of the PNG files, in bytes
+	std::size_t file_bytes;
+
+	// the total size of the decoded pixels, in bytes
+	std::size_t decoded_bytes;
+
+	// the wall-clock time the batch took, in seconds
+	double seconds;
+
+	// the decoded pixels per second, in megabytes (10^6 bytes)
+	double throughput;
+};
+
 class RE_API PngLoader : public AbstractLoader<Image> {
 	friend class AssetLoader;
 
 public:
+	/**
+	 * Creates a PNG loader. If a thread pool is given, batches of files are
+	 * decoded in parallel on the pool, as well as on the calling thread.
+	 */
+	explicit PngLoader(ThreadPool* thread_pool = nullptr);
+
 	Image Load(const std::string& path) const override;
 
+	/**
+	 * Loads all the given PNG files, decoding them concurrently on the thread
+	 * pool of this loader. If one of the files could not be loaded, the first
+	 * error is thrown after all other files are done.
+	 */
+	png_batch LoadBatch(const std::vector<std::string>& paths) const;
+
+	/**
+	 * Decodes a PNG file which is entirely in memory.
+	 */
+	static Image Decode(std::span<const std::byte> data);
+
 private:
-	static Image _load_png(std::istream& input);
+	ThreadPool* _thread_pool;
 
 };
 
 }
 
-#endif
\ No newline at end of file
+#endif
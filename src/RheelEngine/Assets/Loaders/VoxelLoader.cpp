@@ -3,244 +3,465 @@
  */
 #include "VoxelLoader.h"
 
-#include <fstream>
+#include <charconv>
+
+#include "../../Util/ParallelFor.h"
+#include "../../Util/VirtualFileSystem.h"
 
 namespace rheel {
 
-///////////////////////////////
-// STREAM WRAPPER FOR VECTOR //
-///////////////////////////////
+///////////////////////
+// STREAMING PARSING //
+///////////////////////
 
-template<typename CharT, typename TraitsT = std::char_traits<CharT> >
-class VectorStream : public std::basic_streambuf<CharT, TraitsT> {
+/*
+ * Reads the values of a .vox file in place, from front to back. Reading past
+ * the end of the data throws a runtime_error.
+ */
+struct vox_reader {
+	std::span<const std::byte> data;
+	std::size_t position = 0;
 
-public:
-	explicit VectorStream(std::vector<std::istream::char_type>& vec) {
-		this->setg(vec.data(), vec.data(), vec.data() + vec.size());
+	bool AtEnd() const {
+		return position == data.size();
 	}
 
-};
+	std::span<const std::byte> Bytes(std::size_t count) {
+		if (count > data.size() - position) {
+			throw std::runtime_error("Failed reading .vox file: unexpected end of data");
+		}
+
+		auto bytes = data.subspan(position, count);
+		position += count;
+		return bytes;
+	}
 
-//////////////////////////
-// GENERAL RIFF PARSING //
-//////////////////////////
+	std::uint32_t Uint() {
+		auto bytes = Bytes(4);
+		std::uint32_t value = 0;
 
-using uint = uint32_t;
+		for (int i = 3; i >= 0; i--) {
+			value = (value << 8) | std::uint32_t(bytes[i]);
+		}
+
+		return value;
+	}
+
+	std::int32_t Int() {
+		return std::int32_t(Uint());
+	}
+
+	std::string_view Id() {
+		auto bytes = Bytes(4);
+		return std::string_view(reinterpret_cast<const char*>(bytes.data()), 4); // NOLINT (safe)
+	}
+
+	std::string_view String() {
+		auto bytes = Bytes(Uint());
+		return std::string_view(reinterpret_cast<const char*>(bytes.data()), bytes.size()); // NOLINT (safe)
+	}
+
+	// skips a dictionary of string keys and values
+	void SkipDict() {
+		std::uint32_t count = Uint();
+
+		for (std::uint32_t i = 0; i < 2 * count; i++) {
+			String();
+		}
+	}
+
+	void Skip(std::size_t count) {
+		Bytes(count);
+	}
+};
 
 /*
- * Read the next count bytes into data. If an error occurred, or the stream reached
- * end of file before the bytes could be completely read, an error will be shown and
- * the program will abort.
+ * A rotation of a .vox transform, which only swaps and flips axes: row i of
+ * the rotated vector is sign[i] times component axis[i] of the vector.
  */
-static void check_read(std::istream& input, char* data, size_t count) {
-	input.read(data, count);
+struct vox_rotation {
+	std::array<int, 3> axis{ 0, 1, 2 };
+	std::array<int, 3> sign{ 1, 1, 1 };
+
+	bool IsIdentity() const {
+		return axis == std::array<int, 3>{ 0, 1, 2 } && sign == std::array<int, 3>{ 1, 1, 1 };
+	}
 
-	if (!input.good() || input.gcount() != count) {
-		Log::Error() << "Failed reading .vox file: an error occurred while trying to read " << count << " bytes" << std::endl;
-		abort();
+	ivec3 operator*(ivec3 v) const {
+		return ivec3(sign[0] * v[axis[0]], sign[1] * v[axis[1]], sign[2] * v[axis[2]]);
 	}
+
+	vox_rotation operator*(const vox_rotation& other) const {
+		vox_rotation result;
+
+		for (int row = 0; row < 3; row++) {
+			result.axis[row] = other.axis[axis[row]];
+			result.sign[row] = sign[row] * other.sign[axis[row]];
+		}
+
+		return result;
+	}
+};
+
+struct vox_transform {
+	vox_rotation rotation;
+	ivec3 translation{ 0, 0, 0 };
+
+	vox_transform operator*(const vox_transform& other) const {
+		return { rotation * other.rotation, rotation * other.translation + translation };
+	}
+};
+
+enum class vox_node_type {
+	transform, group, shape
+};
+
+struct vox_node {
+	vox_node_type type;
+
+	// the transform node: its child and transform, the group node: its
+	// children, the shape node: its models
+	vox_transform transform;
+	std::vector<std::int32_t> children;
+};
+
+struct vox_model {
+	uvec3 size;
+
+	// the voxels of the XYZI chunk: x, y, z and palette index
+	std::span<const std::byte> voxels;
+};
+
+struct vox_file {
+	std::array<Color, 256> palette{};
+	std::vector<vox_model> models;
+	std::unordered_map<std::int32_t, vox_node> nodes;
+};
+
+// the rotation of a frame of a transform node, which is stored as a byte
+static vox_rotation parse_rotation(std::string_view value) {
+	unsigned bits = 0;
+	std::from_chars(value.data(), value.data() + value.size(), bits);
+
+	vox_rotation rotation;
+	rotation.axis[0] = int(bits & 3u);
+	rotation.axis[1] = int((bits >> 2) & 3u);
+	rotation.axis[2] = 3 - rotation.axis[0] - rotation.axis[1];
+
+	if (rotation.axis[0] > 2 || rotation.axis[1] > 2 || rotation.axis[0] == rotation.axis[1]) {
+		throw std::runtime_error("Failed reading .vox file: invalid rotation");
+	}
+
+	for (int row = 0; row < 3; row++) {
+		rotation.sign[row] = (bits >> (4 + row)) & 1u ? -1 : 1;
+	}
+
+	return rotation;
+}
+
+// the translation of a frame of a transform node: "x y z"
+static ivec3 parse_translation(std::string_view value) {
+	ivec3 translation(0, 0, 0);
+	const char* position = value.data();
+	const char* end = value.data() + value.size();
+
+	for (int i = 0; i < 3; i++) {
+		while (position != end && *position == ' ') {
+			position++;
+		}
+
+		position = std::from_chars(position, end, translation[i]).ptr;
+	}
+
+	return translation;
 }
 
 /*
- * Read a little-endian unsigned integer.
+ * Walks over the chunks of the file once. Only the headers are read; the voxels
+ * of the models are left in the file, to be decoded later.
  */
-static uint read_int(std::istream& input) {
-	char bytes[4];
-	check_read(input, bytes, 4);
+static vox_file parse_vox(std::span<const std::byte> data) {
+	vox_reader reader{ data };
 
-	auto ubytes = reinterpret_cast<uint8_t*>(bytes); // NOLINT (safe)
-	uint part_0 = uint(ubytes[0]);
-	uint part_1 = uint(ubytes[1]) << 8;
-	uint part_2 = uint(ubytes[2]) << 16;
-	uint part_3 = uint(ubytes[3]) << 24;
+	if (reader.Id() != "VOX ") {
+		throw std::runtime_error("Failed reading .vox file: file header invalid");
+	}
 
-	return part_0 | part_1 | part_2 | part_3;
-}
+	reader.Uint(); // version
 
-class Riff {
+	if (reader.Id() != "MAIN") {
+		throw std::runtime_error("Failed reading .vox file: invalid main chunk");
+	}
 
-public:
-	using Byte = char;
+	reader.Skip(reader.Uint());
+	std::uint32_t children_bytes = reader.Uint();
+	vox_reader children{ reader.Bytes(children_bytes) };
 
-	class Chunk {
-		friend class Riff;
+	vox_file file;
+	std::optional<uvec3> size;
 
-	public:
-		/*
-		 * Read an arbitrary chunk
-		 */
-		explicit Chunk(std::istream& input) {
-			// read the chunk header
-			check_read(input, _chunk_id, 4);
-			_bytes_chunk = read_int(input);
-			_bytes_children = read_int(input);
+	while (!children.AtEnd()) {
+		std::string_view id = children.Id();
+		std::uint32_t content_bytes = children.Uint();
+		std::uint32_t child_bytes = children.Uint();
 
-			// read chunk data
-			_data.resize(_bytes_chunk);
-			check_read(input, _data.data(), _bytes_chunk);
+		vox_reader content{ children.Bytes(content_bytes) };
+		children.Skip(child_bytes);
 
-			// read children
-			int64_t child_bytes_left = _bytes_children;
+		if (id == "SIZE") {
+			std::uint32_t x = content.Uint();
+			std::uint32_t y = content.Uint();
+			std::uint32_t z = content.Uint();
+			size = uvec3(x, y, z);
 
-			while (child_bytes_left > 0) {
-				auto& child = _children.emplace_back(input);
-				child_bytes_left -= child._bytes_chunk + child._bytes_children + 12;
+		} else if (id == "XYZI") {
+			if (!size) {
+				throw std::runtime_error("Failed reading .vox file: XYZI chunk without SIZE chunk");
 			}
-		}
 
-		std::string GetId() const {
-			return std::string(_chunk_id, 4);
-		}
+			std::uint32_t count = content.Uint();
+			if (count > content.data.size() / 4) {
+				throw std::runtime_error("Failed reading .vox file: unexpected end of data");
+			}
 
-		VectorStream<Byte> GetDataStream() const {
-			return VectorStream<Byte>(_data);
-		}
+			file.models.push_back({ *size, content.Bytes(std::size_t(count) * 4) });
+			size.reset();
 
-		const std::vector<Chunk>& GetChildren() const {
-			return _children;
-		}
+		} else if (id == "RGBA") {
+			auto colors = content.Bytes(255 * 4);
 
-	private:
-		Chunk() = default;
+			for (std::size_t i = 0; i < 255; i++) {
+				auto c = colors.subspan(i * 4, 4);
+				file.palette[i + 1] = { std::uint8_t(c[0]) / 255.0f, std::uint8_t(c[1]) / 255.0f,
+										std::uint8_t(c[2]) / 255.0f, std::uint8_t(c[3]) / 255.0f };
+			}
 
-		char _chunk_id[4]{};
-		uint _bytes_chunk = 0;
-		uint _bytes_children = 0;
+		} else if (id == "nTRN") {
+			std::int32_t node_id = content.Int();
+			content.SkipDict();
+
+			vox_node node{ vox_node_type::transform, {}, {} };
+			node.children.push_back(content.Int());
+			content.Int(); // reserved
+			content.Int(); // layer
+
+			// only the first frame is used; animations are not supported
+			if (std::uint32_t frames = content.Uint(); frames > 0) {
+				std::uint32_t count = content.Uint();
+
+				for (std::uint32_t i = 0; i < count; i++) {
+					std::string_view key = content.String();
+					std::string_view value = content.String();
+
+					if (key == "_r") {
+						node.transform.rotation = parse_rotation(value);
+					} else if (key == "_t") {
+						node.transform.translation = parse_translation(value);
+					}
+				}
+			}
 
-		mutable std::vector<Byte> _data{};
-		std::vector<Chunk> _children{};
+			file.nodes[node_id] = std::move(node);
 
-	};
+		} else if (id == "nGRP" || id == "nSHP") {
+			std::int32_t node_id = content.Int();
+			content.SkipDict();
 
-public:
-	/*
-	 * Read a RIFF file.
-	 */
-	explicit Riff(std::istream& input) {
-		check_read(input, _id, 4);
-		_version = read_int(input);
-		_root = Chunk(input);
-	}
+			vox_node node{ id == "nGRP" ? vox_node_type::group : vox_node_type::shape, {}, {} };
+			std::uint32_t count = content.Uint();
 
-	std::string GetId() const {
-		return std::string(_id, 4);
-	}
+			for (std::uint32_t i = 0; i < count; i++) {
+				node.children.push_back(content.Int());
+
+				if (node.type == vox_node_type::shape) {
+					content.SkipDict();
+				}
+			}
 
-	uint GetVersion() const {
-		return _version;
+			file.nodes[node_id] = std::move(node);
+		}
+
+		// PACK, materials, layers, cameras, etc. are not needed
 	}
 
-	const Chunk& GetRoot() const {
-		return _root;
+	if (file.models.empty()) {
+		throw std::runtime_error("Failed reading .vox file: no models");
 	}
 
-private:
-	char _id[4]{};
-	uint _version;
-	Chunk _root;
+	return file;
+}
+
+//////////////////
+// SCENE LAYOUT //
+//////////////////
 
+struct vox_instance {
+	std::size_t model;
+	vox_transform transform;
 };
 
-/////////////////////////
-// ACTUAL .VOX READING //
-/////////////////////////
+static void collect_instances(const vox_file& file, std::int32_t node_id, const vox_transform& parent,
+		std::vector<vox_instance>& instances, std::size_t depth) {
 
-VoxelImage VoxelLoader::Load(const std::string& path) const {
-	std::ifstream f(path, std::ios::binary);
+	auto iter = file.nodes.find(node_id);
+
+	// a cycle in the graph can only be detected by its depth
+	if (iter == file.nodes.end() || depth > file.nodes.size()) {
+		throw std::runtime_error("Failed reading .vox file: invalid scene graph");
+	}
+
+	const vox_node& node = iter->second;
 
-	if (!f) {
-		throw std::runtime_error("Error while reading image file: " + path);
+	switch (node.type) {
+		case vox_node_type::transform:
+			collect_instances(file, node.children[0], parent * node.transform, instances, depth + 1);
+			break;
+		case vox_node_type::group:
+			for (std::int32_t child : node.children) {
+				collect_instances(file, child, parent, instances, depth + 1);
+			}
+			break;
+		case vox_node_type::shape:
+			for (std::int32_t model : node.children) {
+				if (model < 0 || std::size_t(model) >= file.models.size()) {
+					throw std::runtime_error("Failed reading .vox file: invalid model in scene graph");
+				}
+
+				instances.push_back({ std::size_t(model), parent });
+			}
+			break;
 	}
+}
 
-	return _load_vox(f);
+// The model is centered on the translation of its transform, and rotated around
+// the voxel at its center. Returns the position of the voxel in the scene.
+static ivec3 place(const vox_instance& instance, const vox_model& model, ivec3 voxel) {
+	return instance.transform.rotation * (voxel - ivec3(model.size / 2u)) + instance.transform.translation;
 }
 
-VoxelImage VoxelLoader::_load_vox(std::istream& input) {
-	// read the riff-formated file.
-	Riff riff(input);
+// Decodes the voxels of the models. Every model has its own image, so they are
+// decoded concurrently.
+static std::vector<VoxelImage> decode_models(ThreadPool* pool, const vox_file& file) {
+	std::vector<VoxelImage> images;
+	images.reserve(file.models.size());
 
-	// check the file header
-	if (riff.GetId() != "VOX " || riff.GetVersion() != 150) {
-		Log::Error() << "Failed reading .vox file: file header invalid." << std::endl;
-		abort();
+	for (const auto& model : file.models) {
+		images.emplace_back(model.size.x, model.size.z, model.size.y, file.palette);
 	}
 
-	const auto& main = riff.GetRoot();
-	if (main.GetId() != "MAIN") {
-		Log::Error() << "Failed reading .vox file: invalid chunk." << std::endl;
-		abort();
-	}
+	parallel_for(pool, file.models.size(), [&file, &images](std::size_t i) {
+		const vox_model& model = file.models[i];
+		VoxelImage& image = images[i];
 
-	if (main.GetChildren().empty()) {
-		Log::Error() << "Failed reading .vox file: empty main child list." << std::endl;
-		abort();
-	}
+		for (std::size_t v = 0; v < model.voxels.size(); v += 4) {
+			auto x = unsigned(model.voxels[v]);
+			auto y = unsigned(model.voxels[v + 1]);
+			auto z = unsigned(model.voxels[v + 2]);
 
-	// currently we only accept a single model.
-	// TODO: add support for multiple models
-	if (main.GetChildren()[0].GetId() == "PACK") {
-		Log::Error() << "Failed reading .vox file: multiple models via 'PACK' unsupported." << std::endl;
-		abort();
-	}
+			if (x >= model.size.x || y >= model.size.y || z >= model.size.z) {
+				throw std::runtime_error("Failed reading .vox file: voxel outside of model");
+			}
+
+			image.SetIndex(x, z, y, std::uint8_t(model.voxels[v + 3]));
+		}
+	});
+
+	return images;
+}
 
-	// read the model. Note that XYZ in the engine is XZY in the .vox format.
-	const auto& size = main.GetChildren()[0];
-	auto size_stream_proxy = size.GetDataStream();
-	std::istream size_stream(&size_stream_proxy);
+//////////////////
+// VOXEL LOADER //
+//////////////////
 
-	unsigned width = read_int(size_stream);
-	unsigned depth = read_int(size_stream);
-	unsigned height = read_int(size_stream);
+VoxelLoader::VoxelLoader(ThreadPool* thread_pool) :
+		_thread_pool(thread_pool) {}
 
-	std::vector<Color> voxels;
-	voxels.resize(width * height * depth);
+VoxelImage VoxelLoader::Load(const std::string& path) const {
+	// the file is mapped, so the voxels are decoded directly from the page
+	// cache
+	return Decode(VirtualFileSystem::Open(path).bytes);
+}
+
+std::vector<VoxelImage> VoxelLoader::LoadModels(const std::string& path) const {
+	return DecodeModels(VirtualFileSystem::Open(path).bytes);
+}
 
-	const auto& xyzi = main.GetChildren()[1];
-	auto xyzi_stream_proxy = xyzi.GetDataStream();
-	std::istream xyzi_stream(&xyzi_stream_proxy);
+VoxelImage VoxelLoader::Decode(std::span<const std::byte> data) const {
+	vox_file file = parse_vox(data);
 
-	uint voxel_count = read_int(xyzi_stream);
-	std::array<std::vector<ivec3>, 256> raw_voxels;
-	char data[4];
+	std::vector<vox_instance> instances;
 
-	for (uint i = 0; i < voxel_count; i++) {
-		check_read(xyzi_stream, data, 4);
-		raw_voxels[data[3]].emplace_back(data[0], data[2], data[1]);
+	if (file.nodes.empty()) {
+		for (std::size_t i = 0; i < file.models.size(); i++) {
+			instances.push_back({ i, { {}, ivec3(file.models[i].size / 2u) } });
+		}
+	} else {
+		collect_instances(file, 0, {}, instances, 0);
 	}
 
-	// read the rest: ignore the materials for now, search for the palette.
-	// TODO: handle materials?
-	std::array<Color, 256> palette{ {} };
-	palette[0] = { 0.0f, 0.0f, 0.0f, 0.0f };
+	std::vector<VoxelImage> models = decode_models(_thread_pool, file);
 
-	for (size_t i = 2; i < main.GetChildren().size(); i++) {
-		const auto& rgba = main.GetChildren()[i];
-		if (rgba.GetId() != "RGBA") {
-			continue;
-		}
+	if (instances.size() == 1 && instances[0].transform.rotation.IsIdentity()) {
+		return models[instances[0].model];
+	}
 
-		auto rgba_stream_proxy = rgba.GetDataStream();
-		std::istream rgba_stream(&rgba_stream_proxy);
+	// the bounds of the scene
+	ivec3 min(std::numeric_limits<int>::max());
+	ivec3 max(std::numeric_limits<int>::min());
 
-		for (int idx = 1; idx < 256; idx++) {
-			check_read(rgba_stream, data, 4);
-			palette[idx] = { data[0] / 255.0f, data[1] / 255.0f, data[2] / 255.0f, data[3] / 255.0f };
-		}
+	for (const auto& instance : instances) {
+		const vox_model& model = file.models[instance.model];
 
-		break;
+		for (ivec3 corner : { ivec3(0, 0, 0), ivec3(model.size) - 1 }) {
+			ivec3 position = place(instance, model, corner);
+			min = glm::min(min, position);
+			max = glm::max(max, position);
+		}
 	}
 
-	// push the voxels to the internal vector
-	for (int i = 0; i < 256; i++) {
-		Color c = palette[i];
-		const std::vector<ivec3>& locations = raw_voxels[i];
+	if (instances.empty()) {
+		min = max = ivec3(0, 0, 0);
+	}
 
-		for (ivec3 v : locations) {
-			voxels[v.x + v.y * width + v.z * width * height] = c;
+	ivec3 size = max - min + 1;
+	VoxelImage scene(size.x, size.z, size.y, file.palette);
+
+	// copy the models into the scene, one chunk at a time
+	for (const auto& instance : instances) {
+		const vox_model& model = file.models[instance.model];
+		const VoxelImage& image = models[instance.model];
+		uvec3 chunks = image.GetChunkCount();
+
+		for (unsigned cz = 0; cz < chunks.z; cz++) {
+			for (unsigned cy = 0; cy < chunks.y; cy++) {
+				for (unsigned cx = 0; cx < chunks.x; cx++) {
+					const std::uint8_t* chunk = image.GetChunk(cx, cy, cz);
+					if (!chunk) {
+						continue;
+					}
+
+					for (unsigned i = 0; i < VoxelImage::chunk_size * VoxelImage::chunk_size * VoxelImage::chunk_size; i++) {
+						if (chunk[i] == 0) {
+							continue;
+						}
+
+						unsigned x = cx * VoxelImage::chunk_size + i % VoxelImage::chunk_size;
+						unsigned y = cy * VoxelImage::chunk_size + (i / VoxelImage::chunk_size) % VoxelImage::chunk_size;
+						unsigned z = cz * VoxelImage::chunk_size + i / (VoxelImage::chunk_size * VoxelImage::chunk_size);
+
+						ivec3 position = place(instance, model, ivec3(x, z, y)) - min;
+						scene.SetIndex(position.x, position.z, position.y, chunk[i]);
+					}
+				}
+			}
 		}
 	}
 
-	return VoxelImage(width, height, depth, std::move(voxels));
+	return scene;
+}
+
+std::vector<VoxelImage> VoxelLoader::DecodeModels(std::span<const std::byte> data) const {
+	return decode_models(_thread_pool, parse_vox(data));
 }
 
 }
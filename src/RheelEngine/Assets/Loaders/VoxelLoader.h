@@ -5,22 +5,61 @@
 #define RHEELENGINE_VOXELLOADER_H
 #include "../../_common.h"
 
+#include <span>
+
 #include "Loader.h"
 #include "../VoxelImage.h"
 
 namespace rheel {
 
+/**
+ * Loads MagicaVoxel (.vox) files. The file is parsed in a single pass over its
+ * bytes, without copying the chunks of the file. Files can have multiple models
+ * (with a PACK chunk, or a scene graph), which are decoded concurrently.
+ *
+ * Note that XYZ in the engine is XZY in the .vox format.
+ */
 class RE_API VoxelLoader : public AbstractLoader<VoxelImage> {
 	friend class AssetLoader;
 
 public:
+	/**
+	 * Creates a voxel loader. If a thread pool is given, the models of a file
+	 * are decoded in parallel on the pool, as well as on the thread that loads
+	 * the file.
+	 */
+	explicit VoxelLoader(ThreadPool* thread_pool = nullptr);
+
+	/**
+	 * Loads the scene of the file: all models in one image, placed by the
+	 * scene graph of the file. Models of files without a scene graph are all
+	 * placed at the origin.
+	 */
 	VoxelImage Load(const std::string& path) const override;
 
+	/**
+	 * Loads each model of the file into its own image, in the order of the
+	 * file.
+	 */
+	std::vector<VoxelImage> LoadModels(const std::string& path) const;
+
+	/**
+	 * Decodes the scene of a .vox file which is entirely in memory. Throws a
+	 * runtime_error if the file is not valid.
+	 */
+	VoxelImage Decode(std::span<const std::byte> data) const;
+
+	/**
+	 * Decodes the models of a .vox file which is entirely in memory. Throws a
+	 * runtime_error if the file is not valid.
+	 */
+	std::vector<VoxelImage> DecodeModels(std::span<const std::byte> data) const;
+
 private:
-	static VoxelImage _load_vox(std::istream& input);
+	ThreadPool* _thread_pool;
 
 };
 
 }
 
-#endif
\ No newline at end of file
+#endif
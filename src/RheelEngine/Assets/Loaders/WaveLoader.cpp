@@ -3,44 +3,107 @@
  */
 #include "WaveLoader.h"
 
-#include <AL/alut.h>
+#include "../../Util/VirtualFileSystem.h"
 
 namespace rheel {
 
+static constexpr std::uint16_t format_pcm = 1;
+static constexpr std::uint16_t format_extensible = 0xFFFE;
+
+// reads a little-endian unsigned integer of the given number of bytes
+static std::uint32_t read_uint(std::span<const std::byte> data, std::size_t offset, std::size_t bytes) {
+	std::uint32_t value = 0;
+
+	for (std::size_t i = bytes; i > 0; i--) {
+		value = (value << 8) | std::uint32_t(data[offset + i - 1]);
+	}
+
+	return value;
+}
+
+static bool has_id(std::span<const std::byte> data, std::size_t offset, std::string_view id) {
+	return std::equal(id.begin(), id.end(), data.begin() + offset, [](char c, std::byte b) { return std::byte(c) == b; });
+}
+
 Sound WaveLoader::Load(const std::string& path) const {
-	// copy the file name into a non-const ALbyte array for alut to handle
-	std::size_t len = path.length();
-	std::vector<ALbyte> file(len + 1);
+	virtual_file file = VirtualFileSystem::Open(path);
+	wave_data wave = Parse(file.bytes);
+
+	const auto* samples = reinterpret_cast<const char*>(wave.samples.data()); // NOLINT (safe)
+	return Sound(std::vector<char>(samples, samples + wave.samples.size()), wave.format, wave.sample_frequency);
+}
 
-	for (std::size_t i = 0; i <= len; i++) {
-		file[i] = path[i];
+wave_data WaveLoader::Parse(std::span<const std::byte> data) {
+	if (data.size() < 12 || !has_id(data, 0, "RIFF") || !has_id(data, 8, "WAVE")) {
+		throw std::runtime_error("Failed reading .wav file: file header invalid");
 	}
 
-	ALenum format;
-	ALsizei size;
-	ALsizei frequency;
-	ALboolean loop;
-	ALvoid* raw_data;
+	std::optional<wave_data> wave;
+	std::size_t offset = 12;
 
-	// TODO: look into other .wav parsing libraries that are not deprecated
-#pragma GCC diagnostic push
-#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
-#pragma clang diagnostic push
-#pragma clang diagnostic ignored "-Wdeprecated-declarations"
+	// walk over the chunks until both the format and the samples are found
+	while (offset + 8 <= data.size()) {
+		std::size_t size = read_uint(data, offset + 4, 4);
+		std::size_t start = offset + 8;
 
-	alutLoadWAVFile(&file[0], &format, &raw_data, &size, &frequency, &loop);
+		// writers that stream the file may not know the size of the last
+		// chunk, so it is cut off at the end of the file
+		size = std::min(size, data.size() - start);
 
-	// copy the data into a C++ vector
-	std::vector<char> data(reinterpret_cast<char*>(raw_data), reinterpret_cast<char*>(raw_data) + size);
+		if (has_id(data, offset, "fmt ")) {
+			if (size < 16) {
+				throw std::runtime_error("Failed reading .wav file: invalid format chunk");
+			}
 
-	// destroy the alut buffer again
-	alutUnloadWAV(format, raw_data, size, frequency);
+			std::uint32_t format = read_uint(data, start, 2);
+			std::uint32_t channels = read_uint(data, start + 2, 2);
+			std::uint32_t frequency = read_uint(data, start + 4, 4);
+			std::uint32_t block_align = read_uint(data, start + 12, 2);
+			std::uint32_t bits = read_uint(data, start + 14, 2);
 
-#pragma clang diagnostic pop
-#pragma GCC diagnostic pop
+			// the extensible format stores the actual format in its sub format
+			if (format == format_extensible && size >= 26) {
+				format = read_uint(data, start + 24, 2);
+			}
 
-	return Sound(std::move(data), InternalSoundFormat(format), frequency);
-}
+			if (format != format_pcm) {
+				throw std::runtime_error("Failed reading .wav file: only PCM files are supported");
+			}
+
+			InternalSoundFormat internal_format;
+
+			if (channels == 1 && bits == 8) {
+				internal_format = InternalSoundFormat::MONO_8;
+			} else if (channels == 1 && bits == 16) {
+				internal_format = InternalSoundFormat::MONO_16;
+			} else if (channels == 2 && bits == 8) {
+				internal_format = InternalSoundFormat::STEREO_8;
+			} else if (channels == 2 && bits == 16) {
+				internal_format = InternalSoundFormat::STEREO_16;
+			} else {
+				throw std::runtime_error("Failed reading .wav file: only 8 and 16 bit mono and stereo files are supported");
+			}
+
+			if (block_align != channels * bits / 8) {
+				throw std::runtime_error("Failed reading .wav file: invalid block alignment");
+			}
+
+			wave = wave_data{ internal_format, int(frequency), block_align, {} };
 
+		} else if (has_id(data, offset, "data")) {
+			if (!wave) {
+				throw std::runtime_error("Failed reading .wav file: data chunk before format chunk");
+			}
+
+			wave->samples = data.subspan(start, size - size % wave->block_align);
+			return *wave;
+		}
+
+		// chunks are aligned to 2 bytes
+		offset = start + size + size % 2;
+	}
+
+	throw std::runtime_error("Failed reading .wav file: no samples");
 }
 
+}
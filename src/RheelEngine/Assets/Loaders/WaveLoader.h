@@ -5,19 +5,43 @@
 #define RHEELENGINE_WAVELOADER_H
 #include "../../_common.h"
 
+#include <span>
+
 #include "Loader.h"
 #include "../Sound.h"
 
 namespace rheel {
 
+/**
+ * The format and the samples of a PCM wave file. The samples point into the
+ * data of the file.
+ */
+struct wave_data {
+	InternalSoundFormat format;
+	int sample_frequency;
+
+	// the size of one sample of all channels, in bytes
+	unsigned block_align;
+
+	// the interleaved samples, a multiple of block_align bytes
+	std::span<const std::byte> samples;
+};
+
 class RE_API WaveLoader : public AbstractLoader<Sound> {
 	friend class AssetLoader;
 
 public:
 	Sound Load(const std::string& path) const override;
 
+	/**
+	 * Parses a wave (.wav) file which is entirely in memory, without copying
+	 * the samples. Only 8 and 16 bit PCM mono and stereo files are supported.
+	 * Throws a runtime_error if the file is not valid or not supported.
+	 */
+	static wave_data Parse(std::span<const std::byte> data);
+
 };
 
 }
 
-#endif
\ No newline at end of file
+#endif
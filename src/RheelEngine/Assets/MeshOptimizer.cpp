@@ -0,0 +1,389 @@
+/*
+ * Copyright (c) Levi van Rheenen. All rights reserved.
+ */
+#include "MeshOptimizer.h"
+
+#include <algorithm>
+#include <numeric>
+#include <optional>
+
+namespace rheel {
+
+// The vertex fetch cache is modelled as a direct-mapped 16 KiB cache with
+// 64-byte lines, which is in the range of the vertex caches of current GPUs.
+static constexpr std::size_t fetch_line_size = 64;
+static constexpr std::size_t fetch_line_count = 256;
+
+// A FIFO post-transform cache. Each vertex remembers the time it entered the
+// cache, so a vertex is cached if fewer than cache_size vertices entered the
+// cache after it.
+struct transform_cache {
+	explicit transform_cache(std::size_t vertex_count) :
+			timestamps(vertex_count, 0) {}
+
+	// returns whether the vertex had to be transformed
+	bool access(unsigned vertex) {
+		if (time - timestamps[vertex] > MeshOptimizer::cache_size) {
+			timestamps[vertex] = time++;
+			return true;
+		}
+
+		return false;
+	}
+
+	unsigned age(unsigned vertex) const {
+		return time - timestamps[vertex];
+	}
+
+	void clear() {
+		time += MeshOptimizer::cache_size + 1;
+	}
+
+	std::vector<unsigned> timestamps;
+	unsigned time = MeshOptimizer::cache_size + 1;
+};
+
+static unsigned access_triangle(transform_cache& cache, std::span<const unsigned> indices, std::size_t triangle) {
+	return unsigned(cache.access(indices[3 * triangle])) +
+			unsigned(cache.access(indices[3 * triangle + 1])) +
+			unsigned(cache.access(indices[3 * triangle + 2]));
+}
+
+Model MeshOptimizer::Optimize(const Model& model) {
+	if (model.GetRenderType() != RenderType::TRIANGLES) {
+		return model;
+	}
+
+	std::vector<model_vertex> vertices(model.GetVertices().begin(), model.GetVertices().end());
+	std::vector<unsigned> indices(model.GetIndices().begin(), model.GetIndices().end());
+
+	// every range of indices between two level of detail boundaries is
+	// reordered on its own, so each level of detail keeps its own triangles
+	std::vector<std::size_t> boundaries{ 0, indices.size() };
+
+	for (const auto& lod : model.GetLods()) {
+		boundaries.push_back(lod.first_index);
+		boundaries.push_back(lod.first_index + lod.index_count);
+	}
+
+	std::sort(boundaries.begin(), boundaries.end());
+	boundaries.erase(std::unique(boundaries.begin(), boundaries.end()), boundaries.end());
+
+	for (std::size_t i = 0; i + 1 < boundaries.size(); i++) {
+		std::span<unsigned> range(indices.data() + boundaries[i], boundaries[i + 1] - boundaries[i]);
+		OptimizeVertexCache(range, vertices.size());
+		OptimizeOverdraw(range, vertices);
+	}
+
+	OptimizeVertexFetch(vertices, indices);
+	return Model(std::move(vertices), std::move(indices), model.GetLods());
+}
+
+mesh_statistics MeshOptimizer::Analyze(const Model& model) {
+	std::span<const unsigned> indices = model.GetIndices();
+
+	if (!model.GetLods().empty()) {
+		indices = indices.subspan(model.GetLods()[0].first_index, model.GetLods()[0].index_count);
+	}
+
+	return _analyze(indices, model.GetVertices().size());
+}
+
+void MeshOptimizer::OptimizeVertexCache(std::span<unsigned> indices, std::size_t vertex_count) {
+	std::size_t triangle_count = indices.size() / 3;
+
+	// the triangles using vertex v are adjacency[offsets[v] .. offsets[v + 1]]
+	std::vector<unsigned> offsets(vertex_count + 1, 0);
+	std::vector<unsigned> adjacency(3 * triangle_count);
+
+	for (std::size_t i = 0; i < 3 * triangle_count; i++) {
+		offsets[indices[i] + 1]++;
+	}
+
+	for (std::size_t v = 0; v < vertex_count; v++) {
+		offsets[v + 1] += offsets[v];
+	}
+
+	std::vector<unsigned> live(vertex_count);
+	std::vector<unsigned> fill(offsets.begin(), offsets.end() - 1);
+
+	for (std::size_t t = 0; t < triangle_count; t++) {
+		for (std::size_t k = 0; k < 3; k++) {
+			unsigned vertex = indices[3 * t + k];
+			adjacency[fill[vertex]++] = t;
+			live[vertex]++;
+		}
+	}
+
+	// Tipsify: emit all triangles around a fanning vertex, then continue with
+	// the vertex that will still be cached after its own triangles are emitted
+	transform_cache cache(vertex_count);
+	std::vector<bool> emitted(triangle_count, false);
+	std::vector<unsigned> dead_end;
+	std::vector<unsigned> candidates;
+	std::vector<unsigned> result;
+	result.reserve(3 * triangle_count);
+
+	std::size_t cursor = 0;
+
+	auto skip_dead_end = [&]() -> std::optional<unsigned> {
+		while (!dead_end.empty()) {
+			unsigned vertex = dead_end.back();
+			dead_end.pop_back();
+
+			if (live[vertex] > 0) {
+				return vertex;
+			}
+		}
+
+		for (; cursor < vertex_count; cursor++) {
+			if (live[cursor] > 0) {
+				return cursor;
+			}
+		}
+
+		return {};
+	};
+
+	std::optional<unsigned> fan = skip_dead_end();
+
+	while (fan) {
+		candidates.clear();
+
+		for (unsigned i = offsets[*fan]; i < offsets[*fan + 1]; i++) {
+			unsigned triangle = adjacency[i];
+
+			if (emitted[triangle]) {
+				continue;
+			}
+
+			for (std::size_t k = 0; k < 3; k++) {
+				unsigned vertex = indices[3 * triangle + k];
+
+				result.push_back(vertex);
+				dead_end.push_back(vertex);
+				candidates.push_back(vertex);
+				live[vertex]--;
+				cache.access(vertex);
+			}
+
+			emitted[triangle] = true;
+		}
+
+		std::optional<unsigned> next;
+		unsigned best_priority = 0;
+
+		for (unsigned vertex : candidates) {
+			if (live[vertex] == 0) {
+				continue;
+			}
+
+			// a vertex that would be evicted while emitting its remaining
+			// triangles gets the lowest priority
+			unsigned priority = 1;
+			if (cache.age(vertex) + 2 * live[vertex] <= cache_size) {
+				priority += cache.age(vertex);
+			}
+
+			if (priority > best_priority) {
+				best_priority = priority;
+				next = vertex;
+			}
+		}
+
+		fan = next ? next : skip_dead_end();
+	}
+
+	std::copy(result.begin(), result.end(), indices.begin());
+}
+
+void MeshOptimizer::OptimizeOverdraw(std::span<unsigned> indices, std::span<const model_vertex> vertices, float threshold) {
+	std::size_t triangle_count = indices.size() / 3;
+
+	if (triangle_count == 0) {
+		return;
+	}
+
+	transform_cache cache(vertices.size());
+
+	// the cache starts over at triangles of which no vertex was cached, so
+	// these clusters can be moved without adding cache misses
+	std::vector<std::size_t> hard_boundaries{ 0 };
+
+	for (std::size_t t = 0; t < triangle_count; t++) {
+		if (access_triangle(cache, indices, t) == 3 && t > 0) {
+			hard_boundaries.push_back(t);
+		}
+	}
+
+	hard_boundaries.push_back(triangle_count);
+
+	// split the clusters further, as long as a cluster on its own has at most
+	// threshold times the cache miss ratio of the cluster it was split from
+	std::vector<std::size_t> boundaries;
+
+	for (std::size_t i = 0; i + 1 < hard_boundaries.size(); i++) {
+		std::size_t start = hard_boundaries[i];
+		std::size_t end = hard_boundaries[i + 1];
+
+		cache.clear();
+		unsigned cluster_misses = 0;
+
+		for (std::size_t t = start; t < end; t++) {
+			cluster_misses += access_triangle(cache, indices, t);
+		}
+
+		float cluster_threshold = threshold * float(cluster_misses) / float(end - start);
+
+		boundaries.push_back(start);
+		cache.clear();
+
+		unsigned misses = 0;
+		unsigned triangles = 0;
+
+		for (std::size_t t = start; t + 1 < end; t++) {
+			misses += access_triangle(cache, indices, t);
+			triangles++;
+
+			if (float(misses) / float(triangles) <= cluster_threshold) {
+				boundaries.push_back(t + 1);
+				cache.clear();
+
+				misses = 0;
+				triangles = 0;
+			}
+		}
+	}
+
+	boundaries.push_back(triangle_count);
+
+	// clusters facing away from the center of the mesh are likely in front of
+	// other clusters, so they are drawn first
+	std::size_t cluster_count = boundaries.size() - 1;
+	std::vector<vec3> centroids(cluster_count, vec3(0.0f));
+	std::vector<vec3> normals(cluster_count, vec3(0.0f));
+	std::vector<float> areas(cluster_count, 0.0f);
+
+	vec3 mesh_centroid(0.0f);
+	float mesh_area = 0.0f;
+
+	for (std::size_t c = 0; c < cluster_count; c++) {
+		for (std::size_t t = boundaries[c]; t < boundaries[c + 1]; t++) {
+			vec3 p0 = vertices[indices[3 * t]].position;
+			vec3 p1 = vertices[indices[3 * t + 1]].position;
+			vec3 p2 = vertices[indices[3 * t + 2]].position;
+
+			vec3 normal = glm::cross(p1 - p0, p2 - p0);
+			float area = glm::length(normal);
+
+			centroids[c] += (p0 + p1 + p2) * (area / 3.0f);
+			normals[c] += normal;
+			areas[c] += area;
+		}
+
+		mesh_centroid += centroids[c];
+		mesh_area += areas[c];
+	}
+
+	if (mesh_area <= 0.0f) {
+		return;
+	}
+
+	mesh_centroid /= mesh_area;
+
+	std::vector<float> keys(cluster_count, 0.0f);
+
+	for (std::size_t c = 0; c < cluster_count; c++) {
+		float normal_length = glm::length(normals[c]);
+
+		if (areas[c] > 0.0f && normal_length > 0.0f) {
+			keys[c] = glm::dot(centroids[c] / areas[c] - mesh_centroid, normals[c] / normal_length);
+		}
+	}
+
+	std::vector<std::size_t> order(cluster_count);
+	std::iota(order.begin(), order.end(), 0);
+	std::stable_sort(order.begin(), order.end(), [&keys](std::size_t c1, std::size_t c2) {
+		return keys[c1] > keys[c2];
+	});
+
+	std::vector<unsigned> result;
+	result.reserve(3 * triangle_count);
+
+	for (std::size_t c : order) {
+		result.insert(result.end(), indices.begin() + 3 * boundaries[c], indices.begin() + 3 * boundaries[c + 1]);
+	}
+
+	std::copy(result.begin(), result.end(), indices.begin());
+}
+
+void MeshOptimizer::OptimizeVertexFetch(std::vector<model_vertex>& vertices, std::span<unsigned> indices) {
+	constexpr unsigned unused = ~0u;
+
+	std::vector<unsigned> remap(vertices.size(), unused);
+	std::vector<model_vertex> result;
+	result.reserve(vertices.size());
+
+	for (unsigned& index : indices) {
+		if (remap[index] == unused) {
+			remap[index] = result.size();
+			result.push_back(vertices[index]);
+		}
+
+		index = remap[index];
+	}
+
+	vertices = std::move(result);
+}
+
+mesh_statistics MeshOptimizer::_analyze(std::span<const unsigned> indices, std::size_t vertex_count) {
+	mesh_statistics statistics{ vertex_count, indices.size() / 3, 0.0f, 0.0f, 0.0f };
+
+	transform_cache cache(vertex_count);
+	std::vector<bool> used(vertex_count, false);
+	std::vector<std::size_t> fetch_lines(fetch_line_count, 0);
+
+	std::size_t transformed = 0;
+	std::size_t used_count = 0;
+	std::size_t fetched_bytes = 0;
+
+	for (unsigned index : indices) {
+		if (!used[index]) {
+			used[index] = true;
+			used_count++;
+		}
+
+		if (!cache.access(index)) {
+			continue;
+		}
+
+		// only transformed vertices are fetched
+		transformed++;
+
+		std::size_t first_line = index * sizeof(model_vertex) / fetch_line_size;
+		std::size_t last_line = ((index + 1) * sizeof(model_vertex) - 1) / fetch_line_size;
+
+		for (std::size_t line = first_line; line <= last_line; line++) {
+			// lines are tagged with their number plus one, so 0 is empty
+			std::size_t& tag = fetch_lines[line % fetch_line_count];
+
+			if (tag != line + 1) {
+				tag = line + 1;
+				fetched_bytes += fetch_line_size;
+			}
+		}
+	}
+
+	if (statistics.triangle_count > 0) {
+		statistics.acmr = float(transformed) / float(statistics.triangle_count);
+	}
+
+	if (used_count > 0) {
+		statistics.atvr = float(transformed) / float(used_count);
+		statistics.overfetch = float(fetched_bytes) / float(used_count * sizeof(model_vertex));
+	}
+
+	return statistics;
+}
+
+}
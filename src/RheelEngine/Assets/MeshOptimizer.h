@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) Levi van Rheenen. All rights reserved.
+ */
+#ifndef RHEELENGINE_MESHOPTIMIZER_H
+#define RHEELENGINE_MESHOPTIMIZER_H
+#include "../_common.h"
+
+#include "Model.h"
+
+namespace rheel {
+
+/**
+ * Statistics about how efficiently the GPU processes a mesh, computed by
+ * simulating the post-transform vertex cache and the vertex fetch cache.
+ */
+struct mesh_statistics {
+	std::size_t vertex_count;
+	std::size_t triangle_count;
+
+	// Average cache miss ratio: the number of transformed vertices per
+	// triangle. Lies in [0.5 .. 3], lower is better.
+	float acmr;
+
+	// Average transformed vertex ratio: the number of transformed vertices per
+	// vertex. At least 1, which is optimal.
+	float atvr;
+
+	// The number of bytes read from the vertex buffer per byte of vertex
+	// data. At least 1, which is optimal.
+	float overfetch;
+};
+
+/**
+ * Reorders the triangles and vertices of triangle meshes, so the GPU
+ * transforms and fetches fewer vertices when drawing them. Loaders optimize
+ * the models they create, so this only needs to be used directly for models
+ * that are created in code.
+ */
+class RE_API MeshOptimizer {
+	RE_NO_CONSTRUCT(MeshOptimizer);
+
+public:
+	/**
+	 * The number of vertices in the post-transform cache that the optimizer
+	 * and the statistics assume. Most GPUs have at least this many entries.
+	 */
+	static constexpr unsigned cache_size = 16;
+
+	/**
+	 * Returns an optimized copy of the model, which draws the same triangles.
+	 * The triangles are ordered for the vertex cache, then clusters of them
+	 * are ordered to reduce overdraw, and finally the vertices are ordered
+	 * by first use. Vertices that no triangle uses are removed. Each level of
+	 * detail is optimized on its own. Models that are not made of triangles
+	 * are returned as-is.
+	 */
+	static Model Optimize(const Model& model);
+
+	/**
+	 * Returns the cache statistics of drawing the model with full detail.
+	 */
+	static mesh_statistics Analyze(const Model& model);
+
+	/**
+	 * Reorders the triangles for the post-transform vertex cache, using the
+	 * Tipsify algorithm. The indices must refer to fewer than vertex_count
+	 * vertices.
+	 */
+	static void OptimizeVertexCache(std::span<unsigned> indices, std::size_t vertex_count);
+
+	/**
+	 * Reorders clusters of triangles so triangles facing outwards are drawn
+	 * first, which lets the depth test reject more hidden fragments. Clusters
+	 * are split as long as this makes the vertex cache miss ratio at most
+	 * threshold times worse. Use after OptimizeVertexCache().
+	 */
+	static void OptimizeOverdraw(std::span<unsigned> indices, std::span<const model_vertex> vertices, float threshold = 1.05f);
+
+	/**
+	 * Reorders the vertices in order of first use by the indices, and updates
+	 * the indices. Vertices that are not used are removed.
+	 */
+	static void OptimizeVertexFetch(std::vector<model_vertex>& vertices, std::span<unsigned> indices);
+
+private:
+	static mesh_statistics _analyze(std::span<const unsigned> indices, std::size_t vertex_count);
+
+};
+
+}
+
+#endif
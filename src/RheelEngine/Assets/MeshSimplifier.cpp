@@ -0,0 +1,411 @@
+/*
+ * Copyright (c) Levi van Rheenen. All rights reserved.
+ */
+#include "MeshSimplifier.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <numeric>
+
+#include "MeshOptimizer.h"
+#include "../Util/Hashes.h"
+
+namespace rheel {
+
+// Border edges are kept in place by a plane through the edge, perpendicular to
+// the triangle. It is weighted more than the triangles, so the outline of an
+// open mesh changes less than its surface.
+static constexpr double border_weight = 10.0;
+
+// A quadric sums the squared distances of a point to a set of weighted
+// planes. The planes are stored as the upper triangle of a symmetric 4x4
+// matrix, so the distances can be evaluated for any point.
+struct quadric {
+	std::array<double, 10> q{};
+	double weight = 0.0;
+
+	quadric& operator+=(const quadric& other) {
+		for (std::size_t i = 0; i < q.size(); i++) {
+			q[i] += other.q[i];
+		}
+
+		weight += other.weight;
+		return *this;
+	}
+};
+
+static quadric plane_quadric(const vec3& normal, const vec3& point, double weight) {
+	double a = normal.x;
+	double b = normal.y;
+	double c = normal.z;
+	double d = -(a * point.x + b * point.y + c * point.z);
+
+	return {
+			{
+					weight * a * a, weight * a * b, weight * a * c, weight * a * d,
+					weight * b * b, weight * b * c, weight * b * d,
+					weight * c * c, weight * c * d,
+					weight * d * d
+			},
+			weight
+	};
+}
+
+static double evaluate(const quadric& quadric, const vec3& p) {
+	const auto& q = quadric.q;
+	double x = p.x;
+	double y = p.y;
+	double z = p.z;
+
+	double result = q[0] * x * x + q[4] * y * y + q[7] * z * z + q[9] +
+			2.0 * (q[1] * x * y + q[2] * x * z + q[3] * x + q[5] * y * z + q[6] * y + q[8] * z);
+
+	// rounding errors can make the result slightly negative
+	return std::max(result, 0.0);
+}
+
+enum class vertex_kind {
+	MANIFOLD, BORDER, LOCKED
+};
+
+struct collapse {
+	unsigned from;
+	unsigned to;
+	double error;
+};
+
+mesh_simplification MeshSimplifier::Simplify(std::span<const unsigned> indices, std::span<const model_vertex> vertices, std::size_t target_index_count) {
+	mesh_simplification result{ std::vector<unsigned>(indices.begin(), indices.begin() + indices.size() / 3 * 3), 0.0f };
+	auto& current = result.indices;
+
+	// vertices at the same position are one position for the simplifier, so
+	// the mesh is connected across attribute seams
+	std::unordered_map<vec3, unsigned> position_indices;
+	std::vector<unsigned> position_of(vertices.size());
+	std::vector<vec3> positions;
+
+	for (std::size_t v = 0; v < vertices.size(); v++) {
+		auto[iter, inserted] = position_indices.try_emplace(vertices[v].position, positions.size());
+		position_of[v] = iter->second;
+
+		if (inserted) {
+			positions.push_back(vertices[v].position);
+		}
+	}
+
+	std::size_t position_count = positions.size();
+
+	// positions with more than one used vertex lie on an attribute seam
+	std::vector<unsigned> wedge_count(position_count, 0);
+	std::vector<bool> used(vertices.size(), false);
+
+	for (unsigned index : current) {
+		if (!used[index]) {
+			used[index] = true;
+			wedge_count[position_of[index]]++;
+		}
+	}
+
+	// the triangles around position p are adjacency[offsets[p] .. offsets[p + 1]]
+	std::vector<unsigned> offsets(position_count + 1);
+	std::vector<unsigned> adjacency;
+	std::vector<unsigned> fill;
+
+	auto update_adjacency = [&]() {
+		std::fill(offsets.begin(), offsets.end(), 0);
+
+		for (unsigned index : current) {
+			offsets[position_of[index] + 1]++;
+		}
+
+		for (std::size_t p = 0; p < position_count; p++) {
+			offsets[p + 1] += offsets[p];
+		}
+
+		adjacency.resize(current.size());
+		fill.assign(offsets.begin(), offsets.end() - 1);
+
+		for (std::size_t i = 0; i < current.size(); i++) {
+			adjacency[fill[position_of[current[i]]]++] = i / 3;
+		}
+	};
+
+	// the number of triangles with the directed edge from -> to
+	auto edge_count = [&](unsigned from, unsigned to) {
+		unsigned count = 0;
+
+		for (unsigned i = offsets[from]; i < offsets[from + 1]; i++) {
+			std::size_t triangle = 3 * adjacency[i];
+
+			for (std::size_t k = 0; k < 3; k++) {
+				if (position_of[current[triangle + k]] == from && position_of[current[triangle + (k + 1) % 3]] == to) {
+					count++;
+				}
+			}
+		}
+
+		return count;
+	};
+
+	update_adjacency();
+
+	std::vector<quadric> quadrics(position_count);
+
+	for (std::size_t i = 0; i < current.size(); i += 3) {
+		std::array<unsigned, 3> p{ position_of[current[i]], position_of[current[i + 1]], position_of[current[i + 2]] };
+
+		vec3 normal = glm::cross(positions[p[1]] - positions[p[0]], positions[p[2]] - positions[p[0]]);
+		float length = glm::length(normal);
+
+		if (length == 0.0f) {
+			continue;
+		}
+
+		normal /= length;
+		quadric face = plane_quadric(normal, positions[p[0]], 0.5 * length);
+
+		for (std::size_t k = 0; k < 3; k++) {
+			quadrics[p[k]] += face;
+
+			unsigned from = p[k];
+			unsigned to = p[(k + 1) % 3];
+
+			if (edge_count(to, from) == 0) {
+				vec3 edge = positions[to] - positions[from];
+				float edge_length = glm::length(edge);
+
+				if (edge_length > 0.0f) {
+					quadric border = plane_quadric(glm::normalize(glm::cross(edge, normal)), positions[from],
+							border_weight * edge_length * edge_length);
+
+					quadrics[from] += border;
+					quadrics[to] += border;
+				}
+			}
+		}
+	}
+
+	std::vector<vertex_kind> kinds(position_count);
+	std::vector<unsigned> open_in(position_count);
+	std::vector<unsigned> open_out(position_count);
+	std::vector<collapse> collapses;
+	std::vector<bool> locked(position_count);
+	std::vector<unsigned> remap(vertices.size());
+
+	while (current.size() > target_index_count) {
+		// classify the positions by the edges of the current triangles
+		std::fill(open_in.begin(), open_in.end(), 0);
+		std::fill(open_out.begin(), open_out.end(), 0);
+		std::fill(kinds.begin(), kinds.end(), vertex_kind::MANIFOLD);
+
+		for (std::size_t i = 0; i < current.size(); i += 3) {
+			for (std::size_t k = 0; k < 3; k++) {
+				unsigned from = position_of[current[i + k]];
+				unsigned to = position_of[current[i + (k + 1) % 3]];
+
+				if (edge_count(from, to) > 1) {
+					// an edge used twice in the same direction is not manifold
+					kinds[from] = vertex_kind::LOCKED;
+					kinds[to] = vertex_kind::LOCKED;
+				} else if (edge_count(to, from) == 0) {
+					open_out[from]++;
+					open_in[to]++;
+				}
+			}
+		}
+
+		for (std::size_t p = 0; p < position_count; p++) {
+			if (wedge_count[p] > 1) {
+				kinds[p] = vertex_kind::LOCKED;
+			} else if (kinds[p] == vertex_kind::MANIFOLD && (open_in[p] > 0 || open_out[p] > 0)) {
+				kinds[p] = open_in[p] == 1 && open_out[p] == 1 ? vertex_kind::BORDER : vertex_kind::LOCKED;
+			}
+		}
+
+		// find the cheapest direction of every edge that can be collapsed
+		auto can_collapse = [&](unsigned from, unsigned to) {
+			switch (kinds[from]) {
+				case vertex_kind::MANIFOLD:
+					return true;
+				case vertex_kind::BORDER:
+					// border positions only move along the border
+					return edge_count(from, to) == 0 || edge_count(to, from) == 0;
+				case vertex_kind::LOCKED:
+					return false;
+			}
+
+			return false;
+		};
+
+		auto collapse_error = [&](unsigned from, unsigned to) {
+			quadric combined = quadrics[from];
+			combined += quadrics[to];
+
+			return combined.weight > 0.0 ? std::sqrt(evaluate(combined, positions[to]) / combined.weight) : 0.0;
+		};
+
+		collapses.clear();
+
+		for (std::size_t i = 0; i < current.size(); i += 3) {
+			for (std::size_t k = 0; k < 3; k++) {
+				unsigned v0 = current[i + k];
+				unsigned v1 = current[i + (k + 1) % 3];
+				unsigned p0 = position_of[v0];
+				unsigned p1 = position_of[v1];
+
+				// every edge is visited from the triangle on both sides, so
+				// only consider it once if it has triangles on both sides
+				if (p0 == p1 || (p0 > p1 && edge_count(p1, p0) > 0)) {
+					continue;
+				}
+
+				bool forward = can_collapse(p0, p1);
+				bool backward = can_collapse(p1, p0);
+
+				if (!forward && !backward) {
+					continue;
+				}
+
+				double forward_error = forward ? collapse_error(p0, p1) : 0.0;
+				double backward_error = backward ? collapse_error(p1, p0) : 0.0;
+
+				if (forward && (!backward || forward_error <= backward_error)) {
+					collapses.push_back({ v0, v1, forward_error });
+				} else {
+					collapses.push_back({ v1, v0, backward_error });
+				}
+			}
+		}
+
+		std::sort(collapses.begin(), collapses.end(), [](const collapse& c1, const collapse& c2) {
+			return c1.error < c2.error;
+		});
+
+		// Collapse the cheapest edges first. Each collapse removes about two
+		// triangles. Positions around a collapsed edge are locked until the
+		// next pass, so the triangles used for checking collapses are current.
+		std::size_t goal = std::max<std::size_t>((current.size() - target_index_count) / 6, 1);
+		std::size_t collapsed = 0;
+
+		std::fill(locked.begin(), locked.end(), false);
+		std::iota(remap.begin(), remap.end(), 0);
+
+		for (const auto& c : collapses) {
+			if (collapsed >= goal) {
+				break;
+			}
+
+			unsigned from = position_of[c.from];
+			unsigned to = position_of[c.to];
+
+			if (locked[from] || locked[to]) {
+				continue;
+			}
+
+			// reject the collapse if it flips a triangle that remains
+			bool flips = false;
+
+			for (unsigned i = offsets[from]; i < offsets[from + 1] && !flips; i++) {
+				std::size_t triangle = 3 * adjacency[i];
+				std::array<vec3, 3> before;
+				std::array<vec3, 3> after;
+				bool removed = false;
+
+				for (std::size_t k = 0; k < 3; k++) {
+					unsigned p = position_of[current[triangle + k]];
+					removed |= p == to;
+					before[k] = positions[p];
+					after[k] = p == from ? positions[to] : positions[p];
+				}
+
+				if (!removed) {
+					vec3 normal_before = glm::cross(before[1] - before[0], before[2] - before[0]);
+					vec3 normal_after = glm::cross(after[1] - after[0], after[2] - after[0]);
+					flips = glm::dot(normal_before, normal_after) <= 0.0f;
+				}
+			}
+
+			if (flips) {
+				continue;
+			}
+
+			for (unsigned i = offsets[from]; i < offsets[from + 1]; i++) {
+				std::size_t triangle = 3 * adjacency[i];
+
+				for (std::size_t k = 0; k < 3; k++) {
+					locked[position_of[current[triangle + k]]] = true;
+				}
+			}
+
+			// a position that is not on a seam has a single vertex
+			remap[c.from] = c.to;
+			quadrics[to] += quadrics[from];
+			result.error = std::max(result.error, float(c.error));
+			collapsed++;
+		}
+
+		if (collapsed == 0) {
+			break;
+		}
+
+		std::size_t count = 0;
+
+		for (std::size_t i = 0; i < current.size(); i += 3) {
+			unsigned v0 = remap[current[i]];
+			unsigned v1 = remap[current[i + 1]];
+			unsigned v2 = remap[current[i + 2]];
+
+			if (position_of[v0] != position_of[v1] && position_of[v1] != position_of[v2] && position_of[v2] != position_of[v0]) {
+				current[count++] = v0;
+				current[count++] = v1;
+				current[count++] = v2;
+			}
+		}
+
+		current.resize(count);
+		update_adjacency();
+	}
+
+	return result;
+}
+
+Model MeshSimplifier::GenerateLods(const Model& model, unsigned max_lod_count, float ratio) {
+	if (model.GetRenderType() != RenderType::TRIANGLES) {
+		return model;
+	}
+
+	std::span<const unsigned> full = model.GetIndices();
+
+	if (!model.GetLods().empty()) {
+		full = full.subspan(model.GetLods()[0].first_index, model.GetLods()[0].index_count);
+	}
+
+	std::vector<model_vertex> vertices(model.GetVertices().begin(), model.GetVertices().end());
+	std::vector<unsigned> indices(full.begin(), full.end());
+	std::vector<model_lod> lods{ { 0, std::uint32_t(indices.size()), 0.0f } };
+
+	while (lods.size() < max_lod_count) {
+		// every level is simplified from the full mesh, so its error is
+		// measured against the full mesh
+		std::size_t target = std::size_t(float(lods.back().index_count / 3) * ratio) * 3;
+		mesh_simplification simplified = Simplify(full, vertices, target);
+
+		// stop when the mesh could barely be simplified any further
+		if (simplified.indices.empty() || float(simplified.indices.size()) > 0.9f * float(lods.back().index_count)) {
+			break;
+		}
+
+		lods.push_back({
+				std::uint32_t(indices.size()),
+				std::uint32_t(simplified.indices.size()),
+				std::max(simplified.error, lods.back().error)
+		});
+
+		indices.insert(indices.end(), simplified.indices.begin(), simplified.indices.end());
+	}
+
+	return MeshOptimizer::Optimize(Model(std::move(vertices), std::move(indices), std::move(lods)));
+}
+
+}
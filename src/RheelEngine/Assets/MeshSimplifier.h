@@ -0,0 +1,54 @@
+/*
+ * Copyright (c) Levi van Rheenen. All rights reserved.
+ */
+#ifndef RHEELENGINE_MESHSIMPLIFIER_H
+#define RHEELENGINE_MESHSIMPLIFIER_H
+#include "../_common.h"
+
+#include "Model.h"
+
+namespace rheel {
+
+/**
+ * The triangles of a simplified mesh, and the approximate distance between
+ * the simplified and the original mesh, in model units.
+ */
+struct mesh_simplification {
+	std::vector<unsigned> indices;
+	float error;
+};
+
+/**
+ * Simplifies triangle meshes by collapsing edges in the order of their
+ * quadric error, and generates levels of detail for models. The simplified
+ * meshes use a subset of the vertices of the original mesh, so all levels of
+ * detail of a model share one vertex buffer.
+ *
+ * Vertices on attribute seams, i.e. positions that have multiple vertices
+ * with different normals or texture coordinates, are never removed. The
+ * borders of open meshes are preserved as well as possible.
+ */
+class RE_API MeshSimplifier {
+	RE_NO_CONSTRUCT(MeshSimplifier);
+
+public:
+	/**
+	 * Simplifies the triangles until at most target_index_count indices
+	 * remain, or until no edge can be collapsed anymore.
+	 */
+	static mesh_simplification Simplify(std::span<const unsigned> indices, std::span<const model_vertex> vertices, std::size_t target_index_count);
+
+	/**
+	 * Returns a copy of the model with up to max_lod_count levels of detail.
+	 * Each level has about ratio times the triangles of the previous one.
+	 * Fewer levels are generated when the mesh cannot be simplified further.
+	 * The model is optimized with MeshOptimizer afterwards. Models that are
+	 * not made of triangles are returned as-is.
+	 */
+	static Model GenerateLods(const Model& model, unsigned max_lod_count = 4, float ratio = 0.5f);
+
+};
+
+}
+
+#endif
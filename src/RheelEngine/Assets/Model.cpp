@@ -5,19 +5,67 @@
 
 namespace rheel {
 
+static model_bounds calculate_bounds(std::span<const model_vertex> vertices) {
+	if (vertices.empty()) {
+		return { vec3(0.0f), vec3(0.0f) };
+	}
+
+	model_bounds bounds{ vertices[0].position, vertices[0].position };
+
+	for (const auto& vertex : vertices) {
+		bounds.min = glm::min(bounds.min, vertex.position);
+		bounds.max = glm::max(bounds.max, vertex.position);
+	}
+
+	return bounds;
+}
+
 Model::Model(std::vector<model_vertex> vertices, std::vector<unsigned> indices, RenderType render_type) :
-		Asset({ std::move(vertices), std::move(indices), render_type }) {}
+		Model(std::move(vertices), std::move(indices), {}, render_type) {}
+
+Model::Model(std::vector<model_vertex> vertices, std::vector<unsigned> indices, std::vector<model_lod> lods, RenderType render_type) :
+		Asset({ std::move(vertices), std::move(indices), render_type, {}, std::move(lods) }) {
+
+	GetRaw()->bounds = calculate_bounds(GetRaw()->vertices);
+}
+
+Model::Model(std::shared_ptr<const void> storage, std::span<const model_vertex> vertices, std::span<const unsigned> indices,
+		model_bounds bounds, std::vector<model_lod> lods, RenderType render_type) :
+		Asset({ {}, {}, render_type, bounds, std::move(lods), std::move(storage), vertices, indices }) {}
 
-const std::vector<model_vertex>& Model::GetVertices() const {
-	return GetRaw()->vertices;
+std::span<const model_vertex> Model::GetVertices() const {
+	const auto* data = GetRaw();
+	return data->storage ? data->storage_vertices : std::span<const model_vertex>(data->vertices);
 }
 
-const std::vector<unsigned>& Model::GetIndices() const {
-	return GetRaw()->indices;
+std::span<const unsigned> Model::GetIndices() const {
+	const auto* data = GetRaw();
+	return data->storage ? data->storage_indices : std::span<const unsigned>(data->indices);
 }
 
 RenderType Model::GetRenderType() const {
 	return GetRaw()->render_type;
 }
 
+const model_bounds& Model::GetBounds() const {
+	return GetRaw()->bounds;
+}
+
+const std::vector<model_lod>& Model::GetLods() const {
+	return GetRaw()->lods;
+}
+
+std::size_t Model::GetMemoryUsage() const {
+	const auto* data = GetRaw();
+	std::size_t usage = sizeof(model_data) + data->lods.capacity() * sizeof(model_lod);
+
+	if (data->storage) {
+		// mapped storage is paged in on access, but counts towards the budget
+		// once the model is uploaded
+		return usage + data->storage_vertices.size_bytes() + data->storage_indices.size_bytes();
+	}
+
+	return usage + data->vertices.capacity() * sizeof(model_vertex) + data->indices.capacity() * sizeof(unsigned);
+}
+
 }
@@ -5,6 +5,8 @@
 #define RHEELENGINE_MODEL_H
 #include "../_common.h"
 
+#include <span>
+
 #include "Asset.h"
 
 namespace rheel {
@@ -19,10 +21,37 @@ struct model_vertex {
 	vec2 texture;
 };
 
+/**
+ * The axis-aligned bounding box of the vertices of a model.
+ */
+struct model_bounds {
+	vec3 min;
+	vec3 max;
+};
+
+/**
+ * A level of detail of a model: a range of its indices that draws a simplified
+ * version of the model, using the same vertices. The error is the maximum
+ * distance between the simplified and the full model, in model units.
+ */
+struct model_lod {
+	std::uint32_t first_index;
+	std::uint32_t index_count;
+	float error;
+};
+
 struct model_data {
 	std::vector<model_vertex> vertices;
 	std::vector<unsigned> indices;
 	RenderType render_type;
+	model_bounds bounds;
+	std::vector<model_lod> lods;
+
+	// When set, the vertices and indices are not owned by the vectors above,
+	// but live in this storage (for example a memory-mapped file).
+	std::shared_ptr<const void> storage;
+	std::span<const model_vertex> storage_vertices;
+	std::span<const unsigned> storage_indices;
 };
 
 class RE_API Model : public Asset<model_data> {
@@ -30,10 +59,40 @@ class RE_API Model : public Asset<model_data> {
 public:
 	Model(std::vector<model_vertex> vertices, std::vector<unsigned> indices, RenderType render_type = RenderType::TRIANGLES);
 
-	const std::vector<model_vertex>& GetVertices() const;
-	const std::vector<unsigned>& GetIndices() const;
+	/**
+	 * Creates a model with levels of detail, which are ranges of the indices.
+	 */
+	Model(std::vector<model_vertex> vertices, std::vector<unsigned> indices, std::vector<model_lod> lods,
+			RenderType render_type = RenderType::TRIANGLES);
+
+	/**
+	 * Creates a model of which the vertices and indices live in external
+	 * storage, for example a memory-mapped file. The model keeps the storage
+	 * alive for as long as the model exists, and does not copy the data.
+	 */
+	Model(std::shared_ptr<const void> storage, std::span<const model_vertex> vertices, std::span<const unsigned> indices,
+			model_bounds bounds, std::vector<model_lod> lods = {}, RenderType render_type = RenderType::TRIANGLES);
+
+	std::span<const model_vertex> GetVertices() const;
+	std::span<const unsigned> GetIndices() const;
 	RenderType GetRenderType() const;
 
+	/**
+	 * Returns the bounding box of the vertices of the model.
+	 */
+	const model_bounds& GetBounds() const;
+
+	/**
+	 * Returns the levels of detail of the model, from the most to the least
+	 * detailed. Models without levels of detail return an empty list.
+	 */
+	const std::vector<model_lod>& GetLods() const;
+
+	/**
+	 * Returns the approximate amount of memory used by the model, in bytes.
+	 */
+	std::size_t GetMemoryUsage() const;
+
 };
 
 }
@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) Levi van Rheenen. All rights reserved.
+ */
+#include "PreloadBatch.h"
+
+namespace rheel {
+
+PreloadBatch::PreloadBatch(ThreadPool* pool, std::vector<std::string> paths, LoadFunction load) :
+		_state(std::make_shared<batch_state>()) {
+
+	_state->paths = std::move(paths);
+	_state->load = std::move(load);
+
+	for (std::size_t i = 0; i < _state->paths.size(); i++) {
+		if (pool == nullptr) {
+			_load(*_state, i);
+		} else {
+			pool->AddTask<void>([state = _state, i]() { _load(*state, i); });
+		}
+	}
+}
+
+std::size_t PreloadBatch::GetAssetCount() const {
+	return _state->paths.size();
+}
+
+std::size_t PreloadBatch::GetLoadedCount() const {
+	return _state->loaded.load(std::memory_order_acquire);
+}
+
+std::size_t PreloadBatch::GetBytesLoaded() const {
+	return _state->bytes_loaded.load(std::memory_order_relaxed);
+}
+
+float PreloadBatch::GetProgress() const {
+	if (_state->paths.empty()) {
+		return 1.0f;
+	}
+
+	return float(GetLoadedCount()) / float(GetAssetCount());
+}
+
+bool PreloadBatch::IsDone() const {
+	return GetLoadedCount() == GetAssetCount();
+}
+
+void PreloadBatch::Wait() const {
+	std::unique_lock lock(_state->mutex);
+	_state->all_loaded.wait(lock, [this]() { return IsDone(); });
+
+	if (_state->exception) {
+		std::rethrow_exception(_state->exception);
+	}
+}
+
+void PreloadBatch::_load(batch_state& state, std::size_t index) {
+	std::exception_ptr exception;
+
+	try {
+		state.bytes_loaded.fetch_add(state.load(state.paths[index]), std::memory_order_relaxed);
+	} catch (...) {
+		exception = std::current_exception();
+	}
+
+	std::lock_guard lock(state.mutex);
+
+	if (exception && !state.exception) {
+		state.exception = exception;
+	}
+
+	if (state.loaded.fetch_add(1, std::memory_order_acq_rel) + 1 == state.paths.size()) {
+		state.all_loaded.notify_all();
+	}
+}
+
+}
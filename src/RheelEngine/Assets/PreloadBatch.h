@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) Levi van Rheenen. All rights reserved.
+ */
+#ifndef RHEELENGINE_PRELOADBATCH_H
+#define RHEELENGINE_PRELOADBATCH_H
+#include "../_common.h"
+
+#include "../ThreadPool.h"
+
+namespace rheel {
+
+/**
+ * A set of assets that is being loaded in the background, for example by
+ * AssetLoader::Preload(const AssetManifest&, ...). The batch can be queried
+ * from the main thread to show the progress on a loading screen.
+ * Copies of a batch refer to the same loading progress.
+ */
+class RE_API PreloadBatch {
+
+public:
+	/**
+	 * A function which loads the asset at the path, and returns its size in
+	 * bytes.
+	 */
+	using LoadFunction = std::function<std::size_t(const std::string&)>;
+
+	/**
+	 * Starts loading the assets on the thread pool. The assets are scheduled in
+	 * the given order, but are loaded concurrently, so an asset can finish
+	 * before the assets that come before it. The load function must therefore
+	 * not depend on other assets of the batch having been loaded. If the
+	 * thread pool is null, the assets are loaded on the calling thread, in
+	 * order, before the constructor returns.
+	 */
+	PreloadBatch(ThreadPool* pool, std::vector<std::string> paths, LoadFunction load);
+
+	/**
+	 * Returns the number of assets in this batch.
+	 */
+	std::size_t GetAssetCount() const;
+
+	/**
+	 * Returns the number of assets that have finished loading, including
+	 * those that failed to load.
+	 */
+	std::size_t GetLoadedCount() const;
+
+	/**
+	 * Returns the total size of the assets that have finished loading, in
+	 * bytes.
+	 */
+	std::size_t GetBytesLoaded() const;
+
+	/**
+	 * Returns the fraction of the assets that have finished loading, in
+	 * [0 .. 1].
+	 */
+	float GetProgress() const;
+
+	/**
+	 * Returns whether all assets have finished loading.
+	 */
+	bool IsDone() const;
+
+	/**
+	 * Blocks until all assets have finished loading. If one of the assets
+	 * could not be loaded, the first error is thrown.
+	 */
+	void Wait() const;
+
+private:
+	struct batch_state {
+		std::vector<std::string> paths;
+		LoadFunction load;
+		std::atomic_size_t loaded = 0;
+		std::atomic_size_t bytes_loaded = 0;
+		std::exception_ptr exception;
+		mutable std::mutex mutex;
+		mutable std::condition_variable all_loaded;
+	};
+
+	static void _load(batch_state& state, std::size_t index);
+
+	std::shared_ptr<batch_state> _state;
+
+};
+
+}
+
+#endif
@@ -12,6 +12,14 @@ const std::string& Shader::GetSource() const {
 	return GetRaw()->source;
 }
 
+std::size_t Shader::GetMemoryUsage() const {
+	if (IsNull()) {
+		return 0;
+	}
+
+	return sizeof(shader_data) + GetRaw()->source.capacity();
+}
+
 Shader Shader::Null() {
 	return Shader(nullptr);
 }
@@ -20,6 +20,11 @@ public:
 
 	const std::string& GetSource() const;
 
+	/**
+	 * Returns the approximate amount of memory used by the shader, in bytes.
+	 */
+	std::size_t GetMemoryUsage() const;
+
 private:
 	Shader() = default;
 	Shader(std::nullptr_t) :
@@ -24,4 +24,8 @@ int Sound::GetSampleFrequency() const {
 	return GetRaw()->sample_frequency;
 }
 
+std::size_t Sound::GetMemoryUsage() const {
+	return sizeof(sound_data) + GetRaw()->data.capacity();
+}
+
 }
@@ -35,6 +35,11 @@ public:
 
 	int GetSampleFrequency() const;
 
+	/**
+	 * Returns the approximate amount of memory used by the sound, in bytes.
+	 */
+	std::size_t GetMemoryUsage() const;
+
 };
 
 }
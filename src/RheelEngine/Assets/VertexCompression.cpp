@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) Levi van Rheenen. All rights reserved.
+ */
+#include "VertexCompression.h"
+
+namespace rheel {
+
+static std::int16_t to_snorm16(float value) {
+	return std::int16_t(std::round(std::clamp(value, -1.0f, 1.0f) * 32767.0f));
+}
+
+static float from_snorm16(std::int16_t value) {
+	return std::max(float(value) / 32767.0f, -1.0f);
+}
+
+static float sign_not_zero(float value) {
+	return value >= 0.0f ? 1.0f : -1.0f;
+}
+
+// Maps the unit sphere onto the octahedron |x| + |y| + |z| = 1, and unfolds
+// the lower half of the octahedron onto the corners of the square [-1, 1]^2.
+static vec2 encode_octahedral(vec3 normal) {
+	float sum = std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z);
+
+	if (sum == 0.0f) {
+		return vec2(0.0f, 0.0f);
+	}
+
+	normal /= sum;
+
+	if (normal.z >= 0.0f) {
+		return vec2(normal.x, normal.y);
+	}
+
+	return vec2(
+			(1.0f - std::abs(normal.y)) * sign_not_zero(normal.x),
+			(1.0f - std::abs(normal.x)) * sign_not_zero(normal.y));
+}
+
+// the same decoding as in the vertex shaders
+static vec3 decode_octahedral(vec2 encoded) {
+	vec3 normal(encoded.x, encoded.y, 1.0f - std::abs(encoded.x) - std::abs(encoded.y));
+
+	if (normal.z < 0.0f) {
+		normal = vec3(
+				(1.0f - std::abs(encoded.y)) * sign_not_zero(encoded.x),
+				(1.0f - std::abs(encoded.x)) * sign_not_zero(encoded.y),
+				normal.z);
+	}
+
+	return glm::normalize(normal);
+}
+
+std::vector<compact_vertex> VertexCompression::Compress(std::span<const model_vertex> vertices, const model_bounds& bounds) {
+	vec3 offset = GetPositionOffset(bounds);
+	vec3 scale = GetPositionScale(bounds);
+
+	std::vector<compact_vertex> compressed;
+	compressed.reserve(vertices.size());
+
+	for (const auto& vertex : vertices) {
+		vec3 position = (vertex.position - offset) / scale;
+		vec2 normal = encode_octahedral(vertex.normal);
+
+		compressed.push_back({
+				{ to_snorm16(position.x), to_snorm16(position.y), to_snorm16(position.z), 0 },
+				{ to_snorm16(normal.x), to_snorm16(normal.y) },
+				glm::packHalf2x16(vertex.texture)
+		});
+	}
+
+	return compressed;
+}
+
+model_vertex VertexCompression::Decompress(const compact_vertex& vertex, const model_bounds& bounds) {
+	vec3 position(from_snorm16(vertex.position[0]), from_snorm16(vertex.position[1]), from_snorm16(vertex.position[2]));
+	vec2 normal(from_snorm16(vertex.normal[0]), from_snorm16(vertex.normal[1]));
+
+	return {
+			GetPositionOffset(bounds) + GetPositionScale(bounds) * position,
+			decode_octahedral(normal),
+			glm::unpackHalf2x16(vertex.texture)
+	};
+}
+
+vec3 VertexCompression::GetPositionOffset(const model_bounds& bounds) {
+	return (bounds.min + bounds.max) * 0.5f;
+}
+
+vec3 VertexCompression::GetPositionScale(const model_bounds& bounds) {
+	vec3 scale = (bounds.max - bounds.min) * 0.5f;
+
+	for (int i = 0; i < 3; i++) {
+		if (scale[i] <= 0.0f) {
+			scale[i] = 1.0f;
+		}
+	}
+
+	return scale;
+}
+
+}
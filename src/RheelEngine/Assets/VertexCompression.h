@@ -0,0 +1,66 @@
+/*
+ * Copyright (c) Levi van Rheenen. All rights reserved.
+ */
+#ifndef RHEELENGINE_VERTEXCOMPRESSION_H
+#define RHEELENGINE_VERTEXCOMPRESSION_H
+#include "../_common.h"
+
+#include <array>
+
+#include "Model.h"
+
+namespace rheel {
+
+/**
+ * A vertex in half the memory of a model_vertex. The position is stored
+ * relative to the bounds of the model, in normalized 16-bit integers. The
+ * normal is encoded with the octahedral mapping, in normalized 16-bit
+ * integers. The texture coordinates are half-precision floats.
+ */
+struct compact_vertex {
+	// x, y, z in [-1, 1] between the center and the sides of the bounds. The
+	// w component is padding.
+	std::array<std::int16_t, 4> position;
+	std::array<std::int16_t, 2> normal;
+
+	// two half floats, as packed by glm::packHalf2x16()
+	std::uint32_t texture;
+};
+
+/**
+ * Converts vertices to and from the compact_vertex format. A compact vertex
+ * decodes to the position offset + scale * position, where the offset and
+ * scale are computed from the bounds of the model.
+ */
+class RE_API VertexCompression {
+	RE_NO_CONSTRUCT(VertexCompression);
+
+public:
+	/**
+	 * Compresses the vertices of a model with the given bounds.
+	 */
+	static std::vector<compact_vertex> Compress(std::span<const model_vertex> vertices, const model_bounds& bounds);
+
+	/**
+	 * Decompresses a vertex of a model with the given bounds. The result
+	 * differs from the original vertex by the quantization error only.
+	 */
+	static model_vertex Decompress(const compact_vertex& vertex, const model_bounds& bounds);
+
+	/**
+	 * Returns the offset that is added to the decoded positions: the center
+	 * of the bounds.
+	 */
+	static vec3 GetPositionOffset(const model_bounds& bounds);
+
+	/**
+	 * Returns the scale by which the decoded positions are multiplied: half
+	 * the size of the bounds. Flat dimensions have a scale of 1.
+	 */
+	static vec3 GetPositionScale(const model_bounds& bounds);
+
+};
+
+}
+
+#endif
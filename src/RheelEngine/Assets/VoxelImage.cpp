@@ -5,14 +5,35 @@
 
 namespace rheel {
 
+static unsigned chunk_count(unsigned size) {
+	return (size + voxel_image_data::chunk_size - 1) / voxel_image_data::chunk_size;
+}
+
 VoxelImage::VoxelImage(unsigned width, unsigned height, unsigned depth) :
-		Asset({ width, height, depth, {} }) {
+		VoxelImage(width, height, depth, std::array<Color, 256>{}) {
+
+	GetRaw()->palette_size = 1;
+}
+
+VoxelImage::VoxelImage(unsigned width, unsigned height, unsigned depth, const std::array<Color, 256>& palette) :
+		Asset({ width, height, depth, palette, 256, {} }) {
 
-	GetRaw()->voxels.resize(width * height * depth);
+	auto* data = GetRaw();
+	data->palette[0] = Color(0.0f, 0.0f, 0.0f, 0.0f);
+	data->chunks.resize(std::size_t(chunk_count(width)) * chunk_count(height) * chunk_count(depth));
 }
 
-VoxelImage::VoxelImage(unsigned width, unsigned height, unsigned depth, std::vector<Color> voxels) :
-		Asset({ width, height, depth, std::move(voxels) }) {}
+VoxelImage::VoxelImage(unsigned width, unsigned height, unsigned depth, const std::vector<Color>& voxels) :
+		VoxelImage(width, height, depth) {
+
+	for (unsigned z = 0; z < depth; z++) {
+		for (unsigned y = 0; y < height; y++) {
+			for (unsigned x = 0; x < width; x++) {
+				Set(x, y, z, voxels[x + y * width + z * width * height]);
+			}
+		}
+	}
+}
 
 unsigned VoxelImage::GetWidth() const {
 	return GetRaw()->width;
@@ -27,13 +48,96 @@ unsigned VoxelImage::GetDepth() const {
 }
 
 const Color& VoxelImage::At(unsigned x, unsigned y, unsigned z) const {
-	const auto* data = GetRaw();
-	return data->voxels[x + y * data->width + z * data->width * data->height];
+	return GetRaw()->palette[GetIndex(x, y, z)];
+}
+
+void VoxelImage::Set(unsigned x, unsigned y, unsigned z, const Color& color) {
+	auto* data = GetRaw();
+
+	if (color.Alpha() == 0.0f) {
+		SetIndex(x, y, z, 0);
+		return;
+	}
+
+	for (unsigned i = 1; i < data->palette_size; i++) {
+		if (data->palette[i] == color) {
+			SetIndex(x, y, z, std::uint8_t(i));
+			return;
+		}
+	}
+
+	if (data->palette_size == data->palette.size()) {
+		throw std::runtime_error("voxel image palette is full");
+	}
+
+	data->palette[data->palette_size] = color;
+	SetIndex(x, y, z, std::uint8_t(data->palette_size++));
+}
+
+std::uint8_t VoxelImage::GetIndex(unsigned x, unsigned y, unsigned z) const {
+	const auto& chunk = GetRaw()->chunks[_chunk_index(x, y, z)];
+	return chunk ? (*chunk)[_voxel_index(x, y, z)] : 0;
+}
+
+void VoxelImage::SetIndex(unsigned x, unsigned y, unsigned z, std::uint8_t index) {
+	auto& chunk = GetRaw()->chunks[_chunk_index(x, y, z)];
+
+	if (!chunk) {
+		if (index == 0) {
+			return;
+		}
+
+		chunk = std::make_unique<voxel_image_data::chunk>();
+		chunk->fill(0);
+	}
+
+	(*chunk)[_voxel_index(x, y, z)] = index;
+}
+
+const std::array<Color, 256>& VoxelImage::GetPalette() const {
+	return GetRaw()->palette;
 }
 
-Color& VoxelImage::At(unsigned x, unsigned y, unsigned z) {
+void VoxelImage::SetPaletteColor(std::uint8_t index, const Color& color) {
+	if (index == 0) {
+		throw std::invalid_argument("palette entry 0 is the empty voxel");
+	}
+
 	auto* data = GetRaw();
-	return data->voxels[x + y * data->width + z * data->width * data->height];
+	data->palette[index] = color;
+	data->palette_size = std::max(data->palette_size, unsigned(index) + 1);
+}
+
+uvec3 VoxelImage::GetChunkCount() const {
+	const auto* data = GetRaw();
+	return uvec3(chunk_count(data->width), chunk_count(data->height), chunk_count(data->depth));
+}
+
+const std::uint8_t* VoxelImage::GetChunk(unsigned chunk_x, unsigned chunk_y, unsigned chunk_z) const {
+	uvec3 count = GetChunkCount();
+	const auto& chunk = GetRaw()->chunks[chunk_x + chunk_y * count.x + chunk_z * count.x * count.y];
+
+	return chunk ? chunk->data() : nullptr;
+}
+
+std::size_t VoxelImage::GetMemoryUsage() const {
+	const auto* data = GetRaw();
+	std::size_t allocated = std::count_if(data->chunks.begin(), data->chunks.end(), [](const auto& chunk) {
+		return chunk != nullptr;
+	});
+
+	return sizeof(voxel_image_data) +
+			data->chunks.capacity() * sizeof(std::unique_ptr<voxel_image_data::chunk>) +
+			allocated * sizeof(voxel_image_data::chunk);
+}
+
+std::size_t VoxelImage::_chunk_index(unsigned x, unsigned y, unsigned z) const {
+	uvec3 count = GetChunkCount();
+	return x / chunk_size + (y / chunk_size) * count.x + (z / chunk_size) * count.x * count.y;
+}
+
+std::size_t VoxelImage::_voxel_index(unsigned x, unsigned y, unsigned z) {
+	return x % chunk_size + (y % chunk_size) * chunk_size + (z % chunk_size) * chunk_size * chunk_size;
 }
 
 }
@@ -5,37 +5,124 @@
 #define RHEELENGINE_VOXELIMAGE_H
 #include "../_common.h"
 
+#include <array>
+
 #include "Asset.h"
 #include "../Color.h"
 
 namespace rheel {
 
+/**
+ * The voxels of a voxel image are indices into a palette of 256 colors, of
+ * which index 0 is an empty voxel. The indices are stored in cubic chunks, so
+ * the empty parts of the image take no memory.
+ */
 struct RE_API voxel_image_data {
+	static constexpr unsigned chunk_size = 16;
+	static constexpr unsigned chunk_volume = chunk_size * chunk_size * chunk_size;
+
+	// the palette indices of the voxels in one chunk, with x varying fastest,
+	// then y, then z
+	using chunk = std::array<std::uint8_t, chunk_volume>;
+
 	unsigned width;
 	unsigned height;
 	unsigned depth;
-	std::vector<Color> voxels;
+
+	std::array<Color, 256> palette;
+
+	// the number of palette entries in use, including the empty entry
+	unsigned palette_size;
+
+	// the chunks of the image, with x varying fastest, then y, then z. Chunks
+	// that only have empty voxels are null.
+	std::vector<std::unique_ptr<chunk>> chunks;
 };
 
 class RE_API VoxelImage : public Asset<voxel_image_data> {
 
 public:
+	static constexpr unsigned chunk_size = voxel_image_data::chunk_size;
+
 	/**
 	 * Creates an empty 3d image with the given dimensions
 	 */
 	VoxelImage(unsigned width, unsigned height, unsigned depth);
-	VoxelImage(unsigned width, unsigned height, unsigned depth, std::vector<Color> voxels);
+
+	/**
+	 * Creates an empty 3d image with the given dimensions and palette. Entry
+	 * 0 of the palette is the empty voxel, and is made transparent.
+	 */
+	VoxelImage(unsigned width, unsigned height, unsigned depth, const std::array<Color, 256>& palette);
+
+	/**
+	 * Creates a 3d image from the colors of the voxels, with x varying
+	 * fastest, then y, then z. Transparent colors are empty voxels. Throws
+	 * when the voxels have more than 255 different colors.
+	 */
+	VoxelImage(unsigned width, unsigned height, unsigned depth, const std::vector<Color>& voxels);
 
 	unsigned GetWidth() const;
 	unsigned GetHeight() const;
 	unsigned GetDepth() const;
 
+	/**
+	 * Returns the color of a voxel. Empty voxels are transparent.
+	 */
 	const Color& At(unsigned x, unsigned y, unsigned z) const;
-	Color& At(unsigned x, unsigned y, unsigned z);
+
+	/**
+	 * Sets the color of a voxel. Colors that are not in the palette yet are
+	 * added to it. Throws when the palette is full. Transparent colors make
+	 * the voxel empty.
+	 */
+	void Set(unsigned x, unsigned y, unsigned z, const Color& color);
+
+	/**
+	 * Returns the palette index of a voxel, which is 0 for empty voxels.
+	 */
+	std::uint8_t GetIndex(unsigned x, unsigned y, unsigned z) const;
+
+	/**
+	 * Sets the palette index of a voxel. Use 0 to make the voxel empty.
+	 */
+	void SetIndex(unsigned x, unsigned y, unsigned z, std::uint8_t index);
+
+	/**
+	 * Returns the palette of the image. Entry 0 is the empty voxel.
+	 */
+	const std::array<Color, 256>& GetPalette() const;
+
+	/**
+	 * Changes a color of the palette, which changes the color of all voxels
+	 * with that index. Entry 0 cannot be changed.
+	 */
+	void SetPaletteColor(std::uint8_t index, const Color& color);
+
+	/**
+	 * Returns the number of chunks in each dimension.
+	 */
+	uvec3 GetChunkCount() const;
+
+	/**
+	 * Returns the palette indices of the voxels of a chunk, with x varying
+	 * fastest, then y, then z. Voxels outside of the image are empty. Returns
+	 * nullptr when all voxels of the chunk are empty.
+	 */
+	const std::uint8_t* GetChunk(unsigned chunk_x, unsigned chunk_y, unsigned chunk_z) const;
+
+	/**
+	 * Returns the approximate amount of memory used by the voxel image, in bytes.
+	 */
+	std::size_t GetMemoryUsage() const;
 
 private:
 	VoxelImage() = default;
 
+	std::size_t _chunk_index(unsigned x, unsigned y, unsigned z) const;
+
+	static std::size_t _voxel_index(unsigned x, unsigned y, unsigned z);
+
 };
 
 }
@@ -0,0 +1,216 @@
+/*
+ * Copyright (c) Levi van Rheenen. All rights reserved.
+ */
+#include "VoxelMesher.h"
+
+#include <cstring>
+
+namespace rheel {
+
+static constexpr int chunk_length = int(VoxelMesher::chunk_size);
+static constexpr int padded_length = int(VoxelMesher::padded_size);
+
+// the index in a padded chunk of a position relative to the chunk, of which
+// the components are in [-1, chunk_length]
+static std::size_t padded_index(ivec3 position) {
+	return (position.x + 1) + (position.y + 1) * padded_length + (position.z + 1) * padded_length * padded_length;
+}
+
+VoxelMesher::padded_chunk VoxelMesher::CopyChunk(const VoxelImage& image, uvec3 chunk) {
+	padded_chunk voxels{};
+
+	// the chunk itself
+	if (const std::uint8_t* source = image.GetChunk(chunk.x, chunk.y, chunk.z); source) {
+		for (int z = 0; z < chunk_length; z++) {
+			for (int y = 0; y < chunk_length; y++) {
+				std::memcpy(&voxels[padded_index(ivec3(0, y, z))], source + (y + z * chunk_length) * chunk_length, chunk_length);
+			}
+		}
+	}
+
+	// the voxels around it
+	ivec3 origin = ivec3(chunk) * chunk_length;
+	ivec3 size(int(image.GetWidth()), int(image.GetHeight()), int(image.GetDepth()));
+
+	for (int z = -1; z <= chunk_length; z++) {
+		for (int y = -1; y <= chunk_length; y++) {
+			bool border = z < 0 || z == chunk_length || y < 0 || y == chunk_length;
+
+			// inside the chunk, only the first and the last x are around it
+			for (int x = -1; x <= chunk_length; x += (border || x == chunk_length) ? 1 : chunk_length + 1) {
+				ivec3 position = origin + ivec3(x, y, z);
+
+				if (position.x >= 0 && position.y >= 0 && position.z >= 0 &&
+						position.x < size.x && position.y < size.y && position.z < size.z) {
+					voxels[padded_index(ivec3(x, y, z))] = image.GetIndex(position.x, position.y, position.z);
+				}
+			}
+		}
+	}
+
+	return voxels;
+}
+
+voxel_mesh VoxelMesher::Mesh(const padded_chunk& voxels, uvec3 chunk) {
+	voxel_mesh mesh;
+
+	// chunks in empty space have no faces
+	if (std::all_of(voxels.begin(), voxels.end(), [](std::uint8_t index) { return index == 0; })) {
+		return mesh;
+	}
+
+	vec3 origin = vec3(chunk) * float(chunk_length);
+
+	auto solid = [&voxels](ivec3 position) {
+		return voxels[padded_index(position)] != 0;
+	};
+
+	// The faces of one slice of the chunk. Each face is the palette index of
+	// its voxel, and the ambient occlusion levels of its four corners in
+	// 2 bits each. Faces with the same value can be merged.
+	std::array<std::uint32_t, chunk_length * chunk_length> mask{};
+
+	for (int axis = 0; axis < 3; axis++) {
+		int u_axis = (axis + 1) % 3;
+		int v_axis = (axis + 2) % 3;
+
+		for (int side = -1; side <= 1; side += 2) {
+			vec3 normal(0.0f, 0.0f, 0.0f);
+			normal[axis] = float(side);
+
+			for (int slice = 0; slice < chunk_length; slice++) {
+				for (int v = 0; v < chunk_length; v++) {
+					for (int u = 0; u < chunk_length; u++) {
+						ivec3 position;
+						position[axis] = slice;
+						position[u_axis] = u;
+						position[v_axis] = v;
+
+						ivec3 front = position;
+						front[axis] += side;
+
+						std::uint8_t index = voxels[padded_index(position)];
+
+						if (index == 0 || solid(front)) {
+							mask[u + v * chunk_length] = 0;
+							continue;
+						}
+
+						// the corners are in the order (-u, -v), (+u, -v),
+						// (+u, +v), (-u, +v)
+						std::uint32_t face = index;
+
+						for (int corner = 0; corner < 4; corner++) {
+							ivec3 side_u = front;
+							side_u[u_axis] += (corner == 1 || corner == 2) ? 1 : -1;
+
+							ivec3 side_v = front;
+							side_v[v_axis] += corner >= 2 ? 1 : -1;
+
+							ivec3 diagonal = side_u;
+							diagonal[v_axis] = side_v[v_axis];
+
+							int occlusion = 0;
+
+							if (!solid(side_u) || !solid(side_v)) {
+								occlusion = 3 - int(solid(side_u)) - int(solid(side_v)) - int(solid(diagonal));
+							}
+
+							face |= std::uint32_t(occlusion) << (8 + 2 * corner);
+						}
+
+						mask[u + v * chunk_length] = face;
+					}
+				}
+
+				// merge the faces greedily: first as wide, then as high as
+				// possible
+				for (int v = 0; v < chunk_length; v++) {
+					for (int u = 0; u < chunk_length;) {
+						std::uint32_t face = mask[u + v * chunk_length];
+
+						if (face == 0) {
+							u++;
+							continue;
+						}
+
+						int width = 1;
+						while (u + width < chunk_length && mask[u + width + v * chunk_length] == face) {
+							width++;
+						}
+
+						int height = 1;
+						for (; v + height < chunk_length; height++) {
+							auto row = mask.begin() + (u + (v + height) * chunk_length);
+
+							if (!std::all_of(row, row + width, [face](std::uint32_t f) { return f == face; })) {
+								break;
+							}
+						}
+
+						for (int dv = 0; dv < height; dv++) {
+							std::fill_n(mask.begin() + (u + (v + dv) * chunk_length), width, 0);
+						}
+
+						// add the quad
+						auto first = unsigned(mesh.vertices.size());
+						std::array<int, 4> occlusion{};
+
+						for (int corner = 0; corner < 4; corner++) {
+							occlusion[corner] = int(face >> (8 + 2 * corner)) & 3;
+
+							vec3 position;
+							position[axis] = float(slice + (side > 0 ? 1 : 0));
+							position[u_axis] = float(u + ((corner == 1 || corner == 2) ? width : 0));
+							position[v_axis] = float(v + (corner >= 2 ? height : 0));
+
+							vec2 texture((float(face & 0xFF) + 0.5f) / 256.0f, (float(occlusion[corner]) + 0.5f) / 4.0f);
+							mesh.vertices.push_back({ origin + position, normal, texture });
+						}
+
+						// Split the quad along the darkest diagonal, so the
+						// ambient occlusion is interpolated symmetrically.
+						std::array<unsigned, 4> corners{ 0, 1, 2, 3 };
+
+						if (occlusion[0] + occlusion[2] > occlusion[1] + occlusion[3]) {
+							corners = { 1, 2, 3, 0 };
+						}
+
+						// The corners are counter-clockwise when seen from the
+						// positive side of the axis, so faces on the negative
+						// side are reversed.
+						if (side < 0) {
+							std::swap(corners[1], corners[3]);
+						}
+
+						mesh.indices.insert(mesh.indices.end(), {
+								first + corners[0], first + corners[1], first + corners[2],
+								first + corners[0], first + corners[2], first + corners[3]
+						});
+
+						u += width;
+					}
+				}
+			}
+		}
+	}
+
+	return mesh;
+}
+
+Image VoxelMesher::CreatePaletteTexture(const VoxelImage& image) {
+	const auto& palette = image.GetPalette();
+
+	std::vector<Color> pixels;
+	pixels.reserve(palette.size() * ambient_occlusion_levels.size());
+
+	for (float brightness : ambient_occlusion_levels) {
+		for (const Color& color : palette) {
+			pixels.emplace_back(color.Red() * brightness, color.Green() * brightness, color.Blue() * brightness, color.Alpha());
+		}
+	}
+
+	return Image(unsigned(palette.size()), unsigned(ambient_occlusion_levels.size()), pixels);
+}
+
+}
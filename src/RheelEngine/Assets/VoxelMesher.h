@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) Levi van Rheenen. All rights reserved.
+ */
+#ifndef RHEELENGINE_VOXELMESHER_H
+#define RHEELENGINE_VOXELMESHER_H
+#include "../_common.h"
+
+#include "Image.h"
+#include "Model.h"
+#include "VoxelImage.h"
+
+namespace rheel {
+
+/**
+ * The triangles of the visible faces of a chunk of a voxel image.
+ */
+struct voxel_mesh {
+	std::vector<model_vertex> vertices;
+	std::vector<unsigned> indices;
+};
+
+/**
+ * Converts the chunks of voxel images to triangle meshes with greedy meshing:
+ * faces between two voxels are culled, and the remaining faces with the same
+ * color and ambient occlusion are merged into as few rectangles as possible.
+ *
+ * The meshes are textured with the palette texture of the image, see
+ * CreatePaletteTexture(). The x texture coordinate selects the palette entry,
+ * the y coordinate the ambient occlusion level.
+ */
+class RE_API VoxelMesher {
+	RE_NO_CONSTRUCT(VoxelMesher);
+
+public:
+	static constexpr unsigned chunk_size = VoxelImage::chunk_size;
+	static constexpr unsigned padded_size = chunk_size + 2;
+
+	/**
+	 * The palette indices of a chunk and the voxels directly around it, with x
+	 * varying fastest, then y, then z. The neighbouring voxels are needed to
+	 * cull faces and compute ambient occlusion on the chunk border.
+	 */
+	using padded_chunk = std::array<std::uint8_t, padded_size * padded_size * padded_size>;
+
+	/**
+	 * The brightness of each of the four ambient occlusion levels, from a
+	 * corner between two solid voxels to an unoccluded corner.
+	 */
+	static constexpr std::array<float, 4> ambient_occlusion_levels{ 0.45f, 0.65f, 0.85f, 1.0f };
+
+	/**
+	 * Copies a chunk of the image, and the voxels around it. A copy can be
+	 * meshed on another thread while the image is modified.
+	 */
+	static padded_chunk CopyChunk(const VoxelImage& image, uvec3 chunk);
+
+	/**
+	 * Creates the mesh of a chunk. The vertex positions are in voxel units,
+	 * relative to the origin of the image.
+	 */
+	static voxel_mesh Mesh(const padded_chunk& voxels, uvec3 chunk);
+
+	/**
+	 * Creates the texture for the meshes of the image: 256 x 4 pixels, with
+	 * each column a color of the palette, and each row that color darkened
+	 * by an ambient occlusion level.
+	 */
+	static Image CreatePaletteTexture(const VoxelImage& image);
+
+};
+
+}
+
+#endif
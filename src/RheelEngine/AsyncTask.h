@@ -0,0 +1,255 @@
+/*
+ * Copyright (c) Levi van Rheenen. All rights reserved.
+ */
+#ifndef RHEELENGINE_ASYNCTASK_H
+#define RHEELENGINE_ASYNCTASK_H
+#include "_common.h"
+
+#include <atomic>
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <utility>
+
+namespace rheel {
+
+template<typename T>
+class AsyncTask;
+
+namespace detail {
+
+class async_task_promise_base {
+	template<typename T>
+	friend class ::rheel::AsyncTask;
+
+public:
+	/**
+	 * Async tasks start running immediately when called, up to their first
+	 * suspension point.
+	 */
+	std::suspend_never initial_suspend() noexcept {
+		return {};
+	}
+
+	auto final_suspend() noexcept {
+		struct final_awaiter {
+			async_task_promise_base& promise;
+
+			bool await_ready() noexcept {
+				return false;
+			}
+
+			void await_suspend(std::coroutine_handle<> handle) noexcept {
+				// mark the task as completed, and wake up anyone waiting on it
+				void* continuation = promise._continuation.exchange(_completed(), std::memory_order_acq_rel);
+				promise._continuation.notify_all();
+
+				if (continuation != nullptr) {
+					std::coroutine_handle<>::from_address(continuation).resume();
+				}
+
+				promise._release(handle);
+			}
+
+			void await_resume() noexcept {}
+		};
+
+		return final_awaiter{ *this };
+	}
+
+	void unhandled_exception() {
+		_exception = std::current_exception();
+	}
+
+protected:
+	void _rethrow_if_failed() const {
+		if (_exception) {
+			std::rethrow_exception(_exception);
+		}
+	}
+
+private:
+	bool _is_done() const {
+		return _continuation.load(std::memory_order_acquire) == _completed();
+	}
+
+	/**
+	 * Registers the coroutine to resume once this task has finished. Returns
+	 * false if the task has already finished, in which case the continuation
+	 * should not suspend at all.
+	 */
+	bool _set_continuation(std::coroutine_handle<> continuation) {
+		void* expected = nullptr;
+		return _continuation.compare_exchange_strong(expected, continuation.address(), std::memory_order_acq_rel);
+	}
+
+	void _wait() const {
+		void* continuation = _continuation.load(std::memory_order_acquire);
+
+		while (continuation != _completed()) {
+			_continuation.wait(continuation, std::memory_order_acquire);
+			continuation = _continuation.load(std::memory_order_acquire);
+		}
+	}
+
+	/**
+	 * Both the running coroutine and the AsyncTask object own the coroutine
+	 * frame. The last of the two to let go destroys it, so an AsyncTask can
+	 * be dropped while its coroutine is still running (fire-and-forget).
+	 */
+	void _release(std::coroutine_handle<> handle) {
+		if (_references.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+			handle.destroy();
+		}
+	}
+
+	std::atomic<void*> _continuation = nullptr;
+	std::atomic<int> _references = 2;
+	std::exception_ptr _exception;
+
+	static void* _completed() {
+		static char completed;
+		return &completed;
+	}
+
+};
+
+template<typename T>
+class async_task_promise : public async_task_promise_base {
+
+public:
+	AsyncTask<T> get_return_object();
+
+	template<typename U>
+	void return_value(U&& value) {
+		_value.emplace(std::forward<U>(value));
+	}
+
+	T& GetValue() {
+		_rethrow_if_failed();
+		return *_value;
+	}
+
+private:
+	std::optional<T> _value;
+
+};
+
+template<>
+class async_task_promise<void> : public async_task_promise_base {
+
+public:
+	AsyncTask<void> get_return_object();
+
+	void return_void() {}
+
+	void GetValue() {
+		_rethrow_if_failed();
+	}
+
+};
+
+}
+
+/**
+ * The return type of engine coroutines. An AsyncTask starts running as soon as
+ * the coroutine is called, and runs on the calling thread until its first
+ * co_await. Where it continues depends on what it awaits: awaiting
+ * ThreadPool::Schedule() continues on a background thread, awaiting
+ * MainWindow::NextFrame() continues on the main thread at the start of the next
+ * frame.
+ *
+ * An AsyncTask can itself be awaited by another coroutine, which will then
+ * continue on whichever thread finished the task. It may also be discarded, in
+ * which case the coroutine keeps running until it finishes on its own.
+ */
+template<typename T>
+class AsyncTask {
+	friend class detail::async_task_promise<T>;
+
+public:
+	using promise_type = detail::async_task_promise<T>;
+
+	AsyncTask() = default;
+
+	~AsyncTask() {
+		if (_handle) {
+			_handle.promise()._release(_handle);
+		}
+	}
+
+	RE_NO_COPY(AsyncTask);
+
+	AsyncTask(AsyncTask&& task) noexcept :
+			_handle(std::exchange(task._handle, nullptr)) {}
+
+	AsyncTask& operator=(AsyncTask&& task) noexcept {
+		if (this != &task) {
+			if (_handle) {
+				_handle.promise()._release(_handle);
+			}
+
+			_handle = std::exchange(task._handle, nullptr);
+		}
+
+		return *this;
+	}
+
+	/**
+	 * Returns whether the coroutine has finished.
+	 */
+	bool IsDone() const {
+		return _handle.promise()._is_done();
+	}
+
+	/**
+	 * Blocks the calling thread until the coroutine has finished, and returns
+	 * its result. If the coroutine threw an exception, it is rethrown here.
+	 * Never call this from the main thread on a task that waits for the next
+	 * frame.
+	 */
+	decltype(auto) Get() {
+		_handle.promise()._wait();
+		return _handle.promise().GetValue();
+	}
+
+	auto operator co_await() const noexcept {
+		struct awaiter {
+			std::coroutine_handle<promise_type> handle;
+
+			bool await_ready() const {
+				return handle.promise()._is_done();
+			}
+
+			bool await_suspend(std::coroutine_handle<> continuation) {
+				return handle.promise()._set_continuation(continuation);
+			}
+
+			decltype(auto) await_resume() {
+				return handle.promise().GetValue();
+			}
+		};
+
+		return awaiter{ _handle };
+	}
+
+private:
+	explicit AsyncTask(std::coroutine_handle<promise_type> handle) :
+			_handle(handle) {}
+
+	std::coroutine_handle<promise_type> _handle;
+
+};
+
+template<typename T>
+AsyncTask<T> detail::async_task_promise<T>::get_return_object() {
+	return AsyncTask<T>(std::coroutine_handle<async_task_promise<T>>::from_promise(*this));
+}
+
+inline AsyncTask<void> detail::async_task_promise<void>::get_return_object() {
+	return AsyncTask<void>(std::coroutine_handle<async_task_promise<void>>::from_promise(*this));
+}
+
+}
+
+#endif
@@ -5,7 +5,24 @@
 
 namespace rheel {
 
-AudioClip::AudioClip(const Sound& sound) {
+// the size of one sample of all channels, in bytes
+static unsigned block_align(InternalSoundFormat format) {
+	switch (format) {
+		case InternalSoundFormat::MONO_8:
+			return 1;
+		case InternalSoundFormat::MONO_16:
+		case InternalSoundFormat::STEREO_8:
+			return 2;
+		case InternalSoundFormat::STEREO_16:
+			return 4;
+	}
+
+	return 1;
+}
+
+AudioClip::AudioClip(const Sound& sound) :
+		_duration(float(sound.GetRawSampleSize()) / float(block_align(sound.GetFormat()) * sound.GetSampleFrequency())) {
+
 	_buffer.SetData(ALenum(sound.GetFormat()), sound.GetRawSampleData(), sound.GetRawSampleSize(), sound.GetSampleFrequency());
 }
 
@@ -13,4 +30,16 @@ const al::Buffer& AudioClip::Buffer() const {
 	return _buffer;
 }
 
+float AudioClip::GetDuration() const {
+	return _duration;
+}
+
+const sound_settings& AudioClip::GetSettings() const {
+	return _settings;
+}
+
+void AudioClip::SetSettings(const sound_settings& settings) {
+	_settings = settings;
+}
+
 }
@@ -10,6 +10,19 @@
 
 namespace rheel {
 
+/**
+ * How the audio manager treats the instances of a sound.
+ */
+struct sound_settings {
+	// When there are more sounds playing than sources, the sounds with the
+	// highest priority are heard.
+	int priority = 0;
+
+	// The maximum number of instances of the sound that play at the same
+	// time, or 0 for no limit. Playing another instance stops the oldest one.
+	unsigned max_instances = 0;
+};
+
 class RE_API AudioClip {
 
 public:
@@ -17,8 +30,18 @@ public:
 
 	const al::Buffer& Buffer() const;
 
+	/**
+	 * Returns the duration of the clip, in seconds.
+	 */
+	float GetDuration() const;
+
+	const sound_settings& GetSettings() const;
+	void SetSettings(const sound_settings& settings);
+
 private:
 	al::Buffer _buffer;
+	float _duration;
+	sound_settings _settings;
 
 };
 
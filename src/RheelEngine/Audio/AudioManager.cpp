@@ -27,46 +27,97 @@ AudioManager::AudioManager() {
 		Log::Error() << "Could not make audio context current" << std::endl;
 		return;
 	}
+
+	// the pool is never resized, so the pointers into it stay valid
+	_source_pool.resize(source_count);
+
+	for (auto& source : _source_pool) {
+		_free_sources.push_back(&source);
+	}
+
+	_stream_thread = std::thread(&AudioManager::_stream_main, this);
 }
 
 AudioManager::~AudioManager() {
+	if (_stream_thread.joinable()) {
+		{
+			std::lock_guard lock(_streams_mutex);
+			_stream_stop_requested = true;
+		}
+
+		_stream_wake.notify_all();
+		_stream_thread.join();
+	}
+
+	// the OpenAL objects must be deleted before the context
+	_streams.clear();
+	_voices.clear();
+	_free_sources.clear();
+	_source_pool.clear();
+	_clip_cache.clear();
+
 	alcDestroyContext(_context);
 	alcCloseDevice(_device);
 }
 
-AudioSource& AudioManager::Play(const Sound& sound) {
-	const AudioClip& clip = _get_audio_clip(sound);
-
-	auto source = std::make_unique<AudioSource>(*this, clip);
-	source->Play();
+AudioSource AudioManager::Play(const Sound& sound, const vec3& position, float gain) {
+	return _play(sound, false, position, gain);
+}
 
-	_sources.push_back(std::move(source));
-	return *_sources.back();
+AudioSource AudioManager::Loop(const Sound& sound, const vec3& position, float gain) {
+	return _play(sound, true, position, gain);
 }
 
-AudioSource& AudioManager::Loop(const Sound& sound) {
-	const AudioClip& clip = _get_audio_clip(sound);
+void AudioManager::SetSoundSettings(const Sound& sound, const sound_settings& settings) {
+	_get_audio_clip(sound).SetSettings(settings);
+}
 
-	auto source = std::make_unique<AudioSource>(*this, clip);
-	source->Loop();
+StreamingAudioSource AudioManager::PlayStream(const std::string& path) {
+	return _stream(path, false);
+}
 
-	_sources.push_back(std::move(source));
-	return *_sources.back();
+StreamingAudioSource AudioManager::LoopStream(const std::string& path) {
+	return _stream(path, true);
 }
 
 void AudioManager::Stop(AudioSource& source) {
-	source._stop();
+	auto voice = source._voice.lock();
+	if (!voice) {
+		return;
+	}
 
-	auto iter = std::find_if(_sources.begin(), _sources.end(),
-			[&](const auto& ptr) { return ptr.get() == &source; });
-	_sources.erase(iter);
+	_release(*voice);
+	_voices.erase(std::find(_voices.begin(), _voices.end(), voice));
+}
+
+void AudioManager::Stop(StreamingAudioSource& source) {
+	auto stream = source._stream.lock();
+	if (!stream) {
+		return;
+	}
+
+	std::lock_guard lock(_streams_mutex);
+	stream->_stop();
+
+	// the stream thread may have deleted the stream already
+	if (auto iter = std::find(_streams.begin(), _streams.end(), stream); iter != _streams.end()) {
+		_streams.erase(iter);
+	}
 }
 
 al::Listener& AudioManager::GetListener() {
 	return _listener;
 }
 
-const AudioClip& AudioManager::_get_audio_clip(const Sound& sound) {
+std::size_t AudioManager::GetVoiceCount() const {
+	return _voices.size();
+}
+
+std::size_t AudioManager::GetRealVoiceCount() const {
+	return _source_pool.size() - _free_sources.size();
+}
+
+AudioClip& AudioManager::_get_audio_clip(const Sound& sound) {
 	auto iter = _clip_cache.find(sound.GetAddress());
 
 	if (iter == _clip_cache.end()) {
@@ -76,12 +127,214 @@ const AudioClip& AudioManager::_get_audio_clip(const Sound& sound) {
 	return iter->second;
 }
 
+AudioSource AudioManager::_play(const Sound& sound, bool loop, const vec3& position, float gain) {
+	const AudioClip& clip = _get_audio_clip(sound);
+	const sound_settings& settings = clip.GetSettings();
+
+	// make room for the new instance by stopping the oldest ones
+	if (settings.max_instances > 0) {
+		auto instances = std::size_t(std::count_if(_voices.begin(), _voices.end(),
+				[&clip](const auto& voice) { return voice->clip == &clip; }));
+
+		for (auto iter = _voices.begin(); instances >= settings.max_instances && iter != _voices.end();) {
+			if ((*iter)->clip == &clip) {
+				_release(**iter);
+				iter = _voices.erase(iter);
+				instances--;
+			} else {
+				iter++;
+			}
+		}
+	}
+
+	auto voice = std::make_shared<audio_voice>();
+	voice->clip = &clip;
+	voice->looping = loop;
+	voice->priority = settings.priority;
+	voice->gain = glm::clamp(gain, 0.0f, 1.0f);
+	voice->position = position;
+	voice->audibility = _audibility(*voice);
+
+	// Start playing right away when the voice is audible, and there is a free
+	// source or a source of a less important voice. Otherwise, the voice
+	// starts as a virtual voice, and _update() decides later.
+	if (voice->audibility >= audibility_threshold) {
+		if (_free_sources.empty()) {
+			audio_voice* least_important = nullptr;
+
+			for (const auto& other : _voices) {
+				if (other->source && (!least_important || _ranks_higher(*least_important, *other))) {
+					least_important = other.get();
+				}
+			}
+
+			if (least_important && _ranks_higher(*voice, *least_important)) {
+				_virtualize(*least_important);
+			}
+		}
+
+		if (!_free_sources.empty()) {
+			_realize(*voice);
+		}
+	}
+
+	_voices.push_back(voice);
+	return AudioSource(*this, voice);
+}
+
+void AudioManager::_update(float dt) {
+	// advance the voices, and remove the finished ones
+	std::erase_if(_voices, [this, dt](const auto& voice) {
+		bool finished = false;
+
+		if (voice->source) {
+			finished = !voice->source->IsPlaying();
+		} else {
+			voice->time += dt;
+
+			if (float duration = voice->clip->GetDuration(); voice->time >= duration) {
+				if (voice->looping && duration > 0.0f) {
+					voice->time = std::fmod(voice->time, duration);
+				} else {
+					finished = true;
+				}
+			}
+		}
+
+		if (finished) {
+			_release(*voice);
+			return true;
+		}
+
+		voice->audibility = _audibility(*voice);
+		return false;
+	});
+
+	// rank the audible voices, only to find the ones that get a source
+	_ranking.clear();
+
+	for (const auto& voice : _voices) {
+		if (voice->audibility >= audibility_threshold) {
+			_ranking.push_back(voice.get());
+		} else if (voice->source) {
+			_virtualize(*voice);
+		}
+	}
+
+	auto real_end = _ranking.begin() + std::ptrdiff_t(std::min(_ranking.size(), _source_pool.size()));
+	std::nth_element(_ranking.begin(), real_end, _ranking.end(), [](audio_voice* a, audio_voice* b) { return _ranks_higher(*a, *b); });
+
+	// free the sources first, so they can be given to the others
+	for (auto iter = real_end; iter != _ranking.end(); iter++) {
+		if ((*iter)->source) {
+			_virtualize(**iter);
+		}
+	}
+
+	for (auto iter = _ranking.begin(); iter != real_end; iter++) {
+		if (!(*iter)->source) {
+			_realize(**iter);
+		}
+	}
+}
+
+float AudioManager::_audibility(const audio_voice& voice) const {
+	// the attenuation of the default distance model of OpenAL (inverse
+	// distance clamped, with a reference distance and rolloff factor of 1)
+	float distance = glm::distance(voice.position, _listener.GetPosition());
+	return voice.gain * _listener.GetGain() / std::max(distance, 1.0f);
+}
+
+void AudioManager::_realize(audio_voice& voice) {
+	voice.source = _free_sources.back();
+	_free_sources.pop_back();
+
+	al::Source& source = *voice.source;
+	source.SetBuffer(voice.clip->Buffer());
+	source.SetLooping(voice.looping);
+	source.SetGain(voice.gain);
+	source.SetPosition(voice.position);
+	source.SetVelocity(voice.velocity);
+	source.Play();
+
+	// the offset is set after starting, as that always seeks
+	if (voice.time > 0.0f) {
+		source.SetSecondOffset(voice.time);
+	}
+}
+
+void AudioManager::_virtualize(audio_voice& voice) {
+	voice.time = voice.source->GetSecondOffset();
+	_release(voice);
+}
+
+void AudioManager::_release(audio_voice& voice) {
+	if (voice.source) {
+		voice.source->Stop();
+		_free_sources.push_back(voice.source);
+		voice.source = nullptr;
+	}
+}
+
+bool AudioManager::_ranks_higher(const audio_voice& a, const audio_voice& b) {
+	if (a.priority != b.priority) {
+		return a.priority > b.priority;
+	}
+
+	// Voices that have a source are preferred a little, so voices that are
+	// about as loud do not keep taking each other's source.
+	float audibility_a = a.audibility * (a.source ? 1.25f : 1.0f);
+	float audibility_b = b.audibility * (b.source ? 1.25f : 1.0f);
+
+	return audibility_a > audibility_b;
+}
+
+StreamingAudioSource AudioManager::_stream(const std::string& path, bool loop) {
+	// open the file before locking, so the stream thread is not blocked by it
+	auto stream = std::make_shared<AudioStream>(path, loop);
+
+	{
+		std::lock_guard lock(_streams_mutex);
+		_streams.push_back(stream);
+	}
+
+	// fill the first buffers right away
+	_stream_wake.notify_all();
+	return StreamingAudioSource(*this, stream);
+}
+
+void AudioManager::_stream_main() {
+	// wake up a few times per buffer, so a buffer is refilled long before the
+	// source runs out of queued buffers
+	auto interval = std::chrono::duration<float>(AudioStream::buffer_duration / 4.0f);
+
+	std::unique_lock lock(_streams_mutex);
+
+	while (!_stream_stop_requested) {
+		// the streams that have finished release their source and buffers
+		std::erase_if(_streams, [](const auto& stream) {
+			stream->_stream();
+			return stream->IsFinished();
+		});
+
+		_stream_wake.wait_for(lock, interval);
+	}
+}
+
 void AudioManager::_stop_all() {
-	for (const auto& source : _sources) {
-		source->_stop();
+	for (const auto& voice : _voices) {
+		_release(*voice);
+	}
+
+	_voices.clear();
+
+	std::lock_guard lock(_streams_mutex);
+
+	for (const auto& stream : _streams) {
+		stream->_stop();
 	}
 
-	_sources.clear();
+	_streams.clear();
 }
 
 }
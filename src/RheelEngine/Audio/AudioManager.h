@@ -7,46 +7,130 @@
 
 #include <AL/alc.h>
 
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
 #include "AudioSource.h"
+#include "StreamingAudioSource.h"
 #include "OpenAL/Listener.h"
 
 namespace rheel {
 
+/**
+ * Plays sounds with a fixed pool of OpenAL sources. Every played sound is a
+ * voice, but only the most important audible voices get a source: those with
+ * the highest priority, and then the highest gain at the listener. The other
+ * voices are virtual: they are not sampled, but their playback position is
+ * kept up to date, so they continue at the right position when they get a
+ * source again. That way, many sounds can play while only the few that are
+ * heard cost anything.
+ */
 class RE_API AudioManager {
 	RE_NO_MOVE(AudioManager);
 	RE_NO_COPY(AudioManager);
 
 	friend class Game;
+	friend class MainWindow;
 
 public:
+	/**
+	 * The number of OpenAL sources in the pool, which is the maximum number of
+	 * voices that are heard at the same time.
+	 */
+	static constexpr unsigned source_count = 32;
+
+	/**
+	 * Voices with a lower gain at the listener (-60 dB) are virtual.
+	 */
+	static constexpr float audibility_threshold = 0.001f;
+
 	AudioManager();
 	~AudioManager();
 
 	/**
-	 * Plays a sound. The returned AudioSource pointer can be used to control
-	 * the sound.
+	 * Plays a sound at the position, with the gain. The returned AudioSource
+	 * can be used to control the sound. Whether the sound gets a source right
+	 * away depends on the position and gain given here, so pass them here
+	 * instead of setting them on the AudioSource afterwards.
 	 */
-	AudioSource& Play(const Sound& sound);
+	AudioSource Play(const Sound& sound, const vec3& position = vec3(0.0f), float gain = 1.0f);
 
 	/**
-	 * Plays a sound, looping when it reaches the end. The returned AudioSource
-	 * pointer can be used to control the sound.
+	 * Plays a sound at the position, with the gain, looping when it reaches
+	 * the end. The returned AudioSource can be used to control the sound. As
+	 * with Play(), pass the position and gain here instead of setting them
+	 * afterwards.
 	 */
-	AudioSource& Loop(const Sound& sound);
+	AudioSource Loop(const Sound& sound, const vec3& position = vec3(0.0f), float gain = 1.0f);
 
 	/**
-	 * Stops the sound. When calling this method, the audio source is deleted,
-	 * and the pointer is deleted.
+	 * Sets the priority and the maximum number of instances of a sound, for
+	 * the instances that are played after this call.
+	 */
+	void SetSoundSettings(const Sound& sound, const sound_settings& settings);
+
+	/**
+	 * Plays a wave file while streaming it from disk, instead of loading it
+	 * completely. Use this for long sounds like music. The returned
+	 * StreamingAudioSource can be used to control the sound. The stream is
+	 * deleted when it has finished. Throws a runtime_error if the file does
+	 * not exist or is not valid.
+	 */
+	StreamingAudioSource PlayStream(const std::string& path);
+
+	/**
+	 * Plays a wave file while streaming it from disk, looping when it reaches
+	 * the end. The returned StreamingAudioSource can be used to control the
+	 * sound. Throws a runtime_error if the file does not exist or is not
+	 * valid.
+	 */
+	StreamingAudioSource LoopStream(const std::string& path);
+
+	/**
+	 * Stops the sound. After this, the audio source does not control a sound
+	 * anymore.
 	 */
 	void Stop(AudioSource& source);
 
+	/**
+	 * Stops the streamed sound. After this, the streaming audio source does
+	 * not control a sound anymore.
+	 */
+	void Stop(StreamingAudioSource& source);
+
 	/**
 	 * Returns the global audio listener.
 	 */
 	al::Listener& GetListener();
 
+	/**
+	 * Returns the number of voices, virtual or not.
+	 */
+	std::size_t GetVoiceCount() const;
+
+	/**
+	 * Returns the number of voices that have a source.
+	 */
+	std::size_t GetRealVoiceCount() const;
+
 private:
-	const AudioClip& _get_audio_clip(const Sound& sound);
+	AudioClip& _get_audio_clip(const Sound& sound);
+	AudioSource _play(const Sound& sound, bool loop, const vec3& position, float gain);
+
+	// Advances the voices, removes the finished ones, and gives the sources
+	// to the most important voices. Called once per frame on the main thread.
+	void _update(float dt);
+
+	float _audibility(const audio_voice& voice) const;
+	void _realize(audio_voice& voice);
+	void _virtualize(audio_voice& voice);
+	void _release(audio_voice& voice);
+
+	static bool _ranks_higher(const audio_voice& a, const audio_voice& b);
+
+	StreamingAudioSource _stream(const std::string& path, bool loop);
+	void _stream_main();
 	void _stop_all();
 
 	ALCdevice* _device;
@@ -54,9 +138,23 @@ private:
 
 	al::Listener _listener;
 
-	std::vector<std::unique_ptr<AudioSource>> _sources;
 	std::unordered_map<std::uintptr_t, AudioClip> _clip_cache;
 
+	std::vector<al::Source> _source_pool;
+	std::vector<al::Source*> _free_sources;
+	std::vector<std::shared_ptr<audio_voice>> _voices;
+	std::vector<audio_voice*> _ranking;
+
+	// The streamed sounds are refilled on their own thread, so they keep
+	// playing when a frame takes long. OpenAL is thread-safe, so the stream
+	// thread queues the buffers itself, and deletes the streams that have
+	// finished.
+	std::vector<std::shared_ptr<AudioStream>> _streams;
+	std::mutex _streams_mutex;
+	std::condition_variable _stream_wake;
+	bool _stream_stop_requested = false;
+	std::thread _stream_thread;
+
 };
 
 }
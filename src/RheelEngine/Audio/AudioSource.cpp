@@ -7,40 +7,53 @@
 
 namespace rheel {
 
-AudioSource::AudioSource(AudioManager& manager, const AudioClip& clip) :
-		_manager(manager) {
+AudioSource::AudioSource(AudioManager& manager, std::weak_ptr<audio_voice> voice) :
+		_manager(&manager),
+		_voice(std::move(voice)) {}
 
-	_source.SetBuffer(clip.Buffer());
-}
-
-void AudioSource::Play() {
-	_source.SetLooping(false);
-	_source.Play();
+void AudioSource::Stop() {
+	if (auto voice = _voice.lock(); voice) {
+		_manager->Stop(*this);
+	}
 }
 
-void AudioSource::Loop() {
-	_source.SetLooping(true);
-	_source.Play();
+bool AudioSource::IsPlaying() const {
+	return !_voice.expired();
 }
 
-void AudioSource::Stop() {
-	_manager.Stop(*this);
+bool AudioSource::IsVirtual() const {
+	auto voice = _voice.lock();
+	return voice && voice->source == nullptr;
 }
 
 void AudioSource::SetGain(float gain) {
-	_source.SetGain(gain);
+	if (auto voice = _voice.lock(); voice) {
+		voice->gain = glm::clamp(gain, 0.0f, 1.0f);
+
+		if (voice->source) {
+			voice->source->SetGain(voice->gain);
+		}
+	}
 }
 
 void AudioSource::SetPosition(const vec3& position) {
-	_source.SetPosition(position);
+	if (auto voice = _voice.lock(); voice) {
+		voice->position = position;
+
+		if (voice->source) {
+			voice->source->SetPosition(position);
+		}
+	}
 }
 
 void AudioSource::SetVelocity(const vec3& velocity) {
-	_source.SetVelocity(velocity);
-}
+	if (auto voice = _voice.lock(); voice) {
+		voice->velocity = velocity;
 
-void AudioSource::_stop() {
-	_source.Stop();
+		if (voice->source) {
+			voice->source->SetVelocity(velocity);
+		}
+	}
 }
 
 }
@@ -12,20 +12,58 @@ namespace rheel {
 
 class AudioManager;
 
-class RE_API AudioSource {
-	RE_NO_MOVE(AudioSource);
-	RE_NO_COPY(AudioSource);
+/**
+ * A sound that is played by the audio manager. A voice only has an OpenAL
+ * source while it is among the most important audible voices; otherwise it
+ * is virtual, and only its playback position is kept up to date.
+ */
+struct audio_voice {
+	const AudioClip* clip = nullptr;
+	bool looping = false;
+	int priority = 0;
+
+	float gain = 1.0f;
+	vec3 position{ 0.0f, 0.0f, 0.0f };
+	vec3 velocity{ 0.0f, 0.0f, 0.0f };
+
+	// the playback position, in seconds, which is kept up to date while the
+	// voice is virtual
+	float time = 0.0f;
+
+	// the gain at the listener, including the attenuation over distance
+	float audibility = 0.0f;
 
+	// the source from the pool of the audio manager, or null while the voice
+	// is virtual
+	al::Source* source = nullptr;
+};
+
+/**
+ * Controls a sound that is played by the audio manager. When the sound has
+ * finished or was stopped, the methods of the audio source do nothing.
+ */
+class RE_API AudioSource {
 	friend class AudioManager;
 
 public:
-	AudioSource(AudioManager& manager, const AudioClip& clip);
-	~AudioSource() = default;
+	/**
+	 * Creates an audio source that does not control a sound.
+	 */
+	AudioSource() = default;
 
-	void Play();
-	void Loop();
 	void Stop();
 
+	/**
+	 * Returns whether the sound has not finished or was stopped yet.
+	 */
+	bool IsPlaying() const;
+
+	/**
+	 * Returns whether the sound is virtual: it is too quiet, or too many
+	 * sounds with a higher priority are playing, so it is not heard.
+	 */
+	bool IsVirtual() const;
+
 	/**
 	 * Sets the gain of the source. This gain can be in a range of 0 to 1, and
 	 * values outside of this range will be clamped.
@@ -43,10 +81,10 @@ public:
 	void SetVelocity(const vec3& velocity);
 
 private:
-	void _stop();
+	AudioSource(AudioManager& manager, std::weak_ptr<audio_voice> voice);
 
-	AudioManager& _manager;
-	al::Source _source;
+	AudioManager* _manager = nullptr;
+	std::weak_ptr<audio_voice> _voice;
 
 };
 
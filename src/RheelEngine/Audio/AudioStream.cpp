@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) Levi van Rheenen. All rights reserved.
+ */
+#include "AudioStream.h"
+
+#include <cstring>
+
+#include "../Util/VirtualFileSystem.h"
+
+namespace rheel {
+
+AudioStream::AudioStream(const std::string& path, bool loop) :
+		_file(VirtualFileSystem::Open(path)),
+		_wave(WaveLoader::Parse(_file.bytes)),
+		_loop(loop) {
+
+	auto frames = std::max(std::size_t(float(_wave.sample_frequency) * buffer_duration), std::size_t(1));
+	_chunk.resize(frames * _wave.block_align);
+
+	for (const auto& buffer : _buffers) {
+		_free_buffers.push_back(buffer.GetName());
+	}
+}
+
+bool AudioStream::IsFinished() const {
+	return _finished;
+}
+
+void AudioStream::SetGain(float gain) {
+	_source.SetGain(gain);
+}
+
+void AudioStream::SetPosition(const vec3& position) {
+	_source.SetPosition(position);
+}
+
+void AudioStream::SetVelocity(const vec3& velocity) {
+	_source.SetVelocity(velocity);
+}
+
+void AudioStream::_stream() {
+	if (_finished) {
+		return;
+	}
+
+	for (int processed = _source.GetProcessedBuffers(); processed > 0; processed--) {
+		_free_buffers.push_back(_source.UnqueueBuffer());
+	}
+
+	while (!_free_buffers.empty() && !_end_of_stream) {
+		std::size_t size = _decode();
+
+		if (size == 0) {
+			_end_of_stream = true;
+			break;
+		}
+
+		ALuint name = _free_buffers.back();
+		_free_buffers.pop_back();
+
+		auto& buffer = *std::find_if(_buffers.begin(), _buffers.end(), [name](const al::Buffer& b) { return b.GetName() == name; });
+		buffer.SetData(ALenum(_wave.format), _chunk.data(), ALsizei(size), _wave.sample_frequency);
+		_source.QueueBuffer(buffer);
+	}
+
+	// Start playing, or continue after the source ran out of buffers because
+	// the stream thread was too late.
+	if (!_source.IsPlaying()) {
+		if (_source.GetQueuedBuffers() > 0) {
+			_source.Play();
+		} else if (_end_of_stream) {
+			_finished = true;
+		}
+	}
+}
+
+void AudioStream::_stop() {
+	_source.Stop();
+}
+
+std::size_t AudioStream::_decode() {
+	// the samples are PCM, so decoding them is a copy out of the mapped file
+	std::size_t size = 0;
+
+	while (size < _chunk.size()) {
+		if (_position == _wave.samples.size()) {
+			if (!_loop || _wave.samples.empty()) {
+				break;
+			}
+
+			_position = 0;
+		}
+
+		std::size_t count = std::min(_chunk.size() - size, _wave.samples.size() - _position);
+		std::memcpy(_chunk.data() + size, _wave.samples.data() + _position, count);
+
+		size += count;
+		_position += count;
+	}
+
+	return size;
+}
+
+}
@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) Levi van Rheenen. All rights reserved.
+ */
+#ifndef RHEELENGINE_AUDIOSTREAM_H
+#define RHEELENGINE_AUDIOSTREAM_H
+#include "../_common.h"
+
+#include "OpenAL/Source.h"
+#include "../Assets/Loaders/WaveLoader.h"
+#include "../Util/PackFile.h"
+
+namespace rheel {
+
+/**
+ * Plays a wave file without loading it completely, for long sounds like music
+ * and ambience. The file is memory-mapped, and the stream thread of the audio
+ * manager decodes it a small chunk at a time into a ring of buffers, which are
+ * queued on the source. Only the queued chunks take memory.
+ *
+ * Streams are owned by the audio manager, which deletes them when they have
+ * finished. A StreamingAudioSource controls a stream.
+ */
+class RE_API AudioStream {
+	RE_NO_MOVE(AudioStream);
+	RE_NO_COPY(AudioStream);
+
+	friend class AudioManager;
+
+public:
+	/**
+	 * The number of buffers in the ring, and the duration of the sound in
+	 * each buffer, in seconds.
+	 */
+	static constexpr unsigned buffer_count = 4;
+	static constexpr float buffer_duration = 0.25f;
+
+	/**
+	 * Opens the wave file. Throws a runtime_error if the file does not exist
+	 * or is not valid.
+	 */
+	AudioStream(const std::string& path, bool loop);
+	~AudioStream() = default;
+
+	/**
+	 * Returns whether the end of the stream has been played. Looping streams
+	 * never finish.
+	 */
+	bool IsFinished() const;
+
+	/**
+	 * Sets the gain of the source. This gain can be in a range of 0 to 1, and
+	 * values outside of this range will be clamped.
+	 */
+	void SetGain(float gain);
+
+	/**
+	 * Sets the position of the source
+	 */
+	void SetPosition(const vec3& position);
+
+	/**
+	 * Sets the velocity of the source
+	 */
+	void SetVelocity(const vec3& velocity);
+
+private:
+	// refills and queues the processed buffers; called on the stream thread
+	void _stream();
+	void _stop();
+
+	// decodes the next chunk of the file into _chunk, and returns its size
+	std::size_t _decode();
+
+	virtual_file _file;
+	wave_data _wave;
+	bool _loop;
+	std::size_t _position = 0;
+	bool _end_of_stream = false;
+	std::atomic_bool _finished = false;
+
+	std::vector<std::byte> _chunk;
+
+	al::Source _source;
+	std::array<al::Buffer, buffer_count> _buffers;
+	std::vector<ALuint> _free_buffers;
+
+};
+
+}
+
+#endif
@@ -6,13 +6,23 @@
 namespace rheel::al {
 
 void Listener::SetGain(float gain) {
+	_gain = gain;
 	alListenerf(AL_GAIN, gain);
 }
 
+float Listener::GetGain() const {
+	return _gain;
+}
+
 void Listener::SetPosition(const vec3& position) {
+	_position = position;
 	alListener3f(AL_POSITION, position.x, position.y, position.z);
 }
 
+const vec3& Listener::GetPosition() const {
+	return _position;
+}
+
 void Listener::SetVelocity(const vec3& velocity) {
 	alListener3f(AL_VELOCITY, velocity.x, velocity.y, velocity.z);
 }
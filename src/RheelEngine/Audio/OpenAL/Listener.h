@@ -27,11 +27,21 @@ public:
 	 */
 	void SetGain(float gain);
 
+	/**
+	 * Returns the gain of the OpenAL listener.
+	 */
+	float GetGain() const;
+
 	/**
 	 * Sets the position of the OpenAL listener
 	 */
 	void SetPosition(const vec3& position);
 
+	/**
+	 * Returns the position of the OpenAL listener
+	 */
+	const vec3& GetPosition() const;
+
 	/**
 	 * Sets the velocity of the OpenAL listener
 	 */
@@ -52,6 +62,9 @@ public:
 private:
 	Listener() = default;
 
+	float _gain = 1.0f;
+	vec3 _position{ 0.0f, 0.0f, 0.0f };
+
 };
 
 }
@@ -43,4 +43,43 @@ void Source::Stop() {
 	alSourceStop(*_handle);
 }
 
+bool Source::IsPlaying() const {
+	ALint state;
+	alGetSourcei(*_handle, AL_SOURCE_STATE, &state);
+	return state == AL_PLAYING;
+}
+
+float Source::GetSecondOffset() const {
+	ALfloat offset;
+	alGetSourcef(*_handle, AL_SEC_OFFSET, &offset);
+	return offset;
+}
+
+void Source::SetSecondOffset(float offset) {
+	alSourcef(*_handle, AL_SEC_OFFSET, offset);
+}
+
+void Source::QueueBuffer(const Buffer& buffer) {
+	ALuint name = buffer.GetName();
+	alSourceQueueBuffers(*_handle, 1, &name);
+}
+
+ALuint Source::UnqueueBuffer() {
+	ALuint name;
+	alSourceUnqueueBuffers(*_handle, 1, &name);
+	return name;
+}
+
+int Source::GetProcessedBuffers() const {
+	ALint processed;
+	alGetSourcei(*_handle, AL_BUFFERS_PROCESSED, &processed);
+	return processed;
+}
+
+int Source::GetQueuedBuffers() const {
+	ALint queued;
+	alGetSourcei(*_handle, AL_BUFFERS_QUEUED, &queued);
+	return queued;
+}
+
 }
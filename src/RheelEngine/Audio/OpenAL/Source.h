@@ -49,6 +49,44 @@ public:
 	 */
 	void Stop();
 
+	/**
+	 * Returns whether the source is playing.
+	 */
+	bool IsPlaying() const;
+
+	/**
+	 * Returns the playback position in the buffer of the source, in seconds.
+	 */
+	float GetSecondOffset() const;
+
+	/**
+	 * Sets the playback position in the buffer of the source, in seconds.
+	 */
+	void SetSecondOffset(float offset);
+
+	/**
+	 * Adds the buffer to the end of the buffer queue of the source. The source
+	 * plays the queued buffers one after the other.
+	 */
+	void QueueBuffer(const Buffer& buffer);
+
+	/**
+	 * Removes the first buffer from the buffer queue of the source, and
+	 * returns its name. The buffer must be processed.
+	 */
+	ALuint UnqueueBuffer();
+
+	/**
+	 * Returns the number of queued buffers that the source has finished
+	 * playing.
+	 */
+	int GetProcessedBuffers() const;
+
+	/**
+	 * Returns the number of buffers in the buffer queue of the source.
+	 */
+	int GetQueuedBuffers() const;
+
 private:
 	std::shared_ptr<ALuint> _handle;
 
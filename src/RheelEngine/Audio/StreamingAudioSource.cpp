@@ -0,0 +1,43 @@
+/*
+ * Copyright (c) Levi van Rheenen. All rights reserved.
+ */
+#include "StreamingAudioSource.h"
+
+#include "AudioManager.h"
+
+namespace rheel {
+
+StreamingAudioSource::StreamingAudioSource(AudioManager& manager, std::weak_ptr<AudioStream> stream) :
+		_manager(&manager),
+		_stream(std::move(stream)) {}
+
+void StreamingAudioSource::Stop() {
+	if (auto stream = _stream.lock(); stream) {
+		_manager->Stop(*this);
+	}
+}
+
+bool StreamingAudioSource::IsPlaying() const {
+	auto stream = _stream.lock();
+	return stream && !stream->IsFinished();
+}
+
+void StreamingAudioSource::SetGain(float gain) {
+	if (auto stream = _stream.lock(); stream) {
+		stream->SetGain(gain);
+	}
+}
+
+void StreamingAudioSource::SetPosition(const vec3& position) {
+	if (auto stream = _stream.lock(); stream) {
+		stream->SetPosition(position);
+	}
+}
+
+void StreamingAudioSource::SetVelocity(const vec3& velocity) {
+	if (auto stream = _stream.lock(); stream) {
+		stream->SetVelocity(velocity);
+	}
+}
+
+}
@@ -0,0 +1,62 @@
+/*
+ * Copyright (c) Levi van Rheenen. All rights reserved.
+ */
+#ifndef RHEELENGINE_STREAMINGAUDIOSOURCE_H
+#define RHEELENGINE_STREAMINGAUDIOSOURCE_H
+#include "../_common.h"
+
+#include "AudioStream.h"
+
+namespace rheel {
+
+class AudioManager;
+
+/**
+ * Controls a sound that is streamed by the audio manager. When the sound has
+ * finished or was stopped, the methods of the streaming audio source do
+ * nothing.
+ */
+class RE_API StreamingAudioSource {
+	friend class AudioManager;
+
+public:
+	/**
+	 * Creates a streaming audio source that does not control a sound.
+	 */
+	StreamingAudioSource() = default;
+
+	void Stop();
+
+	/**
+	 * Returns whether the sound has not finished or was stopped yet. Looping
+	 * sounds only stop when they are stopped.
+	 */
+	bool IsPlaying() const;
+
+	/**
+	 * Sets the gain of the source. This gain can be in a range of 0 to 1, and
+	 * values outside of this range will be clamped.
+	 */
+	void SetGain(float gain);
+
+	/**
+	 * Sets the position of the source
+	 */
+	void SetPosition(const vec3& position);
+
+	/**
+	 * Sets the velocity of the source
+	 */
+	void SetVelocity(const vec3& velocity);
+
+private:
+	StreamingAudioSource(AudioManager& manager, std::weak_ptr<AudioStream> stream);
+
+	AudioManager* _manager = nullptr;
+	std::weak_ptr<AudioStream> _stream;
+
+};
+
+}
+
+#endif
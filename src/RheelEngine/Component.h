@@ -46,7 +46,9 @@ public:
 	Component& operator=(Component&& c) noexcept;
 
 	/**
-	 * Called in the update cycle.
+	 * Called in the update cycle. In the pipelined frame mode, this is called
+	 * on a worker thread, concurrently with rendering. See
+	 * MainWindow::FrameMode::PIPELINED for what is allowed in that case.
 	 */
 	virtual void Update() {}
 
@@ -3,9 +3,54 @@
  */
 #include "VoxelRenderComponent.h"
 
+#include "../Registry/Registry.h"
+#include "../Scene.h"
+
 namespace rheel {
 
 VoxelRenderComponent::VoxelRenderComponent(VoxelImage model) :
 		_model(std::move(model)) {}
 
-}
\ No newline at end of file
+const VoxelImage& VoxelRenderComponent::GetImage() const {
+	return _model;
+}
+
+void VoxelRenderComponent::Set(unsigned x, unsigned y, unsigned z, const Color& color) {
+	_model.Set(x, y, z, color);
+
+	if (_renderer) {
+		_renderer->Invalidate(x, y, z);
+	}
+}
+
+void VoxelRenderComponent::SetIndex(unsigned x, unsigned y, unsigned z, std::uint8_t index) {
+	_model.SetIndex(x, y, z, index);
+
+	if (_renderer) {
+		_renderer->Invalidate(x, y, z);
+	}
+}
+
+void VoxelRenderComponent::OnActivate() {
+	auto& scene = GetEntity().GetScene();
+	auto& scene_render_manager = scene.GetGame().GetRenderer().GetSceneRenderManager(&scene);
+
+	_renderer = std::make_unique<VoxelRenderer>(scene_render_manager, _model);
+	_matrix.reset();
+}
+
+void VoxelRenderComponent::OnDeactivate() {
+	_renderer.reset();
+}
+
+void VoxelRenderComponent::Update() {
+	// setting the matrix updates every chunk, so only do it when it changed
+	mat4 matrix = GetEntity().AbsoluteTransform().AsMatrix();
+
+	if (!_matrix || *_matrix != matrix) {
+		_renderer->SetMatrix(matrix);
+		_matrix = matrix;
+	}
+}
+
+}
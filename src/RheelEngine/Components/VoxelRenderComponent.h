@@ -5,11 +5,17 @@
 #define RHEELENGINE_VOXELRENDERCOMPONENT_H
 #include "../_common.h"
 
+#include <optional>
+
 #include "../Component.h"
 #include "../Assets/VoxelImage.h"
+#include "../Renderer/VoxelRenderer.h"
 
 namespace rheel {
 
+/**
+ * A component that renders a VoxelImage
+ */
 class RE_API VoxelRenderComponent : public Component {
 
 public:
@@ -19,8 +25,35 @@ public:
 
 	explicit VoxelRenderComponent(VoxelImage model);
 
+	/**
+	 * Returns the rendered voxel image.
+	 */
+	const VoxelImage& GetImage() const;
+
+	/**
+	 * Sets the color of a voxel in the image, which is shared with all other
+	 * copies of the image. Only the chunks around the voxel are meshed again.
+	 */
+	void Set(unsigned x, unsigned y, unsigned z, const Color& color);
+
+	/**
+	 * Sets the palette index of a voxel in the image, which is shared with
+	 * all other copies of the image. Only the chunks around the voxel are
+	 * meshed again.
+	 */
+	void SetIndex(unsigned x, unsigned y, unsigned z, std::uint8_t index);
+
+protected:
+	void OnActivate() override;
+	void OnDeactivate() override;
+	void Update() override;
+
 private:
 	VoxelImage _model;
+	std::unique_ptr<VoxelRenderer> _renderer;
+
+	// the matrix that was last set on the renderer
+	std::optional<mat4> _matrix;
 
 };
 
@@ -5,6 +5,7 @@
 
 #include "Scene.h"
 #include "UI/UI.h"
+#include "Util/CacheStatistics.h"
 
 namespace rheel {
 
@@ -34,12 +35,18 @@ Game::Game(DisplayConfiguration display_configuration, const std::string& window
 
 	// spool up the thread pool
 	_thread_pool = new ThreadPool(*_window);
+	_asset_loader._set_thread_pool(_thread_pool);
 
 	// show the window
 	_window->SetVisible(true);
 }
 
 Game::~Game() {
+	// report how the caches were used during the game
+	if constexpr (CacheStatistics::enabled) {
+		CacheStatistics::Dump();
+	}
+
 	// stop all sounds
 	_audio_manager->_stop_all();
 
@@ -50,7 +57,11 @@ Game::~Game() {
 	// delete the current active scene
 	SetActiveScene(nullptr);
 
+	// stop watching for changed assets
+	_hot_reloader = nullptr;
+
 	// stop the thread pool
+	_asset_loader._set_thread_pool(nullptr);
 	delete _thread_pool;
 
 	// destroy the window and its contents
@@ -115,6 +126,15 @@ std::future<void> Game::PreloadTexture(const Image& image, ImageTexture::WrapTyp
 	});
 }
 
+void Game::EnableHotReload(const std::string& directory) {
+	_hot_reloader = nullptr;
+	_hot_reloader = std::make_unique<HotReloader>(*this, directory);
+}
+
+void Game::DisableHotReload() {
+	_hot_reloader = nullptr;
+}
+
 void Game::RunAfterCurrentFrame(std::function<void()> f) {
 	_window->RunAfterCurrentFrame(std::move(f));
 }
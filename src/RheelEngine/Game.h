@@ -7,6 +7,7 @@
 
 #include "ThreadPool.h"
 #include "Assets/AssetLoader.h"
+#include "Assets/HotReloader.h"
 #include "Audio/AudioManager.h"
 #include "Renderer/GameRenderer.h"
 #include "Renderer/ImageTexture.h"
@@ -107,12 +108,34 @@ public:
 	 */
 	std::future<void> PreloadTexture(const Image& image, ImageTexture::WrapType type = ImageTexture::WrapType::WRAP, bool linear = true);
 
+	/**
+	 * Starts reloading assets when their files in the directory change, so
+	 * changes show up without restarting the game. Only one directory can be
+	 * watched at a time.
+	 *
+	 * @see HotReloader
+	 */
+	void EnableHotReload(const std::string& directory);
+
+	/**
+	 * Stops reloading assets when their files change.
+	 */
+	void DisableHotReload();
+
 	/**
 	 * Runs the function `f` after the current frame has completely finished
 	 * updating and rendering.
 	 */
 	void RunAfterCurrentFrame(std::function<void()> f);
 
+	/**
+	 * Returns an awaitable which, when awaited in an AsyncTask, continues the
+	 * coroutine on the main thread at the start of the next frame.
+	 */
+	auto NextFrame() {
+		return _window->NextFrame();
+	}
+
 private:
 	void _loop();
 
@@ -124,6 +147,7 @@ private:
 
 	AssetLoader _asset_loader;
 	ThreadPool* _thread_pool = nullptr;
+	std::unique_ptr<HotReloader> _hot_reloader;
 
 	ScenePointer _active_scene = nullptr;
 
@@ -9,16 +9,19 @@
 namespace rheel {
 
 CustomShaderModelRenderer::CustomShaderModelRenderer(const Model& model, const Shader& shader) :
-		_vertex_buffer_object(gl::Buffer::Target::ARRAY),
-		_object_data_buffer(gl::Buffer::Target::ARRAY),
-		_shader(_get_compiled_shader(shader)) {
+		_model(model),
+		_shader_asset(shader) {}
 
-	_vertex_buffer_object.SetData(model.GetVertices());
-	_object_data_buffer.SetData(std::vector<ModelRenderer::ObjectData>());
+void CustomShaderModelRenderer::Upload() {
+	if (_buffers) {
+		return;
+	}
+
+	_shader = &_get_compiled_shader(*_shader_asset);
+	_buffers = ModelRenderer::_create_buffers(*_model, _get_indices(*_model));
 
-	_vao.SetVertexAttributes<vec3, vec3, vec2>(_vertex_buffer_object);
-	_vao.SetVertexIndices(model.GetIndices());
-	_vao.SetVertexAttributes<mat4, mat4, vec4, vec4>(_object_data_buffer, sizeof(ModelRenderer::ObjectData), 1);
+	_model.reset();
+	_shader_asset.reset();
 }
 
 ModelRenderer::ObjectDataPtr CustomShaderModelRenderer::AddObject() {
@@ -35,59 +38,93 @@ void CustomShaderModelRenderer::RemoveObject(ModelRenderer::ObjectDataPtr&& obje
 	_objects.erase(_objects.begin() + index);
 }
 
+void CustomShaderModelRenderer::SetModel(const Model& model) {
+	if (!_buffers) {
+		_model = model;
+		return;
+	}
+
+	gl::ContextScope cs;
+
+	ModelRenderer::_set_vertices(_buffers->vertex_buffer_object, _buffers->decoding_buffer, model);
+	_buffers->index_size = ModelRenderer::_set_indices(_buffers->vao, _get_indices(model), model.GetVertices().size());
+}
+
+void CustomShaderModelRenderer::Snapshot() {
+	ModelRenderer::_snapshot(_objects, _render_objects);
+}
+
 void CustomShaderModelRenderer::RenderToShadowMap() const {
-	_vao.Bind();
+	_buffers->vao.Bind();
 
-	_object_data_buffer.SetData(_objects, gl::Buffer::Usage::STREAM_DRAW);
-	_vao.DrawElements(gl::VertexArray::Mode::TRIANGLES, _objects.size());
+	_buffers->object_data_buffer.SetData(_render_objects, gl::Buffer::Usage::STREAM_DRAW);
+	_buffers->vao.DrawElements(gl::VertexArray::Mode::TRIANGLES, _render_objects.size());
 }
 
 void CustomShaderModelRenderer::RenderObjects() const {
-	_shader.Use();
-	_vao.Bind();
+	_shader->Use();
+	_buffers->vao.Bind();
 
-	_object_data_buffer.SetData(_objects, gl::Buffer::Usage::STREAM_DRAW);
-	_vao.DrawElements(gl::VertexArray::Mode::TRIANGLES, _objects.size());
+	_buffers->object_data_buffer.SetData(_render_objects, gl::Buffer::Usage::STREAM_DRAW);
+	_buffers->vao.DrawElements(gl::VertexArray::Mode::TRIANGLES, _render_objects.size());
 }
 
 gl::Program& CustomShaderModelRenderer::GetShaderProgram() {
-	return _shader;
+	return *_shader;
+}
+
+std::span<const unsigned> CustomShaderModelRenderer::_get_indices(const Model& model) {
+	// custom shaders always render the full detail of the model
+	model_lod lod = ModelRenderer::_get_lods(model)[0];
+	return model.GetIndices().subspan(lod.first_index, lod.index_count);
 }
 
 gl::Program& CustomShaderModelRenderer::_get_compiled_shader(const Shader& shader) {
-	auto address = shader.GetAddress();
+	return _shader_cache->cache.Get(shader.GetAddress(), [shader](std::uintptr_t) {
+		return _compile_shader(shader);
+	});
+}
 
-	return _shader_cache->cache.Get(address, [shader](std::uintptr_t) {
-		gl::ContextScope cs;
+void CustomShaderModelRenderer::ReloadShader(const Shader& shader) {
+	// the shader cache only exists while there are renderers
+	pseudo_static_pointer<shader_cache> shader_cache;
 
-		std::string shader_source = EngineResources::PreprocessShader("Shaders_modelshader_custom_header_frag_glsl");
-		shader_source += "\n\n";
-		shader_source += "#line 1\n";
-		shader_source += shader.GetSource();
+	if (shader_cache->cache.ContainsKey(shader.GetAddress())) {
+		gl::Program program = _compile_shader(shader);
+		shader_cache->cache.Get(shader.GetAddress()) = std::move(program);
+	}
+}
 
-		gl::Program shader_program;
-		shader_program.AttachShader(gl::Shader::ShaderType::VERTEX, EngineResources::PreprocessShader("Shaders_modelshader_vert_glsl"));
-		shader_program.AttachShader(gl::Shader::ShaderType::FRAGMENT, shader_source);
-		shader_program.Link();
+gl::Program CustomShaderModelRenderer::_compile_shader(const Shader& shader) {
+	gl::ContextScope cs;
 
-		if (shader_program.HasUniform("_shadowMap0")) {
-			shader_program["_shadowMap0"] = 3;
-		}
+	std::string shader_source = EngineResources::PreprocessShader("Shaders_modelshader_custom_header_frag_glsl");
+	shader_source += "\n\n";
+	shader_source += "#line 1\n";
+	shader_source += shader.GetSource();
 
-		if (shader_program.HasUniform("_shadowMap1")) {
-			shader_program["_shadowMap1"] = 4;
-		}
+	gl::Program shader_program;
+	shader_program.AttachShader(gl::Shader::ShaderType::VERTEX, EngineResources::PreprocessShader("Shaders_modelshader_vert_glsl"));
+	shader_program.AttachShader(gl::Shader::ShaderType::FRAGMENT, shader_source);
+	shader_program.Link();
 
-		if (shader_program.HasUniform("_shadowMap2")) {
-			shader_program["_shadowMap2"] = 5;
-		}
+	if (shader_program.HasUniform("_shadowMap0")) {
+		shader_program["_shadowMap0"] = 3;
+	}
 
-		if (shader_program.HasUniform("_shadowMap3")) {
-			shader_program["_shadowMap3"] = 6;
-		}
+	if (shader_program.HasUniform("_shadowMap1")) {
+		shader_program["_shadowMap1"] = 4;
+	}
 
-		return shader_program;
-	});
+	if (shader_program.HasUniform("_shadowMap2")) {
+		shader_program["_shadowMap2"] = 5;
+	}
+
+	if (shader_program.HasUniform("_shadowMap3")) {
+		shader_program["_shadowMap3"] = 6;
+	}
+
+	return shader_program;
 }
 
-}
\ No newline at end of file
+}
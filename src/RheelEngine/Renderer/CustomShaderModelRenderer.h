@@ -19,12 +19,40 @@ class RE_API CustomShaderModelRenderer {
 	pseudo_static_pointer<shader_cache> _shader_cache;
 
 public:
+	/**
+	 * Creates a renderer for the model with the shader. This does not use
+	 * OpenGL, so it can be done on any thread. The renderer must be uploaded
+	 * before it can render.
+	 *
+	 * @see ModelRenderer::ModelRenderer(const Model&)
+	 */
 	CustomShaderModelRenderer(const Model& model, const Shader& shader);
 
+	/**
+	 * Compiles the shader, if it was not compiled yet, creates the OpenGL
+	 * objects of this renderer, and uploads the vertices and indices of the
+	 * model. Does nothing if the renderer was already uploaded.
+	 */
+	void Upload();
+
+	/**
+	 * Uploads the vertices and indices of the model again, keeping all
+	 * objects. Used when the contents of the model were replaced in place. If
+	 * the renderer was not yet uploaded, the model is uploaded on Upload().
+	 */
+	void SetModel(const Model& model);
+
 	ModelRenderer::ObjectDataPtr AddObject();
 
 	void RemoveObject(ModelRenderer::ObjectDataPtr&& object);
 
+	/**
+	 * Copies the current object data to the render state.
+	 *
+	 * @see ModelRenderer::Snapshot()
+	 */
+	void Snapshot();
+
 	void RenderToShadowMap() const;
 
 	void RenderObjects() const;
@@ -32,17 +60,33 @@ public:
 	gl::Program& GetShaderProgram();
 
 private:
-	gl::VertexArray _vao;
-	gl::Buffer _vertex_buffer_object;
-	mutable gl::Buffer _object_data_buffer;
+	// the model and shader to upload, until the renderer is uploaded
+	std::optional<Model> _model;
+	std::optional<Shader> _shader_asset;
 
-	gl::Program& _shader;
+	std::unique_ptr<ModelRenderer::model_buffers> _buffers;
+	gl::Program* _shader = nullptr;
 
 	ModelRenderer::ObjectDataVector _objects;
+	ModelRenderer::InstanceDataVector _render_objects;
 
 private:
+	static std::span<const unsigned> _get_indices(const Model& model);
+
 	gl::Program& _get_compiled_shader(const Shader& shader);
 
+public:
+	/**
+	 * Compiles the shader again, if it was compiled before, and replaces the
+	 * program that the renderers for the shader use. Used when the contents
+	 * of the shader were replaced in place. If the new source does not
+	 * compile, the old program is kept.
+	 */
+	static void ReloadShader(const Shader& shader);
+
+private:
+	static gl::Program _compile_shader(const Shader& shader);
+
 };
 
 }
@@ -31,6 +31,10 @@ public:
 	bool enable_mipmaps = false;
 	float anisotropic_level = 1.0f;
 
+	// store model vertices in 16 instead of 32 bytes, at a small loss of
+	// precision
+	bool compress_vertices = false;
+
 private:
 	void _calculate_actual_resolution();
 	void _clamp_anisotropic_level();
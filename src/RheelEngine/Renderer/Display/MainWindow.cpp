@@ -3,6 +3,7 @@
  */
 #include "MainWindow.h"
 
+#include <chrono>
 #include <sstream>
 
 #include "../../Game.h"
@@ -83,6 +84,17 @@ MainWindow::MainWindow(DisplayConfiguration& configuration, const std::string& t
 
 MainWindow::~MainWindow() {
 	Log::Info() << "Closing Window" << std::endl;
+
+	// stop the simulation thread, if it was started
+	if (_simulation_thread.joinable()) {
+		{
+			std::lock_guard lock(_simulation_mutex);
+			_simulation_stop = true;
+		}
+
+		_simulation_wait.notify_all();
+		_simulation_thread.join();
+	}
 }
 
 void MainWindow::Loop() {
@@ -105,22 +117,26 @@ void MainWindow::Loop() {
 		time = new_time;
 
 		// run UI thread tasks
-		{
-			std::lock_guard lock(_mutex);
-			while (!_task_queue.empty()) {
-				auto task = std::move(_task_queue.front());
-				_task_queue.pop();
-
-				GetContext().Push();
-				task->operator()();
-				GetContext().Pop();
-			}
-		}
+		_run_tasks();
 
 		// update the scene
+		SceneRenderManager* simulating = nullptr;
+
 		if (auto scene = _game.GetActiveScene(); scene) {
-			scene->Update(time, dt);
-			_game.GetRenderer().GetSceneRenderManager(scene).Update();
+			auto& scene_render_manager = _game.GetRenderer().GetSceneRenderManager(scene);
+
+			if (_frame_mode == FrameMode::PIPELINED) {
+				// take a snapshot of the last simulated state, and simulate the
+				// next frame while this one renders
+				scene_render_manager.Update();
+				scene_render_manager.SetSimulationRunning(true);
+				simulating = &scene_render_manager;
+
+				_start_simulation([scene, time, dt]() { scene->Update(time, dt); });
+			} else {
+				scene->Update(time, dt);
+				scene_render_manager.Update();
+			}
 		}
 
 		// initialize OpenGL state
@@ -130,6 +146,13 @@ void MainWindow::Loop() {
 		// draw the game
 		_game.GetUI().Draw(time, dt);
 
+		// the simulation must be finished before anything else can touch the
+		// scene
+		if (simulating) {
+			_wait_for_simulation();
+			simulating->SetSimulationRunning(false);
+		}
+
 		// perform the after-frame queue
 		for (const auto& f : after_frame_queue) {
 			f();
@@ -137,6 +160,9 @@ void MainWindow::Loop() {
 
 		after_frame_queue.clear();
 
+		// let the audio manager give its sources to the most important sounds
+		_game.GetAudioManager()._update(dt);
+
 		// finish the update/render cycle
 		GetContext().Pop();
 
@@ -150,6 +176,26 @@ void MainWindow::Loop() {
 	}
 }
 
+void MainWindow::SetFrameMode(FrameMode mode) {
+	_frame_mode = mode;
+}
+
+MainWindow::FrameMode MainWindow::GetFrameMode() const {
+	return _frame_mode;
+}
+
+void MainWindow::SetTaskTimeBudget(float milliseconds) {
+	_task_time_budget = milliseconds;
+}
+
+float MainWindow::GetTaskTimeBudget() const {
+	return _task_time_budget;
+}
+
+const task_queue_metrics& MainWindow::GetTaskQueueMetrics() const {
+	return _task_queue_metrics;
+}
+
 void MainWindow::SetInputMode(int mode, int value) const {
 	glfwSetInputMode(handle, mode, value);
 }
@@ -161,6 +207,96 @@ vec2 MainWindow::GetMousePosition() const {
 	return vec2{ x, y };
 }
 
+void MainWindow::_run_tasks() {
+	using clock = std::chrono::steady_clock;
+	using duration = std::chrono::duration<float, std::milli>;
+
+	// Only run the tasks that were queued before this frame started. Tasks
+	// queued by the tasks themselves (e.g. coroutines awaiting NextFrame())
+	// will run next frame.
+	std::size_t available = _task_queue.GetSize();
+	std::size_t executed = 0;
+
+	auto start = clock::now();
+	float elapsed = 0.0f;
+
+	if (available > 0) {
+		GetContext().Push();
+
+		while (executed < available) {
+			auto task = _task_queue.Pop();
+
+			if (!task) {
+				break;
+			}
+
+			(*task)->operator()();
+			executed++;
+
+			elapsed = duration(clock::now() - start).count();
+			if (elapsed >= _task_time_budget) {
+				break;
+			}
+		}
+
+		GetContext().Pop();
+	}
+
+	_task_queue_metrics.queue_depth = _task_queue.GetSize();
+	_task_queue_metrics.tasks_executed = executed;
+	_task_queue_metrics.drain_time = elapsed;
+}
+
+void MainWindow::_start_simulation(std::function<void()> simulation) {
+	if (!_simulation_thread.joinable()) {
+		_simulation_thread = std::thread(&MainWindow::_simulation_main, this);
+	}
+
+	{
+		std::lock_guard lock(_simulation_mutex);
+		_simulation = std::move(simulation);
+	}
+
+	_simulation_wait.notify_all();
+}
+
+void MainWindow::_wait_for_simulation() {
+	std::unique_lock lock(_simulation_mutex);
+	_simulation_wait.wait(lock, [this]() { return !_simulation; });
+
+	// propagate exceptions of the simulation to the main thread
+	if (_simulation_exception) {
+		std::rethrow_exception(std::exchange(_simulation_exception, nullptr));
+	}
+}
+
+void MainWindow::_simulation_main() {
+	std::unique_lock lock(_simulation_mutex);
+
+	while (true) {
+		_simulation_wait.wait(lock, [this]() { return _simulation_stop || _simulation; });
+
+		if (_simulation_stop) {
+			break;
+		}
+
+		// run the simulation without holding the lock
+		lock.unlock();
+
+		try {
+			_simulation();
+		} catch (...) {
+			_simulation_exception = std::current_exception();
+		}
+
+		lock.lock();
+
+		// signal that the simulation has finished
+		_simulation = nullptr;
+		_simulation_wait.notify_all();
+	}
+}
+
 window_hints MainWindow::_create_window_hints(const DisplayConfiguration& configuration) {
 	window_hints hints;
 	hints.visible = false;
@@ -5,20 +5,63 @@
 #define RHEELENGINE_MAINWINDOW_H
 #include "../../_common.h"
 
-#include <queue>
+#include <condition_variable>
+#include <thread>
 
 #include "DisplayConfiguration.h"
 #include "Window.h"
+#include "../../AsyncTask.h"
 #include "../../Task.h"
+#include "../../Util/MpscQueue.h"
 
 namespace rheel {
 
 class Game;
 
+/**
+ * Statistics of the UI thread task queue, as measured in the last frame.
+ */
+struct task_queue_metrics {
+	// the number of tasks still waiting after the last frame
+	std::size_t queue_depth = 0;
+
+	// the number of tasks executed in the last frame
+	std::size_t tasks_executed = 0;
+
+	// the time spent executing tasks in the last frame, in milliseconds
+	float drain_time = 0.0f;
+};
+
 class RE_API MainWindow : public Window {
 	RE_NO_MOVE(MainWindow);
 	RE_NO_COPY(MainWindow);
 
+public:
+	enum class FrameMode {
+		/**
+		 * Each frame, the active scene is first updated, and then rendered.
+		 */
+		SEQUENTIAL,
+
+		/**
+		 * While the main thread renders a frame, the next frame of the active
+		 * scene is simulated on a worker thread. Rendering uses a snapshot of
+		 * the render state (object data, lights, and cameras) which is taken
+		 * at the frame boundary, so what is rendered lags one update behind.
+		 *
+		 * During the simulation (i.e. in Component::Update()), components may
+		 * modify the scene: entities, components, transforms, lights and
+		 * materials. Models and custom shaders that are used for the first
+		 * time in the scene are uploaded at the next frame boundary. The
+		 * components may not use OpenGL or the UI. Such work has to be moved
+		 * to the main thread, with Game::RunAfterCurrentFrame() or by
+		 * awaiting Game::NextFrame(). Input callbacks, main thread tasks, and
+		 * after-frame functions are never run concurrently with the
+		 * simulation.
+		 */
+		PIPELINED
+	};
+
 public:
 	/**
 	 * Creates a window using the given display configuration and title. A
@@ -29,12 +72,27 @@ public:
 
 	void Loop();
 
+	/**
+	 * Sets how the update and render of a frame are scheduled. The change
+	 * takes effect at the next frame.
+	 */
+	void SetFrameMode(FrameMode mode);
+
+	/**
+	 * Returns how the update and render of a frame are scheduled.
+	 */
+	FrameMode GetFrameMode() const;
+
 	void SetInputMode(int mode, int value) const;
 	vec2 GetMousePosition() const;
 
 	/**
-	 * Runs the task on the UI thread at the start of the next frame. Once
+	 * Runs the task on the UI thread at the start of a next frame. Once
 	 * finished, the result will be available in the returned std::future.
+	 *
+	 * Tasks are executed in order, but only for as long as the task time budget
+	 * allows each frame. Tasks that don't fit in the budget are carried over to
+	 * the next frame. This method is thread-safe and never blocks.
 	 */
 	template<typename T>
 	std::future<T> AddTask(Task<T> task) {
@@ -42,20 +100,71 @@ public:
 		auto t = std::make_unique<Task<T>>(std::move(task));
 		std::future<T> future = t->GetFuture();
 
-		{
-			// add the task to the queue
-			std::lock_guard lock(_mutex);
-			_task_queue.push(std::move(t));
-		}
+		// add the task to the queue
+		_task_queue.Push(std::move(t));
 
 		return future;
 	}
 
+	/**
+	 * Sets the maximum time, in milliseconds, spent on executing UI thread
+	 * tasks each frame. At least one task is executed every frame, regardless
+	 * of the budget.
+	 */
+	void SetTaskTimeBudget(float milliseconds);
+
+	/**
+	 * Returns the maximum time, in milliseconds, spent on executing UI thread
+	 * tasks each frame.
+	 */
+	float GetTaskTimeBudget() const;
+
+	/**
+	 * Returns the UI thread task queue statistics of the last frame.
+	 */
+	const task_queue_metrics& GetTaskQueueMetrics() const;
+
+	/**
+	 * Returns an awaitable which, when awaited in an AsyncTask, continues the
+	 * coroutine on the UI thread at the start of the next frame.
+	 */
+	auto NextFrame() {
+		struct awaiter {
+			MainWindow& window;
+
+			bool await_ready() const noexcept {
+				return false;
+			}
+
+			void await_suspend(std::coroutine_handle<> handle) {
+				window.AddTask<void>([handle]() { handle.resume(); });
+			}
+
+			void await_resume() const noexcept {}
+		};
+
+		return awaiter{ *this };
+	}
+
 private:
-	Game& _game;
+	void _run_tasks();
+	void _start_simulation(std::function<void()> simulation);
+	void _wait_for_simulation();
+	void _simulation_main();
 
-	std::queue<std::unique_ptr<TaskBase>> _task_queue;
-	std::mutex _mutex;
+	Game& _game;
+	FrameMode _frame_mode = FrameMode::SEQUENTIAL;
+
+	MpscQueue<std::unique_ptr<TaskBase>> _task_queue;
+	float _task_time_budget = 4.0f;
+	task_queue_metrics _task_queue_metrics;
+
+	std::thread _simulation_thread;
+	std::mutex _simulation_mutex;
+	std::condition_variable _simulation_wait;
+	std::function<void()> _simulation;
+	std::exception_ptr _simulation_exception;
+	bool _simulation_stop = false;
 
 private:
 	static window_hints _create_window_hints(const DisplayConfiguration& configuration);
@@ -19,12 +19,9 @@ ForwardSceneRenderer::ForwardSceneRenderer(SceneRenderManager* manager, ConstEnt
 		SceneRenderer(manager, camera_entity, width, height, sample_count, true) {}
 
 void ForwardSceneRenderer::Render(float dt) {
-	// get the camera
-	const Camera* camera = GetCamera();
-
 	// if no camera with the given name was found: don't render anything
 	// new to the buffer.
-	if (!camera) {
+	if (!EnsurePrepared()) {
 		return;
 	}
 
@@ -50,10 +47,10 @@ void ForwardSceneRenderer::Render(float dt) {
 			gl::Program& model_shader = model_shader_ref;
 
 			GetManager()->InitializeShaderLights(model_shader);
-			model_shader["_cameraMatrix"] = camera->CreateMatrix(Width(), Height());
+			model_shader["_cameraMatrix"] = GetCameraMatrix();
 
 			if (model_shader.HasUniform("_cameraPosition")) {
-				model_shader["_cameraPosition"] = camera->GetEntity().AbsoluteTransform().GetTranslation();
+				model_shader["_cameraPosition"] = GetCameraPosition();
 			}
 		}
 
@@ -105,9 +102,11 @@ void ForwardSceneRenderer::Render(float dt) {
 			_empty_shadow_map->texture.Bind(texture_unit++);
 		}
 
-		// render all the models
+		// render all the models, with a level of detail per object
+		auto lod_view = GetLodView();
+
 		for (const auto&[_, renderer] : GetManager()->RenderMap()) {
-			renderer.RenderObjects();
+			renderer.RenderObjects(lod_view);
 		}
 
 		// render all models with custom shaders
@@ -9,4 +9,16 @@ SceneRenderManager& GameRenderer::GetSceneRenderManager(Scene* scene) {
 	return *_scene_render_managers.Get(scene, [](Scene* s) { return std::make_unique<SceneRenderManager>(s); });
 }
 
+void GameRenderer::ReloadModel(const Model& model) {
+	_scene_render_managers.ForEach([&model](Scene*, std::unique_ptr<SceneRenderManager>& manager) {
+		manager->ReloadModel(model);
+	});
+}
+
+void GameRenderer::ReloadVoxelImage(const VoxelImage& image) {
+	_scene_render_managers.ForEach([&image](Scene*, std::unique_ptr<SceneRenderManager>& manager) {
+		manager->ReloadVoxelImage(image);
+	});
+}
+
 }
\ No newline at end of file
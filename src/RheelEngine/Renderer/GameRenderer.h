@@ -15,6 +15,18 @@ class RE_API GameRenderer {
 public:
 	SceneRenderManager& GetSceneRenderManager(Scene* scene);
 
+	/**
+	 * Uploads the vertices and indices of the model again to its renderers
+	 * in all scenes, after its contents were replaced in place.
+	 */
+	void ReloadModel(const Model& model);
+
+	/**
+	 * Meshes the voxel image again in all scenes, after its contents were
+	 * replaced in place.
+	 */
+	void ReloadVoxelImage(const VoxelImage& image);
+
 private:
 	Cache<Scene*, std::unique_ptr<SceneRenderManager>> _scene_render_managers;
 
@@ -7,7 +7,7 @@
 
 namespace rheel {
 
-Cache<ImageTexture::CacheTuple, ImageTexture, keep_policy, true> ImageTexture::_texture_cache;
+ShardedCache<ImageTexture::CacheTuple, ImageTexture, keep_policy> ImageTexture::_texture_cache;
 
 void ImageTexture::Bind(unsigned texture_unit) const {
 	_texture.Bind(texture_unit);
@@ -46,8 +46,13 @@ ImageTexture::ImageTexture(const Image& image, WrapType type, bool linear) {
 
 	_texture.SetAnisotropyParameter(DisplayConfiguration::Get().anisotropic_level);
 
-	// upload texure data to the GPU
-	_texture.SetData(gl::InternalFormat::RGBA, image.GetWidth(), image.GetHeight(), gl::Format::RGBA, image.GetRawColorData());
+	_upload(image);
+}
+
+void ImageTexture::_upload(const Image& image) {
+	// upload texure data to the GPU in its own format
+	auto[internal_format, format, data_type] = GetUploadFormat(image.GetFormat());
+	_texture.SetData(internal_format, image.GetWidth(), image.GetHeight(), format, data_type, image.GetData().data());
 
 	// generate mipmaps
 	if (DisplayConfiguration::Get().enable_mipmaps) {
@@ -63,4 +68,27 @@ const ImageTexture& ImageTexture::Get(const Image& image, WrapType type, bool li
 	});
 }
 
+void ImageTexture::Reload(const Image& image) {
+	for (auto type : { WrapType::WRAP, WrapType::CLAMP }) {
+		for (bool linear : { false, true }) {
+			auto tuple = std::make_tuple(image.GetAddress(), type, linear);
+
+			if (_texture_cache.ContainsKey(tuple)) {
+				_texture_cache.Get(tuple)._upload(image);
+			}
+		}
+	}
+}
+
+ImageTexture::upload_format ImageTexture::GetUploadFormat(PixelFormat format) {
+	switch (format) {
+		case PixelFormat::RGBA8: return { gl::InternalFormat::RGBA8, gl::Format::RGBA, gl::Type::UNSIGNED_BYTE };
+		case PixelFormat::RG8: return { gl::InternalFormat::RG8, gl::Format::RG, gl::Type::UNSIGNED_BYTE };
+		case PixelFormat::R8: return { gl::InternalFormat::R8, gl::Format::RED, gl::Type::UNSIGNED_BYTE };
+		case PixelFormat::RGBA16F: return { gl::InternalFormat::RGBA16F, gl::Format::RGBA, gl::Type::HALF_FLOAT };
+	}
+
+	abort();
+}
+
 }
@@ -6,7 +6,7 @@
 #include "../_common.h"
 
 #include "../Assets/Image.h"
-#include "../Util/Cache.h"
+#include "../Util/ShardedCache.h"
 #include "OpenGL/Texture2D.h"
 
 namespace rheel {
@@ -18,6 +18,15 @@ public:
 		WRAP, CLAMP
 	};
 
+	/**
+	 * The OpenGL formats to upload the pixels of an image with.
+	 */
+	struct upload_format {
+		gl::InternalFormat internal_format;
+		gl::Format format;
+		gl::Type type;
+	};
+
 private:
 	using CacheTuple = std::tuple<uintptr_t, WrapType, bool>;
 
@@ -27,13 +36,28 @@ public:
 private:
 	ImageTexture(const Image& image, WrapType type, bool linear);
 
+	void _upload(const Image& image);
+
 	gl::Texture2D _texture;
 
 public:
 	static const ImageTexture& Get(const Image& image, WrapType type = WrapType::WRAP, bool linear = true);
 
+	/**
+	 * Uploads the contents of the image again to the textures that were
+	 * created for it, after its contents were replaced in place. Must be
+	 * called on the thread that renders.
+	 */
+	static void Reload(const Image& image);
+
+	/**
+	 * Returns the OpenGL formats to upload an image with the given pixel
+	 * format with, without converting the pixels.
+	 */
+	static upload_format GetUploadFormat(PixelFormat format);
+
 private:
-	static Cache<CacheTuple, ImageTexture, keep_policy, true> _texture_cache;
+	static ShardedCache<CacheTuple, ImageTexture, keep_policy> _texture_cache;
 
 };
 
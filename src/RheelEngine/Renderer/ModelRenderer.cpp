@@ -3,23 +3,20 @@
  */
 #include "ModelRenderer.h"
 
+#include "../Assets/VertexCompression.h"
+#include "Display/DisplayConfiguration.h"
 #include "OpenGL/Context.h"
 
+#include <algorithm>
 #include <array>
+#include <limits>
 
 namespace rheel {
 
-ModelRenderer::ObjectData::ObjectData() :
-		_model_matrix(glm::identity<mat4>()),
-		_normal_model_matrix(glm::identity<mat4>()),
-		_material_vector(0, 0, 0, 0),
-		_material_color(0, 0, 0, 0) {}
+ModelRenderer::ObjectData::ObjectData() = default;
 
 ModelRenderer::ObjectData::ObjectData(ObjectData&& data) noexcept :
-		_model_matrix(data._model_matrix),
-		_normal_model_matrix(data._normal_model_matrix),
-		_material_vector(data._material_vector),
-		_material_color(data._material_color),
+		_instance(data._instance),
 		_ptr(data._ptr) {
 
 	if (_ptr) {
@@ -32,10 +29,7 @@ ModelRenderer::ObjectData& ModelRenderer::ObjectData::operator=(ObjectData&& dat
 		return *this;
 	}
 
-	_model_matrix = data._model_matrix;
-	_normal_model_matrix = data._normal_model_matrix;
-	_material_vector = data._material_vector;
-	_material_color = data._material_color;
+	_instance = data._instance;
 	_ptr = data._ptr;
 
 	if (_ptr) {
@@ -52,16 +46,15 @@ ModelRenderer::ObjectDataPtr::ObjectDataPtr(ObjectData* data) :
 }
 
 void ModelRenderer::ObjectDataPtr::SetMatrix(mat4 matrix) {
-	_data->_model_matrix = matrix;
-	_data->_normal_model_matrix = glm::transpose(glm::inverse(mat3(_data->_model_matrix)));
+	_data->_instance.model_matrix = glm::transpose(mat4x3(matrix));
 }
 
 void ModelRenderer::ObjectDataPtr::SetMaterialVector(vec4 material_vector) {
-	_data->_material_vector = material_vector;
+	_data->_instance.material_vector = material_vector;
 }
 
 void ModelRenderer::ObjectDataPtr::SetMaterialColor(vec4 material_color) {
-	_data->_material_color = material_color;
+	_data->_instance.material_color = material_color;
 }
 
 ModelRenderer::ObjectDataPtr::operator bool() const {
@@ -106,17 +99,33 @@ bool ModelRenderer::material_texture_compare::operator()(const Material& mat_1,
 
 ModelRenderer::ModelRenderer(const Model& model) :
 		_mode(_get_mode(model.GetRenderType())),
-		_vertex_buffer_object(gl::Buffer::Target::ARRAY),
-		_object_data_buffer(gl::Buffer::Target::ARRAY) {
+		_lods(_get_lods(model)),
+		_bounding_radius(_get_bounding_radius(model)),
+		_model(model) {}
 
-	gl::ContextScope cs;
+void ModelRenderer::Upload() {
+	if (_buffers) {
+		return;
+	}
+
+	_buffers = _create_buffers(*_model, _model->GetIndices());
+	_model.reset();
+}
+
+void ModelRenderer::SetModel(const Model& model) {
+	_mode = _get_mode(model.GetRenderType());
+	_lods = _get_lods(model);
+	_bounding_radius = _get_bounding_radius(model);
 
-	_vertex_buffer_object.SetData(model.GetVertices());
-	_object_data_buffer.SetData(std::vector<ObjectData>());
+	if (!_buffers) {
+		_model = model;
+		return;
+	}
+
+	gl::ContextScope cs;
 
-	_vao.SetVertexAttributes<vec3, vec3, vec2>(_vertex_buffer_object);
-	_vao.SetVertexIndices(model.GetIndices());
-	_vao.SetVertexAttributes<mat4, mat4, vec4, vec4>(_object_data_buffer, sizeof(ObjectData), 1);
+	_set_vertices(_buffers->vertex_buffer_object, _buffers->decoding_buffer, model);
+	_buffers->index_size = _set_indices(_buffers->vao, model.GetIndices(), model.GetVertices().size());
 }
 
 ModelRenderer::ObjectDataPtr ModelRenderer::AddObject() {
@@ -135,22 +144,98 @@ void ModelRenderer::RemoveTexturedObject(const Material& material, ObjectDataPtr
 	_remove(_textured_objects[material], std::forward<ObjectDataPtr>(object));
 }
 
+void ModelRenderer::Snapshot() {
+	_snapshot(_objects, _render_objects);
+
+	_render_textured_objects.resize(_textured_objects.size());
+	std::size_t i = 0;
+
+	for (const auto&[material, objects] : _textured_objects) {
+		_render_textured_objects[i].first = material;
+		_snapshot(objects, _render_textured_objects[i].second);
+		i++;
+	}
+}
+
 void ModelRenderer::RenderObjects() const {
+	_render_objects(nullptr);
+}
+
+void ModelRenderer::RenderObjects(const lod_view& view) const {
+	_render_objects(&view);
+}
+
+void ModelRenderer::_render_objects(const lod_view* view) const {
 	gl::Context::Current().ClearTexture(0, gl::Texture::Target::TEXTURE_2D);
 	gl::Context::Current().ClearTexture(1, gl::Texture::Target::TEXTURE_2D);
 	gl::Context::Current().ClearTexture(2, gl::Texture::Target::TEXTURE_2D);
 
-	_object_data_buffer.SetData(_objects, gl::Buffer::Usage::STREAM_DRAW);
-	_vao.DrawElements(_mode, _objects.size());
+	_draw(_render_objects, view);
 
-	for (const auto&[material, objects] : _textured_objects) {
+	for (const auto&[material, objects] : _render_textured_objects) {
 		material.BindTextures();
+		_draw(objects, view);
+	}
+}
+
+void ModelRenderer::_draw(const InstanceDataVector& objects, const lod_view* view) const {
+	if (view == nullptr || _lods.size() == 1) {
+		_draw_lod(0, objects);
+		return;
+	}
+
+	_lod_objects.resize(_lods.size());
+
+	for (auto& lod_objects : _lod_objects) {
+		lod_objects.clear();
+	}
+
+	for (const auto& object : objects) {
+		_lod_objects[_select_lod(object.model_matrix, *view)].push_back(object);
+	}
 
-		_object_data_buffer.SetData(objects, gl::Buffer::Usage::STREAM_DRAW);
-		_vao.DrawElements(_mode, _objects.size());
+	for (std::size_t lod = 0; lod < _lods.size(); lod++) {
+		if (!_lod_objects[lod].empty()) {
+			_draw_lod(lod, _lod_objects[lod]);
+		}
 	}
 }
 
+void ModelRenderer::_draw_lod(std::size_t lod, const InstanceDataVector& objects) const {
+	_buffers->object_data_buffer.SetData(objects, gl::Buffer::Usage::STREAM_DRAW);
+	_buffers->vao.DrawElements(_mode, _lods[lod].index_count, _lods[lod].first_index * _buffers->index_size, objects.size());
+}
+
+std::size_t ModelRenderer::_select_lod(const mat3x4& model_matrix, const lod_view& view) const {
+	// the columns of the model matrix are stored in the components of its
+	// rows
+	mat4x3 columns = glm::transpose(model_matrix);
+
+	float scale = std::max({
+			glm::length(columns[0]),
+			glm::length(columns[1]),
+			glm::length(columns[2])
+	});
+
+	// the distance to the nearest point that the model could cover
+	float distance = glm::distance(columns[3], view.camera_position) - _bounding_radius * scale;
+
+	if (distance <= 0.0f || scale <= 0.0f) {
+		return 0;
+	}
+
+	// the largest error in model units that covers at most max_pixel_error
+	// pixels on the screen at this distance
+	float max_error = view.max_pixel_error * distance / (view.pixels_per_unit * scale);
+
+	std::size_t lod = 0;
+	while (lod + 1 < _lods.size() && _lods[lod + 1].error <= max_error) {
+		lod++;
+	}
+
+	return lod;
+}
+
 gl::VertexArray::Mode ModelRenderer::_get_mode(RenderType type) {
 	switch (type) {
 		case RenderType::TRIANGLES:
@@ -162,6 +247,81 @@ gl::VertexArray::Mode ModelRenderer::_get_mode(RenderType type) {
 	return gl::VertexArray::Mode::TRIANGLES;
 }
 
+std::vector<model_lod> ModelRenderer::_get_lods(const Model& model) {
+	if (model.GetLods().empty()) {
+		return { { 0, std::uint32_t(model.GetIndices().size()), 0.0f } };
+	}
+
+	return model.GetLods();
+}
+
+float ModelRenderer::_get_bounding_radius(const Model& model) {
+	// the farthest corner of the bounding box takes the largest coordinate
+	// along each axis, which can come from either the minimum or the maximum
+	const model_bounds& bounds = model.GetBounds();
+	return glm::length(glm::max(glm::abs(bounds.min), glm::abs(bounds.max)));
+}
+
+std::unique_ptr<ModelRenderer::model_buffers> ModelRenderer::_create_buffers(const Model& model, std::span<const unsigned> indices) {
+	gl::ContextScope cs;
+
+	auto buffers = std::make_unique<model_buffers>();
+
+	_set_vertices(buffers->vertex_buffer_object, buffers->decoding_buffer, model);
+	buffers->object_data_buffer.SetData(InstanceDataVector());
+
+	_set_vertex_attributes(buffers->vao, buffers->vertex_buffer_object, buffers->object_data_buffer, buffers->decoding_buffer);
+	buffers->index_size = _set_indices(buffers->vao, indices, model.GetVertices().size());
+
+	return buffers;
+}
+
+void ModelRenderer::_set_vertices(gl::Buffer& vertex_buffer, gl::Buffer& decoding_buffer, const Model& model) {
+	vertex_decoding decoding{ vec4(0.0f, 0.0f, 0.0f, 0.0f), vec3(1.0f, 1.0f, 1.0f) };
+
+	if (DisplayConfiguration::Get().compress_vertices) {
+		const model_bounds& bounds = model.GetBounds();
+		decoding.position_offset = vec4(VertexCompression::GetPositionOffset(bounds), 1.0f);
+		decoding.position_scale = VertexCompression::GetPositionScale(bounds);
+
+		vertex_buffer.SetData(VertexCompression::Compress(model.GetVertices(), bounds));
+	} else {
+		vertex_buffer.SetData(model.GetVertices());
+	}
+
+	decoding_buffer.SetData(&decoding, 1);
+}
+
+void ModelRenderer::_set_vertex_attributes(gl::VertexArray& vao, const gl::Buffer& vertex_buffer, const gl::Buffer& object_data_buffer,
+		const gl::Buffer& decoding_buffer) {
+
+	if (DisplayConfiguration::Get().compress_vertices) {
+		static_assert(sizeof(compact_vertex) == sizeof(gl::snorm16x4) + sizeof(gl::snorm16x2) + sizeof(gl::half2));
+		vao.SetVertexAttributes<gl::snorm16x4, gl::snorm16x2, gl::half2>(vertex_buffer);
+	} else {
+		vao.SetVertexAttributes<vec3, vec3, vec2>(vertex_buffer);
+	}
+
+	vao.SetVertexAttributes<mat3x4, vec4, vec4>(object_data_buffer, sizeof(instance_data), 1);
+
+	// All instances read the first (and only) element of the decoding
+	// buffer, so the decoding does not cost any uniforms.
+	vao.SetVertexAttributes<vec4, vec3>(decoding_buffer, sizeof(vertex_decoding), std::numeric_limits<GLuint>::max());
+}
+
+unsigned ModelRenderer::_set_indices(gl::VertexArray& vao, std::span<const unsigned> indices, std::size_t vertex_count) {
+	// 16-bit indices halve the index memory and bandwidth, and suffice for
+	// most models
+	if (vertex_count <= std::size_t(std::numeric_limits<GLushort>::max()) + 1) {
+		std::vector<GLushort> narrow_indices(indices.begin(), indices.end());
+		vao.SetVertexIndices(std::span<const GLushort>(narrow_indices));
+		return sizeof(GLushort);
+	}
+
+	vao.SetVertexIndices(indices);
+	return sizeof(GLuint);
+}
+
 ModelRenderer::ObjectDataPtr ModelRenderer::_add(ObjectDataVector& objects) {
 	return ObjectDataPtr(&objects.emplace_back());
 }
@@ -176,4 +336,12 @@ void ModelRenderer::_remove(ObjectDataVector& objects, ObjectDataPtr&& data) {
 	objects.erase(objects.begin() + index);
 }
 
+void ModelRenderer::_snapshot(const ObjectDataVector& objects, InstanceDataVector& instances) {
+	instances.resize(objects.size());
+
+	for (std::size_t i = 0; i < objects.size(); i++) {
+		instances[i] = objects[i]._instance;
+	}
+}
+
 }
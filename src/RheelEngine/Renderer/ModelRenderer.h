@@ -6,6 +6,7 @@
 #include "../_common.h"
 
 #include <map>
+#include <optional>
 
 #include "../Material.h"
 #include "../Assets/Model.h"
@@ -21,6 +22,33 @@ class RE_API ModelRenderer {
 public:
 	class ObjectDataPtr;
 
+	/**
+	 * The per-object data, as it is uploaded to the GPU. Only the first three
+	 * rows of the model matrix are stored, as the last row of an affine
+	 * matrix is always (0, 0, 0, 1). The vertex shaders derive the normal
+	 * matrix from the model matrix.
+	 */
+	struct instance_data {
+		mat3x4 model_matrix = mat3x4(1.0f);
+		vec4 material_vector{ 0, 0, 0, 0 };
+		vec4 material_color{ 0, 0, 0, 0 };
+	};
+
+	/**
+	 * The camera for which the levels of detail of the objects are selected.
+	 */
+	struct lod_view {
+		vec3 camera_position;
+
+		// the size in pixels of one unit at a distance of one unit from the
+		// camera
+		float pixels_per_unit;
+
+		// the largest difference between a level of detail and the full
+		// model that may show on the screen, in pixels
+		float max_pixel_error = 1.0f;
+	};
+
 	class ObjectData {
 		friend class ModelRenderer;
 		friend class ObjectDataPtr;
@@ -36,10 +64,7 @@ public:
 		ObjectData& operator=(ObjectData&& data) noexcept;
 
 	private:
-		mat4 _model_matrix{};
-		mat4 _normal_model_matrix{};
-		vec4 _material_vector{};
-		vec4 _material_color{};
+		instance_data _instance;
 
 		ObjectDataPtr* _ptr{};
 
@@ -74,35 +99,110 @@ public:
 
 private:
 	using ObjectDataVector = std::vector<ObjectData>;
+	using InstanceDataVector = std::vector<instance_data>;
+
+	// How the vertex shaders decode the vertices of the model. The w
+	// component of position_offset is 1 when the normals are octahedral-
+	// encoded.
+	struct vertex_decoding {
+		vec4 position_offset;
+		vec3 position_scale;
+	};
 
 	struct material_texture_compare {
 		bool operator()(const Material& mat_1, const Material& mat_2) const;
 	};
 
+	// The OpenGL objects of a renderer, which are only created when the
+	// renderer is uploaded.
+	struct model_buffers {
+		gl::VertexArray vao;
+		gl::Buffer vertex_buffer_object{ gl::Buffer::Target::ARRAY };
+		gl::Buffer decoding_buffer{ gl::Buffer::Target::ARRAY };
+		gl::Buffer object_data_buffer{ gl::Buffer::Target::ARRAY };
+		unsigned index_size = 0;
+	};
+
 public:
+	/**
+	 * Creates a renderer for the model. This does not use OpenGL, so it can be
+	 * done on any thread. The renderer must be uploaded before it can render.
+	 */
 	explicit ModelRenderer(const Model& model);
 
+	/**
+	 * Creates the OpenGL objects of this renderer, and uploads the vertices
+	 * and indices of the model. Does nothing if the renderer was already
+	 * uploaded.
+	 */
+	void Upload();
+
+	/**
+	 * Uploads the vertices and indices of the model again, keeping all
+	 * objects. Used when the contents of the model were replaced in place. If
+	 * the renderer was not yet uploaded, the model is uploaded on Upload().
+	 */
+	void SetModel(const Model& model);
+
 	ObjectDataPtr AddObject();
 	ObjectDataPtr AddTexturedObject(const Material& material);
 
 	void RemoveObject(ObjectDataPtr&& object);
 	void RemoveTexturedObject(const Material& material, ObjectDataPtr&& object);
 
+	/**
+	 * Copies the current object data to the render state. Rendering only uses
+	 * the object data as it was during the last call to Snapshot(), so objects
+	 * can be added, removed, and modified while a previous frame is rendering.
+	 */
+	void Snapshot();
+
+	/**
+	 * Renders all objects with the full detail of the model.
+	 */
 	void RenderObjects() const;
 
+	/**
+	 * Renders each object with the least detailed level of the model of which
+	 * the error is at most view.max_pixel_error pixels on the screen. Models
+	 * without levels of detail are always rendered with full detail.
+	 */
+	void RenderObjects(const lod_view& view) const;
+
 private:
+	void _render_objects(const lod_view* view) const;
+	void _draw(const InstanceDataVector& objects, const lod_view* view) const;
+	void _draw_lod(std::size_t lod, const InstanceDataVector& objects) const;
+	std::size_t _select_lod(const mat3x4& model_matrix, const lod_view& view) const;
+
 	static gl::VertexArray::Mode _get_mode(RenderType type);
+	static std::vector<model_lod> _get_lods(const Model& model);
+	static float _get_bounding_radius(const Model& model);
+	static void _set_vertices(gl::Buffer& vertex_buffer, gl::Buffer& decoding_buffer, const Model& model);
+	static void _set_vertex_attributes(gl::VertexArray& vao, const gl::Buffer& vertex_buffer, const gl::Buffer& object_data_buffer, const gl::Buffer& decoding_buffer);
+	static unsigned _set_indices(gl::VertexArray& vao, std::span<const unsigned> indices, std::size_t vertex_count);
+	static std::unique_ptr<model_buffers> _create_buffers(const Model& model, std::span<const unsigned> indices);
 	static ObjectDataPtr _add(ObjectDataVector& objects);
 	static void _remove(ObjectDataVector& objects, ObjectDataPtr&& data);
+	static void _snapshot(const ObjectDataVector& objects, InstanceDataVector& instances);
 
 	gl::VertexArray::Mode _mode;
-	gl::VertexArray _vao;
-	gl::Buffer _vertex_buffer_object;
-	mutable gl::Buffer _object_data_buffer;
+	std::vector<model_lod> _lods;
+	float _bounding_radius;
+
+	// the model to upload, until the renderer is uploaded
+	std::optional<Model> _model;
+	std::unique_ptr<model_buffers> _buffers;
 
 	ObjectDataVector _objects;
 	std::map<Material, ObjectDataVector, material_texture_compare> _textured_objects;
 
+	InstanceDataVector _render_objects;
+	std::vector<std::pair<Material, InstanceDataVector>> _render_textured_objects;
+
+	// the objects of one draw call, per level of detail
+	mutable std::vector<InstanceDataVector> _lod_objects;
+
 };
 
 }
@@ -5,6 +5,8 @@
 #define RHEELENGINE_BUFFER_H
 #include "../../_common.h"
 
+#include <span>
+
 #include "Object.h"
 
 OPENGL_GEN_FUNCTION(glGenBuffers, gen_buffers_);
@@ -149,6 +151,18 @@ public:
 		SetData(data.data(), data.size(), usage);
 	}
 
+	/**
+	 * Sets the contents of the buffer. All elements from the span will be
+	 * read. Use the usage parameter to specify usage hits to OpenGL.
+	 * Default is STATIC_DRAW. See
+	 * https://www.khronos.org/registry/OpenGL-Refpages/gl4/html/glBufferData.xhtml
+	 * for more information on this.
+	 */
+	template<typename T>
+	void SetData(std::span<const T> data, Usage usage = Usage::STATIC_DRAW) {
+		SetData(data.data(), data.size(), usage);
+	}
+
 	/**
 	 * Replaces part of the contents of the buffer. Count elements will be read
 	 * from the data pointer. The first element will be put at the specified
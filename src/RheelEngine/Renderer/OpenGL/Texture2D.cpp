@@ -36,6 +36,7 @@ void Texture2D::SetEmpty(InternalFormat internal_format, unsigned width, unsigne
 
 void Texture2D::SetData(InternalFormat internal_format, unsigned width, unsigned height, Format format, Type type, const void* data) {
 	Bind();
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
 	glTexImage2D(GL_TEXTURE_2D, 0, GLenum(internal_format), width, height, 0, GLenum(format), GLenum(type), data);
 }
 
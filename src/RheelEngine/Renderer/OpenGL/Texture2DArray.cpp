@@ -25,6 +25,7 @@ void Texture2DArray::Initialize(InternalFormat internal_format, unsigned int wid
 
 void Texture2DArray::SetData(InternalFormat internal_format, unsigned width, unsigned height, unsigned layers, Format format, Type type, const void* data) {
 	Bind();
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
 	glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GLenum(internal_format), width, height, layers, 0, GLenum(format), GLenum(type), data);
 }
 
@@ -34,6 +35,7 @@ void Texture2DArray::SetData(InternalFormat internal_format, unsigned width, uns
 
 void Texture2DArray::SetLayerData(unsigned int width, unsigned int height, unsigned int layer, Format format, Type type, const void* data) {
 	Bind();
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
 	glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, layer, width, height, 1, GLenum(format), GLenum(type), data);
 }
 
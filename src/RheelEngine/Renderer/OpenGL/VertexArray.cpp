@@ -133,15 +133,15 @@ void VertexArray::SetVertexAttributes(const Buffer& buffer, const std::vector<Ve
 	}
 }
 
-void VertexArray::SetVertexIndices(const std::vector<GLubyte>& indices) {
+void VertexArray::SetVertexIndices(std::span<const GLubyte> indices) {
 	_set_indices(indices, Type::UNSIGNED_BYTE);
 }
 
-void VertexArray::SetVertexIndices(const std::vector<GLushort>& indices) {
+void VertexArray::SetVertexIndices(std::span<const GLushort> indices) {
 	_set_indices(indices, Type::UNSIGNED_SHORT);
 }
 
-void VertexArray::SetVertexIndices(const std::vector<GLuint>& indices) {
+void VertexArray::SetVertexIndices(std::span<const GLuint> indices) {
 	_set_indices(indices, Type::UNSIGNED_INT);
 }
 
@@ -246,6 +246,23 @@ void VertexArray::_set_vertex_attributes(const Buffer& buffer, const std::vector
 
 			attribute = VertexAttribute(index, 4, Type::FLOAT, 0, offset + attribute._byte_size() * 3);
 			offset += attribute._byte_size() * 3;
+		} else if (t == typeid(mat3x4)) {
+			index = _first_unused_index(3);
+
+			attribute = attributes.emplace_back(index++, 4, Type::FLOAT, 0, offset);
+			_unused_attribute_indices.erase(attribute._index);
+
+			attribute = attributes.emplace_back(index++, 4, Type::FLOAT, 0, offset + attribute._byte_size());
+			_unused_attribute_indices.erase(attribute._index);
+
+			attribute = VertexAttribute(index, 4, Type::FLOAT, 0, offset + attribute._byte_size() * 2);
+			offset += attribute._byte_size() * 2;
+		} else if (t == typeid(snorm16x2)) {
+			attribute = VertexAttribute(index, 2, Type::SHORT, 0, offset, true);
+		} else if (t == typeid(snorm16x4)) {
+			attribute = VertexAttribute(index, 4, Type::SHORT, 0, offset, true);
+		} else if (t == typeid(half2)) {
+			attribute = VertexAttribute(index, 2, Type::HALF_FLOAT, 0, offset);
 		} else if (t == typeid(int) || t == typeid(ivec1)) {
 			attribute = VertexAttribute(index, 1, Type::INT, 0, offset);
 		} else if (t == typeid(ivec2)) {
@@ -5,6 +5,7 @@
 #define RHEELENGINE_VERTEXARRAY_H
 #include "../../_common.h"
 
+#include <span>
 #include <typeindex>
 #include <set>
 
@@ -16,6 +17,15 @@ namespace rheel::gl {
 OPENGL_GEN_FUNCTION(glGenVertexArrays, gen_vertex_arrays_);
 OPENGL_DELETE_FUNCTION(glDeleteVertexArrays, delete_vertex_arrays_);
 
+/**
+ * Packed attribute types, for use with VertexArray::SetVertexAttributes<...>().
+ * The snorm types are signed 16-bit integers that the shader reads as floats
+ * in [-1, 1]. The half type holds two half-precision floats.
+ */
+struct snorm16x2 { GLshort x, y; };
+struct snorm16x4 { GLshort x, y, z, w; };
+struct half2 { GLushort x, y; };
+
 class RE_API VertexArray : public Object<gen_vertex_arrays_, delete_vertex_arrays_> {
 
 public:
@@ -26,7 +36,8 @@ public:
 		ElementArrayBuffer() = default;
 
 		unsigned _index_count = 0;
-		unsigned _index_capacity = 0;
+		// the size of the buffer, in bytes, as the index type can change
+		std::size_t _byte_capacity = 0;
 		Type _index_type;
 
 	};
@@ -128,17 +139,17 @@ public:
 	/**
 	 * Set the vertex indices of this VAO.
 	 */
-	void SetVertexIndices(const std::vector<GLubyte>& indices);
+	void SetVertexIndices(std::span<const GLubyte> indices);
 
 	/**
 	 * Set the vertex indices of this VAO.
 	 */
-	void SetVertexIndices(const std::vector<GLushort>& indices);
+	void SetVertexIndices(std::span<const GLushort> indices);
 
 	/**
 	 * Set the vertex indices of this VAO.
 	 */
-	void SetVertexIndices(const std::vector<GLuint>& indices);
+	void SetVertexIndices(std::span<const GLuint> indices);
 
 	/**
 	 * Sets the vertex index buffer of this VAO. Note that any call to
@@ -191,7 +202,7 @@ public:
 
 private:
 	template<typename T>
-	void _set_indices(const std::vector<T>& indices, Type type) {
+	void _set_indices(std::span<const T> indices, Type type) {
 		Bind();
 		SetIndexBuffer(_index_buffer);
 
@@ -200,11 +211,13 @@ private:
 
 		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _index_buffer.GetName());
 
-		if (_index_buffer._index_capacity < _index_buffer._index_count) {
-			glBufferData(GL_ELEMENT_ARRAY_BUFFER, _index_buffer._index_count * sizeof(T), indices.data(), GL_STATIC_DRAW);
-			_index_buffer._index_capacity = _index_buffer._index_count;
+		std::size_t byte_size = indices.size_bytes();
+
+		if (_index_buffer._byte_capacity < byte_size) {
+			glBufferData(GL_ELEMENT_ARRAY_BUFFER, GLsizeiptr(byte_size), indices.data(), GL_STATIC_DRAW);
+			_index_buffer._byte_capacity = byte_size;
 		} else {
-			glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, _index_buffer._index_count * sizeof(T), indices.data());
+			glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, GLsizeiptr(byte_size), indices.data());
 		}
 	}
 
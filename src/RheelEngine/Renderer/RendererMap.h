@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) Levi van Rheenen. All rights reserved.
+ */
+#ifndef RHEELENGINE_RENDERERMAP_H
+#define RHEELENGINE_RENDERERMAP_H
+#include "../_common.h"
+
+#include <mutex>
+
+namespace rheel {
+
+/**
+ * The renderers of a scene, keyed by the assets they render. In pipelined
+ * frame mode, the render thread uses the renderers while the scene is being
+ * simulated on another thread, so the simulation cannot add renderers to the
+ * map, and cannot use the OpenGL context to create their buffers.
+ *
+ * Renderers that are requested while the scene is being simulated are
+ * therefore created without OpenGL objects, and kept aside. They can be used
+ * by the simulation right away, for example to add objects, but they only
+ * join the map, and create their OpenGL objects with their Upload() method,
+ * on the next call to Flush(). Likewise, renderers that are erased while the
+ * scene is being simulated are only removed from the map on the next Flush().
+ */
+template<typename Key, typename Renderer>
+class RendererMap {
+	RE_NO_COPY(RendererMap);
+	RE_NO_MOVE(RendererMap);
+
+	using Map = std::unordered_map<Key, Renderer>;
+
+public:
+	RendererMap() = default;
+
+	/**
+	 * Returns the renderer for the key. If it does not exist, it is created
+	 * from the arguments. When deferred is set, a new renderer is kept aside
+	 * until the next Flush(). Otherwise, it is uploaded and added to the map
+	 * immediately. References to renderers stay valid when they join the map.
+	 */
+	template<typename... Args>
+	Renderer& Get(const Key& key, bool deferred, Args&&... args) {
+		std::lock_guard lock(_mutex);
+
+		if (!_erased.contains(key)) {
+			if (auto iter = _renderers.find(key); iter != _renderers.end()) {
+				return iter->second;
+			}
+		} else if (!deferred) {
+			_renderers.erase(key);
+			_erased.erase(key);
+		}
+
+		auto[iter, inserted] = _pending.try_emplace(key, std::forward<Args>(args)...);
+		if (deferred) {
+			return iter->second;
+		}
+
+		return _add(_pending.extract(iter));
+	}
+
+	/**
+	 * Removes the renderer for the key. When deferred is set, a renderer in
+	 * the map stays there until the next Flush(), but it is no longer
+	 * returned by Get(). Returns whether the renderer existed.
+	 */
+	bool Erase(const Key& key, bool deferred) {
+		std::lock_guard lock(_mutex);
+
+		bool existed = _pending.erase(key) > 0 || (_renderers.contains(key) && !_erased.contains(key));
+
+		if (!deferred) {
+			_renderers.erase(key);
+			_erased.erase(key);
+		} else if (_renderers.contains(key)) {
+			_erased.insert(key);
+		}
+
+		return existed;
+	}
+
+	/**
+	 * Removes the renderers that were erased, and uploads and adds the
+	 * renderers that were kept aside. Requires the OpenGL context.
+	 */
+	void Flush() {
+		std::lock_guard lock(_mutex);
+
+		for (const Key& key : _erased) {
+			_renderers.erase(key);
+		}
+
+		_erased.clear();
+
+		while (!_pending.empty()) {
+			_add(_pending.extract(_pending.begin()));
+		}
+	}
+
+	/**
+	 * Returns the renderers in the map. These do not include the renderers
+	 * that are kept aside, but do include the erased renderers, until the
+	 * next Flush().
+	 */
+	Map& GetRenderers() {
+		return _renderers;
+	}
+
+	/**
+	 * Returns the renderers in the map. These do not include the renderers
+	 * that are kept aside, but do include the erased renderers, until the
+	 * next Flush().
+	 */
+	const Map& GetRenderers() const {
+		return _renderers;
+	}
+
+private:
+	Renderer& _add(typename Map::node_type node) {
+		node.mapped().Upload();
+		return _renderers.insert(std::move(node)).position->second;
+	}
+
+	Map _renderers;
+	Map _pending;
+	std::unordered_set<Key> _erased;
+	std::mutex _mutex;
+
+};
+
+}
+
+#endif
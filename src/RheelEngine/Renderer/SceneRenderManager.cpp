@@ -5,6 +5,7 @@
 
 #include "ForwardSceneRenderer.h"
 #include "ShadowMapDirectional.h"
+#include "VoxelRenderer.h"
 #include "../EngineResources.h"
 #include "../Components/DirectionalLight.h"
 #include "../Components/PointLight.h"
@@ -77,26 +78,76 @@ void SceneRenderManager::Update() {
 	}
 
 	_shadow_level = _get_shadow_quality();
+
+	for (auto* voxel_renderer : _voxel_renderers) {
+		voxel_renderer->_update();
+	}
+
+	// upload the renderers that were created during the simulation
+	_render_map.Flush();
+	_custom_shader_render_map.Flush();
+
+	for (auto&[_, renderer] : _render_map.GetRenderers()) {
+		renderer.Snapshot();
+	}
+
+	for (auto&[_, renderer] : _custom_shader_render_map.GetRenderers()) {
+		renderer.Snapshot();
+	}
+
+	// In pipelined mode, the scene renderers render while the next frame is
+	// simulated, so they need to capture the camera state here.
+	if (_scene->GetGame().GetWindow().GetFrameMode() == MainWindow::FrameMode::PIPELINED) {
+		for (auto* scene_renderer : _scene_renderers) {
+			scene_renderer->Prepare();
+		}
+	}
+}
+
+void SceneRenderManager::SetSimulationRunning(bool running) {
+	_simulation_running = running;
+}
+
+bool SceneRenderManager::IsSimulationRunning() const {
+	return _simulation_running;
 }
 
 ModelRenderer& SceneRenderManager::GetModelRenderer(const Model& model) {
-	auto iter = _render_map.find(model.GetAddress());
+	return _render_map.Get(model.GetAddress(), _simulation_running, model);
+}
+
+CustomShaderModelRenderer& SceneRenderManager::GetModelRendererForCustomShader(const Model& model, const Shader& shader) {
+	return _custom_shader_render_map.Get(std::make_pair(model.GetAddress(), shader.GetAddress()), _simulation_running, model, shader);
+}
+
+void SceneRenderManager::ReloadModel(const Model& model) {
+	_require_not_simulating();
 
-	if (iter == _render_map.end()) {
-		iter = _render_map.emplace(model.GetAddress(), model).first;
+	// renderers that are not uploaded yet upload the new contents when they
+	// are, as they share the contents with the model
+	if (auto iter = _render_map.GetRenderers().find(model.GetAddress()); iter != _render_map.GetRenderers().end()) {
+		iter->second.SetModel(model);
 	}
 
-	return iter->second;
+	for (auto&[addresses, renderer] : _custom_shader_render_map.GetRenderers()) {
+		if (addresses.first == model.GetAddress()) {
+			renderer.SetModel(model);
+		}
+	}
 }
 
-CustomShaderModelRenderer& SceneRenderManager::GetModelRendererForCustomShader(const Model& model, const Shader& shader) {
-	auto iter = _custom_shader_render_map.find(std::make_pair(model.GetAddress(), shader.GetAddress()));
+void SceneRenderManager::ReloadVoxelImage(const VoxelImage& image) {
+	_require_not_simulating();
 
-	if (iter == _custom_shader_render_map.end()) {
-		iter = _custom_shader_render_map.emplace(std::make_pair(model.GetAddress(), shader.GetAddress()), CustomShaderModelRenderer(model, shader)).first;
+	for (auto* voxel_renderer : _voxel_renderers) {
+		if (voxel_renderer->_image.GetAddress() == image.GetAddress()) {
+			voxel_renderer->_reload();
+		}
 	}
+}
 
-	return iter->second;
+void SceneRenderManager::RemoveModelRenderer(const Model& model) {
+	_render_map.Erase(model.GetAddress(), _simulation_running);
 }
 
 std::unique_ptr<SceneRenderer> SceneRenderManager::CreateSceneRenderer(ConstEntityId camera_entity, unsigned width, unsigned height) {
@@ -121,11 +172,11 @@ Scene* SceneRenderManager::GetScene() {
 }
 
 const std::unordered_map<std::uintptr_t, ModelRenderer>& SceneRenderManager::RenderMap() const {
-	return _render_map;
+	return _render_map.GetRenderers();
 }
 
 const std::unordered_map<std::pair<std::uintptr_t, std::uintptr_t>, CustomShaderModelRenderer>& SceneRenderManager::CustomShaderRenderMap() const {
-	return _custom_shader_render_map;
+	return _custom_shader_render_map.GetRenderers();
 }
 
 const SkyboxRenderer& SceneRenderManager::GetSkyboxRenderer() const {
@@ -135,7 +186,7 @@ const SkyboxRenderer& SceneRenderManager::GetSkyboxRenderer() const {
 std::vector<std::reference_wrapper<gl::Program>> SceneRenderManager::CustomShaderPrograms() {
 	std::vector<std::reference_wrapper<gl::Program>> shaders;
 
-	for (auto&[key, value] : _custom_shader_render_map) {
+	for (auto&[key, value] : _custom_shader_render_map.GetRenderers()) {
 		shaders.emplace_back(value.GetShaderProgram());
 	}
 
@@ -184,6 +235,12 @@ gl::Program& SceneRenderManager::GetOpaqueShader() {
 	return _model_shaders->opaque_shader;
 }
 
+void SceneRenderManager::_require_not_simulating() const {
+	if (_simulation_running) {
+		throw std::runtime_error("Cannot reload an asset while the scene is being simulated concurrently");
+	}
+}
+
 int SceneRenderManager::_get_shadow_quality() {
 	if (std::ranges::any_of(_scene->GetRegistry().GetComponents<PointLight, SpotLight, DirectionalLight>().As<Light>(),
 			[](const Light& light) { return light.CastsShadows(); })) {
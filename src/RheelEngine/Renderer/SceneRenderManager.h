@@ -5,10 +5,14 @@
 #define RHEELENGINE_SCENERENDERMANAGER_H
 #include "../_common.h"
 
+#include <atomic>
+
 #include "CustomShaderModelRenderer.h"
+#include "RendererMap.h"
 #include "SkyboxRenderer.h"
 #include "OpenGL/Framebuffer.h"
 #include "../Assets/Model.h"
+#include "../Assets/VoxelImage.h"
 #include "../Registry/EntityId.h"
 
 namespace rheel {
@@ -17,11 +21,15 @@ class Light;
 class Scene;
 class SceneRenderer;
 class ShadowMap;
+class VoxelRenderer;
 
 class RE_API SceneRenderManager {
 	RE_NO_COPY(SceneRenderManager);
 	RE_NO_MOVE(SceneRenderManager);
 
+	friend class SceneRenderer;
+	friend class VoxelRenderer;
+
 	struct RE_API model_shaders {
 		model_shaders();
 		gl::Program forward_model_shader;
@@ -39,13 +47,33 @@ public:
 	bool ShouldDrawShadows() const;
 
 	/**
-	 * Updates this render manager from the scene.
+	 * Updates this render manager from the scene. This takes a snapshot of the
+	 * render state of the scene (object data, lights and, in pipelined frame
+	 * mode, cameras), which is used for rendering until the next Update().
+	 * Model renderers that were created during the simulation, and voxel
+	 * renderers, upload their meshes here.
 	 */
 	void Update();
 
+	/**
+	 * Marks whether the scene is currently being simulated on another thread,
+	 * while this render manager renders the previous frame.
+	 */
+	void SetSimulationRunning(bool running);
+
+	/**
+	 * Returns whether the scene is currently being simulated on another
+	 * thread.
+	 */
+	bool IsSimulationRunning() const;
+
 	/**
 	 * Returns a ModelRenderer instance to render the specified model. Multiple
 	 * calls with the same model will result in the same model renderer.
+	 *
+	 * A new model renderer that is created while the scene is being simulated
+	 * concurrently can be used right away, but only uploads its model and
+	 * starts rendering on the next Update().
 	 */
 	ModelRenderer& GetModelRenderer(const Model& model);
 
@@ -53,9 +81,37 @@ public:
 	 * Returns a CustomShaderModelRenderer instance to render the specified model
 	 * using the specified shader. Multiple calls with the same model and shader
 	 * pair will result in the same custom shader model renderer.
+	 *
+	 * As with GetModelRenderer(), a renderer that is created while the scene
+	 * is being simulated concurrently starts rendering on the next Update().
 	 */
 	CustomShaderModelRenderer& GetModelRendererForCustomShader(const Model& model, const Shader& shader);
 
+	/**
+	 * Uploads the vertices and indices of the model again to the renderers
+	 * of the model, after its contents were replaced in place. This cannot be
+	 * done while the scene is being simulated concurrently, since that
+	 * requires the OpenGL context.
+	 */
+	void ReloadModel(const Model& model);
+
+	/**
+	 * Meshes the voxel image again in the voxel renderers of the image, after
+	 * its contents were replaced in place. The dimensions of the image may
+	 * have changed. This cannot be done while the scene is being simulated
+	 * concurrently.
+	 */
+	void ReloadVoxelImage(const VoxelImage& image);
+
+	/**
+	 * Removes the ModelRenderer of the model, and its OpenGL buffers. This
+	 * must be called when a model with a renderer is destroyed, since a new
+	 * model at the same address would otherwise get the renderer of the old
+	 * model. When the scene is being simulated concurrently, the renderer is
+	 * removed on the next Update().
+	 */
+	void RemoveModelRenderer(const Model& model);
+
 	/**
 	 * Creates and returns a SceneRenderer managed by this manager.
 	 */
@@ -103,13 +159,17 @@ public:
 	gl::Program& GetOpaqueShader();
 
 private:
+	void _require_not_simulating() const;
 	int _get_shadow_quality();
 
 	Scene* _scene;
 
-	std::unordered_map<std::uintptr_t, ModelRenderer> _render_map;
-	std::unordered_map<std::pair<uintptr_t, uintptr_t>, CustomShaderModelRenderer> _custom_shader_render_map;
+	RendererMap<std::uintptr_t, ModelRenderer> _render_map;
+	RendererMap<std::pair<uintptr_t, uintptr_t>, CustomShaderModelRenderer> _custom_shader_render_map;
 	std::shared_ptr<SkyboxRenderer> _skybox_renderer;
+	std::unordered_set<SceneRenderer*> _scene_renderers;
+	std::unordered_set<VoxelRenderer*> _voxel_renderers;
+	std::atomic<bool> _simulation_running = false;
 
 	std::vector<int> _lights_type;
 	std::vector<vec3> _lights_position;
@@ -37,6 +37,12 @@ SceneRenderer::SceneRenderer(
 	}
 
 	_result_buffer.SetDrawBuffers({ 0 });
+
+	_manager->_scene_renderers.insert(this);
+}
+
+SceneRenderer::~SceneRenderer() {
+	_manager->_scene_renderers.erase(this);
 }
 
 void SceneRenderer::SetSize(unsigned width, unsigned height) {
@@ -46,6 +52,7 @@ void SceneRenderer::SetSize(unsigned width, unsigned height) {
 
 	_width = width;
 	_height = height;
+	_prepared = false;
 
 	_result_buffer = gl::Framebuffer(_result_buffer, width, height);
 	Resize(width, height);
@@ -55,21 +62,52 @@ const gl::Framebuffer& SceneRenderer::ResultBuffer() const {
 	return _result_buffer;
 }
 
-void SceneRenderer::RenderShadowMaps() {
-	const Camera* camera = GetCamera();
-	if (!camera || !_manager->ShouldDrawShadows()) {
+void SceneRenderer::Prepare() {
+	_camera = GetCamera();
+	_prepared = true;
+
+	if (!_camera) {
 		return;
 	}
 
-	_correct_shadow_map_list();
+	_camera_matrix = _camera->CreateMatrix(_width, _height);
+	_camera_position = _camera->GetEntity().AbsoluteTransform().GetTranslation();
+
+	// at a distance of one unit, the projection maps one unit to
+	// projection[1][1] half screen heights
+	_pixels_per_unit = _camera->GetProjectionMatrix(_width, _height)[1][1] * float(_height) / 2.0f;
+
+	if (_manager->ShouldDrawShadows()) {
+		_correct_shadow_map_list();
+
+		for (auto& iter : _shadow_maps) {
+			iter.second->Prepare(_camera, _width, _height);
+		}
+	}
+}
+
+void SceneRenderer::RenderShadowMaps() {
+	if (!_camera || !_manager->ShouldDrawShadows()) {
+		return;
+	}
 
 	for (auto& iter : _shadow_maps) {
-		iter.second->Update(camera, _width, _height);
+		iter.second->Render();
 	}
 }
 
 void SceneRenderer::RenderSkybox(unsigned width, unsigned height) {
-	_manager->GetSkyboxRenderer().Render(GetCamera(), width, height);
+	_manager->GetSkyboxRenderer().Render(_camera, width, height);
+}
+
+bool SceneRenderer::EnsurePrepared() {
+	// When the scene is not being simulated at the same time, it is safe to
+	// read the most recent state.
+	if (!_manager->IsSimulationRunning()) {
+		Prepare();
+	}
+
+	return _prepared && _camera;
 }
 
 SceneRenderManager* SceneRenderer::GetManager() const {
@@ -80,6 +118,18 @@ const Camera* SceneRenderer::GetCamera() const {
 	return _manager->GetScene()->GetRegistry().GetEntity(_camera_entity)->GetComponent<Camera>();
 }
 
+const mat4& SceneRenderer::GetCameraMatrix() const {
+	return _camera_matrix;
+}
+
+const vec3& SceneRenderer::GetCameraPosition() const {
+	return _camera_position;
+}
+
+ModelRenderer::lod_view SceneRenderer::GetLodView() const {
+	return { _camera_position, _pixels_per_unit };
+}
+
 unsigned SceneRenderer::Width() const {
 	return _width;
 }
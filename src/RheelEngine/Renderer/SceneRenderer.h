@@ -15,10 +15,17 @@ namespace rheel {
 class RE_API SceneRenderer {
 
 public:
-	virtual ~SceneRenderer() = default;
+	virtual ~SceneRenderer();
 
 	void SetSize(unsigned width, unsigned height);
 
+	/**
+	 * Captures the camera and shadow state needed to render the scene. The
+	 * render manager calls this at the frame boundary, while the scene is not
+	 * being simulated. Render() only uses the captured state.
+	 */
+	void Prepare();
+
 	const gl::Framebuffer& ResultBuffer() const;
 
 	virtual void Render(float dt) = 0;
@@ -30,10 +37,34 @@ protected:
 
 	void RenderSkybox(unsigned width, unsigned height);
 
+	/**
+	 * Prepares the renderer if that can be done safely, i.e. when the scene is
+	 * not being simulated concurrently. Returns whether there is a camera to
+	 * render the scene with. A renderer that is created or resized while the
+	 * scene is being simulated can only render after the next frame boundary.
+	 */
+	bool EnsurePrepared();
+
 	SceneRenderManager* GetManager() const;
 
 	const Camera* GetCamera() const;
 
+	/**
+	 * Returns the camera matrix, as captured by the last Prepare().
+	 */
+	const mat4& GetCameraMatrix() const;
+
+	/**
+	 * Returns the camera position, as captured by the last Prepare().
+	 */
+	const vec3& GetCameraPosition() const;
+
+	/**
+	 * Returns the view for selecting levels of detail of the models, as
+	 * captured by the last Prepare().
+	 */
+	ModelRenderer::lod_view GetLodView() const;
+
 	unsigned Width() const;
 
 	unsigned Height() const;
@@ -52,6 +83,12 @@ private:
 
 	gl::Framebuffer _result_buffer;
 
+	bool _prepared = false;
+	const Camera* _camera = nullptr;
+	mat4 _camera_matrix{};
+	vec3 _camera_position{};
+	float _pixels_per_unit = 1.0f;
+
 	std::map<const Light*, std::unique_ptr<ShadowMap>> _shadow_maps;
 
 };
@@ -17,7 +17,18 @@ class RE_API ShadowMap {
 public:
 	virtual ~ShadowMap() = default;
 
-	virtual void Update(const Camera* camera, unsigned width, unsigned height) = 0;
+	/**
+	 * Calculates the light space transformations for the given camera. This
+	 * reads the light and camera components, so it may not run while the
+	 * scene is being simulated.
+	 */
+	virtual void Prepare(const Camera* camera, unsigned width, unsigned height) = 0;
+
+	/**
+	 * Renders the shadow map, using the transformations calculated in the last
+	 * call to Prepare().
+	 */
+	virtual void Render() = 0;
 
 protected:
 	ShadowMap(SceneRenderManager* manager, const Light& light);
@@ -64,11 +64,13 @@ ShadowMapDirectional::ShadowMapDirectional(SceneRenderManager* manager, const Li
 
 ShadowMapDirectional::~ShadowMapDirectional() = default;
 
-void ShadowMapDirectional::Update(const Camera* camera, unsigned width, unsigned height) {
-	gl::ContextScope cs;
-
+void ShadowMapDirectional::Prepare(const Camera* camera, unsigned width, unsigned height) {
 	// set the lightspace matrices
 	_calculate_view_projection_matrices(camera, width, height);
+}
+
+void ShadowMapDirectional::Render() {
+	gl::ContextScope cs;
 
 	gl::Program& model_shader = GetManager()->GetOpaqueShader();
 
@@ -15,7 +15,9 @@ class RE_API ShadowMapDirectional : public ShadowMap {
 public:
 	~ShadowMapDirectional() override;
 
-	void Update(const Camera* camera, unsigned width, unsigned height) override;
+	void Prepare(const Camera* camera, unsigned width, unsigned height) override;
+
+	void Render() override;
 
 	std::vector<std::reference_wrapper<const gl::Texture2D>> Textures() const;
 
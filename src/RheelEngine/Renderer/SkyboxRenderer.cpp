@@ -84,7 +84,8 @@ void SkyboxRenderer::_load_image(Image image, unsigned layer) const {
 		_textures = _create_texture(_current_width, _current_height);
 	}
 
-	_textures.SetLayerData(image.GetWidth(), image.GetHeight(), layer, gl::Format::RGBA, image.GetRawColorData());
+	auto upload_format = ImageTexture::GetUploadFormat(image.GetFormat());
+	_textures.SetLayerData(image.GetWidth(), image.GetHeight(), layer, upload_format.format, upload_format.type, image.GetData().data());
 }
 
 gl::Texture2DArray SkyboxRenderer::_create_texture(unsigned width, unsigned height) {
@@ -1,8 +1,199 @@
 /*
- * Copyright (c) 2020 Levi van Rheenen
+ * Copyright (c) Levi van Rheenen. All rights reserved.
  */
 #include "VoxelRenderer.h"
 
+#include "ImageTexture.h"
+#include "SceneRenderManager.h"
+#include "../Game.h"
+#include "../Scene.h"
+#include "../Assets/VoxelMesher.h"
+
 namespace rheel {
 
-}
\ No newline at end of file
+VoxelRenderer::VoxelRenderer(SceneRenderManager& manager, VoxelImage image) :
+		_manager(manager),
+		_image(std::move(image)),
+		_palette(_image.GetPalette()),
+		_palette_texture(VoxelMesher::CreatePaletteTexture(_image)),
+		_material(_palette_texture, 0.7f, 0.0f),
+		_chunk_count(_image.GetChunkCount()),
+		_chunks(std::size_t(_chunk_count.x) * _chunk_count.y * _chunk_count.z) {
+
+	InvalidateAll();
+	_manager._voxel_renderers.insert(this);
+}
+
+VoxelRenderer::~VoxelRenderer() {
+	_manager._voxel_renderers.erase(this);
+	_remove_chunks();
+}
+
+void VoxelRenderer::Invalidate(unsigned x, unsigned y, unsigned z) {
+	uvec3 voxel(x, y, z);
+	uvec3 first;
+	uvec3 last;
+
+	// the chunks that contain the voxel in their border
+	for (int i = 0; i < 3; i++) {
+		first[i] = voxel[i] / VoxelImage::chunk_size;
+		last[i] = first[i];
+
+		if (voxel[i] % VoxelImage::chunk_size == 0 && first[i] > 0) {
+			first[i]--;
+		}
+
+		if (voxel[i] % VoxelImage::chunk_size == VoxelImage::chunk_size - 1 && last[i] + 1 < _chunk_count[i]) {
+			last[i]++;
+		}
+	}
+
+	for (unsigned chunk_z = first.z; chunk_z <= last.z; chunk_z++) {
+		for (unsigned chunk_y = first.y; chunk_y <= last.y; chunk_y++) {
+			for (unsigned chunk_x = first.x; chunk_x <= last.x; chunk_x++) {
+				_invalidate(chunk_x + chunk_y * _chunk_count.x + chunk_z * _chunk_count.x * _chunk_count.y);
+			}
+		}
+	}
+}
+
+void VoxelRenderer::InvalidateAll() {
+	for (std::size_t i = 0; i < _chunks.size(); i++) {
+		_invalidate(i);
+	}
+}
+
+void VoxelRenderer::SetMatrix(const mat4& matrix) {
+	_matrix = matrix;
+
+	for (auto& chunk : _chunks) {
+		if (chunk.object) {
+			chunk.object.SetMatrix(matrix);
+		}
+	}
+}
+
+bool VoxelRenderer::IsMeshing() const {
+	return !_changed_chunks.empty() || !_meshing_chunks.empty();
+}
+
+void VoxelRenderer::_update() {
+	// new colors may have been added to the palette
+	if (_image.GetPalette() != _palette) {
+		_palette = _image.GetPalette();
+		_palette_texture.ReplaceContents(VoxelMesher::CreatePaletteTexture(_image));
+		ImageTexture::Reload(_palette_texture);
+	}
+
+	// upload the meshes that are done
+	std::erase_if(_meshing_chunks, [this](std::size_t index) {
+		auto& mesh = _chunks[index].mesh;
+
+		if (mesh.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+			return false;
+		}
+
+		_upload(index, mesh.get());
+		return true;
+	});
+
+	// Start meshing the changed chunks. Chunks that are still being meshed
+	// are meshed again when they are done.
+	std::erase_if(_changed_chunks, [this](std::size_t index) {
+		if (_chunks[index].mesh.valid()) {
+			return false;
+		}
+
+		_start_meshing(index);
+		return true;
+	});
+}
+
+void VoxelRenderer::_reload() {
+	// the meshes of the old contents are not uploaded
+	_changed_chunks.clear();
+	_meshing_chunks.clear();
+
+	if (_image.GetChunkCount() == _chunk_count) {
+		for (auto& chunk : _chunks) {
+			chunk.changed = false;
+			chunk.mesh = std::future<Model>();
+		}
+	} else {
+		_remove_chunks();
+		_chunk_count = _image.GetChunkCount();
+		_chunks = std::vector<chunk>(std::size_t(_chunk_count.x) * _chunk_count.y * _chunk_count.z);
+	}
+
+	InvalidateAll();
+}
+
+void VoxelRenderer::_remove_chunks() {
+	for (auto& chunk : _chunks) {
+		if (chunk.object) {
+			_manager.GetModelRenderer(*chunk.model).RemoveTexturedObject(_material, std::move(chunk.object));
+		}
+
+		if (chunk.model) {
+			_manager.RemoveModelRenderer(*chunk.model);
+		}
+	}
+}
+
+void VoxelRenderer::_invalidate(std::size_t index) {
+	if (!_chunks[index].changed) {
+		_chunks[index].changed = true;
+		_changed_chunks.push_back(index);
+	}
+}
+
+void VoxelRenderer::_start_meshing(std::size_t index) {
+	uvec3 position(
+			index % _chunk_count.x,
+			(index / _chunk_count.x) % _chunk_count.y,
+			index / (std::size_t(_chunk_count.x) * _chunk_count.y));
+
+	// the task meshes a copy, so the image can change in the meantime
+	auto voxels = std::make_shared<VoxelMesher::padded_chunk>(VoxelMesher::CopyChunk(_image, position));
+
+	_chunks[index].changed = false;
+	_chunks[index].mesh = _manager.GetScene()->GetGame().GetThreadPool().AddTask<Model>([voxels, position]() {
+		voxel_mesh mesh = VoxelMesher::Mesh(*voxels, position);
+		return Model(std::move(mesh.vertices), std::move(mesh.indices));
+	});
+
+	_meshing_chunks.push_back(index);
+}
+
+void VoxelRenderer::_upload(std::size_t index, Model model) {
+	auto& chunk = _chunks[index];
+	bool empty = model.GetIndices().empty();
+
+	if (!chunk.model) {
+		if (empty) {
+			return;
+		}
+
+		chunk.model = std::move(model);
+	} else {
+		chunk.model->ReplaceContents(std::move(model));
+
+		if (!empty) {
+			_manager.ReloadModel(*chunk.model);
+		}
+	}
+
+	ModelRenderer& renderer = _manager.GetModelRenderer(*chunk.model);
+
+	if (empty && chunk.object) {
+		renderer.RemoveTexturedObject(_material, std::move(chunk.object));
+		chunk.object = ModelRenderer::ObjectDataPtr();
+	} else if (!empty && !chunk.object) {
+		chunk.object = renderer.AddTexturedObject(_material);
+		chunk.object.SetMaterialVector(_material.MaterialVector());
+		chunk.object.SetMaterialColor(_material.GetColor());
+		chunk.object.SetMatrix(_matrix);
+	}
+}
+
+}
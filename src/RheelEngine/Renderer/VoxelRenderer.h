@@ -1,13 +1,93 @@
 /*
- * Copyright (c) 2020 Levi van Rheenen
+ * Copyright (c) Levi van Rheenen. All rights reserved.
  */
 #ifndef RHEELENGINE_VOXELRENDERER_H
 #define RHEELENGINE_VOXELRENDERER_H
 #include "../_common.h"
 
+#include <future>
+#include <optional>
+
+#include "ModelRenderer.h"
+#include "../Material.h"
+#include "../Assets/Image.h"
+#include "../Assets/VoxelImage.h"
+
 namespace rheel {
 
+class SceneRenderManager;
+
+/**
+ * Renders a voxel image as one model per chunk of the image, using the model
+ * renderers of the scene. The chunks are meshed with VoxelMesher on the
+ * thread pool of the game. After the image is changed, only the chunks that
+ * the changed voxels touch are meshed again.
+ *
+ * The render manager uploads finished meshes and starts meshing changed
+ * chunks in SceneRenderManager::Update(), so the image must not be changed
+ * concurrently with that call.
+ */
 class RE_API VoxelRenderer {
+	RE_NO_COPY(VoxelRenderer);
+	RE_NO_MOVE(VoxelRenderer);
+
+	friend class SceneRenderManager;
+
+public:
+	VoxelRenderer(SceneRenderManager& manager, VoxelImage image);
+	~VoxelRenderer();
+
+	/**
+	 * Marks the chunks of which the mesh depends on the voxel as changed:
+	 * the chunk of the voxel, and the chunks next to it when the voxel lies
+	 * on the border of its chunk.
+	 */
+	void Invalidate(unsigned x, unsigned y, unsigned z);
+
+	/**
+	 * Marks all chunks as changed.
+	 */
+	void InvalidateAll();
+
+	/**
+	 * Sets the model matrix of all chunks.
+	 */
+	void SetMatrix(const mat4& matrix);
+
+	/**
+	 * Returns whether any chunk is changed or being meshed.
+	 */
+	bool IsMeshing() const;
+
+private:
+	struct chunk {
+		std::optional<Model> model;
+		ModelRenderer::ObjectDataPtr object;
+
+		bool changed = false;
+		std::future<Model> mesh;
+	};
+
+	void _update();
+	void _reload();
+	void _remove_chunks();
+	void _invalidate(std::size_t index);
+	void _start_meshing(std::size_t index);
+	void _upload(std::size_t index, Model model);
+
+	SceneRenderManager& _manager;
+	VoxelImage _image;
+
+	// the palette of the image when the palette texture was created
+	std::array<Color, 256> _palette;
+	Image _palette_texture;
+	Material _material;
+	mat4 _matrix = glm::identity<mat4>();
+
+	uvec3 _chunk_count;
+	std::vector<chunk> _chunks;
+	std::vector<std::size_t> _changed_chunks;
+	std::vector<std::size_t> _meshing_chunks;
 
 };
 
@@ -10,6 +10,7 @@
 #include <mutex>
 #include <condition_variable>
 
+#include "AsyncTask.h"
 #include "Task.h"
 #include "Renderer/Display/DummyWindow.h"
 
@@ -49,6 +50,28 @@ public:
 		return future;
 	}
 
+	/**
+	 * Returns an awaitable which, when awaited in an AsyncTask, continues the
+	 * coroutine on one of the background threads of this pool.
+	 */
+	auto Schedule() {
+		struct awaiter {
+			ThreadPool& pool;
+
+			bool await_ready() const noexcept {
+				return false;
+			}
+
+			void await_suspend(std::coroutine_handle<> handle) {
+				pool.AddTask<void>([handle]() { handle.resume(); });
+			}
+
+			void await_resume() const noexcept {}
+		};
+
+		return awaiter{ *this };
+	}
+
 private:
 	std::unique_ptr<TaskBase> _get_next_task();
 
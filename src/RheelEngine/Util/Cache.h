@@ -5,15 +5,19 @@
 #define RHEELENGINE_CACHE_H
 #include "../_common.h"
 
+#include <algorithm>
+#include <array>
+#include <concepts>
 #include <mutex>
 #include <future>
 #include <condition_variable>
 #include <list>
-#include <queue>
+#include <optional>
+#include <string_view>
 
-namespace rheel {
+#include "CacheStatistics.h"
 
-// TODO: possible error condition: capacity=n, >n threads put at the same time
+namespace rheel {
 
 struct cache_policy {
 	virtual ~cache_policy() = default;
@@ -28,6 +32,12 @@ struct cache_policy {
 	 */
 	virtual void Insert(uintptr_t) {}
 
+	/**
+	 * Called when an element is removed from the cache by the cache itself,
+	 * instead of through MakeSpace()
+	 */
+	virtual void Erase(uintptr_t) = 0;
+
 	/**
 	 * Picks which element to remove
 	 */
@@ -40,37 +50,293 @@ struct cache_policy {
  * Simple policy where every element is kept for the duration of the cache
  */
 struct keep_policy : public cache_policy {
+	void Erase(uintptr_t) override {}
+
 	uintptr_t MakeSpace() override {
 		return dont_remove;
 	}
 };
 
+namespace detail {
+
+/**
+ * Node of an intrusive doubly-linked list of cache elements. Policies store
+ * their nodes in a node-based map, so moving an element within or between
+ * lists only relinks pointers, and never allocates.
+ */
+struct policy_node {
+	uintptr_t element;
+	policy_node* previous = nullptr;
+	policy_node* next = nullptr;
+	bool protect = false;
+};
+
+class policy_list {
+
+public:
+	void PushBack(policy_node* node) {
+		node->previous = _back;
+		node->next = nullptr;
+
+		if (_back == nullptr) {
+			_front = node;
+		} else {
+			_back->next = node;
+		}
+
+		_back = node;
+		_size++;
+	}
+
+	void Remove(policy_node* node) {
+		if (node->previous == nullptr) {
+			_front = node->next;
+		} else {
+			node->previous->next = node->next;
+		}
+
+		if (node->next == nullptr) {
+			_back = node->previous;
+		} else {
+			node->next->previous = node->previous;
+		}
+
+		node->previous = nullptr;
+		node->next = nullptr;
+		_size--;
+	}
+
+	policy_node* GetFront() const {
+		return _front;
+	}
+
+	std::size_t GetSize() const {
+		return _size;
+	}
+
+private:
+	policy_node* _front = nullptr;
+	policy_node* _back = nullptr;
+	std::size_t _size = 0;
+
+};
+
+}
+
 /**
  * Policy where the least-recently used element is removed when there is no
- * space left
+ * space left. Accessing an element only relinks it in the recency list, so
+ * the only allocation is done when an element is inserted.
  */
 struct least_recently_used_policy : public cache_policy {
-	void Access(uintptr_t key) const override {
-		_lru_list.erase(_index[key]);
-		_lru_list.push_back(key);
-		_index[key] = --_lru_list.cend();
+	least_recently_used_policy() = default;
+
+	RE_NO_COPY(least_recently_used_policy);
+	RE_DEFAULT_MOVE(least_recently_used_policy);
+
+	void Access(uintptr_t element) const override {
+		auto iter = _nodes.find(element);
+		if (iter == _nodes.end()) {
+			return;
+		}
+
+		_lru_list.Remove(&iter->second);
+		_lru_list.PushBack(&iter->second);
+	}
+
+	void Insert(uintptr_t element) override {
+		auto[iter, inserted] = _nodes.try_emplace(element, detail::policy_node{ element });
+		_lru_list.PushBack(&iter->second);
 	}
 
-	void Insert(uintptr_t key) override {
-		_lru_list.push_back(key);
-		_index[key] = --_lru_list.cend();
+	void Erase(uintptr_t element) override {
+		if (auto iter = _nodes.find(element); iter != _nodes.end()) {
+			_lru_list.Remove(&iter->second);
+			_nodes.erase(iter);
+		}
 	}
 
 	uintptr_t MakeSpace() override {
-		uintptr_t element = _lru_list.front();
-		_lru_list.pop_front();
-		_index.erase(element);
+		detail::policy_node* node = _lru_list.GetFront();
+		if (node == nullptr) {
+			return dont_remove;
+		}
+
+		uintptr_t element = node->element;
+		_lru_list.Remove(node);
+		_nodes.erase(element);
 		return element;
 	}
 
 private:
-	mutable std::list<uintptr_t> _lru_list;
-	mutable std::unordered_map<uintptr_t, std::list<uintptr_t>::const_iterator> _index;
+	mutable std::unordered_map<uintptr_t, detail::policy_node> _nodes;
+	mutable detail::policy_list _lru_list;
+
+};
+
+/**
+ * Approximation of the least-recently used policy. Accessing an element only
+ * sets its reference bit. When there is no space left, a clock hand sweeps
+ * over the elements, clearing the reference bits, and removes the first
+ * element that was not referenced since the last sweep.
+ */
+struct clock_policy : public cache_policy {
+	void Access(uintptr_t element) const override {
+		if (auto iter = _index.find(element); iter != _index.end()) {
+			_slots[iter->second].referenced = true;
+		}
+	}
+
+	void Insert(uintptr_t element) override {
+		std::size_t index;
+
+		if (_free_slots.empty()) {
+			index = _slots.size();
+			_slots.push_back({ element, false });
+		} else {
+			index = _free_slots.back();
+			_free_slots.pop_back();
+			_slots[index] = { element, false };
+		}
+
+		_index[element] = index;
+	}
+
+	void Erase(uintptr_t element) override {
+		if (auto iter = _index.find(element); iter != _index.end()) {
+			_slots[iter->second].element = dont_remove;
+			_free_slots.push_back(iter->second);
+			_index.erase(iter);
+		}
+	}
+
+	uintptr_t MakeSpace() override {
+		if (_index.empty()) {
+			return dont_remove;
+		}
+
+		while (true) {
+			if (_hand >= _slots.size()) {
+				_hand = 0;
+			}
+
+			std::size_t index = _hand++;
+			auto& slot = _slots[index];
+
+			if (slot.element == dont_remove) {
+				continue;
+			}
+
+			if (slot.referenced) {
+				slot.referenced = false;
+				continue;
+			}
+
+			uintptr_t element = slot.element;
+			slot.element = dont_remove;
+			_free_slots.push_back(index);
+			_index.erase(element);
+			return element;
+		}
+	}
+
+private:
+	struct clock_slot {
+		uintptr_t element;
+		bool referenced;
+	};
+
+	mutable std::vector<clock_slot> _slots;
+	std::vector<std::size_t> _free_slots;
+	std::unordered_map<uintptr_t, std::size_t> _index;
+	std::size_t _hand = 0;
+
+};
+
+/**
+ * Scan-resistant variant of the least-recently used policy. New elements are
+ * inserted in a probationary segment, and are moved to a protected segment
+ * when they are accessed again. Elements are removed from the probationary
+ * segment first, so a burst of elements that are used only once (e.g. when
+ * loading a level) does not remove the elements that are used all the time.
+ *
+ * The protected segment holds at most the given fraction of the elements. When
+ * it grows beyond that, its least-recently used element is moved back to the
+ * probationary segment.
+ */
+struct segmented_least_recently_used_policy : public cache_policy {
+	explicit segmented_least_recently_used_policy(float protected_fraction = 0.8f) :
+			_protected_fraction(protected_fraction) {}
+
+	RE_NO_COPY(segmented_least_recently_used_policy);
+	RE_DEFAULT_MOVE(segmented_least_recently_used_policy);
+
+	void Access(uintptr_t element) const override {
+		auto iter = _nodes.find(element);
+		if (iter == _nodes.end()) {
+			return;
+		}
+
+		detail::policy_node* node = &iter->second;
+
+		if (node->protect) {
+			_protected.Remove(node);
+			_protected.PushBack(node);
+			return;
+		}
+
+		_probation.Remove(node);
+		node->protect = true;
+		_protected.PushBack(node);
+
+		// demote the least-recently used protected elements
+		auto max_protected = std::size_t(double(_nodes.size()) * _protected_fraction);
+
+		while (_protected.GetSize() > std::max(max_protected, std::size_t(1))) {
+			detail::policy_node* demote = _protected.GetFront();
+			_protected.Remove(demote);
+			demote->protect = false;
+			_probation.PushBack(demote);
+		}
+	}
+
+	void Insert(uintptr_t element) override {
+		auto[iter, inserted] = _nodes.try_emplace(element, detail::policy_node{ element });
+		_probation.PushBack(&iter->second);
+	}
+
+	void Erase(uintptr_t element) override {
+		if (auto iter = _nodes.find(element); iter != _nodes.end()) {
+			(iter->second.protect ? _protected : _probation).Remove(&iter->second);
+			_nodes.erase(iter);
+		}
+	}
+
+	uintptr_t MakeSpace() override {
+		detail::policy_node* node = _probation.GetFront();
+		auto* list = &_probation;
+
+		if (node == nullptr) {
+			node = _protected.GetFront();
+			list = &_protected;
+		}
+
+		if (node == nullptr) {
+			return dont_remove;
+		}
+
+		uintptr_t element = node->element;
+		list->Remove(node);
+		_nodes.erase(element);
+		return element;
+	}
+
+private:
+	float _protected_fraction;
+
+	mutable std::unordered_map<uintptr_t, detail::policy_node> _nodes;
+	mutable detail::policy_list _probation;
+	mutable detail::policy_list _protected;
 
 };
 
@@ -78,121 +344,378 @@ private:
  * Policy where the oldest element is removed when there is no space left
  */
 struct last_in_frist_out_policy : public cache_policy {
-	void Insert(uintptr_t key) override {
-		_lifo_queue.push(key);
+	last_in_frist_out_policy() = default;
+
+	RE_NO_COPY(last_in_frist_out_policy);
+	RE_DEFAULT_MOVE(last_in_frist_out_policy);
+
+	void Insert(uintptr_t element) override {
+		auto[iter, inserted] = _nodes.try_emplace(element, detail::policy_node{ element });
+		_lifo_queue.PushBack(&iter->second);
+	}
+
+	void Erase(uintptr_t element) override {
+		if (auto iter = _nodes.find(element); iter != _nodes.end()) {
+			_lifo_queue.Remove(&iter->second);
+			_nodes.erase(iter);
+		}
 	}
 
 	uintptr_t MakeSpace() override {
-		uintptr_t element = _lifo_queue.front();
-		_lifo_queue.pop();
+		detail::policy_node* node = _lifo_queue.GetFront();
+		if (node == nullptr) {
+			return dont_remove;
+		}
+
+		uintptr_t element = node->element;
+		_lifo_queue.Remove(node);
+		_nodes.erase(element);
 		return element;
 	}
 
 private:
-	std::queue<uintptr_t> _lifo_queue;
+	std::unordered_map<uintptr_t, detail::policy_node> _nodes;
+	detail::policy_list _lifo_queue;
+
+};
 
+/**
+ * Cost function where every element costs 1, so the capacity of a cache is the
+ * maximum number of elements in it.
+ */
+struct element_cost {
+	template<typename V>
+	std::size_t operator()(const V&) const {
+		return 1;
+	}
 };
 
-template<typename K, typename V, typename Policy = keep_policy, bool threadsafe = false>
+/**
+ * Cost function where every element costs the amount of memory it uses, as
+ * reported by its GetMemoryUsage() method. The capacity of a cache is then its
+ * memory budget in bytes.
+ */
+struct memory_cost {
+	template<typename V>
+			requires requires(const V& value) { { value.GetMemoryUsage() } -> std::convertible_to<std::size_t>; }
+	std::size_t operator()(const V& value) const {
+		return value.GetMemoryUsage();
+	}
+};
+
+/**
+ * Hashing and equality of cache keys. By default, a key is looked up using the
+ * key type itself. String keys can be looked up using a std::string_view, so
+ * looking up a string literal or a view does not allocate.
+ */
+template<typename K>
+struct cache_key {
+	using lookup_type = const K&;
+	using hash = std::hash<K>;
+	using equal = std::equal_to<K>;
+};
+
+template<>
+struct cache_key<std::string> {
+	using lookup_type = std::string_view;
+
+	struct hash {
+		using is_transparent = void;
+
+		std::size_t operator()(std::string_view key) const {
+			return std::hash<std::string_view>()(key);
+		}
+	};
+
+	using equal = std::equal_to<>;
+};
+
+template<typename K, typename V, typename Policy = keep_policy, bool threadsafe = false, typename Cost = element_cost>
 class Cache;
 
+namespace detail {
+
+struct cache_base {
+	virtual ~cache_base() = default;
+	virtual void ReleaseMemory(float fraction) = 0;
+};
+
+template<typename K, typename V, typename Policy, typename Cost, std::size_t ShardCount>
+class concurrent_cache;
+
+}
+
 /**
- * Thread-safe cache implementation with several policies. Because of the
- * internals of the cache, it works best and fastest if the key type (K) is
- * trivially-copyable.
+ * Keeps track of all thread-safe caches, so memory can be released from all of
+ * them at once when memory is running low.
  */
-template<typename K, typename V, typename Policy>
-class Cache<K, V, Policy, true> {
+class CacheRegistry {
+	template<typename K, typename V, typename Policy, typename Cost, std::size_t ShardCount>
+	friend class detail::concurrent_cache;
+
+public:
+	/**
+	 * Signals that memory is running low. Every thread-safe cache evicts
+	 * elements, as dictated by its policy, until its total cost has been
+	 * reduced by the given fraction (between 0 and 1). Elements that are still
+	 * loading are never evicted, and neither are elements of caches with the
+	 * keep policy.
+	 */
+	static void SignalMemoryPressure(float fraction) {
+		fraction = std::clamp(fraction, 0.0f, 1.0f);
+
+		std::lock_guard lock(_mutex());
+
+		for (auto* cache : _caches()) {
+			cache->ReleaseMemory(fraction);
+		}
+	}
+
+private:
+	static void _register(detail::cache_base* cache) {
+		std::lock_guard lock(_mutex());
+		_caches().insert(cache);
+	}
+
+	static void _unregister(detail::cache_base* cache) {
+		std::lock_guard lock(_mutex());
+		_caches().erase(cache);
+	}
+
+	static std::mutex& _mutex() {
+		static std::mutex mutex;
+		return mutex;
+	}
+
+	static std::unordered_set<detail::cache_base*>& _caches() {
+		static std::unordered_set<detail::cache_base*> caches;
+		return caches;
+	}
+
+};
+
+namespace detail {
+
+/**
+ * Implementation of the thread-safe caches. Keys, values and their loading
+ * state are stored together in a single table, so a lookup only hashes the
+ * key once. The table is split into a number of shards, each with its own
+ * lock, based on the hash of the key.
+ *
+ * The capacity, the total cost and the policy are shared by all shards, so
+ * elements are evicted in the order of the policy regardless of their shard.
+ * They are guarded either by the lock of a shard together with the budget
+ * lock, or by the locks of all shards. The budget lock is always locked last.
+ * With a single shard, the lock of the shard guards everything.
+ */
+template<typename K, typename V, typename Policy, typename Cost, std::size_t ShardCount>
+class concurrent_cache : public cache_base {
+	static_assert(ShardCount > 0, "A cache needs at least one shard");
+
+	RE_NO_COPY(concurrent_cache);
+	RE_NO_MOVE(concurrent_cache);
+
+	struct loading_state {
+		std::condition_variable condition_variable;
+		bool done = false;
+	};
+
+	/*
+	 * An entry can be in one of the following states:
+	 *  - loaded: value is set, loading is not;
+	 *  - loading for the first time: loading is set, value is not;
+	 *  - reloading after an invalidation: both are set. The old value stays
+	 *    available until the new one has been constructed.
+	 * Only loaded entries are known to the policy. A stale entry is reloaded on
+	 * its next access. The value is shared, so a reload swaps in a new value
+	 * while GetShared() handles to the old value keep it alive.
+	 */
+	struct cache_entry {
+		std::shared_ptr<V> value;
+		std::size_t cost = 0;
+		std::shared_ptr<loading_state> loading;
+		bool stale = false;
+	};
+
+	using Table = std::unordered_map<K, cache_entry, typename cache_key<K>::hash, typename cache_key<K>::equal>;
+	using Node = typename Table::value_type;
+
+	struct cache_shard {
+		Table table;
+		mutable std::mutex mutex;
+	};
+
+	using ShardLocks = std::array<std::unique_lock<std::mutex>, ShardCount>;
 
 public:
 	using SizeType = size_t;
+	using KeyType = typename cache_key<K>::lookup_type;
 
 	/**
 	 * Constructs a cache with the maximum possible size
 	 */
-	explicit Cache(Policy&& policy = Policy()) :
-			Cache(std::numeric_limits<SizeType>::max(), std::forward<Policy>(policy)) {}
+	explicit concurrent_cache(Policy&& policy = Policy()) :
+			concurrent_cache(std::numeric_limits<SizeType>::max(), std::forward<Policy>(policy)) {}
 
 	/**
-	 * Constructs a cache with a maximum number of elements.
+	 * Constructs a cache with a maximum total cost of its elements.
 	 */
-	explicit Cache(SizeType capacity, Policy&& policy = Policy()) :
+	explicit concurrent_cache(SizeType capacity, Policy&& policy = Policy()) :
 			_capacity(capacity),
-			_policy(std::forward<Policy>(policy)) {}
+			_policy(std::forward<Policy>(policy)) {
+
+		CacheRegistry::_register(this);
+	}
+
+	~concurrent_cache() override {
+		CacheRegistry::_unregister(this);
+	}
 
 	/**
 	 * Returns the amount of elements in the cache, including the elements that
 	 * are currently loading.
 	 */
 	SizeType GetSize() const {
-		return _size;
+		SizeType size = 0;
+
+		for (const auto& shard : _shards) {
+			std::lock_guard lock(shard.mutex);
+			size += shard.table.size();
+		}
+
+		return size;
+	}
+
+	/**
+	 * Returns the total cost of the loaded elements in the cache.
+	 */
+	SizeType GetCost() const {
+		auto locks = _lock_shards();
+		return _cost;
 	}
 
 	/**
 	 * Returns the capacity of the cache.
 	 */
 	SizeType GetCapacity() const {
+		auto locks = _lock_shards();
 		return _capacity;
 	}
 
+	/**
+	 * Sets the capacity of the cache. If the current cost of the cache exceeds
+	 * the new capacity, elements are evicted until it fits.
+	 */
+	void SetCapacity(SizeType capacity) {
+		auto locks = _lock_shards();
+
+		_capacity = capacity;
+		_evict(0);
+	}
+
+	/**
+	 * Evicts elements, as dictated by the policy, until the total cost of the
+	 * cache is at most the given cost. Returns the number of evicted elements.
+	 */
+	SizeType Trim(SizeType cost) {
+		auto locks = _lock_shards();
+		return _trim(cost);
+	}
+
+	/**
+	 * Evicts the given fraction of the total cost of the cache.
+	 */
+	void ReleaseMemory(float fraction) override {
+		auto locks = _lock_shards();
+		_trim(SizeType(double(_cost) * (1.0 - fraction)));
+	}
+
+	/**
+	 * Sets the name under which the statistics of this cache are reported.
+	 *
+	 * @see CacheStatistics
+	 */
+	void SetName(std::string name) {
+		_statistics.SetName(std::move(name));
+	}
+
 	/**
 	 * Returns whether the cache contains the key.
 	 */
-	bool ContainsKey(const K& key) const {
-		std::lock_guard lock(_mutex);
-		return _key_set.find(key) != _key_set.end();
+	bool ContainsKey(KeyType key) const {
+		const cache_shard& shard = _shard(key);
+
+		std::lock_guard lock(shard.mutex);
+		return shard.table.find(key) != shard.table.end();
 	}
 
 	/**
 	 * Returns the value for the given key. If the key is not in this cache,
 	 * this causes undefined behaviour.
 	 */
-	const V& Get(const K& key) const {
-		std::lock_guard lock(_mutex);
+	const V& Get(KeyType key) const {
+		const cache_shard& shard = _shard(key);
+		std::lock_guard lock(shard.mutex);
 
-		auto element = reinterpret_cast<uintptr_t>(&(*_key_set.find(key)));
-		_policy.Access(element);
+		auto iter = shard.table.find(key);
+		_access(*iter);
 
-		return _cache.find(element)->second;
+		return *iter->second.value;
 	}
 
 	/**
 	 * Returns the value for the given key. If the key is not in this cache,
 	 * this causes undefined behaviour.
 	 */
-	V& Get(const K& key) {
-		std::lock_guard lock(_mutex);
+	V& Get(KeyType key) {
+		cache_shard& shard = _shard(key);
+		std::lock_guard lock(shard.mutex);
 
-		auto element = reinterpret_cast<uintptr_t>(&(*_key_set.find(key)));
-		_policy.Access(element);
+		auto iter = shard.table.find(key);
+		_access(*iter);
 
-		return _cache.find(element)->second;
+		return *iter->second.value;
 	}
 
 	/**
 	 * Atomically checks if a value for the key exists, and inserts a new value
 	 * for the key if it does not exist. The value should be created by the
 	 * constructor parameter. Returned is a reference to the (possibly newly
-	 * inserted) reference and a bool denoting whether a new value was inserted.
+	 * inserted) value.
+	 *
+	 * The value is constructed without holding the lock to the cache, so
+	 * values for different keys can be constructed concurrently. Concurrent
+	 * requests for a key that is being constructed wait for that construction
+	 * only.
 	 *
 	 * Depending on the cache policy, this might cause other elements to be
-	 * removed from the cache.
+	 * removed from the cache. The returned reference is only valid until the
+	 * value is evicted, erased or reloaded. If other threads can cause that,
+	 * use GetShared() or GetCopy() instead.
 	 */
 	template<typename Constructor>
-	V& Get(const K& key, Constructor&& constructor) {
-		// ensure that no other thread is modifying the cache while the element
-		// is loading/constructing. This is needed to ensure the element is
-		// removed from the cache before it is accessed.
-		std::lock_guard lock(_mutex);
-
-		bool changed = Put(key, std::forward<Constructor&&>(constructor));
-		auto element = reinterpret_cast<uintptr_t>(&(*_key_set.find(key)));
+	V& Get(KeyType key, Constructor&& constructor) {
+		return *_get_or_put(key, constructor, true, [](const std::shared_ptr<V>& value, bool) { return value.get(); });
+	}
 
-		if (!changed) {
-			_policy.Access(element);
-		}
+	/**
+	 * Same as Get(KeyType, Constructor&&), but returns a handle that shares
+	 * the value with the cache. The value stays valid for as long as the
+	 * handle exists, even after it is evicted, erased or reloaded.
+	 */
+	template<typename Constructor>
+	std::shared_ptr<V> GetShared(KeyType key, Constructor&& constructor) {
+		return _get_or_put(key, constructor, true, [](const std::shared_ptr<V>& value, bool) { return value; });
+	}
 
-		return _cache.find(element)->second;
+	/**
+	 * Same as Get(KeyType, Constructor&&), but returns a copy of the value.
+	 * The copy is made while the value is guaranteed to be in the cache, so
+	 * this is safe to use while other threads evict elements.
+	 */
+	template<typename Constructor>
+	V GetCopy(KeyType key, Constructor&& constructor) {
+		return _get_or_put(key, constructor, true, [](const std::shared_ptr<V>& value, bool) { return *value; });
 	}
 
 	/**
@@ -207,93 +730,402 @@ public:
 	 * Returns whether the element was newly inserted in the cache.
 	 */
 	template<typename Constructor>
-	bool Put(const K& key, Constructor&& constructor) {
-		uintptr_t pointer;
+	bool Put(KeyType key, Constructor&& constructor) {
+		return _get_or_put(key, constructor, false, [](const std::shared_ptr<V>&, bool inserted) { return inserted; });
+	}
+
+	/**
+	 * Removes the key and its value from the cache. Returns whether the cache
+	 * contained the key.
+	 *
+	 * If the value is still being loaded, the threads that requested it will
+	 * still receive it, but it is marked stale, so it will be loaded again on
+	 * its next access.
+	 */
+	bool Erase(KeyType key) {
+		cache_shard& shard = _shard(key);
+		std::lock_guard lock(shard.mutex);
 
-		// First check that the cache does not yet contain the key. Otherwise
-		// check if it is already being loaded. If neither: add it to the
-		// loading set and make space for the element.
+		auto iter = shard.table.find(key);
+		if (iter == shard.table.end()) {
+			return false;
+		}
+
+		auto budget = _lock_budget();
+		_erase(shard.table, iter);
+		return true;
+	}
+
+	/**
+	 * Marks the value of the key as stale, so it will be constructed again on
+	 * its next access. Until the new value has been constructed, the old
+	 * value stays in the cache. After that, threads that hold the old value
+	 * through GetShared() can keep using it, but references to it returned by
+	 * Get() are no longer valid. If constructing the new value fails, the old
+	 * value is kept, and stays stale. Returns whether the cache contained the
+	 * key.
+	 */
+	bool Invalidate(KeyType key) {
+		cache_shard& shard = _shard(key);
+		std::lock_guard lock(shard.mutex);
+
+		auto iter = shard.table.find(key);
+		if (iter == shard.table.end()) {
+			return false;
+		}
+
+		iter->second.stale = true;
+		return true;
+	}
+
+	/**
+	 * Removes all keys and values from the cache. Values that are still being
+	 * loaded are marked stale instead, as with Erase().
+	 */
+	void Clear() {
+		auto locks = _lock_shards();
+
+		for (auto& shard : _shards) {
+			for (auto iter = shard.table.begin(); iter != shard.table.end();) {
+				auto next = std::next(iter);
+				_erase(shard.table, iter);
+				iter = next;
+			}
+		}
+	}
+
+private:
+	/**
+	 * Looks up the value for the key, constructing and inserting it first if
+	 * it does not exist. The result function is called with the shared value
+	 * and whether it was newly inserted, while holding the lock.
+	 */
+	template<typename Constructor, typename Result>
+	auto _get_or_put(KeyType key, Constructor& constructor, bool access, Result&& result) {
+		cache_shard& shard = _shard(key);
+		Node* node;
+		std::shared_ptr<loading_state> loading;
+
+		// First check that the cache does not yet contain an up-to-date value
+		// for the key. Otherwise check if it is already being loaded, and wait
+		// for that to finish. If neither: insert it as a loading entry, or
+		// start reloading the stale entry.
 		{
-			std::unique_lock lock(_mutex);
+			std::unique_lock lock(shard.mutex);
+
+			while (true) {
+				auto iter = shard.table.find(key);
+				if (iter == shard.table.end()) {
+					auto[inserted_iter, inserted] = shard.table.try_emplace(K(key));
+					node = &(*inserted_iter);
+					break;
+				}
 
-			if (auto iter = _key_set.find(key); iter != _key_set.end()) {
-				auto element = reinterpret_cast<uintptr_t>(&(*_key_set.find(key)));
+				if (iter->second.loading) {
+					// Wait for the element to finish loading. Only the threads
+					// waiting for this element are woken up. Afterwards, look
+					// the key up again: the constructor could have thrown, or
+					// the element could have been evicted in the meantime.
+					_statistics.Wait();
 
-				if (_cache.find(element) != _cache.end()) {
-					return false;
+					std::shared_ptr<loading_state> state = iter->second.loading;
+					state->condition_variable.wait(lock, [&]() { return state->done; });
+					continue;
 				}
 
-				if (auto iter_2 = _loading.find(element); iter_2 != _loading.end()) {
-					iter_2->second->wait(lock, [&]() { return _loading.find(element) == _loading.end(); });
-					return false;
+				if (!iter->second.stale) {
+					if (access) {
+						_access(*iter);
+					}
+
+					_statistics.Hit();
+					return result(iter->second.value, false);
 				}
+
+				// The value is stale. Keep it available for the threads that
+				// still use it, but take it out of the policy while reloading,
+				// so it cannot be evicted.
+				node = &(*iter);
+
+				auto budget = _lock_budget();
+				_unload(*node);
+				node->second.stale = false;
+				break;
 			}
 
-			// make space for the new element
-			if (_size == _capacity) {
-				uintptr_t remove = _policy.MakeSpace();
-				_cache.erase(remove);
-				_key_set.erase(*reinterpret_cast<K*>(remove));
-				_size--;
+			loading = std::make_shared<loading_state>();
+			node->second.loading = loading;
+
+			_statistics.Miss();
+		}
+
+		// construct the value, without holding the lock. The node is not
+		// removed while it is loading, so its key stays valid.
+		std::shared_ptr<V> value;
+		std::size_t cost;
+
+		try {
+			auto start = _statistics.StartLoad();
+			value = std::make_shared<V>(constructor(node->first));
+			_statistics.FinishLoad(start);
+
+			cost = Cost()(*value);
+		} catch (...) {
+			std::unique_lock lock(shard.mutex);
+
+			if (!node->second.value) {
+				// remove the key again, and let waiting threads try for
+				// themselves
+				shard.table.erase(shard.table.find(node->first));
+			} else {
+				// keep the old value, and reload it again on its next access
+				auto space = _make_space(lock, node->second.cost);
+				_load(*node, node->second.cost);
+				node->second.stale = true;
 			}
 
-			// initial insertion into the cache
-			auto[iter, inserted] = _key_set.insert(key);
-			pointer = reinterpret_cast<uintptr_t>(&(*iter));
-			_size++;
+			_finish_loading(*loading);
+			throw;
+		}
+
+		// Make space for the new element, now that its cost is known. Add the
+		// value to the cache and notify any waiting threads that the value has
+		// finished loading. If the element was erased or invalidated while it
+		// was loading, it stays stale, and will be reloaded on its next access.
+		std::unique_lock lock(shard.mutex);
+		auto space = _make_space(lock, cost);
+
+		// add the asset to the cache, replacing the old value. Threads that
+		// share the old value keep it alive.
+		node->second.value = std::move(value);
+		_load(*node, cost);
 
-			// insert the key into the loading map, and default-construct the
-			// condition_variable.
-			_loading[pointer] = std::make_unique<std::condition_variable_any>();
+		// notify waiting threads
+		_finish_loading(*loading);
+
+		return result(node->second.value, true);
+	}
+
+	/**
+	 * Evicts elements until an element with the given cost fits in the cache,
+	 * while holding the lock of the shard of the element. Evicting can remove
+	 * elements of any shard, so it needs the locks of all shards: if elements
+	 * have to be evicted, the lock of the shard is released, and the locks of
+	 * all shards are taken instead. Returned are the locks that guard the
+	 * budget of the cache afterwards.
+	 */
+	std::pair<std::unique_lock<std::mutex>, ShardLocks> _make_space(std::unique_lock<std::mutex>& lock, std::size_t cost) {
+		auto budget = _lock_budget();
+		ShardLocks locks;
+
+		if (cost > _capacity || _cost > _capacity - cost) {
+			if constexpr (ShardCount > 1) {
+				budget.unlock();
+				lock.unlock();
+				locks = _lock_shards();
+			}
+
+			_evict(cost);
 		}
 
-		// construct the value
-		V value = constructor(key);
+		return { std::move(budget), std::move(locks) };
+	}
 
-		// Add the value to the cache, remove it from the loading set and notify
-		// any waiting threads that the value has finished loading. Also notify
-		// the cache policy that a new element has been inserted.
-		{
-			std::lock_guard lock(_mutex);
+	/**
+	 * Notifies the policy of an access to a loaded entry. The keep policy
+	 * ignores accesses, so reads from caches with that policy never contend
+	 * for the budget lock.
+	 */
+	void _access(const Node& node) const {
+		if constexpr (!std::is_same_v<Policy, keep_policy>) {
+			auto budget = _lock_budget();
+			_policy.Access(_element(node));
+		}
+	}
+
+	/**
+	 * Adds an entry that has finished loading to the policy and the cost of
+	 * the cache.
+	 */
+	void _load(Node& node, std::size_t cost) {
+		node.second.cost = cost;
+		node.second.loading = nullptr;
 
-			// add the asset to the cache
-			_cache.try_emplace(pointer, std::move(value));
+		_cost += cost;
+		_loaded++;
 
-			// remove the key from the loading set
-			auto condition_variable = std::move(_loading[pointer]);
-			_loading.erase(pointer);
+		_policy.Insert(_element(node));
+	}
 
-			// notify the policy of the insertion
-			_policy.Insert(pointer);
+	/**
+	 * Removes a loaded entry from the policy and the cost of the cache. The
+	 * entry itself is kept.
+	 */
+	void _unload(Node& node) {
+		_policy.Erase(_element(node));
+		_cost -= node.second.cost;
+		_loaded--;
+	}
 
-			// notify waiting threads
-			condition_variable->notify_all();
+	/**
+	 * Erases the entry if it is loaded. If it is still loading, it is marked
+	 * stale instead, as the loading thread still needs it.
+	 */
+	void _erase(Table& table, typename Table::iterator iter) {
+		if (iter->second.loading) {
+			iter->second.stale = true;
+			return;
 		}
 
-		return true;
+		_unload(*iter);
+		table.erase(iter);
+	}
+
+	void _finish_loading(loading_state& loading) {
+		loading.done = true;
+		loading.condition_variable.notify_all();
+	}
+
+	/**
+	 * Evicts elements until an element with the given cost fits in the cache.
+	 */
+	void _evict(std::size_t cost) {
+		if (cost > _capacity) {
+			_trim(0);
+		} else {
+			_trim(_capacity - cost);
+		}
+	}
+
+	SizeType _trim(SizeType cost) {
+		SizeType evicted = 0;
+
+		while (_cost > cost && _loaded > 0) {
+			uintptr_t remove = _policy.MakeSpace();
+			if (remove == cache_policy::dont_remove) {
+				break;
+			}
+
+			Node* node = reinterpret_cast<Node*>(remove);
+			Table& table = _shards[_shard_index(node->first)].table;
+
+			_cost -= node->second.cost;
+			_loaded--;
+			table.erase(table.find(node->first));
+			evicted++;
+
+			_statistics.Evict();
+		}
+
+		return evicted;
+	}
+
+	const cache_shard& _shard(KeyType key) const {
+		return _shards[_shard_index(key)];
+	}
+
+	cache_shard& _shard(KeyType key) {
+		return _shards[_shard_index(key)];
+	}
+
+	/**
+	 * Locks all shards, in order.
+	 */
+	ShardLocks _lock_shards() const {
+		ShardLocks locks;
+
+		for (std::size_t i = 0; i < ShardCount; i++) {
+			locks[i] = std::unique_lock(_shards[i].mutex);
+		}
+
+		return locks;
+	}
+
+	/**
+	 * Locks the budget, while holding the lock of a single shard.
+	 */
+	std::unique_lock<std::mutex> _lock_budget() const {
+		if constexpr (ShardCount == 1) {
+			return {};
+		} else {
+			return std::unique_lock(_budget_mutex);
+		}
+	}
+
+	static std::size_t _shard_index(KeyType key) {
+		if constexpr (ShardCount == 1) {
+			return 0;
+		} else {
+			// Mix the hash before selecting a shard. Otherwise the shard would
+			// be correlated with the bucket the key ends up in within the
+			// shard.
+			std::uint64_t hash = typename cache_key<K>::hash()(key);
+			hash ^= hash >> 33;
+			hash *= 0xff51afd7ed558ccdull;
+			hash ^= hash >> 33;
+
+			return hash % ShardCount;
+		}
+	}
+
+	/**
+	 * The policies identify elements by the address of their node in the
+	 * table, which is stable for as long as the element is in the cache.
+	 */
+	static uintptr_t _element(const Node& node) {
+		return reinterpret_cast<uintptr_t>(&node);
 	}
 
 private:
-	SizeType _size = 0;
+	SizeType _cost = 0;
 	SizeType _capacity;
+	SizeType _loaded = 0;
 
-	std::unordered_set<K> _key_set;
-	std::unordered_map<uintptr_t, V> _cache;
-
-	std::unordered_map<uintptr_t, std::unique_ptr<std::condition_variable_any>> _loading;
-	mutable std::recursive_mutex _mutex;
+	std::array<cache_shard, ShardCount> _shards;
+	mutable std::mutex _budget_mutex;
 
 	Policy _policy;
+	CacheStatistics _statistics{ typeid(K), typeid(V) };
+};
+
+}
+
+/**
+ * Thread-safe cache implementation with several policies. Keys, values and
+ * their loading state are stored together in a single table, so a lookup only
+ * hashes the key once. String keys can be looked up using a std::string_view
+ * without allocating.
+ *
+ * The capacity of the cache is expressed in the unit of the cost function. By
+ * default every element costs 1, but with memory_cost the capacity becomes a
+ * memory budget. When inserting an element would exceed the capacity, elements
+ * are evicted as dictated by the policy until it fits again.
+ */
+template<typename K, typename V, typename Policy, typename Cost>
+class Cache<K, V, Policy, true, Cost> : public detail::concurrent_cache<K, V, Policy, Cost, 1> {
+
+public:
+	using detail::concurrent_cache<K, V, Policy, Cost, 1>::concurrent_cache;
+
 };
 
 /**
  * Non-thread-safe cache implementation
  */
-template<typename K, typename V, typename Policy>
-class Cache<K, V, Policy, false> {
+template<typename K, typename V, typename Policy, typename Cost>
+class Cache<K, V, Policy, false, Cost> {
+
+	struct cache_entry {
+		V value;
+		std::size_t cost;
+	};
+
+	using Table = std::unordered_map<K, cache_entry, typename cache_key<K>::hash, typename cache_key<K>::equal>;
+	using Node = typename Table::value_type;
 
 public:
 	using SizeType = size_t;
+	using KeyType = typename cache_key<K>::lookup_type;
 
 	/**
 	 * Constructs a cache with the maximum possible size
@@ -302,18 +1134,24 @@ public:
 			Cache(std::numeric_limits<SizeType>::max(), std::forward<Policy>(policy)) {}
 
 	/**
-	 * Constructs a cache with a maximum number of elements.
+	 * Constructs a cache with a maximum total cost of its elements.
 	 */
 	explicit Cache(SizeType capacity, Policy&& policy = Policy()) :
 			_capacity(capacity),
 			_policy(std::forward<Policy>(policy)) {}
 
 	/**
-	 * Returns the amount of elements in the cache, including the elements that
-	 * are currently loading.
+	 * Returns the amount of elements in the cache.
 	 */
 	SizeType GetSize() const {
-		return _size;
+		return _cache.size();
+	}
+
+	/**
+	 * Returns the total cost of the elements in the cache.
+	 */
+	SizeType GetCost() const {
+		return _cost;
 	}
 
 	/**
@@ -323,69 +1161,138 @@ public:
 		return _capacity;
 	}
 
+	/**
+	 * Sets the capacity of the cache. If the current cost of the cache exceeds
+	 * the new capacity, elements are evicted until it fits.
+	 */
+	void SetCapacity(SizeType capacity) {
+		_capacity = capacity;
+		Trim(capacity);
+	}
+
+	/**
+	 * Evicts elements, as dictated by the policy, until the total cost of the
+	 * cache is at most the given cost. Returns the number of evicted elements.
+	 */
+	SizeType Trim(SizeType cost) {
+		SizeType evicted = 0;
+
+		while (_cost > cost && !_cache.empty()) {
+			uintptr_t remove = _policy.MakeSpace();
+			if (remove == cache_policy::dont_remove) {
+				break;
+			}
+
+			Node* node = reinterpret_cast<Node*>(remove);
+			_cost -= node->second.cost;
+			_cache.erase(_cache.find(node->first));
+			evicted++;
+
+			_statistics.Evict();
+		}
+
+		return evicted;
+	}
+
+	/**
+	 * Sets the name under which the statistics of this cache are reported.
+	 *
+	 * @see CacheStatistics
+	 */
+	void SetName(std::string name) {
+		_statistics.SetName(std::move(name));
+	}
+
 	/**
 	 * Returns whether the cache contains the key.
 	 */
-	bool ContainsKey(const K& key) const {
-		return _key_set.find(key) != _key_set.end();
+	bool ContainsKey(KeyType key) const {
+		return _cache.find(key) != _cache.end();
+	}
+
+	/**
+	 * Removes the key and its value from the cache. Returns whether the cache
+	 * contained the key.
+	 */
+	bool Erase(KeyType key) {
+		auto iter = _cache.find(key);
+		if (iter == _cache.end()) {
+			return false;
+		}
+
+		_policy.Erase(_element(*iter));
+		_cost -= iter->second.cost;
+		_cache.erase(iter);
+		return true;
 	}
 
 	/**
 	 * Clears the cache.
-	 *
-	 * TODO: create this for the multithreaded cache
-	 * TODO: test
 	 */
 	void Clear() {
-		_size = 0;
+		for (const auto& node : _cache) {
+			_policy.Erase(_element(node));
+		}
 
-		_key_set.clear();
+		_cost = 0;
 		_cache.clear();
+	}
 
-		_policy = Policy();
+	/**
+	 * Calls the function with every key and value in the cache, without
+	 * counting as an access for the policy. The function must not add
+	 * elements to or remove elements from the cache.
+	 */
+	template<typename Function>
+	void ForEach(Function&& function) {
+		for (auto&[key, entry] : _cache) {
+			function(key, entry.value);
+		}
 	}
 
 	/**
 	 * Returns the value for the given key. If the key is not in this cache,
 	 * this causes undefined behaviour.
 	 */
-	const V& Get(const K& key) const {
-		auto element = reinterpret_cast<uintptr_t>(&(*_key_set.find(key)));
-		_policy.Access(element);
+	const V& Get(KeyType key) const {
+		auto iter = _cache.find(key);
+		_policy.Access(_element(*iter));
 
-		return _cache.find(element)->second;
+		return iter->second.value;
 	}
 
 	/**
 	 * Returns the value for the given key. If the key is not in this cache,
 	 * this causes undefined behaviour.
 	 */
-	V& Get(const K& key) {
-		auto element = reinterpret_cast<uintptr_t>(&(*_key_set.find(key)));
-		_policy.Access(element);
+	V& Get(KeyType key) {
+		auto iter = _cache.find(key);
+		_policy.Access(_element(*iter));
 
-		return _cache.find(element)->second;
+		return iter->second.value;
 	}
 
 	/**
 	 * Atomically checks if a value for the key exists, and inserts a new value
 	 * for the key if it does not exist. The value should be created by the
 	 * constructor parameter. Returned is a reference to the (possibly newly
-	 * inserted) reference and a bool denoting whether a new value was inserted.
+	 * inserted) value.
 	 *
 	 * Depending on the cache policy, this might cause other elements to be
 	 * removed from the cache.
 	 */
 	template<typename Constructor>
-	V& Get(const K& key, Constructor&& constructor) {
-		bool changed = Put(key, std::forward<Constructor&&>(constructor));
-		auto element = reinterpret_cast<uintptr_t>(&(*_key_set.find(key)));
+	V& Get(KeyType key, Constructor&& constructor) {
+		auto iter = _cache.find(key);
+
+		if (iter != _cache.end()) {
+			_policy.Access(_element(*iter));
+			_statistics.Hit();
 
-		if (!changed) {
-			_policy.Access(element);
+			return iter->second.value;
 		}
 
-		return _cache.find(element)->second;
+		return _insert(key, constructor).second.value;
 	}
 
 	/**
@@ -398,44 +1305,58 @@ public:
 	 * Returns whether the element was newly inserted in the cache.
 	 */
 	template<typename Constructor>
-	bool Put(const K& key, Constructor&& constructor) {
-		uintptr_t pointer;
-
+	bool Put(KeyType key, Constructor&& constructor) {
 		// First check that the cache does not yet contain the key.
-		if (auto iter = _key_set.find(key); iter != _key_set.end()) {
+		if (_cache.find(key) != _cache.end()) {
+			_statistics.Hit();
 			return false;
 		}
 
-		// make space for the new element
-		if (_size == _capacity) {
-			uintptr_t remove = _policy.MakeSpace();
-			_cache.erase(remove);
-			_key_set.erase(*reinterpret_cast<K*>(remove));
-			_size--;
-		}
+		_insert(key, constructor);
+		return true;
+	}
 
-		// initial insertion into the cache
-		auto[iter, inserted] = _key_set.insert(key);
-		pointer = reinterpret_cast<uintptr_t>(&(*iter));
-		_size++;
+private:
+	template<typename Constructor>
+	Node& _insert(KeyType key, Constructor& constructor) {
+		_statistics.Miss();
+
+		// construct the value, and make space for it
+		K stored_key(key);
+
+		auto start = _statistics.StartLoad();
+		V value = constructor(static_cast<const K&>(stored_key));
+		_statistics.FinishLoad(start);
+
+		std::size_t cost = Cost()(value);
+		Trim(cost > _capacity ? 0 : _capacity - cost);
 
 		// add the asset to the cache
-		_cache.try_emplace(pointer, constructor(key));
+		auto[iter, inserted] = _cache.try_emplace(std::move(stored_key), cache_entry{ std::move(value), cost });
+		_cost += cost;
 
 		// notify the policy of the insertion
-		_policy.Insert(pointer);
+		_policy.Insert(_element(*iter));
 
-		return true;
+		return *iter;
+	}
+
+	/**
+	 * The policies identify elements by the address of their node in the
+	 * table, which is stable for as long as the element is in the cache.
+	 */
+	static uintptr_t _element(const Node& node) {
+		return reinterpret_cast<uintptr_t>(&node);
 	}
 
 private:
-	SizeType _size = 0;
+	SizeType _cost = 0;
 	SizeType _capacity;
 
-	std::unordered_set<K> _key_set;
-	std::unordered_map<uintptr_t, V> _cache;
+	Table _cache;
 
 	Policy _policy;
+	CacheStatistics _statistics{ typeid(K), typeid(V) };
 };
 
 }
@@ -0,0 +1,186 @@
+/*
+ * Copyright (c) Levi van Rheenen. All rights reserved.
+ */
+#include "CacheStatistics.h"
+
+#include <cstdlib>
+#include <mutex>
+#include <sstream>
+
+#if defined(__GNUG__)
+#include <cxxabi.h>
+#endif
+
+namespace rheel {
+
+static std::mutex& registry_mutex() {
+	static std::mutex mutex;
+	return mutex;
+}
+
+static std::unordered_set<CacheStatistics*>& registry() {
+	static std::unordered_set<CacheStatistics*> caches;
+	return caches;
+}
+
+static std::string type_name(const std::type_info& type) {
+#if defined(__GNUG__)
+	int status;
+	char* demangled = abi::__cxa_demangle(type.name(), nullptr, nullptr, &status);
+
+	if (status == 0) {
+		std::string name = demangled;
+		std::free(demangled);
+		return name;
+	}
+#endif
+
+	return type.name();
+}
+
+CacheStatistics::CacheStatistics(const std::type_info& key_type, const std::type_info& value_type) :
+		_key_type(key_type),
+		_value_type(value_type) {
+
+	if constexpr (enabled) {
+		std::lock_guard lock(registry_mutex());
+		registry().insert(this);
+	}
+}
+
+CacheStatistics::~CacheStatistics() {
+	if constexpr (enabled) {
+		std::lock_guard lock(registry_mutex());
+		registry().erase(this);
+	}
+}
+
+void CacheStatistics::SetName(std::string name) {
+	std::lock_guard lock(registry_mutex());
+	_name = std::move(name);
+}
+
+cache_statistics CacheStatistics::GetSnapshot() const {
+	cache_statistics statistics;
+
+	{
+		std::lock_guard lock(registry_mutex());
+		statistics.name = _name;
+	}
+
+	if (statistics.name.empty()) {
+		statistics.name = "Cache<" + type_name(_key_type) + ", " + type_name(_value_type) + ">";
+	}
+
+	statistics.hits = _hits.load(std::memory_order_relaxed);
+	statistics.misses = _misses.load(std::memory_order_relaxed);
+	statistics.waits = _waits.load(std::memory_order_relaxed);
+	statistics.evictions = _evictions.load(std::memory_order_relaxed);
+	statistics.load_time = std::chrono::nanoseconds(_load_time.load(std::memory_order_relaxed));
+
+	for (std::size_t i = 0; i < cache_statistics::histogram_buckets; i++) {
+		statistics.load_time_histogram[i] = _load_time_histogram[i].load(std::memory_order_relaxed);
+	}
+
+	return statistics;
+}
+
+void CacheStatistics::_add_load_time(Clock::duration duration) {
+	auto nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+	_load_time.fetch_add(nanoseconds, std::memory_order_relaxed);
+
+	// find the power of two bucket of the duration in microseconds
+	auto microseconds = std::uint64_t(nanoseconds / 1000);
+	std::size_t bucket = 0;
+
+	while (microseconds > 0 && bucket < cache_statistics::histogram_buckets - 1) {
+		microseconds >>= 1;
+		bucket++;
+	}
+
+	_load_time_histogram[bucket].fetch_add(1, std::memory_order_relaxed);
+}
+
+std::vector<cache_statistics> CacheStatistics::GetAll() {
+	std::vector<CacheStatistics*> caches;
+
+	{
+		std::lock_guard lock(registry_mutex());
+		caches.assign(registry().begin(), registry().end());
+	}
+
+	std::map<std::string, cache_statistics> combined;
+
+	for (const auto* cache : caches) {
+		cache_statistics statistics = cache->GetSnapshot();
+		auto[iter, inserted] = combined.try_emplace(statistics.name, statistics);
+
+		if (inserted) {
+			continue;
+		}
+
+		auto& total = iter->second;
+		total.hits += statistics.hits;
+		total.misses += statistics.misses;
+		total.waits += statistics.waits;
+		total.evictions += statistics.evictions;
+		total.load_time += statistics.load_time;
+
+		for (std::size_t i = 0; i < cache_statistics::histogram_buckets; i++) {
+			total.load_time_histogram[i] += statistics.load_time_histogram[i];
+		}
+	}
+
+	std::vector<cache_statistics> all;
+	all.reserve(combined.size());
+
+	for (auto&[name, statistics] : combined) {
+		all.push_back(std::move(statistics));
+	}
+
+	return all;
+}
+
+void CacheStatistics::Dump() {
+	if constexpr (!enabled) {
+		Log::Info() << "Cache statistics are disabled, build with CACHE_STATISTICS to enable them" << std::endl;
+		return;
+	}
+
+	for (const auto& statistics : GetAll()) {
+		std::uint64_t lookups = statistics.hits + statistics.misses;
+		double hit_rate = lookups == 0 ? 0.0 : 100.0 * double(statistics.hits) / double(lookups);
+		double load_time = std::chrono::duration<double, std::milli>(statistics.load_time).count();
+		double average_load_time = statistics.misses == 0 ? 0.0 : load_time / double(statistics.misses);
+
+		std::stringstream summary;
+		summary << statistics.hits << " hits, " << statistics.misses << " misses ("
+				<< std::fixed << std::setprecision(1) << hit_rate << "% hit rate), "
+				<< statistics.waits << " waits, " << statistics.evictions << " evictions, "
+				<< std::setprecision(3) << load_time << " ms loading (" << average_load_time << " ms per load)";
+
+		Log::Info() << statistics.name << ": " << summary.str() << std::endl;
+
+		std::stringstream histogram;
+
+		for (std::size_t i = 0; i < cache_statistics::histogram_buckets; i++) {
+			if (statistics.load_time_histogram[i] == 0) {
+				continue;
+			}
+
+			if (i == cache_statistics::histogram_buckets - 1) {
+				histogram << " >=" << (1ull << (i - 1)) << "us: ";
+			} else {
+				histogram << " <" << (1ull << i) << "us: ";
+			}
+
+			histogram << statistics.load_time_histogram[i];
+		}
+
+		if (!histogram.str().empty()) {
+			Log::Info() << statistics.name << " load times:" << histogram.str() << std::endl;
+		}
+	}
+}
+
+}
@@ -0,0 +1,146 @@
+/*
+ * Copyright (c) Levi van Rheenen. All rights reserved.
+ */
+#ifndef RHEELENGINE_CACHESTATISTICS_H
+#define RHEELENGINE_CACHESTATISTICS_H
+#include "../_common.h"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <typeinfo>
+
+namespace rheel {
+
+/**
+ * A snapshot of the statistics of a cache. The load time histogram counts the
+ * number of loads per power of two microseconds: bucket i holds the loads that
+ * took less than 2^i microseconds (and at least 2^(i-1)). The last bucket holds
+ * all slower loads.
+ */
+struct cache_statistics {
+	static constexpr std::size_t histogram_buckets = 20;
+
+	std::string name;
+	std::uint64_t hits = 0;
+	std::uint64_t misses = 0;
+	std::uint64_t waits = 0;
+	std::uint64_t evictions = 0;
+	std::chrono::nanoseconds load_time{ 0 };
+	std::array<std::uint64_t, histogram_buckets> load_time_histogram{};
+};
+
+/**
+ * Collects the statistics of a single cache: the number of hits and misses, the
+ * number of times a thread had to wait for another thread to load a value, the
+ * number of evictions, and the time spent in the value constructors.
+ *
+ * Statistics are only collected when the engine is built with the
+ * CACHE_STATISTICS option, which defines RE_CACHE_STATISTICS. Otherwise all
+ * methods are empty, and the caches do not register themselves.
+ */
+class RE_API CacheStatistics {
+	RE_NO_COPY(CacheStatistics);
+	RE_NO_MOVE(CacheStatistics);
+
+public:
+#ifdef RE_CACHE_STATISTICS
+	static constexpr bool enabled = true;
+#else
+	static constexpr bool enabled = false;
+#endif
+
+	using Clock = std::chrono::steady_clock;
+
+	/**
+	 * Creates the statistics of a cache with the given key and value type. The
+	 * name of the cache is derived from these types.
+	 */
+	CacheStatistics(const std::type_info& key_type, const std::type_info& value_type);
+
+	~CacheStatistics();
+
+	/**
+	 * Sets the name under which these statistics are reported. Caches with the
+	 * same name are reported together.
+	 */
+	void SetName(std::string name);
+
+	void Hit() {
+		if constexpr (enabled) {
+			_hits.fetch_add(1, std::memory_order_relaxed);
+		}
+	}
+
+	void Miss() {
+		if constexpr (enabled) {
+			_misses.fetch_add(1, std::memory_order_relaxed);
+		}
+	}
+
+	void Wait() {
+		if constexpr (enabled) {
+			_waits.fetch_add(1, std::memory_order_relaxed);
+		}
+	}
+
+	void Evict() {
+		if constexpr (enabled) {
+			_evictions.fetch_add(1, std::memory_order_relaxed);
+		}
+	}
+
+	/**
+	 * Returns the time at which a value constructor starts, to be passed to
+	 * FinishLoad() afterwards.
+	 */
+	Clock::time_point StartLoad() const {
+		if constexpr (enabled) {
+			return Clock::now();
+		} else {
+			return {};
+		}
+	}
+
+	void FinishLoad(Clock::time_point start) {
+		if constexpr (enabled) {
+			_add_load_time(Clock::now() - start);
+		}
+	}
+
+	/**
+	 * Returns a snapshot of these statistics.
+	 */
+	cache_statistics GetSnapshot() const;
+
+private:
+	void _add_load_time(Clock::duration duration);
+
+	std::string _name;
+	const std::type_info& _key_type;
+	const std::type_info& _value_type;
+
+	std::atomic<std::uint64_t> _hits = 0;
+	std::atomic<std::uint64_t> _misses = 0;
+	std::atomic<std::uint64_t> _waits = 0;
+	std::atomic<std::uint64_t> _evictions = 0;
+	std::atomic<std::int64_t> _load_time = 0;
+	std::array<std::atomic<std::uint64_t>, cache_statistics::histogram_buckets> _load_time_histogram{};
+
+public:
+	/**
+	 * Returns the statistics of all caches that currently exist. Caches with
+	 * the same name are combined.
+	 */
+	static std::vector<cache_statistics> GetAll();
+
+	/**
+	 * Logs the statistics of all caches that currently exist.
+	 */
+	static void Dump();
+
+};
+
+}
+
+#endif
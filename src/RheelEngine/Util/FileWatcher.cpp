@@ -0,0 +1,179 @@
+/*
+ * Copyright (c) Levi van Rheenen. All rights reserved.
+ */
+#include "FileWatcher.h"
+
+#include <algorithm>
+#include <thread>
+
+#if defined(__linux__)
+#include <cerrno>
+#include <cstring>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace rheel {
+
+// removes duplicates, keeping the first occurrence of every path
+static void remove_duplicates(std::vector<std::string>& paths) {
+	std::vector<std::string> unique;
+
+	for (auto& path : paths) {
+		if (std::find(unique.begin(), unique.end(), path) == unique.end()) {
+			unique.push_back(std::move(path));
+		}
+	}
+
+	paths = std::move(unique);
+}
+
+#if defined(__linux__)
+
+FileWatcher::FileWatcher(const std::string& directory) :
+		_directory(std::filesystem::path(directory).lexically_normal().generic_string()) {
+
+	if (!_directory.empty() && _directory.back() == '/') {
+		_directory.pop_back();
+	}
+
+	_inotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (_inotify < 0) {
+		throw std::runtime_error("Could not initialize inotify");
+	}
+
+	if (!_add_watch(_directory)) {
+		close(_inotify);
+		throw std::runtime_error("Could not watch directory " + directory);
+	}
+}
+
+FileWatcher::~FileWatcher() {
+	close(_inotify);
+}
+
+std::vector<std::string> FileWatcher::Poll(std::chrono::milliseconds timeout) {
+	std::vector<std::string> changed;
+
+	pollfd fd{ _inotify, POLLIN, 0 };
+	if (poll(&fd, 1, int(timeout.count())) <= 0) {
+		return changed;
+	}
+
+	alignas(inotify_event) char buffer[16 * 1024];
+	ssize_t length;
+
+	while ((length = read(_inotify, buffer, sizeof(buffer))) > 0) {
+		for (ssize_t offset = 0; offset < length;) {
+			const auto* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+			offset += ssize_t(sizeof(inotify_event) + event->len);
+
+			if (event->mask & IN_IGNORED) {
+				_watches.erase(event->wd);
+				continue;
+			}
+
+			auto watch = _watches.find(event->wd);
+			if (watch == _watches.end() || event->len == 0) {
+				continue;
+			}
+
+			std::string path = watch->second + '/' + event->name;
+
+			if (event->mask & IN_ISDIR) {
+				if (event->mask & (IN_CREATE | IN_MOVED_TO)) {
+					_add_watch(path);
+				}
+			} else if (event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO)) {
+				changed.push_back(std::move(path));
+			}
+		}
+	}
+
+	remove_duplicates(changed);
+	return changed;
+}
+
+bool FileWatcher::_add_watch(const std::string& directory) {
+	// files are reported when they are closed after writing, or moved into
+	// place, so half-written files are not reported
+	int wd = inotify_add_watch(_inotify, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_ONLYDIR);
+
+	if (wd < 0) {
+		// subdirectories can be removed before they are watched, for example
+		// the temporary directories of editors
+		if (errno != ENOENT && errno != ENOTDIR && directory != _directory) {
+			Log::Warning() << "Could not watch directory " << directory << ": " << std::strerror(errno) << std::endl;
+		}
+
+		return false;
+	}
+
+	_watches[wd] = directory;
+
+	std::error_code error;
+	for (const auto& entry : std::filesystem::directory_iterator(directory, error)) {
+		if (entry.is_directory(error) && !entry.is_symlink(error)) {
+			_add_watch(directory + '/' + entry.path().filename().string());
+		}
+	}
+
+	return true;
+}
+
+#else
+
+FileWatcher::FileWatcher(const std::string& directory) :
+		_directory(std::filesystem::path(directory).lexically_normal().generic_string()) {
+
+	if (!_directory.empty() && _directory.back() == '/') {
+		_directory.pop_back();
+	}
+
+	if (!std::filesystem::is_directory(_directory)) {
+		throw std::runtime_error("Could not watch directory " + directory);
+	}
+
+	_scan();
+}
+
+FileWatcher::~FileWatcher() = default;
+
+std::vector<std::string> FileWatcher::Poll(std::chrono::milliseconds timeout) {
+	auto changed = _scan();
+
+	if (changed.empty() && timeout.count() > 0) {
+		std::this_thread::sleep_for(timeout);
+		changed = _scan();
+	}
+
+	return changed;
+}
+
+std::vector<std::string> FileWatcher::_scan() {
+	std::vector<std::string> changed;
+	std::error_code error;
+
+	for (const auto& entry : std::filesystem::recursive_directory_iterator(_directory, error)) {
+		if (!entry.is_regular_file(error)) {
+			continue;
+		}
+
+		std::string path = entry.path().generic_string();
+		auto write_time = entry.last_write_time(error);
+		auto[iter, inserted] = _write_times.try_emplace(path, write_time);
+
+		if (!inserted && iter->second != write_time) {
+			iter->second = write_time;
+			changed.push_back(std::move(path));
+		}
+	}
+
+	remove_duplicates(changed);
+	return changed;
+}
+
+#endif
+
+}
@@ -0,0 +1,61 @@
+/*
+ * Copyright (c) Levi van Rheenen. All rights reserved.
+ */
+#ifndef RHEELENGINE_FILEWATCHER_H
+#define RHEELENGINE_FILEWATCHER_H
+#include "../_common.h"
+
+#include <chrono>
+#include <filesystem>
+#include <unordered_map>
+
+namespace rheel {
+
+/**
+ * Watches a directory and its subdirectories for files that are written to.
+ * On Linux, the kernel reports changes through inotify, so watching costs
+ * nothing while no files change. On other platforms, the modification times
+ * of the files are compared on every call to Poll().
+ */
+class RE_API FileWatcher {
+	RE_NO_COPY(FileWatcher);
+	RE_NO_MOVE(FileWatcher);
+
+public:
+	/**
+	 * Starts watching the directory. Subdirectories that are created later
+	 * are watched as well, and skipped when they cannot be watched, for
+	 * example because they were removed right away. Throws a runtime_error if
+	 * the directory itself could not be watched.
+	 */
+	explicit FileWatcher(const std::string& directory);
+
+	~FileWatcher();
+
+	/**
+	 * Returns the paths of the files that were changed since the last call,
+	 * each path once. The paths start with the watched directory. If no files
+	 * were changed yet, this waits at most the timeout for a change.
+	 */
+	std::vector<std::string> Poll(std::chrono::milliseconds timeout = std::chrono::milliseconds(0));
+
+private:
+	std::string _directory;
+
+#if defined(__linux__)
+	// returns false if the directory could not be watched
+	bool _add_watch(const std::string& directory);
+
+	int _inotify = -1;
+	std::unordered_map<int, std::string> _watches;
+#else
+	std::vector<std::string> _scan();
+
+	std::unordered_map<std::string, std::filesystem::file_time_type> _write_times;
+#endif
+
+};
+
+}
+
+#endif
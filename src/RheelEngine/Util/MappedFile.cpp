@@ -0,0 +1,171 @@
+/*
+ * Copyright (c) Levi van Rheenen. All rights reserved.
+ */
+#include "MappedFile.h"
+
+#include <utility>
+
+#if defined(_WIN32)
+#include <windows.h>
+#elif defined(__linux__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace rheel {
+
+#if defined(_WIN32)
+
+MappedFile::MappedFile(const std::string& path) {
+	HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE) {
+		throw std::runtime_error("Could not open file " + path);
+	}
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(file, &size)) {
+		CloseHandle(file);
+		throw std::runtime_error("Could not read the size of file " + path);
+	}
+
+	_file_handle = file;
+	_size = std::size_t(size.QuadPart);
+
+	// empty files cannot be mapped
+	if (_size == 0) {
+		return;
+	}
+
+	HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (mapping == nullptr) {
+		_unmap();
+		throw std::runtime_error("Could not map file " + path);
+	}
+
+	_mapping_handle = mapping;
+	_data = static_cast<const std::byte*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+
+	if (_data == nullptr) {
+		_unmap();
+		throw std::runtime_error("Could not map file " + path);
+	}
+}
+
+void MappedFile::_unmap() {
+	if (_data != nullptr) {
+		UnmapViewOfFile(_data);
+	}
+
+	if (_mapping_handle != nullptr) {
+		CloseHandle(_mapping_handle);
+	}
+
+	if (_file_handle != nullptr) {
+		CloseHandle(_file_handle);
+	}
+
+	_data = nullptr;
+	_size = 0;
+	_mapping_handle = nullptr;
+	_file_handle = nullptr;
+}
+
+MappedFile::MappedFile(MappedFile&& file) noexcept :
+		_data(std::exchange(file._data, nullptr)),
+		_size(std::exchange(file._size, 0)),
+		_file_handle(std::exchange(file._file_handle, nullptr)),
+		_mapping_handle(std::exchange(file._mapping_handle, nullptr)) {}
+
+MappedFile& MappedFile::operator=(MappedFile&& file) noexcept {
+	if (this != &file) {
+		_unmap();
+
+		_data = std::exchange(file._data, nullptr);
+		_size = std::exchange(file._size, 0);
+		_file_handle = std::exchange(file._file_handle, nullptr);
+		_mapping_handle = std::exchange(file._mapping_handle, nullptr);
+	}
+
+	return *this;
+}
+
+#elif defined(__linux__)
+
+MappedFile::MappedFile(const std::string& path) {
+	int file = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+	if (file < 0) {
+		throw std::runtime_error("Could not open file " + path);
+	}
+
+	struct stat status{};
+	if (fstat(file, &status) != 0) {
+		close(file);
+		throw std::runtime_error("Could not read the size of file " + path);
+	}
+
+	_size = std::size_t(status.st_size);
+
+	// empty files cannot be mapped
+	if (_size == 0) {
+		close(file);
+		return;
+	}
+
+	void* data = mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, file, 0);
+
+	// the mapping stays valid after the file is closed
+	close(file);
+
+	if (data == MAP_FAILED) {
+		_size = 0;
+		throw std::runtime_error("Could not map file " + path);
+	}
+
+	_data = static_cast<const std::byte*>(data);
+}
+
+void MappedFile::_unmap() {
+	if (_data != nullptr) {
+		munmap(const_cast<std::byte*>(_data), _size);
+	}
+
+	_data = nullptr;
+	_size = 0;
+}
+
+MappedFile::MappedFile(MappedFile&& file) noexcept :
+		_data(std::exchange(file._data, nullptr)),
+		_size(std::exchange(file._size, 0)) {}
+
+MappedFile& MappedFile::operator=(MappedFile&& file) noexcept {
+	if (this != &file) {
+		_unmap();
+
+		_data = std::exchange(file._data, nullptr);
+		_size = std::exchange(file._size, 0);
+	}
+
+	return *this;
+}
+
+#endif
+
+MappedFile::~MappedFile() {
+	_unmap();
+}
+
+const std::byte* MappedFile::GetData() const {
+	return _data;
+}
+
+std::size_t MappedFile::GetSize() const {
+	return _size;
+}
+
+std::span<const std::byte> MappedFile::GetBytes() const {
+	return { _data, _size };
+}
+
+}
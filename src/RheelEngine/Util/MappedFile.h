@@ -0,0 +1,68 @@
+/*
+ * Copyright (c) Levi van Rheenen. All rights reserved.
+ */
+#ifndef RHEELENGINE_MAPPEDFILE_H
+#define RHEELENGINE_MAPPEDFILE_H
+#include "../_common.h"
+
+#include <span>
+
+namespace rheel {
+
+/**
+ * A read-only view of a file that is mapped into memory. The contents of the
+ * file are paged in by the operating system when they are first accessed,
+ * without copying them into a separate buffer.
+ *
+ * The file must not be modified in place while it is mapped: changes can show
+ * up in the mapped contents, and accessing the contents after the file has
+ * been truncated crashes the process. To update a mapped file, write a new
+ * file and rename it over the old one. The mapping keeps referring to the old
+ * contents.
+ */
+class RE_API MappedFile {
+	RE_NO_COPY(MappedFile);
+
+public:
+	/**
+	 * Maps the file at the given path into memory. Throws a runtime_error if
+	 * the file could not be opened or mapped.
+	 */
+	explicit MappedFile(const std::string& path);
+
+	~MappedFile();
+
+	MappedFile(MappedFile&& file) noexcept;
+	MappedFile& operator=(MappedFile&& file) noexcept;
+
+	/**
+	 * Returns a pointer to the start of the file contents.
+	 */
+	const std::byte* GetData() const;
+
+	/**
+	 * Returns the size of the file, in bytes.
+	 */
+	std::size_t GetSize() const;
+
+	/**
+	 * Returns the file contents.
+	 */
+	std::span<const std::byte> GetBytes() const;
+
+private:
+	void _unmap();
+
+	const std::byte* _data = nullptr;
+	std::size_t _size = 0;
+
+#if defined(_WIN32)
+	void* _file_handle = nullptr;
+	void* _mapping_handle = nullptr;
+#endif
+
+};
+
+}
+
+#endif
@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) Levi van Rheenen. All rights reserved.
+ */
+#ifndef RHEELENGINE_MPSCQUEUE_H
+#define RHEELENGINE_MPSCQUEUE_H
+#include "../_common.h"
+
+#include <atomic>
+#include <optional>
+
+namespace rheel {
+
+/**
+ * Unbounded lock-free multiple-producer, single-consumer queue. Any thread may
+ * call Push() concurrently, but only a single thread at a time may call Pop().
+ *
+ * Push() never blocks. Because a producer first claims its place in the queue
+ * and only then links it in, an element that is being pushed while Pop() runs
+ * may not be visible yet; it will be returned by a later Pop().
+ */
+template<typename T>
+class MpscQueue {
+	RE_NO_COPY(MpscQueue);
+	RE_NO_MOVE(MpscQueue);
+
+	struct node {
+		std::atomic<node*> next = nullptr;
+		std::optional<T> value;
+	};
+
+public:
+	MpscQueue() :
+			_head(new node),
+			_tail(_head.load()) {}
+
+	~MpscQueue() {
+		while (Pop()) {}
+		delete _tail;
+	}
+
+	/**
+	 * Adds an element to the back of the queue. This method is thread-safe.
+	 */
+	void Push(T value) {
+		auto* n = new node;
+		n->value.emplace(std::move(value));
+
+		// count the element before it becomes visible, so the size can never
+		// drop below zero when a consumer pops it right away
+		_size.fetch_add(1, std::memory_order_relaxed);
+
+		node* previous = _head.exchange(n, std::memory_order_acq_rel);
+		previous->next.store(n, std::memory_order_release);
+	}
+
+	/**
+	 * Removes and returns the element at the front of the queue, or an empty
+	 * optional if no element is available. Only a single consumer thread may
+	 * call this method at a time.
+	 */
+	std::optional<T> Pop() {
+		node* tail = _tail;
+		node* next = tail->next.load(std::memory_order_acquire);
+
+		if (next == nullptr) {
+			return std::nullopt;
+		}
+
+		std::optional<T> value = std::move(next->value);
+		next->value.reset();
+
+		_tail = next;
+		delete tail;
+
+		_size.fetch_sub(1, std::memory_order_relaxed);
+		return value;
+	}
+
+	/**
+	 * Returns the approximate number of elements in the queue.
+	 */
+	std::size_t GetSize() const {
+		return _size.load(std::memory_order_relaxed);
+	}
+
+private:
+	std::atomic<node*> _head;
+	node* _tail;
+	std::atomic<std::size_t> _size = 0;
+
+};
+
+}
+
+#endif
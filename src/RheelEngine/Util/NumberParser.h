@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) Levi van Rheenen. All rights reserved.
+ */
+#ifndef RHEELENGINE_NUMBERPARSER_H
+#define RHEELENGINE_NUMBERPARSER_H
+#include "../_common.h"
+
+#include <algorithm>
+#include <bit>
+#include <charconv>
+#include <string_view>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define RE_NUMBER_PARSER_SSE2
+#endif
+
+namespace rheel {
+
+inline constexpr bool is_whitespace(char c) {
+	return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+/**
+ * Returns a pointer to the first non-whitespace character in [begin, end), or
+ * end if there is none. Long runs of whitespace, like the indentation of
+ * pretty-printed files, are skipped 16 characters at a time.
+ */
+inline const char* skip_whitespace(const char* begin, const char* end) {
+#ifdef RE_NUMBER_PARSER_SSE2
+	const __m128i space = _mm_set1_epi8(' ');
+	const __m128i newline = _mm_set1_epi8('\n');
+	const __m128i carriage_return = _mm_set1_epi8('\r');
+	const __m128i tab = _mm_set1_epi8('\t');
+
+	while (end - begin >= 16) {
+		// most separators are a single space, so check the first character
+		// before loading a whole block
+		if (!is_whitespace(*begin)) {
+			return begin;
+		}
+
+		__m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+		__m128i whitespace = _mm_or_si128(
+				_mm_or_si128(_mm_cmpeq_epi8(block, space), _mm_cmpeq_epi8(block, newline)),
+				_mm_or_si128(_mm_cmpeq_epi8(block, carriage_return), _mm_cmpeq_epi8(block, tab)));
+
+		auto non_whitespace = unsigned(~_mm_movemask_epi8(whitespace)) & 0xffffu;
+		if (non_whitespace != 0) {
+			return begin + std::countr_zero(non_whitespace);
+		}
+
+		begin += 16;
+	}
+#endif
+
+	while (begin != end && is_whitespace(*begin)) {
+		begin++;
+	}
+
+	return begin;
+}
+
+/**
+ * Parses a whitespace-separated list of numbers, and appends them to values.
+ * The numbers are parsed with std::from_chars, so they are always read in the
+ * C locale. If the number of values is known in advance, pass it as the
+ * expected count, so the vector is allocated only once. Throws a runtime_error
+ * if the text contains something other than numbers and whitespace.
+ */
+template<typename T>
+void parse_numbers(std::string_view text, std::vector<T>& values, std::size_t expected_count = 0) {
+	values.reserve(values.size() + expected_count);
+
+	const char* current = text.data();
+	const char* end = text.data() + text.size();
+
+	while ((current = skip_whitespace(current, end)) != end) {
+		T value;
+		auto[next, error] = std::from_chars(current, end, value);
+
+		if (error != std::errc() || (next != end && !is_whitespace(*next))) {
+			throw std::runtime_error("Invalid number: " + std::string(current, std::find_if(current, end, is_whitespace)));
+		}
+
+		values.push_back(value);
+		current = next;
+	}
+}
+
+}
+
+#endif
@@ -0,0 +1,284 @@
+/*
+ * Copyright (c) Levi van Rheenen. All rights reserved.
+ */
+#include "PackFile.h"
+
+#include <zlib.h>
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <fstream>
+#include <limits>
+
+namespace rheel {
+
+static_assert(std::endian::native == std::endian::little, "The pack file format is little-endian");
+
+static constexpr char pack_magic[4] = { 'R', 'P', 'A', 'K' };
+static constexpr std::uint64_t pack_alignment = 16;
+
+enum class pack_compression : std::uint32_t {
+	NONE, ZLIB
+};
+
+struct pack_file_header {
+	char magic[4];
+	std::uint32_t version;
+	std::uint64_t entry_count;
+	std::uint64_t entry_offset;
+	std::uint64_t name_offset;
+	std::uint64_t name_size;
+};
+
+static_assert(sizeof(pack_file_header) == 40, "pack_file_header must be tightly packed");
+
+struct PackFile::entry {
+	std::uint64_t name_hash;
+	std::uint64_t offset;
+	std::uint64_t size;
+	std::uint64_t stored_size;
+	std::uint32_t name_offset;
+	std::uint32_t name_length;
+	pack_compression compression;
+	std::uint32_t reserved;
+};
+
+static std::uint64_t align(std::uint64_t offset) {
+	return (offset + pack_alignment - 1) / pack_alignment * pack_alignment;
+}
+
+// checks that count elements of the given size at the offset lie within the
+// file, without overflowing
+static bool in_file(std::uint64_t offset, std::uint64_t count, std::uint64_t element_size, std::uint64_t file_size) {
+	return offset <= file_size && count <= (file_size - offset) / element_size;
+}
+
+PackFile::PackFile(const std::string& path) :
+		_file(path) {
+
+	static_assert(sizeof(entry) == 48, "PackFile::entry must be tightly packed");
+
+	const std::byte* data = _file.GetData();
+	std::uint64_t size = _file.GetSize();
+
+	if (size < sizeof(pack_file_header)) {
+		throw std::runtime_error("Pack file " + path + " is too small");
+	}
+
+	pack_file_header header;
+	std::memcpy(&header, data, sizeof(pack_file_header));
+
+	if (std::memcmp(header.magic, pack_magic, sizeof(pack_magic)) != 0) {
+		throw std::runtime_error("File " + path + " is not a pack file");
+	}
+
+	if (header.version != version) {
+		throw std::runtime_error("Pack file " + path + " has unsupported version " + std::to_string(header.version));
+	}
+
+	if (header.entry_offset % alignof(entry) != 0 ||
+			!in_file(header.entry_offset, header.entry_count, sizeof(entry), size) ||
+			!in_file(header.name_offset, header.name_size, 1, size)) {
+		throw std::runtime_error("Pack file " + path + " is corrupt");
+	}
+
+	_entries = { reinterpret_cast<const entry*>(data + header.entry_offset), header.entry_count };
+	_names = { reinterpret_cast<const char*>(data + header.name_offset), header.name_size };
+
+	// validate all entries once, so lookups do not have to
+	for (std::size_t i = 0; i < _entries.size(); i++) {
+		const entry& e = _entries[i];
+
+		if (!in_file(e.name_offset, e.name_length, 1, _names.size()) ||
+				!in_file(e.offset, e.stored_size, 1, size) ||
+				e.offset % pack_alignment != 0 ||
+				e.compression > pack_compression::ZLIB ||
+				(e.compression == pack_compression::NONE && e.stored_size != e.size) ||
+				e.name_hash != HashName(_name(e)) ||
+				(i > 0 && e.name_hash < _entries[i - 1].name_hash)) {
+			throw std::runtime_error("Pack file " + path + " is corrupt");
+		}
+	}
+}
+
+bool PackFile::Contains(std::string_view name) const {
+	return _find(name) != nullptr;
+}
+
+std::optional<virtual_file> PackFile::Open(std::string_view name) const {
+	const entry* e = _find(name);
+
+	if (e == nullptr) {
+		return {};
+	}
+
+	const std::byte* stored = _file.GetData() + e->offset;
+
+	if (e->compression == pack_compression::NONE) {
+		return virtual_file{ shared_from_this(), { stored, e->size }};
+	}
+
+	auto buffer = std::make_shared<std::vector<std::byte>>(e->size);
+	uLongf size = e->size;
+
+	int result = uncompress(reinterpret_cast<Bytef*>(buffer->data()), &size,
+			reinterpret_cast<const Bytef*>(stored), e->stored_size);
+
+	if (result != Z_OK || size != e->size) {
+		throw std::runtime_error("Could not inflate " + std::string(name) + " from pack file");
+	}
+
+	std::span<const std::byte> bytes(*buffer);
+	return virtual_file{ std::move(buffer), bytes };
+}
+
+std::vector<std::string_view> PackFile::GetNames() const {
+	std::vector<std::string_view> names;
+	names.reserve(_entries.size());
+
+	for (const auto& e : _entries) {
+		names.push_back(_name(e));
+	}
+
+	return names;
+}
+
+std::size_t PackFile::GetFileCount() const {
+	return _entries.size();
+}
+
+void PackFile::Write(const std::vector<pack_file_input>& files, const std::string& path) {
+	std::vector<entry> entries;
+	std::vector<std::vector<std::byte>> compressed(files.size());
+	std::string names;
+
+	entries.reserve(files.size());
+
+	for (std::size_t i = 0; i < files.size(); i++) {
+		const auto& file = files[i];
+
+		entry e{};
+		e.name_hash = HashName(file.name);
+		e.size = file.data.size();
+		e.stored_size = file.data.size();
+		e.name_offset = names.size();
+		e.name_length = file.name.size();
+		e.compression = pack_compression::NONE;
+
+		// the index of the input is stored in the offset until the blobs are
+		// laid out
+		e.offset = i;
+
+		if (file.compress) {
+			uLongf size = compressBound(file.data.size());
+			compressed[i].resize(size);
+
+			int result = compress2(reinterpret_cast<Bytef*>(compressed[i].data()), &size,
+					reinterpret_cast<const Bytef*>(file.data.data()), file.data.size(), Z_BEST_COMPRESSION);
+
+			if (result != Z_OK) {
+				throw std::runtime_error("Could not compress " + file.name);
+			}
+
+			if (size < file.data.size()) {
+				compressed[i].resize(size);
+				e.stored_size = size;
+				e.compression = pack_compression::ZLIB;
+			} else {
+				compressed[i].clear();
+			}
+		}
+
+		names += file.name;
+		entries.push_back(e);
+	}
+
+	if (names.size() > std::numeric_limits<std::uint32_t>::max()) {
+		throw std::runtime_error("The file names are too long for a pack file");
+	}
+
+	std::sort(entries.begin(), entries.end(), [&names](const entry& a, const entry& b) {
+		if (a.name_hash != b.name_hash) {
+			return a.name_hash < b.name_hash;
+		}
+
+		return names.compare(a.name_offset, a.name_length, names, b.name_offset, b.name_length) < 0;
+	});
+
+	for (std::size_t i = 1; i < entries.size(); i++) {
+		const entry& a = entries[i - 1];
+		const entry& b = entries[i];
+
+		if (names.compare(a.name_offset, a.name_length, names, b.name_offset, b.name_length) == 0) {
+			throw std::runtime_error("Duplicate file " + names.substr(b.name_offset, b.name_length) + " in pack file");
+		}
+	}
+
+	pack_file_header header{};
+	std::memcpy(header.magic, pack_magic, sizeof(pack_magic));
+	header.version = version;
+	header.entry_count = entries.size();
+	header.entry_offset = align(sizeof(pack_file_header));
+	header.name_offset = header.entry_offset + entries.size() * sizeof(entry);
+	header.name_size = names.size();
+
+	// lay out the blobs in the order of the inputs, so files that were added
+	// together are close together
+	std::vector<entry*> by_input(files.size());
+	for (auto& e : entries) {
+		by_input[e.offset] = &e;
+	}
+
+	std::uint64_t offset = header.name_offset + header.name_size;
+	for (entry* e : by_input) {
+		e->offset = align(offset);
+		offset = e->offset + e->stored_size;
+	}
+
+	std::ofstream output(path, std::ios::binary | std::ios::trunc);
+	if (!output) {
+		throw std::runtime_error("Could not open " + path + " for writing");
+	}
+
+	auto write_at = [&output](std::uint64_t offset, const void* data, std::size_t size) {
+		static constexpr char padding[pack_alignment] = {};
+		output.write(padding, std::streamsize(offset - std::uint64_t(output.tellp())));
+		output.write(static_cast<const char*>(data), std::streamsize(size));
+	};
+
+	write_at(0, &header, sizeof(pack_file_header));
+	write_at(header.entry_offset, entries.data(), entries.size() * sizeof(entry));
+	write_at(header.name_offset, names.data(), names.size());
+
+	for (std::size_t i = 0; i < files.size(); i++) {
+		const auto& data = compressed[i].empty() ? files[i].data : compressed[i];
+		write_at(by_input[i]->offset, data.data(), data.size());
+	}
+
+	if (!output) {
+		throw std::runtime_error("Could not write pack file " + path);
+	}
+}
+
+const PackFile::entry* PackFile::_find(std::string_view name) const {
+	std::uint64_t hash = HashName(name);
+
+	auto it = std::lower_bound(_entries.begin(), _entries.end(), hash, [](const entry& e, std::uint64_t hash) {
+		return e.name_hash < hash;
+	});
+
+	for (; it != _entries.end() && it->name_hash == hash; it++) {
+		if (_name(*it) == name) {
+			return &*it;
+		}
+	}
+
+	return nullptr;
+}
+
+std::string_view PackFile::_name(const entry& entry) const {
+	return _names.substr(entry.name_offset, entry.name_length);
+}
+
+}
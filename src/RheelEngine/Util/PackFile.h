@@ -0,0 +1,123 @@
+/*
+ * Copyright (c) Levi van Rheenen. All rights reserved.
+ */
+#ifndef RHEELENGINE_PACKFILE_H
+#define RHEELENGINE_PACKFILE_H
+#include "../_common.h"
+
+#include <optional>
+#include <span>
+
+#include "MappedFile.h"
+
+namespace rheel {
+
+/**
+ * The contents of a file, which stay valid for as long as the storage is
+ * alive. The storage may be a memory-mapped file, or a buffer holding
+ * decompressed data.
+ */
+struct virtual_file {
+	std::shared_ptr<const void> storage;
+	std::span<const std::byte> bytes;
+};
+
+/**
+ * A file to be added to a pack file by PackFile::Write().
+ */
+struct pack_file_input {
+	// the name of the file inside the pack file, with '/' as separator
+	std::string name;
+
+	// the contents of the file
+	std::vector<std::byte> data;
+
+	// whether to store the file compressed. If compression does not make the
+	// file smaller, it is stored uncompressed anyway.
+	bool compress;
+};
+
+/**
+ * A read-only archive of many files (.rpak). The pack file is memory-mapped,
+ * and its table of contents is sorted by the hash of the file names, so a file
+ * is found without touching the file system. The contents of uncompressed
+ * files are aligned to 16 bytes and are returned as spans into the mapped
+ * archive, so loaders that use the data in-place (like MeshLoader) do not copy
+ * it. Compressed files are inflated with zlib when they are opened.
+ *
+ * Use Write() or the AssetPacker tool to create pack files. To let the asset
+ * loaders read from a pack file, mount it in the VirtualFileSystem.
+ */
+class RE_API PackFile : public std::enable_shared_from_this<PackFile> {
+	RE_NO_COPY(PackFile);
+	RE_NO_MOVE(PackFile);
+
+public:
+	static constexpr std::uint32_t version = 1;
+
+	/**
+	 * Maps the pack file at the given path into memory and validates its table
+	 * of contents. Throws a runtime_error if the file is not a valid pack file.
+	 */
+	explicit PackFile(const std::string& path);
+
+	/**
+	 * Returns whether the pack file contains a file with the given name.
+	 */
+	bool Contains(std::string_view name) const;
+
+	/**
+	 * Returns the contents of the file with the given name, or an empty
+	 * optional if the pack file does not contain it. The returned storage
+	 * keeps this pack file alive, so it must be owned by a shared_ptr. Throws
+	 * a runtime_error if a compressed file could not be inflated.
+	 */
+	std::optional<virtual_file> Open(std::string_view name) const;
+
+	/**
+	 * Returns the names of all files in the pack file.
+	 */
+	std::vector<std::string_view> GetNames() const;
+
+	/**
+	 * Returns the number of files in the pack file.
+	 */
+	std::size_t GetFileCount() const;
+
+	/**
+	 * Writes the given files to a pack file at the given path. Throws a
+	 * runtime_error if two files have the same name, or if the file could not
+	 * be written.
+	 */
+	static void Write(const std::vector<pack_file_input>& files, const std::string& path);
+
+	/**
+	 * The hash of a file name which is used in the table of contents (64-bit
+	 * FNV-1a). Unlike std::hash, it is the same on every platform.
+	 */
+	static constexpr std::uint64_t HashName(std::string_view name) {
+		std::uint64_t hash = 0xcbf29ce484222325;
+
+		for (char c : name) {
+			hash ^= std::uint8_t(c);
+			hash *= 0x100000001b3;
+		}
+
+		return hash;
+	}
+
+private:
+	struct entry;
+
+	const entry* _find(std::string_view name) const;
+	std::string_view _name(const entry& entry) const;
+
+	MappedFile _file;
+	std::span<const entry> _entries;
+	std::string_view _names;
+
+};
+
+}
+
+#endif
@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) Levi van Rheenen. All rights reserved.
+ */
+#ifndef RHEELENGINE_PARALLELFOR_H
+#define RHEELENGINE_PARALLELFOR_H
+#include "../_common.h"
+
+#include "../ThreadPool.h"
+
+namespace rheel {
+
+/**
+ * Calls body(i) for every i in [0, count), spread over the threads of the
+ * pool. The calling thread claims indices as well, instead of only waiting for
+ * the pool. That way, this never deadlocks when all pool threads are busy (for
+ * example when called from a pool thread), and tasks that start after all
+ * indices are claimed return immediately. If the pool is null, all indices are
+ * processed on the calling thread. Returns when all calls have finished. If a
+ * call throws, the first exception is rethrown after that.
+ */
+template<typename F>
+void parallel_for(ThreadPool* pool, std::size_t count, F body) {
+	struct parallel_state {
+		F body;
+		std::size_t count;
+		std::atomic_size_t next_index = 0;
+		std::size_t finished = 0;
+		std::exception_ptr exception;
+		std::mutex mutex;
+		std::condition_variable all_finished;
+	};
+
+	if (count == 0) {
+		return;
+	}
+
+	auto state = std::make_shared<parallel_state>(std::move(body), count);
+
+	auto run = [state]() {
+		std::size_t index;
+
+		while ((index = state->next_index.fetch_add(1, std::memory_order_relaxed)) < state->count) {
+			std::exception_ptr exception;
+
+			try {
+				state->body(index);
+			} catch (...) {
+				exception = std::current_exception();
+			}
+
+			std::lock_guard lock(state->mutex);
+
+			if (exception && !state->exception) {
+				state->exception = exception;
+			}
+
+			if (++state->finished == state->count) {
+				state->all_finished.notify_all();
+			}
+		}
+	};
+
+	if (pool != nullptr && count > 1) {
+		std::size_t helpers = std::min<std::size_t>(count, std::max(std::thread::hardware_concurrency(), 1u)) - 1;
+
+		for (std::size_t i = 0; i < helpers; i++) {
+			pool->AddTask<void>(run);
+		}
+	}
+
+	run();
+
+	std::unique_lock lock(state->mutex);
+	state->all_finished.wait(lock, [&state]() { return state->finished == state->count; });
+
+	if (state->exception) {
+		std::rethrow_exception(state->exception);
+	}
+}
+
+}
+
+#endif
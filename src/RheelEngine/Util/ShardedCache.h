@@ -0,0 +1,35 @@
+/*
+ * Copyright (c) Levi van Rheenen. All rights reserved.
+ */
+#ifndef RHEELENGINE_SHARDEDCACHE_H
+#define RHEELENGINE_SHARDEDCACHE_H
+#include "../_common.h"
+
+#include "Cache.h"
+
+namespace rheel {
+
+/**
+ * Thread-safe cache, split into a number of independently locked shards. Each
+ * key always maps to the same shard, based on its hash. Threads accessing keys
+ * in different shards never contend for the same lock, so reads scale with
+ * the number of threads.
+ *
+ * The interface and semantics are the same as those of the thread-safe Cache.
+ * The capacity, the cost and the policy are shared by all shards, so a single
+ * element can use the full capacity, and elements are evicted in the order of
+ * the policy regardless of their shard. Evicting elements locks all shards,
+ * and policies other than keep_policy are notified of every access under a
+ * single lock, so reads scale best with the keep policy.
+ */
+template<typename K, typename V, typename Policy = keep_policy, typename Cost = element_cost, std::size_t ShardCount = 16>
+class ShardedCache : public detail::concurrent_cache<K, V, Policy, Cost, ShardCount> {
+
+public:
+	using detail::concurrent_cache<K, V, Policy, Cost, ShardCount>::concurrent_cache;
+
+};
+
+}
+
+#endif
@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) Levi van Rheenen. All rights reserved.
+ */
+#include "VirtualFileSystem.h"
+
+#include <filesystem>
+
+namespace rheel {
+
+std::vector<VirtualFileSystem::mount> VirtualFileSystem::_mounts;
+std::shared_mutex VirtualFileSystem::_mounts_mutex;
+
+// normalizes the path to the form of the names in pack files, e.g.
+// "./res\\textures/../a.png" becomes "res/a.png"
+static std::string normalize(const std::string& path) {
+	std::string normalized = std::filesystem::path(path).lexically_normal().generic_string();
+
+	if (normalized == ".") {
+		return "";
+	}
+
+	if (!normalized.empty() && normalized.back() == '/') {
+		normalized.pop_back();
+	}
+
+	return normalized;
+}
+
+// returns the name of the file at the normalized path inside a pack file which
+// is mounted at the mount point, or an empty optional if the path is not below
+// the mount point
+static std::optional<std::string_view> packed_name(const std::string& mount_point, std::string_view path) {
+	if (mount_point.empty()) {
+		return path;
+	}
+
+	if (path.size() <= mount_point.size() || !path.starts_with(mount_point) || path[mount_point.size()] != '/') {
+		return {};
+	}
+
+	return path.substr(mount_point.size() + 1);
+}
+
+void VirtualFileSystem::Mount(const std::string& pack_file, const std::string& mount_point) {
+	auto pack = std::make_shared<PackFile>(pack_file);
+
+	std::unique_lock lock(_mounts_mutex);
+	_mounts.push_back(mount{ pack_file, normalize(mount_point), std::move(pack) });
+}
+
+void VirtualFileSystem::Unmount(const std::string& pack_file) {
+	std::unique_lock lock(_mounts_mutex);
+	std::erase_if(_mounts, [&pack_file](const mount& m) { return m.pack_file == pack_file; });
+}
+
+void VirtualFileSystem::UnmountAll() {
+	std::unique_lock lock(_mounts_mutex);
+	_mounts.clear();
+}
+
+virtual_file VirtualFileSystem::Open(const std::string& path) {
+	if (auto file = _open_packed(path)) {
+		return std::move(*file);
+	}
+
+	auto file = std::make_shared<MappedFile>(path);
+	std::span<const std::byte> bytes = file->GetBytes();
+
+	return virtual_file{ std::move(file), bytes };
+}
+
+bool VirtualFileSystem::Exists(const std::string& path) {
+	std::string normalized = normalize(path);
+
+	{
+		std::shared_lock lock(_mounts_mutex);
+
+		for (const auto& m : _mounts) {
+			auto name = packed_name(m.mount_point, normalized);
+
+			if (name && m.pack->Contains(*name)) {
+				return true;
+			}
+		}
+	}
+
+	return std::filesystem::is_regular_file(path);
+}
+
+std::optional<virtual_file> VirtualFileSystem::_open_packed(const std::string& path) {
+	std::string normalized = normalize(path);
+	std::shared_lock lock(_mounts_mutex);
+
+	// the last mounted pack file has precedence
+	for (auto it = _mounts.rbegin(); it != _mounts.rend(); it++) {
+		auto name = packed_name(it->mount_point, normalized);
+		if (!name) {
+			continue;
+		}
+
+		if (auto file = it->pack->Open(*name)) {
+			return file;
+		}
+	}
+
+	return {};
+}
+
+}
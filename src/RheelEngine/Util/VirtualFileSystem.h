@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) Levi van Rheenen. All rights reserved.
+ */
+#ifndef RHEELENGINE_VIRTUALFILESYSTEM_H
+#define RHEELENGINE_VIRTUALFILESYSTEM_H
+#include "../_common.h"
+
+#include <shared_mutex>
+
+#include "PackFile.h"
+
+namespace rheel {
+
+/**
+ * The files that the asset loaders read. Pack files can be mounted at a
+ * directory, after which files in that directory are read from the pack file
+ * instead of from disk. Files that are not in any mounted pack file are read
+ * from disk, so assets can be moved into pack files without changing the paths
+ * that the game loads them with. All methods are thread-safe.
+ */
+class RE_API VirtualFileSystem {
+	RE_NO_CONSTRUCT(VirtualFileSystem);
+
+public:
+	/**
+	 * Mounts the pack file at the given path at the mount point, which is a
+	 * directory (e.g. "res/textures"). A file "a.png" in the pack file is then
+	 * found as "res/textures/a.png". An empty mount point is the current
+	 * directory. When multiple pack files contain the same file, the pack file
+	 * that was mounted last is used. Throws a runtime_error if the pack file is
+	 * not valid.
+	 */
+	static void Mount(const std::string& pack_file, const std::string& mount_point = "");
+
+	/**
+	 * Unmounts all pack files that were mounted from the given path. Files
+	 * that were opened from the pack file stay valid.
+	 */
+	static void Unmount(const std::string& pack_file);
+
+	/**
+	 * Unmounts all pack files.
+	 */
+	static void UnmountAll();
+
+	/**
+	 * Returns the contents of the file at the given path, from a mounted pack
+	 * file if one contains it, or else from disk. Throws a runtime_error if
+	 * the file does not exist or could not be read.
+	 */
+	static virtual_file Open(const std::string& path);
+
+	/**
+	 * Returns whether a file exists at the given path, in a mounted pack file
+	 * or on disk.
+	 */
+	static bool Exists(const std::string& path);
+
+private:
+	struct mount {
+		std::string pack_file;
+		std::string mount_point;
+		std::shared_ptr<PackFile> pack;
+	};
+
+	static std::optional<virtual_file> _open_packed(const std::string& path);
+
+	static std::vector<mount> _mounts;
+	static std::shared_mutex _mounts_mutex;
+
+};
+
+}
+
+#endif
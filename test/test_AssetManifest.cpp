@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) Levi van Rheenen. All rights reserved.
+ */
+
+#include <gtest/gtest.h>
+#include <RheelEngine/Assets/AssetManifest.h>
+#include <RheelEngine/Assets/PreloadBatch.h>
+
+using namespace rheel;
+
+static std::size_t indexOf(const std::vector<std::string>& paths, const std::string& path) {
+	return std::find(paths.begin(), paths.end(), path) - paths.begin();
+}
+
+TEST(AssetManifest, Closure) {
+	AssetManifest manifest;
+	manifest.Add("forest.rmesh", { "bark.png", "leaves.png", "wind.glsl" });
+	manifest.Add("bush.rmesh", { "leaves.png" });
+	manifest.Add("wind.glsl", { "noise.glsl" });
+	manifest.Add("rock.rmesh");
+
+	EXPECT_TRUE(manifest.Contains("leaves.png"));
+	EXPECT_EQ(3u, manifest.GetDependencies("forest.rmesh").size());
+	EXPECT_THROW(manifest.GetDependencies("missing.png"), std::runtime_error);
+
+	auto closure = manifest.GetClosure({ "forest.rmesh", "bush.rmesh", "unlisted.png" });
+
+	// shared dependencies occur once, assets that are not needed are left out
+	ASSERT_EQ(7u, closure.size());
+	EXPECT_EQ(closure.size(), indexOf(closure, "rock.rmesh"));
+	EXPECT_LT(indexOf(closure, "unlisted.png"), closure.size());
+
+	// dependencies come before the assets that use them
+	EXPECT_LT(indexOf(closure, "noise.glsl"), indexOf(closure, "wind.glsl"));
+	EXPECT_LT(indexOf(closure, "wind.glsl"), indexOf(closure, "forest.rmesh"));
+	EXPECT_LT(indexOf(closure, "leaves.png"), indexOf(closure, "forest.rmesh"));
+	EXPECT_LT(indexOf(closure, "leaves.png"), indexOf(closure, "bush.rmesh"));
+
+	EXPECT_EQ(7u, manifest.GetClosure().size());
+}
+
+TEST(AssetManifest, RejectsCycles) {
+	AssetManifest manifest;
+	manifest.Add("a.glsl", { "b.glsl" });
+	manifest.Add("b.glsl", { "c.glsl" });
+	manifest.Add("c.glsl", { "a.glsl" });
+
+	EXPECT_THROW(manifest.GetClosure({ "a.glsl" }), std::runtime_error);
+}
+
+TEST(AssetManifest, Parse) {
+	AssetManifest manifest = AssetManifest::Parse(
+			"# the forest level\n"
+			"res/tree.rmesh: res/bark.png\tres/leaves.png # the tree\r\n"
+			"\n"
+			"res/tree.rmesh: res/bark.png res/moss.png\n"
+			"  res/sky.png  ");
+
+	EXPECT_EQ((std::vector<std::string>{ "res/bark.png", "res/leaves.png", "res/moss.png" }), manifest.GetDependencies("res/tree.rmesh"));
+	EXPECT_TRUE(manifest.GetDependencies("res/sky.png").empty());
+	EXPECT_EQ(5u, manifest.GetAssets().size());
+
+	EXPECT_THROW(AssetManifest::Parse("a.png b.png: c.png"), std::runtime_error);
+	EXPECT_THROW(AssetManifest::Parse(": c.png"), std::runtime_error);
+	EXPECT_THROW(AssetManifest::Parse("a.png: b.png: c.png"), std::runtime_error);
+}
+
+TEST(PreloadBatch, Progress) {
+	std::vector<std::string> loaded;
+
+	PreloadBatch batch(nullptr, { "a", "bb", "ccc" }, [&loaded](const std::string& path) {
+		loaded.push_back(path);
+		return path.size() * 100;
+	});
+
+	EXPECT_TRUE(batch.IsDone());
+	EXPECT_EQ(3u, batch.GetLoadedCount());
+	EXPECT_EQ(600u, batch.GetBytesLoaded());
+	EXPECT_FLOAT_EQ(1.0f, batch.GetProgress());
+	EXPECT_EQ((std::vector<std::string>{ "a", "bb", "ccc" }), loaded);
+	EXPECT_NO_THROW(batch.Wait());
+
+	PreloadBatch empty(nullptr, {}, [](const std::string&) { return std::size_t(0); });
+	EXPECT_TRUE(empty.IsDone());
+	EXPECT_FLOAT_EQ(1.0f, empty.GetProgress());
+}
+
+TEST(PreloadBatch, Errors) {
+	PreloadBatch batch(nullptr, { "a", "missing", "b" }, [](const std::string& path) {
+		if (path == "missing") {
+			throw std::runtime_error("missing");
+		}
+
+		return std::size_t(1);
+	});
+
+	// failed assets count as finished, so loading screens do not wait forever
+	EXPECT_TRUE(batch.IsDone());
+	EXPECT_EQ(2u, batch.GetBytesLoaded());
+	EXPECT_THROW(batch.Wait(), std::runtime_error);
+}
@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) Levi van Rheenen. All rights reserved.
+ */
+
+#include <gtest/gtest.h>
+#include <RheelEngine/AsyncTask.h>
+
+#include <thread>
+
+using namespace rheel;
+
+namespace {
+
+struct resume_on_new_thread {
+	bool await_ready() const noexcept {
+		return false;
+	}
+
+	void await_suspend(std::coroutine_handle<> handle) {
+		std::thread([handle]() { handle.resume(); }).detach();
+	}
+
+	void await_resume() const noexcept {}
+};
+
+struct resume_manually {
+	std::coroutine_handle<>* target;
+
+	bool await_ready() const noexcept {
+		return false;
+	}
+
+	void await_suspend(std::coroutine_handle<> handle) {
+		*target = handle;
+	}
+
+	void await_resume() const noexcept {}
+};
+
+}
+
+static AsyncTask<int> immediate(int value) {
+	co_return value;
+}
+
+static AsyncTask<int> on_other_thread(int value) {
+	co_await resume_on_new_thread{};
+	co_return value * 2;
+}
+
+static AsyncTask<int> chained(int value) {
+	int a = co_await immediate(value);
+	int b = co_await on_other_thread(value);
+	co_return a + b;
+}
+
+static AsyncTask<void> throwing() {
+	co_await resume_on_new_thread{};
+	throw std::runtime_error("error");
+}
+
+TEST(AsyncTask, Immediate) {
+	auto task = immediate(5);
+	EXPECT_EQ(task.IsDone(), true);
+	EXPECT_EQ(task.Get(), 5);
+}
+
+TEST(AsyncTask, OtherThread) {
+	EXPECT_EQ(on_other_thread(4).Get(), 8);
+	EXPECT_EQ(chained(3).Get(), 9);
+}
+
+TEST(AsyncTask, Exception) {
+	auto task = throwing();
+	EXPECT_THROW(task.Get(), std::runtime_error);
+}
+
+TEST(AsyncTask, Resume) {
+	std::coroutine_handle<> handle;
+	int stage = 0;
+
+	auto coroutine = [&]() -> AsyncTask<void> {
+		stage = 1;
+		co_await resume_manually{ &handle };
+		stage = 2;
+	};
+
+	auto task = coroutine();
+	EXPECT_EQ(stage, 1);
+	EXPECT_EQ(task.IsDone(), false);
+
+	handle.resume();
+	EXPECT_EQ(stage, 2);
+	EXPECT_EQ(task.IsDone(), true);
+}
+
+TEST(AsyncTask, Detached) {
+	std::coroutine_handle<> handle;
+	bool finished = false;
+
+	auto coroutine = [&]() -> AsyncTask<void> {
+		co_await resume_manually{ &handle };
+		finished = true;
+	};
+
+	// dropping the task must not destroy the running coroutine
+	coroutine();
+	EXPECT_EQ(finished, false);
+
+	handle.resume();
+	EXPECT_EQ(finished, true);
+}
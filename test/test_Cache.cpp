@@ -4,6 +4,9 @@
 
 #include <gtest/gtest.h>
 #include <RheelEngine/Util/Cache.h>
+#include <RheelEngine/Util/ShardedCache.h>
+
+#include <numeric>
 
 using namespace rheel;
 
@@ -15,6 +18,16 @@ static const auto& getLength2 = [](const std::string& str) {
 	return str.length() + 2;
 };
 
+static const auto& getString = [](const std::string& str) {
+	return std::string(4, str[0]);
+};
+
+struct string_cost {
+	std::size_t operator()(const std::string& str) const {
+		return str.length();
+	}
+};
+
 static const auto& getLengthSleep = [](const std::string& str) {
 	std::this_thread::sleep_for(std::chrono::milliseconds(50));
 	return str.length();
@@ -72,6 +85,58 @@ TEST(Cache, LeastRecentlyUsed) {
 	EXPECT_EQ(cache.ContainsKey("Hello"), false);
 }
 
+TEST(Cache, Clock) {
+	Cache<std::string, std::string::size_type, clock_policy> cache(4);
+
+	EXPECT_EQ(cache.Put("A", getLength), true);
+	EXPECT_EQ(cache.Put("B", getLength), true);
+	EXPECT_EQ(cache.Put("C", getLength), true);
+	EXPECT_EQ(cache.Put("D", getLength), true);
+
+	cache.Get("A");
+	cache.Get("C");
+
+	// the referenced elements get a second chance
+	EXPECT_EQ(cache.Put("E", getLength), true);
+	EXPECT_EQ(cache.ContainsKey("B"), false);
+	EXPECT_EQ(cache.Put("F", getLength), true);
+	EXPECT_EQ(cache.ContainsKey("D"), false);
+	EXPECT_EQ(cache.ContainsKey("A"), true);
+	EXPECT_EQ(cache.ContainsKey("C"), true);
+
+	// ... but only once
+	EXPECT_EQ(cache.Put("G", getLength), true);
+	EXPECT_EQ(cache.ContainsKey("A"), false);
+	EXPECT_EQ(cache.GetSize(), 4);
+}
+
+TEST(Cache, SegmentedLeastRecentlyUsed) {
+	Cache<std::string, std::string::size_type, segmented_least_recently_used_policy> cache(4, segmented_least_recently_used_policy(0.5f));
+
+	EXPECT_EQ(cache.Put("A", getLength), true);
+	EXPECT_EQ(cache.Put("B", getLength), true);
+	EXPECT_EQ(cache.Put("C", getLength), true);
+	EXPECT_EQ(cache.Put("D", getLength), true);
+
+	// protects B and C, A is demoted again because the protected segment is full
+	cache.Get("A");
+	cache.Get("B");
+	cache.Get("C");
+
+	EXPECT_EQ(cache.Put("E", getLength), true);
+	EXPECT_EQ(cache.ContainsKey("D"), false);
+
+	// a scan of new elements does not evict the protected elements
+	EXPECT_EQ(cache.Put("F", getLength), true);
+	EXPECT_EQ(cache.Put("G", getLength), true);
+	EXPECT_EQ(cache.Put("H", getLength), true);
+	EXPECT_EQ(cache.ContainsKey("A"), false);
+	EXPECT_EQ(cache.ContainsKey("E"), false);
+	EXPECT_EQ(cache.ContainsKey("B"), true);
+	EXPECT_EQ(cache.ContainsKey("C"), true);
+	EXPECT_EQ(cache.GetSize(), 4);
+}
+
 TEST(Cache, LastInFirstOut) {
 	Cache<std::string, std::string::size_type, last_in_frist_out_policy> cache(4);
 
@@ -120,3 +185,334 @@ TEST(Cache, MultithreadedKeep) {
 	t1.join();
 	t2.join();
 }
+
+TEST(Cache, MultithreadedConstructParallel) {
+	Cache<std::string, std::string::size_type, keep_policy, true> cache;
+	std::atomic<int> constructing = 0;
+
+	// Each constructor waits for the other one to start. If construction were
+	// done while holding the lock, this would never succeed.
+	const auto& getLengthTogether = [&](const std::string& str) {
+		constructing++;
+
+		auto start = std::chrono::steady_clock::now();
+		while (constructing < 2 && std::chrono::steady_clock::now() - start < std::chrono::seconds(2)) {
+			std::this_thread::yield();
+		}
+
+		return str.length();
+	};
+
+	std::thread t1([&](){ EXPECT_EQ(cache.Get("Hello", getLengthTogether), 5); });
+	std::thread t2([&](){ EXPECT_EQ(cache.Get("Hi", getLengthTogether), 2); });
+
+	t1.join();
+	t2.join();
+
+	EXPECT_EQ(constructing, 2);
+	EXPECT_EQ(cache.GetSize(), 2);
+}
+
+TEST(Cache, MultithreadedConstructorThrows) {
+	Cache<std::string, std::string::size_type, keep_policy, true> cache;
+	std::atomic<bool> started = false;
+
+	const auto& getLengthThrow = [&](const std::string&) -> std::string::size_type {
+		started = true;
+		std::this_thread::sleep_for(std::chrono::milliseconds(20));
+		throw std::runtime_error("error");
+	};
+
+	std::thread t1([&](){ EXPECT_THROW(cache.Get("Hello", getLengthThrow), std::runtime_error); });
+
+	while (!started) {
+		std::this_thread::yield();
+	}
+
+	// waits for the first constructor, and then constructs the value itself
+	EXPECT_EQ(cache.Get("Hello", getLength), 5);
+	t1.join();
+
+	EXPECT_EQ(cache.GetSize(), 1);
+}
+
+TEST(Cache, Cost) {
+	Cache<std::string, std::string, least_recently_used_policy, false, string_cost> cache(10);
+
+	EXPECT_EQ(cache.Get("a", getString), "aaaa");
+	EXPECT_EQ(cache.Get("b", getString), "bbbb");
+	EXPECT_EQ(cache.GetCost(), 8);
+
+	// evicts "a", which is least recently used
+	EXPECT_EQ(cache.Put("c", getString), true);
+	EXPECT_EQ(cache.GetCost(), 8);
+	EXPECT_EQ(cache.ContainsKey("a"), false);
+	EXPECT_EQ(cache.ContainsKey("b"), true);
+
+	// an element larger than the capacity evicts everything else
+	EXPECT_EQ(cache.Put("d", [](const std::string&) { return std::string(12, 'd'); }), true);
+	EXPECT_EQ(cache.GetSize(), 1);
+
+	cache.SetCapacity(100);
+	cache.Put("a", getString);
+	EXPECT_EQ(cache.Trim(4), 1);
+	EXPECT_EQ(cache.ContainsKey("a"), true);
+}
+
+TEST(Cache, MemoryPressure) {
+	Cache<std::string, std::string, least_recently_used_policy, true, string_cost> cache;
+	Cache<std::string, std::string, keep_policy, true, string_cost> keep;
+
+	for (std::string key : { "a", "b", "c", "d" }) {
+		cache.Put(key, getString);
+		keep.Put(key, getString);
+	}
+
+	CacheRegistry::SignalMemoryPressure(0.5f);
+
+	EXPECT_EQ(cache.GetCost(), 8);
+	EXPECT_EQ(cache.ContainsKey("a"), false);
+	EXPECT_EQ(cache.ContainsKey("d"), true);
+	EXPECT_EQ(keep.GetCost(), 16);
+}
+
+TEST(Cache, EraseAndClear) {
+	Cache<std::string, std::string::size_type, least_recently_used_policy> cache(4);
+
+	cache.Put("Hello", getLength);
+	cache.Put("Hi", getLength);
+	cache.Put("Test", getLength);
+
+	EXPECT_EQ(cache.Erase("Hi"), true);
+	EXPECT_EQ(cache.Erase("Hi"), false);
+	EXPECT_EQ(cache.ContainsKey("Hi"), false);
+	EXPECT_EQ(cache.GetSize(), 2);
+
+	// the erased element must not be picked for eviction anymore
+	cache.Put("Foo", getLength);
+	cache.Put("Bar", getLength);
+	cache.Put("Testing", getLength);
+	EXPECT_EQ(cache.ContainsKey("Hello"), false);
+	EXPECT_EQ(cache.GetSize(), 4);
+
+	cache.Clear();
+	EXPECT_EQ(cache.GetSize(), 0);
+	EXPECT_EQ(cache.GetCost(), 0);
+	EXPECT_EQ(cache.Get("Hello", getLength2), 7);
+}
+
+TEST(Cache, MultithreadedEraseAndInvalidate) {
+	Cache<std::string, std::string::size_type, least_recently_used_policy, true> cache(4);
+
+	cache.Put("Hello", getLength);
+	cache.Put("Hi", getLength);
+
+	// an invalidated value stays valid until it is reloaded, and after that
+	// for the threads that share it
+	const auto& value = cache.Get("Hello", getLength);
+	auto shared = cache.GetShared("Hello", getLength);
+	EXPECT_EQ(cache.Invalidate("Hello"), true);
+	EXPECT_EQ(value, 5);
+	EXPECT_EQ(cache.Get("Hello", getLength2), 7);
+	EXPECT_EQ(*shared, 5);
+	EXPECT_EQ(*cache.GetShared("Hello", getLength), 7);
+
+	EXPECT_EQ(cache.Erase("Hi"), true);
+	EXPECT_EQ(cache.ContainsKey("Hi"), false);
+	EXPECT_EQ(cache.Invalidate("Hi"), false);
+
+	cache.Clear();
+	EXPECT_EQ(cache.GetSize(), 0);
+	EXPECT_EQ(cache.GetCost(), 0);
+}
+
+TEST(Cache, MultithreadedReloadThrows) {
+	Cache<std::string, std::string::size_type, least_recently_used_policy, true> cache(4);
+	cache.Put("Hello", getLength);
+	cache.Invalidate("Hello");
+
+	const auto& getLengthThrows = [](const std::string&) -> std::string::size_type {
+		throw std::runtime_error("Could not reload");
+	};
+
+	// the old value is kept, and is reloaded again on the next access
+	EXPECT_THROW(cache.Get("Hello", getLengthThrows), std::runtime_error);
+	EXPECT_EQ(cache.ContainsKey("Hello"), true);
+	EXPECT_EQ(cache.Get("Hello"), 5);
+	EXPECT_EQ(cache.GetCost(), 1);
+	EXPECT_EQ(cache.Get("Hello", getLength2), 7);
+}
+
+TEST(Cache, MultithreadedEraseWhileLoading) {
+	Cache<std::string, std::string::size_type, least_recently_used_policy, true> cache(4);
+	std::atomic<bool> started = false;
+
+	const auto& getLengthSlow = [&](const std::string& str) {
+		started = true;
+		std::this_thread::sleep_for(std::chrono::milliseconds(20));
+		return str.length();
+	};
+
+	std::thread t1([&](){ EXPECT_EQ(cache.Get("Hello", getLengthSlow), 5); });
+
+	while (!started) {
+		std::this_thread::yield();
+	}
+
+	// the loading thread still gets its value, but it is loaded again after
+	cache.Clear();
+	t1.join();
+
+	EXPECT_EQ(cache.Get("Hello", getLength2), 7);
+	EXPECT_EQ(cache.GetSize(), 1);
+}
+
+TEST(Cache, StringViewLookup) {
+	Cache<std::string, std::string::size_type, least_recently_used_policy> cache(2);
+	Cache<std::string, std::string::size_type, least_recently_used_policy, true> threadsafe(2);
+
+	std::string_view key = "Hello, World";
+	key = key.substr(0, 5);
+
+	EXPECT_EQ(cache.Get(key, getLength), 5);
+	EXPECT_EQ(cache.ContainsKey("Hello"), true);
+	EXPECT_EQ(cache.Get(std::string("Hello")), 5);
+
+	EXPECT_EQ(threadsafe.Get(key, getLength), 5);
+	EXPECT_EQ(threadsafe.ContainsKey("Hello"), true);
+	EXPECT_EQ(threadsafe.Get(key), 5);
+}
+
+TEST(Cache, Statistics) {
+	if constexpr (!CacheStatistics::enabled) {
+		GTEST_SKIP() << "Cache statistics are disabled";
+	}
+
+	Cache<std::string, std::string::size_type, least_recently_used_policy> cache(1);
+	cache.SetName("Statistics");
+
+	cache.Get("Hello", getLength);
+	cache.Get("Hello", getLength);
+	cache.Put("Hi", getLength);
+
+	auto all = CacheStatistics::GetAll();
+	auto statistics = std::find_if(all.begin(), all.end(), [](const auto& s) { return s.name == "Statistics"; });
+	ASSERT_NE(statistics, all.end());
+
+	EXPECT_EQ(statistics->hits, 1);
+	EXPECT_EQ(statistics->misses, 2);
+	EXPECT_EQ(statistics->evictions, 1);
+	EXPECT_EQ(std::accumulate(statistics->load_time_histogram.begin(), statistics->load_time_histogram.end(), 0ull), 2);
+}
+
+TEST(Cache, ShardedKeep) {
+	ShardedCache<std::string, std::string::size_type> cache;
+
+	EXPECT_EQ(cache.Put("Hello", getLength), true);
+	EXPECT_EQ(cache.Put("Hello", getLength2), false);
+	EXPECT_EQ(cache.Get("Hello"), 5);
+	EXPECT_EQ(cache.ContainsKey("Hello"), true);
+
+	EXPECT_EQ(cache.Get("Test", getLength), 4);
+	EXPECT_EQ(cache.Get("Test", getLength2), 4);
+	EXPECT_EQ(cache.ContainsKey("Test"), true);
+
+	EXPECT_EQ(cache.Get("Testing", getLength2), 9);
+	EXPECT_EQ(cache.ContainsKey("Testing"), true);
+
+	EXPECT_EQ(cache.ContainsKey("Foo"), false);
+	EXPECT_EQ(cache.ContainsKey("Bar"), false);
+
+	EXPECT_EQ(cache.GetSize(), 3);
+}
+
+TEST(Cache, ShardedLeastRecentlyUsed) {
+	// the capacity and the policy are shared by all shards
+	ShardedCache<std::string, std::string::size_type, least_recently_used_policy> cache(4);
+
+	EXPECT_EQ(cache.GetCapacity(), 4);
+
+	EXPECT_EQ(cache.Put("Hello", getLength), true);
+	EXPECT_EQ(cache.Put("Hi", getLength), true);
+	EXPECT_EQ(cache.Put("Test", getLength), true);
+	EXPECT_EQ(cache.Put("Testing", getLength), true);
+
+	EXPECT_EQ(cache.Get("Hello", getLength2), 5);
+	cache.Get("Testing");
+	cache.Get("Hello");
+	cache.Get("Hi");
+	cache.Get("Testing");
+
+	EXPECT_EQ(cache.ContainsKey("Test"), true);
+	EXPECT_EQ(cache.Put("Foo", getLength), true);
+	EXPECT_EQ(cache.GetSize(), 4);
+	EXPECT_EQ(cache.ContainsKey("Test"), false);
+}
+
+TEST(Cache, ShardedCapacity) {
+	ShardedCache<int, int, last_in_frist_out_policy> cache(4);
+
+	for (int i = 0; i < 100; i++) {
+		cache.Put(i, [](int key) { return key; });
+		EXPECT_LE(cache.GetSize(), 4);
+	}
+
+	// the oldest elements are evicted first, whichever shard they are in
+	for (int i = 96; i < 100; i++) {
+		EXPECT_EQ(cache.ContainsKey(i), true);
+	}
+
+	cache.SetCapacity(2);
+	EXPECT_EQ(cache.GetSize(), 2);
+	EXPECT_EQ(cache.ContainsKey(98), true);
+	EXPECT_EQ(cache.ContainsKey(99), true);
+}
+
+TEST(Cache, ShardedCost) {
+	ShardedCache<std::string, std::string, least_recently_used_policy, string_cost> cache(32);
+
+	// an element larger than the capacity of a single shard still fits
+	EXPECT_EQ(cache.Put("a", [](const std::string&) { return std::string(20, 'a'); }), true);
+	EXPECT_EQ(cache.ContainsKey("a"), true);
+	EXPECT_EQ(cache.GetCost(), 20);
+
+	cache.Put("b", getString);
+	cache.Put("c", getString);
+	cache.Put("d", getString);
+	cache.Get("a");
+
+	// evicts "b" and "c", which are least recently used, from their shards
+	EXPECT_EQ(cache.Put("e", [](const std::string&) { return std::string(8, 'e'); }), true);
+	EXPECT_EQ(cache.GetCost(), 32);
+	EXPECT_EQ(cache.ContainsKey("a"), true);
+	EXPECT_EQ(cache.ContainsKey("b"), false);
+	EXPECT_EQ(cache.ContainsKey("c"), false);
+	EXPECT_EQ(cache.ContainsKey("d"), true);
+
+	// trimming and memory pressure also follow the global order
+	EXPECT_EQ(cache.Trim(28), 1);
+	EXPECT_EQ(cache.ContainsKey("d"), false);
+
+	CacheRegistry::SignalMemoryPressure(0.25f);
+	EXPECT_EQ(cache.GetCost(), 8);
+	EXPECT_EQ(cache.ContainsKey("e"), true);
+}
+
+TEST(Cache, ShardedMultithreaded) {
+	ShardedCache<int, int> cache;
+	std::vector<std::thread> threads;
+
+	for (int t = 0; t < 4; t++) {
+		threads.emplace_back([&cache]() {
+			for (int i = 0; i < 1000; i++) {
+				EXPECT_EQ(cache.Get(i, [](int key) { return key * 2; }), i * 2);
+			}
+		});
+	}
+
+	for (auto& thread : threads) {
+		thread.join();
+	}
+
+	EXPECT_EQ(cache.GetSize(), 1000);
+}
@@ -0,0 +1,160 @@
+/*
+ * Copyright (c) Levi van Rheenen. All rights reserved.
+ */
+
+#include <gtest/gtest.h>
+#include <RheelEngine/Util/Cache.h>
+#include <RheelEngine/Util/ShardedCache.h>
+
+#include <chrono>
+#include <random>
+#include <thread>
+
+using namespace rheel;
+
+static constexpr int benchmark_keys = 1024;
+static constexpr int benchmark_reads = 200000;
+
+/*
+ * Measures the total number of cache reads per second, when all threads read
+ * (already loaded) values from the same cache.
+ */
+template<typename C>
+static double measure_reads(C& cache, unsigned thread_count) {
+	std::vector<std::thread> threads;
+	threads.reserve(thread_count);
+
+	auto start = std::chrono::steady_clock::now();
+
+	for (unsigned t = 0; t < thread_count; t++) {
+		threads.emplace_back([&cache, t]() {
+			std::size_t sum = 0;
+
+			for (int i = 0; i < benchmark_reads; i++) {
+				int key = static_cast<int>((i * 7919 + t * 104729) % benchmark_keys);
+				sum += cache.Get(key, [](int k) { return k; });
+			}
+
+			EXPECT_GT(sum, 0);
+		});
+	}
+
+	for (auto& thread : threads) {
+		thread.join();
+	}
+
+	std::chrono::duration<double> duration = std::chrono::steady_clock::now() - start;
+	return (double(thread_count) * benchmark_reads) / duration.count();
+}
+
+template<typename C>
+static void benchmark_read_scaling(const std::string& name) {
+	C cache;
+
+	for (int i = 0; i < benchmark_keys; i++) {
+		cache.Put(i, [](int k) { return k; });
+	}
+
+	// measure with 1, 2, 4, ... threads, up to the number of cores
+	unsigned max_threads = std::max(1u, std::thread::hardware_concurrency());
+	std::vector<unsigned> thread_counts;
+
+	for (unsigned threads = 1; threads < max_threads; threads *= 2) {
+		thread_counts.push_back(threads);
+	}
+
+	thread_counts.push_back(max_threads);
+
+	double single = 0.0;
+
+	for (unsigned threads : thread_counts) {
+		double reads = measure_reads(cache, threads);
+		if (threads == 1) {
+			single = reads;
+		}
+
+		std::cout << name << " " << threads << " threads: "
+				  << std::fixed << std::setprecision(2) << reads / 1.0e6 << " M reads/s ("
+				  << reads / single << "x)" << std::endl;
+	}
+}
+
+TEST(CacheBenchmark, ReadScaling) {
+	benchmark_read_scaling<Cache<int, int, keep_policy, true>>("Cache");
+	benchmark_read_scaling<ShardedCache<int, int>>("ShardedCache");
+}
+
+static constexpr int trace_keys = 4096;
+static constexpr int trace_length = 200000;
+static constexpr int trace_capacity = 512;
+
+/*
+ * Generates a synthetic asset access trace, where the popularity of the assets
+ * follows a Zipf distribution. If scans is true, the trace is interrupted by
+ * bursts of assets that are used only once, like when a new level is loaded.
+ */
+static std::vector<int> generate_trace(bool scans) {
+	std::vector<double> weights(trace_keys);
+	for (int i = 0; i < trace_keys; i++) {
+		weights[i] = 1.0 / (i + 1);
+	}
+
+	std::mt19937 random(42);
+	std::discrete_distribution<int> distribution(weights.begin(), weights.end());
+
+	std::vector<int> trace;
+	trace.reserve(trace_length);
+
+	int scan_key = trace_keys;
+
+	while (trace.size() < std::size_t(trace_length)) {
+		if (scans && trace.size() % 20000 == 10000) {
+			for (int i = 0; i < 1024; i++) {
+				trace.push_back(scan_key++);
+			}
+		}
+
+		trace.push_back(distribution(random));
+	}
+
+	return trace;
+}
+
+template<typename Policy>
+static void benchmark_policy(const std::string& name, const std::vector<int>& trace) {
+	Cache<int, int, Policy> cache(trace_capacity);
+	std::size_t misses = 0;
+
+	auto start = std::chrono::steady_clock::now();
+
+	for (int key : trace) {
+		cache.Get(key, [&misses](int k) {
+			misses++;
+			return k;
+		});
+	}
+
+	std::chrono::duration<double> duration = std::chrono::steady_clock::now() - start;
+	double hit_rate = 1.0 - double(misses) / double(trace.size());
+
+	std::cout << name << ": " << std::fixed << std::setprecision(2)
+			  << hit_rate * 100.0 << "% hits, "
+			  << double(trace.size()) / duration.count() / 1.0e6 << " M accesses/s" << std::endl;
+
+	EXPECT_GT(hit_rate, 0.0);
+}
+
+static void benchmark_policies(const std::vector<int>& trace) {
+	benchmark_policy<least_recently_used_policy>("LRU", trace);
+	benchmark_policy<clock_policy>("CLOCK", trace);
+	benchmark_policy<segmented_least_recently_used_policy>("SLRU", trace);
+	benchmark_policy<last_in_frist_out_policy>("FIFO", trace);
+}
+
+TEST(CacheBenchmark, PolicySkewed) {
+	benchmark_policies(generate_trace(false));
+}
+
+TEST(CacheBenchmark, PolicySkewedWithScans) {
+	benchmark_policies(generate_trace(true));
+}
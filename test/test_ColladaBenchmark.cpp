@@ -0,0 +1,182 @@
+/*
+ * Copyright (c) Levi van Rheenen. All rights reserved.
+ */
+
+#include <gtest/gtest.h>
+#include <RheelEngine/Assets/Loaders/ColladaLoader.h>
+#include <RheelEngine/Util/NumberParser.h>
+
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <random>
+
+using namespace rheel;
+
+static constexpr int benchmark_geometries = 8;
+static constexpr int benchmark_grid_size = 128;
+
+/*
+ * Writes a collada file with a number of geometries, each a grid of
+ * grid_size x grid_size quads with pseudo-random heights.
+ */
+static void write_collada_grid(const std::string& path, int geometries, int grid_size) {
+	std::ofstream output(path);
+	std::mt19937 random(42);
+	std::uniform_real_distribution<float> height(-1.0f, 1.0f);
+
+	int vertex_count = (grid_size + 1) * (grid_size + 1);
+	int triangle_count = grid_size * grid_size * 2;
+
+	output << "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n";
+	output << "<COLLADA>\n  <asset>\n    <up_axis>Y_UP</up_axis>\n  </asset>\n";
+	output << "  <library_geometries>\n";
+
+	for (int g = 0; g < geometries; g++) {
+		std::string id = "grid" + std::to_string(g);
+
+		output << "    <geometry id=\"" << id << "\">\n      <mesh>\n";
+
+		output << "        <source id=\"" << id << "-positions\">\n";
+		output << "          <float_array count=\"" << 3 * vertex_count << "\">";
+		for (int z = 0; z <= grid_size; z++) {
+			for (int x = 0; x <= grid_size; x++) {
+				output << x << " " << height(random) << " " << z << " ";
+			}
+		}
+		output << "</float_array>\n        </source>\n";
+
+		output << "        <source id=\"" << id << "-normals\">\n";
+		output << "          <float_array count=\"" << 3 * vertex_count << "\">";
+		for (int i = 0; i < vertex_count; i++) {
+			output << height(random) << " 1 " << height(random) << "\n";
+		}
+		output << "</float_array>\n        </source>\n";
+
+		output << "        <source id=\"" << id << "-texcoords\">\n";
+		output << "          <float_array count=\"" << 2 * vertex_count << "\">";
+		for (int z = 0; z <= grid_size; z++) {
+			for (int x = 0; x <= grid_size; x++) {
+				output << float(x) / float(grid_size) << " " << float(z) / float(grid_size) << " ";
+			}
+		}
+		output << "</float_array>\n";
+		output << "          <technique_common>\n";
+		output << "            <accessor source=\"#" << id << "-texcoords-array\" count=\"" << vertex_count << "\" stride=\"2\"/>\n";
+		output << "          </technique_common>\n        </source>\n";
+
+		output << "        <vertices id=\"" << id << "-vertices\">\n";
+		output << "          <input semantic=\"POSITION\" source=\"#" << id << "-positions\"/>\n";
+		output << "        </vertices>\n";
+
+		output << "        <polylist count=\"" << triangle_count << "\">\n";
+		output << "          <input semantic=\"VERTEX\" source=\"#" << id << "-vertices\" offset=\"0\"/>\n";
+		output << "          <input semantic=\"NORMAL\" source=\"#" << id << "-normals\" offset=\"1\"/>\n";
+		output << "          <input semantic=\"TEXCOORD\" source=\"#" << id << "-texcoords\" offset=\"2\"/>\n";
+
+		output << "          <vcount>";
+		for (int i = 0; i < triangle_count; i++) {
+			output << "3 ";
+		}
+		output << "</vcount>\n          <p>";
+
+		auto write_vertex = [&output, grid_size](int x, int z) {
+			int index = z * (grid_size + 1) + x;
+			output << index << " " << index << " " << index << " ";
+		};
+
+		for (int z = 0; z < grid_size; z++) {
+			for (int x = 0; x < grid_size; x++) {
+				write_vertex(x, z);
+				write_vertex(x, z + 1);
+				write_vertex(x + 1, z + 1);
+				write_vertex(x, z);
+				write_vertex(x + 1, z + 1);
+				write_vertex(x + 1, z);
+			}
+		}
+
+		output << "</p>\n        </polylist>\n      </mesh>\n    </geometry>\n";
+	}
+
+	output << "  </library_geometries>\n";
+	output << "  <library_visual_scenes>\n    <visual_scene id=\"scene\">\n";
+
+	for (int g = 0; g < geometries; g++) {
+		output << "      <node id=\"node" << g << "\">\n";
+		output << "        <matrix sid=\"transform\">1 0 0 " << g * grid_size << " 0 1 0 0 0 0 1 0 0 0 0 1</matrix>\n";
+		output << "        <instance_geometry url=\"#grid" << g << "\"/>\n";
+		output << "      </node>\n";
+	}
+
+	output << "    </visual_scene>\n  </library_visual_scenes>\n</COLLADA>\n";
+}
+
+/*
+ * The number parsing that was used by the collada loader before it used
+ * std::from_chars, kept as a baseline.
+ */
+static std::vector<float> parse_floats_strtof(const char* values) {
+	std::vector<float> vec;
+	const char* tmp = values;
+
+	do {
+		int l = strcspn(tmp, " ");
+
+		if (l > 0) {
+			vec.push_back(strtof(tmp, nullptr));
+		}
+
+		tmp += l + 1;
+	} while (tmp[-1]);
+
+	return vec;
+}
+
+TEST(ColladaBenchmark, ParseNumbers) {
+	constexpr std::size_t count = 2000000;
+
+	std::mt19937 random(42);
+	std::uniform_real_distribution<float> distribution(-1000.0f, 1000.0f);
+
+	std::string text;
+	for (std::size_t i = 0; i < count; i++) {
+		text += std::to_string(distribution(random));
+		text += ' ';
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	std::vector<float> baseline = parse_floats_strtof(text.c_str());
+	std::chrono::duration<double, std::milli> baseline_duration = std::chrono::steady_clock::now() - start;
+
+	start = std::chrono::steady_clock::now();
+	std::vector<float> values;
+	parse_numbers(text, values, count);
+	std::chrono::duration<double, std::milli> duration = std::chrono::steady_clock::now() - start;
+
+	EXPECT_EQ(baseline, values);
+
+	std::cout << "Parsing " << count << " floats: strtof " << baseline_duration.count() << " ms, "
+			  << "from_chars " << duration.count() << " ms" << std::endl;
+}
+
+TEST(ColladaBenchmark, LoadLargeFile) {
+	std::string path = (std::filesystem::temp_directory_path() / "rheel_benchmark_grid.dae").string();
+	write_collada_grid(path, benchmark_geometries, benchmark_grid_size);
+
+	auto start = std::chrono::steady_clock::now();
+	Model model = ColladaLoader().Load(path);
+	std::chrono::duration<double, std::milli> duration = std::chrono::steady_clock::now() - start;
+
+	auto file_size = std::filesystem::file_size(path);
+	std::filesystem::remove(path);
+
+	int vertices_per_geometry = (benchmark_grid_size + 1) * (benchmark_grid_size + 1);
+	int triangles_per_geometry = benchmark_grid_size * benchmark_grid_size * 2;
+
+	EXPECT_EQ(std::size_t(benchmark_geometries * vertices_per_geometry), model.GetVertices().size());
+	EXPECT_EQ(std::size_t(benchmark_geometries * triangles_per_geometry * 3), model.GetIndices().size());
+
+	std::cout << "Loading a " << file_size / (1024 * 1024) << " MiB collada file: " << duration.count() << " ms" << std::endl;
+}
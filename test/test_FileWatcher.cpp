@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) Levi van Rheenen. All rights reserved.
+ */
+
+#include <gtest/gtest.h>
+#include <RheelEngine/Util/FileWatcher.h>
+
+#include <fstream>
+#include <thread>
+
+using namespace rheel;
+
+static std::vector<std::string> pollUntilChanged(FileWatcher& watcher) {
+	for (int i = 0; i < 20; i++) {
+		if (auto changed = watcher.Poll(std::chrono::milliseconds(100)); !changed.empty()) {
+			return changed;
+		}
+	}
+
+	return {};
+}
+
+TEST(FileWatcher, DetectsChanges) {
+	auto directory = std::filesystem::temp_directory_path() / "rheel_test_watcher";
+	std::filesystem::remove_all(directory);
+	std::filesystem::create_directories(directory / "textures");
+	std::ofstream(directory / "textures" / "a.png") << "old";
+
+	// make sure the new modification time differs on file systems with a
+	// coarse time resolution
+	std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+	FileWatcher watcher(directory.string());
+	EXPECT_TRUE(watcher.Poll().empty());
+
+	std::ofstream(directory / "textures" / "a.png") << "new";
+	std::ofstream(directory / "textures" / "a.png", std::ios::app) << "er";
+
+	auto changed = pollUntilChanged(watcher);
+	ASSERT_EQ(1u, changed.size());
+	EXPECT_EQ((directory / "textures" / "a.png").generic_string(), changed[0]);
+	EXPECT_TRUE(watcher.Poll().empty());
+
+	std::filesystem::remove_all(directory);
+}
+
+#if defined(__linux__)
+TEST(FileWatcher, WatchesNewDirectories) {
+	auto directory = std::filesystem::temp_directory_path() / "rheel_test_watcher_new";
+	std::filesystem::remove_all(directory);
+	std::filesystem::create_directories(directory);
+
+	FileWatcher watcher(directory.string());
+
+	std::filesystem::create_directories(directory / "models");
+	EXPECT_TRUE(watcher.Poll(std::chrono::milliseconds(100)).empty());
+
+	std::ofstream(directory / "models" / "tree.dae") << "tree";
+
+	auto changed = pollUntilChanged(watcher);
+	ASSERT_EQ(1u, changed.size());
+	EXPECT_EQ((directory / "models" / "tree.dae").generic_string(), changed[0]);
+
+	std::filesystem::remove_all(directory);
+}
+
+TEST(FileWatcher, SkipsRemovedDirectories) {
+	auto directory = std::filesystem::temp_directory_path() / "rheel_test_watcher_removed";
+	std::filesystem::remove_all(directory);
+	std::filesystem::create_directories(directory);
+
+	FileWatcher watcher(directory.string());
+
+	// the directory is gone before the watcher sees it
+	std::filesystem::create_directories(directory / "temp");
+	std::filesystem::remove(directory / "temp");
+	EXPECT_NO_THROW(watcher.Poll(std::chrono::milliseconds(100)));
+
+	std::ofstream(directory / "a.png") << "a";
+
+	auto changed = pollUntilChanged(watcher);
+	ASSERT_EQ(1u, changed.size());
+	EXPECT_EQ((directory / "a.png").generic_string(), changed[0]);
+
+	std::filesystem::remove_all(directory);
+}
+#endif
+
+TEST(FileWatcher, InvalidDirectory) {
+	EXPECT_THROW(FileWatcher("/this/directory/does/not/exist"), std::runtime_error);
+}
@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) Levi van Rheenen. All rights reserved.
+ */
+
+#include <gtest/gtest.h>
+#include <RheelEngine/Assets/Image.h>
+
+using namespace rheel;
+
+static constexpr float e = 0.51f / 255.0f;
+
+static std::vector<Color> createGradient(unsigned width, unsigned height) {
+	std::vector<Color> pixels;
+
+	for (unsigned y = 0; y < height; y++) {
+		for (unsigned x = 0; x < width; x++) {
+			pixels.emplace_back(float(x) / float(width), float(y) / float(height), 0.25f, 1.0f - float(x) / float(width));
+		}
+	}
+
+	return pixels;
+}
+
+TEST(Image, MemoryUsage) {
+	Image rgba8(64, 64, PixelFormat::RGBA8);
+	Image rg8(64, 64, PixelFormat::RG8);
+	Image r8(64, 64, PixelFormat::R8);
+	Image rgba16f(64, 64, PixelFormat::RGBA16F);
+
+	EXPECT_EQ(64u * 64u * 4u, rgba8.GetData().size());
+	EXPECT_EQ(64u * 64u * 2u, rg8.GetData().size());
+	EXPECT_EQ(64u * 64u * 1u, r8.GetData().size());
+	EXPECT_EQ(64u * 64u * 8u, rgba16f.GetData().size());
+}
+
+TEST(Image, PixelsRoundTrip) {
+	// an odd width exercises both the vectorized and the scalar conversions
+	unsigned width = 13;
+	unsigned height = 5;
+	std::vector<Color> pixels = createGradient(width, height);
+
+	for (PixelFormat format : { PixelFormat::RGBA8, PixelFormat::RGBA16F }) {
+		Image image(width, height, pixels, format);
+		std::vector<float> rgba = image.GetFloatData();
+
+		for (unsigned i = 0; i < width * height; i++) {
+			EXPECT_NEAR(pixels[i].Red(), rgba[4 * i + 0], e);
+			EXPECT_NEAR(pixels[i].Green(), rgba[4 * i + 1], e);
+			EXPECT_NEAR(pixels[i].Blue(), rgba[4 * i + 2], e);
+			EXPECT_NEAR(pixels[i].Alpha(), rgba[4 * i + 3], e);
+		}
+	}
+}
+
+TEST(Image, MissingChannels) {
+	Image image(2, 1, PixelFormat::RG8);
+	image.SetPixel(1, 0, Color(1.0f, 0.5f, 0.75f, 0.25f));
+
+	Color pixel = image.GetPixel(1, 0);
+	EXPECT_FLOAT_EQ(1.0f, pixel.Red());
+	EXPECT_NEAR(0.5f, pixel.Green(), e);
+	EXPECT_FLOAT_EQ(0.0f, pixel.Blue());
+	EXPECT_FLOAT_EQ(1.0f, pixel.Alpha());
+
+	EXPECT_EQ(Color(0.0f, 0.0f, 0.0f, 1.0f), image.GetPixel(0, 0));
+}
+
+TEST(Image, Rgba8Rounding) {
+	Image image(5, 1, { Color(0.0f, 1.0f, 0.5f, 0.2f), Color(), Color(), Color(), Color(1.0f, 1.0f, 1.0f) });
+
+	auto data = image.GetData();
+	EXPECT_EQ(0, data[0]);
+	EXPECT_EQ(255, data[1]);
+	EXPECT_EQ(128, data[2]);
+	EXPECT_EQ(51, data[3]);
+	EXPECT_EQ(255, data[16]);
+}
+
+TEST(Image, HalfFloats) {
+	std::vector<float> rgba{ 0.0f, -2.0f, 65504.0f, 1e-7f, 1e6f, 0.333333f, 1.0f, 0.5f };
+	std::vector<std::uint8_t> pixels(16);
+	Image::EncodePixels(PixelFormat::RGBA16F, rgba.data(), pixels.data(), 2);
+
+	std::vector<float> decoded(8);
+	Image::DecodePixels(PixelFormat::RGBA16F, pixels.data(), decoded.data(), 2);
+
+	EXPECT_EQ(0.0f, decoded[0]);
+	EXPECT_EQ(-2.0f, decoded[1]);
+	EXPECT_EQ(65504.0f, decoded[2]);
+	EXPECT_NEAR(1e-7f, decoded[3], 1e-7f);
+	EXPECT_TRUE(std::isinf(decoded[4]));
+	EXPECT_NEAR(0.333333f, decoded[5], 0.0005f);
+	EXPECT_EQ(1.0f, decoded[6]);
+	EXPECT_EQ(0.5f, decoded[7]);
+}
+
+TEST(Image, SubImage) {
+	Image image(8, 8, createGradient(8, 8), PixelFormat::RG8);
+	Image sub = image.SubImage(2, 3, 4, 2);
+
+	EXPECT_EQ(PixelFormat::RG8, sub.GetFormat());
+
+	for (unsigned y = 0; y < 2; y++) {
+		for (unsigned x = 0; x < 4; x++) {
+			EXPECT_EQ(image.GetPixel(x + 2, y + 3), sub.GetPixel(x, y));
+		}
+	}
+}
+
+TEST(Image, ConvertTo) {
+	Image image(4, 4, createGradient(4, 4));
+	Image converted = image.ConvertTo(PixelFormat::R8);
+
+	EXPECT_EQ(PixelFormat::R8, converted.GetFormat());
+	EXPECT_EQ(16u, converted.GetData().size());
+
+	for (unsigned y = 0; y < 4; y++) {
+		for (unsigned x = 0; x < 4; x++) {
+			EXPECT_EQ(image.GetPixel(x, y).Red(), converted.GetPixel(x, y).Red());
+		}
+	}
+}
@@ -0,0 +1,120 @@
+/*
+ * Copyright (c) Levi van Rheenen. All rights reserved.
+ */
+
+#include <gtest/gtest.h>
+#include <RheelEngine/Assets/Loaders/MeshLoader.h>
+
+#include <filesystem>
+#include <fstream>
+
+using namespace rheel;
+
+static std::string temporaryPath(const std::string& name) {
+	return (std::filesystem::temp_directory_path() / name).string();
+}
+
+static Model createQuad() {
+	std::vector<model_vertex> vertices{
+			{ { -1.0f, 0.0f, -2.0f }, { 0.0f, 1.0f, 0.0f }, { 0.0f, 0.0f } },
+			{ { 1.0f, 0.0f, -2.0f }, { 0.0f, 1.0f, 0.0f }, { 1.0f, 0.0f } },
+			{ { 1.0f, 0.5f, 2.0f }, { 0.0f, 1.0f, 0.0f }, { 1.0f, 1.0f } },
+			{ { -1.0f, 0.5f, 2.0f }, { 0.0f, 1.0f, 0.0f }, { 0.0f, 1.0f } }
+	};
+
+	return Model(std::move(vertices), { 0, 1, 2, 0, 2, 3 });
+}
+
+TEST(MeshLoader, Bounds) {
+	Model model = createQuad();
+
+	EXPECT_EQ(vec3(-1.0f, 0.0f, -2.0f), model.GetBounds().min);
+	EXPECT_EQ(vec3(1.0f, 0.5f, 2.0f), model.GetBounds().max);
+}
+
+TEST(MeshLoader, RoundTrip) {
+	std::string path = temporaryPath("rheel_test_round_trip.rmesh");
+	Model model = createQuad();
+	MeshLoader::Write(model, path);
+
+	Model loaded = MeshLoader().Load(path);
+	std::filesystem::remove(path);
+
+	ASSERT_EQ(model.GetVertices().size(), loaded.GetVertices().size());
+	ASSERT_EQ(model.GetIndices().size(), loaded.GetIndices().size());
+
+	for (std::size_t i = 0; i < model.GetVertices().size(); i++) {
+		EXPECT_EQ(model.GetVertices()[i].position, loaded.GetVertices()[i].position);
+		EXPECT_EQ(model.GetVertices()[i].normal, loaded.GetVertices()[i].normal);
+		EXPECT_EQ(model.GetVertices()[i].texture, loaded.GetVertices()[i].texture);
+	}
+
+	for (std::size_t i = 0; i < model.GetIndices().size(); i++) {
+		EXPECT_EQ(model.GetIndices()[i], loaded.GetIndices()[i]);
+	}
+
+	EXPECT_EQ(model.GetBounds().min, loaded.GetBounds().min);
+	EXPECT_EQ(model.GetBounds().max, loaded.GetBounds().max);
+	EXPECT_EQ(RenderType::TRIANGLES, loaded.GetRenderType());
+	EXPECT_TRUE(loaded.GetLods().empty());
+}
+
+TEST(MeshLoader, OverwriteWhileLoaded) {
+	std::string path = temporaryPath("rheel_test_overwrite.rmesh");
+	MeshLoader::Write(createQuad(), path);
+
+	Model loaded = MeshLoader().Load(path);
+
+	// the loaded model refers to the old file, which must stay intact
+	Model triangle(std::vector<model_vertex>(loaded.GetVertices().begin(), loaded.GetVertices().begin() + 3), { 2, 1, 0 });
+	MeshLoader::Write(triangle, path);
+
+	EXPECT_EQ(4u, loaded.GetVertices().size());
+	EXPECT_EQ(0u, loaded.GetIndices()[0]);
+	EXPECT_EQ(3u, loaded.GetIndices()[5]);
+
+	EXPECT_EQ(2u, MeshLoader().Load(path).GetIndices()[0]);
+	EXPECT_FALSE(std::filesystem::exists(path + ".tmp"));
+
+	std::filesystem::remove(path);
+}
+
+TEST(MeshLoader, RejectsInvalidFiles) {
+	std::string path = temporaryPath("rheel_test_invalid.rmesh");
+
+	{
+		std::ofstream output(path, std::ios::binary);
+		output << "this is not a mesh file, but it is long enough to hold a mesh header";
+	}
+
+	EXPECT_THROW(MeshLoader().Load(path), std::runtime_error);
+	std::filesystem::remove(path);
+
+	EXPECT_THROW(MeshLoader().Load(temporaryPath("rheel_test_missing.rmesh")), std::runtime_error);
+}
+
+TEST(MeshLoader, RejectsTruncatedFiles) {
+	std::string path = temporaryPath("rheel_test_truncated.rmesh");
+	MeshLoader::Write(createQuad(), path);
+	std::filesystem::resize_file(path, std::filesystem::file_size(path) - 8);
+
+	EXPECT_THROW(MeshLoader().Load(path), std::runtime_error);
+	std::filesystem::remove(path);
+}
+
+TEST(MeshLoader, RejectsInvalidIndices) {
+	std::string path = temporaryPath("rheel_test_invalid_indices.rmesh");
+	MeshLoader::Write(createQuad(), path);
+
+	// the indices start after the 80-byte header and the 4 vertices, aligned
+	// to 16 bytes
+	{
+		std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+		unsigned index = 4;
+		file.seekp(208 + 5 * sizeof(unsigned));
+		file.write(reinterpret_cast<const char*>(&index), sizeof(unsigned));
+	}
+
+	EXPECT_THROW(MeshLoader().Load(path), std::runtime_error);
+	std::filesystem::remove(path);
+}
@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) Levi van Rheenen. All rights reserved.
+ */
+
+#include <gtest/gtest.h>
+#include <RheelEngine/Assets/MeshOptimizer.h>
+
+#include <algorithm>
+#include <array>
+#include <random>
+
+using namespace rheel;
+
+// a grid of size x size quads, with the triangles in random order
+static Model createShuffledGrid(unsigned size) {
+	std::vector<model_vertex> vertices;
+
+	for (unsigned y = 0; y <= size; y++) {
+		for (unsigned x = 0; x <= size; x++) {
+			vertices.push_back({ { float(x), 0.0f, float(y) }, { 0.0f, 1.0f, 0.0f }, { float(x), float(y) } });
+		}
+	}
+
+	std::vector<std::array<unsigned, 3>> triangles;
+
+	for (unsigned y = 0; y < size; y++) {
+		for (unsigned x = 0; x < size; x++) {
+			unsigned i = y * (size + 1) + x;
+			triangles.push_back({ i, i + size + 1, i + 1 });
+			triangles.push_back({ i + 1, i + size + 1, i + size + 2 });
+		}
+	}
+
+	std::shuffle(triangles.begin(), triangles.end(), std::mt19937(17));
+
+	std::vector<unsigned> indices;
+	for (const auto& triangle : triangles) {
+		indices.insert(indices.end(), triangle.begin(), triangle.end());
+	}
+
+	return Model(std::move(vertices), std::move(indices));
+}
+
+// the triangles of the model as sorted position triples, in the given range of
+// indices
+static std::vector<std::array<float, 9>> triangles(const Model& model, std::size_t first, std::size_t count) {
+	std::vector<std::array<float, 9>> result;
+
+	for (std::size_t i = first; i < first + count; i += 3) {
+		std::array<float, 9> triangle{};
+
+		for (std::size_t k = 0; k < 3; k++) {
+			vec3 position = model.GetVertices()[model.GetIndices()[i + k]].position;
+			triangle[3 * k] = position.x;
+			triangle[3 * k + 1] = position.y;
+			triangle[3 * k + 2] = position.z;
+		}
+
+		result.push_back(triangle);
+	}
+
+	std::sort(result.begin(), result.end());
+	return result;
+}
+
+TEST(MeshOptimizer, KeepsTriangles) {
+	Model model = createShuffledGrid(32);
+	Model optimized = MeshOptimizer::Optimize(model);
+
+	ASSERT_EQ(model.GetIndices().size(), optimized.GetIndices().size());
+	EXPECT_EQ(triangles(model, 0, model.GetIndices().size()), triangles(optimized, 0, optimized.GetIndices().size()));
+	EXPECT_EQ(model.GetBounds().min, optimized.GetBounds().min);
+	EXPECT_EQ(model.GetBounds().max, optimized.GetBounds().max);
+}
+
+TEST(MeshOptimizer, ImprovesCacheStatistics) {
+	Model model = createShuffledGrid(64);
+	mesh_statistics before = MeshOptimizer::Analyze(model);
+	mesh_statistics after = MeshOptimizer::Analyze(MeshOptimizer::Optimize(model));
+
+	EXPECT_EQ(2u * 64u * 64u, after.triangle_count);
+	EXPECT_GT(before.acmr, 2.0f);
+	EXPECT_LT(after.acmr, 1.0f);
+	EXPECT_GE(after.atvr, 1.0f);
+	EXPECT_LT(after.atvr, before.atvr);
+	EXPECT_GE(after.overfetch, 1.0f);
+	EXPECT_LT(after.overfetch, before.overfetch);
+}
+
+TEST(MeshOptimizer, OrdersVerticesByFirstUse) {
+	std::vector<model_vertex> vertices(5);
+	for (std::size_t i = 0; i < vertices.size(); i++) {
+		vertices[i].position = vec3(float(i), float(i * i), 0.0f);
+	}
+
+	// vertex 1 is not used
+	std::vector<unsigned> indices{ 4, 2, 0, 0, 2, 3 };
+	MeshOptimizer::OptimizeVertexFetch(vertices, indices);
+
+	ASSERT_EQ(4u, vertices.size());
+	EXPECT_EQ((std::vector<unsigned>{ 0, 1, 2, 2, 1, 3 }), indices);
+	EXPECT_EQ(4.0f, vertices[0].position.x);
+	EXPECT_EQ(2.0f, vertices[1].position.x);
+	EXPECT_EQ(0.0f, vertices[2].position.x);
+	EXPECT_EQ(3.0f, vertices[3].position.x);
+}
+
+TEST(MeshOptimizer, KeepsLevelsOfDetail) {
+	Model grid = createShuffledGrid(16);
+
+	// the second half of the triangles acts as a lower level of detail
+	std::size_t half = grid.GetIndices().size() / 2;
+	std::vector<model_lod> lods{
+			{ 0, std::uint32_t(grid.GetIndices().size()), 0.0f },
+			{ std::uint32_t(half), std::uint32_t(half), 0.5f }
+	};
+
+	Model model(std::vector<model_vertex>(grid.GetVertices().begin(), grid.GetVertices().end()),
+			std::vector<unsigned>(grid.GetIndices().begin(), grid.GetIndices().end()), lods);
+	Model optimized = MeshOptimizer::Optimize(model);
+
+	ASSERT_EQ(2u, optimized.GetLods().size());
+	EXPECT_EQ(half, optimized.GetLods()[1].first_index);
+	EXPECT_EQ(triangles(model, 0, half), triangles(optimized, 0, half));
+	EXPECT_EQ(triangles(model, half, half), triangles(optimized, half, half));
+}
+
+TEST(MeshOptimizer, IgnoresLines) {
+	Model lines(std::vector<model_vertex>(3), { 2, 1, 1, 0 }, RenderType::LINES);
+	Model optimized = MeshOptimizer::Optimize(lines);
+
+	EXPECT_EQ(lines.GetIndices().data(), optimized.GetIndices().data());
+}
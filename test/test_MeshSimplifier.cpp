@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) Levi van Rheenen. All rights reserved.
+ */
+
+#include <gtest/gtest.h>
+#include <RheelEngine/Assets/MeshSimplifier.h>
+
+#include <cmath>
+
+using namespace rheel;
+
+// a grid of size x size quads in the xz plane, with a height of height(x, z)
+template<typename F>
+static Model createGrid(unsigned size, F height) {
+	std::vector<model_vertex> vertices;
+	std::vector<unsigned> indices;
+
+	for (unsigned z = 0; z <= size; z++) {
+		for (unsigned x = 0; x <= size; x++) {
+			vertices.push_back({ { float(x), height(float(x), float(z)), float(z) }, { 0.0f, 1.0f, 0.0f }, { 0.0f, 0.0f } });
+		}
+	}
+
+	for (unsigned z = 0; z < size; z++) {
+		for (unsigned x = 0; x < size; x++) {
+			unsigned i = z * (size + 1) + x;
+			indices.insert(indices.end(), { i, i + size + 1, i + 1, i + 1, i + size + 1, i + size + 2 });
+		}
+	}
+
+	return Model(std::move(vertices), std::move(indices));
+}
+
+static float flat(float, float) {
+	return 0.0f;
+}
+
+static float hill(float x, float z) {
+	return 4.0f * std::exp(-((x - 16.0f) * (x - 16.0f) + (z - 16.0f) * (z - 16.0f)) / 64.0f);
+}
+
+TEST(MeshSimplifier, FlatGrid) {
+	Model model = createGrid(32, flat);
+	mesh_simplification simplified = MeshSimplifier::Simplify(model.GetIndices(), model.GetVertices(), 60);
+
+	EXPECT_LE(simplified.indices.size(), 60u);
+	EXPECT_NEAR(0.0f, simplified.error, 1e-4f);
+
+	// the simplified grid still covers the whole square, facing up
+	float area = 0.0f;
+
+	for (std::size_t i = 0; i < simplified.indices.size(); i += 3) {
+		vec3 p0 = model.GetVertices()[simplified.indices[i]].position;
+		vec3 p1 = model.GetVertices()[simplified.indices[i + 1]].position;
+		vec3 p2 = model.GetVertices()[simplified.indices[i + 2]].position;
+		vec3 normal = glm::cross(p1 - p0, p2 - p0);
+
+		EXPECT_GT(normal.y, 0.0f);
+		area += 0.5f * glm::length(normal);
+	}
+
+	EXPECT_NEAR(32.0f * 32.0f, area, 1e-2f);
+}
+
+TEST(MeshSimplifier, SeamsAreKept) {
+	Model grid = createGrid(32, flat);
+	std::vector<model_vertex> vertices(grid.GetVertices().begin(), grid.GetVertices().end());
+	std::vector<unsigned> indices(grid.GetIndices().begin(), grid.GetIndices().end());
+
+	// give the right half of the grid its own vertices at x = 16, with other
+	// texture coordinates, which makes a seam
+	std::unordered_map<unsigned, unsigned> seam_vertices;
+
+	for (std::size_t i = 0; i < indices.size(); i += 3) {
+		float center = (vertices[indices[i]].position.x + vertices[indices[i + 1]].position.x + vertices[indices[i + 2]].position.x) / 3.0f;
+
+		for (std::size_t k = 0; k < 3 && center > 16.0f; k++) {
+			unsigned& index = indices[i + k];
+
+			if (vertices[index].position.x == 16.0f) {
+				auto[iter, inserted] = seam_vertices.try_emplace(index, vertices.size());
+
+				if (inserted) {
+					vertices.push_back({ vertices[index].position, vertices[index].normal, { 1.0f, 0.0f } });
+				}
+
+				index = iter->second;
+			}
+		}
+	}
+
+	mesh_simplification simplified = MeshSimplifier::Simplify(indices, vertices, 0);
+	std::set<float> seam_positions;
+
+	for (unsigned index : simplified.indices) {
+		if (vertices[index].position.x == 16.0f) {
+			seam_positions.insert(vertices[index].position.z);
+		}
+	}
+
+	EXPECT_LT(simplified.indices.size(), indices.size() / 4);
+	EXPECT_EQ(33u, seam_positions.size());
+}
+
+TEST(MeshSimplifier, GenerateLods) {
+	Model model = MeshSimplifier::GenerateLods(createGrid(32, hill), 4);
+	const auto& lods = model.GetLods();
+
+	ASSERT_EQ(4u, lods.size());
+	EXPECT_EQ(0u, lods[0].first_index);
+	EXPECT_EQ(6u * 32u * 32u, lods[0].index_count);
+	EXPECT_EQ(0.0f, lods[0].error);
+
+	for (std::size_t i = 1; i < lods.size(); i++) {
+		EXPECT_EQ(lods[i - 1].first_index + lods[i - 1].index_count, lods[i].first_index);
+		EXPECT_LE(lods[i].index_count, lods[i - 1].index_count * 6 / 10);
+		EXPECT_GE(lods[i].error, lods[i - 1].error);
+	}
+
+	EXPECT_GT(lods.back().error, 0.0f);
+	EXPECT_LT(lods.back().error, 1.0f);
+	EXPECT_EQ(lods.back().first_index + lods.back().index_count, model.GetIndices().size());
+
+	for (unsigned index : model.GetIndices()) {
+		ASSERT_LT(index, model.GetVertices().size());
+	}
+}
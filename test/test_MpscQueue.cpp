@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) Levi van Rheenen. All rights reserved.
+ */
+
+#include <gtest/gtest.h>
+#include <RheelEngine/Util/MpscQueue.h>
+
+#include <thread>
+
+using namespace rheel;
+
+TEST(MpscQueue, Order) {
+	MpscQueue<std::unique_ptr<int>> queue;
+	EXPECT_EQ(queue.Pop().has_value(), false);
+
+	queue.Push(std::make_unique<int>(1));
+	queue.Push(std::make_unique<int>(2));
+	queue.Push(std::make_unique<int>(3));
+	EXPECT_EQ(queue.GetSize(), 3);
+
+	EXPECT_EQ(**queue.Pop(), 1);
+	EXPECT_EQ(**queue.Pop(), 2);
+	EXPECT_EQ(**queue.Pop(), 3);
+	EXPECT_EQ(queue.Pop().has_value(), false);
+	EXPECT_EQ(queue.GetSize(), 0);
+}
+
+TEST(MpscQueue, MultipleProducers) {
+	constexpr int producers = 4;
+	constexpr int count = 10000;
+
+	MpscQueue<int> queue;
+	std::vector<std::thread> threads;
+
+	for (int p = 0; p < producers; p++) {
+		threads.emplace_back([&queue, p]() {
+			for (int i = 0; i < count; i++) {
+				queue.Push(p * count + i);
+			}
+		});
+	}
+
+	// consume concurrently, and check that elements of each producer arrive
+	// in order
+	std::vector<int> last(producers, -1);
+	int received = 0;
+
+	while (received < producers * count) {
+		if (auto value = queue.Pop(); value) {
+			int p = *value / count;
+			int i = *value % count;
+
+			EXPECT_GT(i, last[p]);
+			last[p] = i;
+			received++;
+		}
+	}
+
+	for (auto& thread : threads) {
+		thread.join();
+	}
+
+	EXPECT_EQ(queue.Pop().has_value(), false);
+	EXPECT_EQ(queue.GetSize(), 0);
+}
@@ -0,0 +1,62 @@
+/*
+ * Copyright (c) Levi van Rheenen. All rights reserved.
+ */
+
+#include <gtest/gtest.h>
+#include <RheelEngine/Util/NumberParser.h>
+
+using namespace rheel;
+
+TEST(NumberParser, SkipWhitespace) {
+	std::string text = "  \t\r\n                                   \n\t  x";
+	EXPECT_EQ(text.data() + text.size() - 1, skip_whitespace(text.data(), text.data() + text.size()));
+
+	std::string empty = "                                        ";
+	EXPECT_EQ(empty.data() + empty.size(), skip_whitespace(empty.data(), empty.data() + empty.size()));
+
+	std::string none = "1 2";
+	EXPECT_EQ(none.data(), skip_whitespace(none.data(), none.data() + none.size()));
+}
+
+TEST(NumberParser, Floats) {
+	std::vector<float> values;
+	parse_numbers("1 -2.5 3e2\n\t0.125  -0 \n", values, 5);
+
+	std::vector<float> expected{ 1.0f, -2.5f, 300.0f, 0.125f, -0.0f };
+	EXPECT_EQ(expected, values);
+}
+
+TEST(NumberParser, Unsigned) {
+	std::vector<unsigned> values;
+	parse_numbers("0 1 2\n 4294967295", values);
+
+	std::vector<unsigned> expected{ 0, 1, 2, 4294967295u };
+	EXPECT_EQ(expected, values);
+}
+
+TEST(NumberParser, Empty) {
+	std::vector<float> values;
+	parse_numbers("", values);
+	parse_numbers(" \n\t ", values);
+
+	EXPECT_TRUE(values.empty());
+}
+
+TEST(NumberParser, Appends) {
+	std::vector<unsigned> values{ 7 };
+	parse_numbers("8 9", values);
+
+	std::vector<unsigned> expected{ 7, 8, 9 };
+	EXPECT_EQ(expected, values);
+}
+
+TEST(NumberParser, Invalid) {
+	std::vector<float> floats;
+	EXPECT_THROW(parse_numbers("1.0 abc", floats), std::runtime_error);
+	EXPECT_THROW(parse_numbers("1.0x 2.0", floats), std::runtime_error);
+
+	std::vector<unsigned> unsigneds;
+	EXPECT_THROW(parse_numbers("1 -2", unsigneds), std::runtime_error);
+	EXPECT_THROW(parse_numbers("1.5", unsigneds), std::runtime_error);
+	EXPECT_THROW(parse_numbers("4294967296", unsigneds), std::runtime_error);
+}
@@ -0,0 +1,148 @@
+/*
+ * Copyright (c) Levi van Rheenen. All rights reserved.
+ */
+
+#include <gtest/gtest.h>
+#include <RheelEngine/Util/VirtualFileSystem.h>
+#include <RheelEngine/Assets/Loaders/MeshLoader.h>
+
+#include <filesystem>
+#include <fstream>
+
+using namespace rheel;
+
+static std::string temporaryPath(const std::string& name) {
+	return (std::filesystem::temp_directory_path() / name).string();
+}
+
+static std::vector<std::byte> bytes(std::string_view text) {
+	auto begin = reinterpret_cast<const std::byte*>(text.data());
+	return std::vector<std::byte>(begin, begin + text.size());
+}
+
+static std::string text(const virtual_file& file) {
+	return std::string(reinterpret_cast<const char*>(file.bytes.data()), file.bytes.size());
+}
+
+TEST(PackFile, RoundTrip) {
+	std::string path = temporaryPath("rheel_test_roundtrip.rpak");
+	std::string repeated(10000, 'a');
+
+	PackFile::Write({
+			{ "a.txt", bytes("first file"), false },
+			{ "dir/b.txt", bytes(repeated), true },
+			{ "empty.txt", {}, true },
+			{ "c.bin", bytes("\x01\x02\x03"), true }
+	}, path);
+
+	auto pack = std::make_shared<PackFile>(path);
+	std::filesystem::remove(path);
+
+	EXPECT_EQ(4u, pack->GetFileCount());
+	EXPECT_TRUE(pack->Contains("dir/b.txt"));
+	EXPECT_FALSE(pack->Contains("b.txt"));
+	EXPECT_FALSE(pack->Open("missing.txt"));
+
+	auto a = pack->Open("a.txt");
+	ASSERT_TRUE(a);
+	EXPECT_EQ("first file", text(*a));
+	EXPECT_EQ(0u, reinterpret_cast<std::uintptr_t>(a->bytes.data()) % 16);
+
+	auto b = pack->Open("dir/b.txt");
+	ASSERT_TRUE(b);
+	EXPECT_EQ(repeated, text(*b));
+
+	EXPECT_EQ("", text(*pack->Open("empty.txt")));
+	EXPECT_EQ("\x01\x02\x03", text(*pack->Open("c.bin")));
+
+	// opened files keep the pack file alive
+	pack.reset();
+	EXPECT_EQ("first file", text(*a));
+}
+
+TEST(PackFile, RejectsDuplicateNames) {
+	std::string path = temporaryPath("rheel_test_duplicate.rpak");
+	EXPECT_THROW(PackFile::Write({{ "a", bytes("1"), false }, { "a", bytes("2"), false }}, path), std::runtime_error);
+	std::filesystem::remove(path);
+}
+
+TEST(PackFile, RejectsInvalidFiles) {
+	std::string path = temporaryPath("rheel_test_invalid.rpak");
+	PackFile::Write({{ "a.txt", bytes("contents"), false }}, path);
+
+	// flip a byte in the file name, so it no longer matches its hash
+	std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+	file.seekp(48 + 48);
+	file.put('b');
+	file.close();
+
+	EXPECT_THROW(PackFile pack(path), std::runtime_error);
+
+	std::ofstream(path, std::ios::binary | std::ios::trunc) << "not a pack file, but long enough for a header";
+	EXPECT_THROW(PackFile pack(path), std::runtime_error);
+
+	std::filesystem::remove(path);
+}
+
+TEST(VirtualFileSystem, Mount) {
+	std::string disk_path = temporaryPath("rheel_test_disk.txt");
+	std::ofstream(disk_path) << "on disk";
+
+	std::string first = temporaryPath("rheel_test_first.rpak");
+	std::string second = temporaryPath("rheel_test_second.rpak");
+	PackFile::Write({{ "a.txt", bytes("first a"), false }, { "b.txt", bytes("first b"), true }}, first);
+	PackFile::Write({{ "a.txt", bytes("second a"), false }}, second);
+
+	VirtualFileSystem::Mount(first, "res/");
+	VirtualFileSystem::Mount(second, "./res/other/..");
+
+	EXPECT_EQ("second a", text(VirtualFileSystem::Open("res/a.txt")));
+	EXPECT_EQ("first b", text(VirtualFileSystem::Open("./res/b.txt")));
+	EXPECT_TRUE(VirtualFileSystem::Exists("res/b.txt"));
+	EXPECT_FALSE(VirtualFileSystem::Exists("b.txt"));
+	EXPECT_FALSE(VirtualFileSystem::Exists("resb.txt"));
+
+	// files that are not in a pack file are read from disk
+	EXPECT_EQ("on disk", text(VirtualFileSystem::Open(disk_path)));
+	EXPECT_THROW(VirtualFileSystem::Open("res/c.txt"), std::runtime_error);
+
+	VirtualFileSystem::Unmount(second);
+	EXPECT_EQ("first a", text(VirtualFileSystem::Open("res/a.txt")));
+
+	VirtualFileSystem::UnmountAll();
+	EXPECT_FALSE(VirtualFileSystem::Exists("res/a.txt"));
+
+	std::filesystem::remove(disk_path);
+	std::filesystem::remove(first);
+	std::filesystem::remove(second);
+}
+
+TEST(VirtualFileSystem, LoadMeshFromPackFile) {
+	std::string mesh_path = temporaryPath("rheel_test_packed.rmesh");
+	std::string pack_path = temporaryPath("rheel_test_mesh.rpak");
+
+	Model model({
+			{ vec3(0, 0, 0), vec3(0, 0, 1), vec2(0, 0) },
+			{ vec3(1, 0, 0), vec3(0, 0, 1), vec2(1, 0) },
+			{ vec3(0, 1, 0), vec3(0, 0, 1), vec2(0, 1) }
+	}, { 0, 1, 2 });
+
+	MeshLoader::Write(model, mesh_path);
+
+	std::ifstream input(mesh_path, std::ios::binary);
+	std::vector<std::byte> data(std::filesystem::file_size(mesh_path));
+	input.read(reinterpret_cast<char*>(data.data()), std::streamsize(data.size()));
+	input.close();
+	std::filesystem::remove(mesh_path);
+
+	PackFile::Write({{ "triangle.rmesh", std::move(data), false }}, pack_path);
+	VirtualFileSystem::Mount(pack_path, "packed");
+
+	Model loaded = MeshLoader().Load("packed/triangle.rmesh");
+	VirtualFileSystem::UnmountAll();
+	std::filesystem::remove(pack_path);
+
+	ASSERT_EQ(3u, loaded.GetVertices().size());
+	EXPECT_EQ(vec3(1, 0, 0), loaded.GetVertices()[1].position);
+	EXPECT_EQ(2u, loaded.GetIndices()[2]);
+}
@@ -0,0 +1,156 @@
+/*
+ * Copyright (c) Levi van Rheenen. All rights reserved.
+ */
+
+#include <gtest/gtest.h>
+#include <RheelEngine/Assets/Loaders/PngLoader.h>
+
+#include <png.h>
+
+#include <filesystem>
+
+using namespace rheel;
+
+static std::string temporaryPath(const std::string& name) {
+	return (std::filesystem::temp_directory_path() / name).string();
+}
+
+/*
+ * Writes a PNG file with the given libpng color type and bit depth. The
+ * channels are given row by row, as 8 or 16 bit values.
+ */
+static void writePng(const std::string& path, unsigned width, unsigned height, int color_type, int bit_depth,
+		const std::vector<std::uint16_t>& channels) {
+
+	FILE* file = std::fopen(path.c_str(), "wb");
+	ASSERT_NE(nullptr, file);
+
+	png_structp png_ptr = png_create_write_struct(PNG_LIBPNG_VER_STRING, nullptr, nullptr, nullptr);
+	png_infop info_ptr = png_create_info_struct(png_ptr);
+	png_init_io(png_ptr, file);
+	png_set_IHDR(png_ptr, info_ptr, width, height, bit_depth, color_type, PNG_INTERLACE_NONE,
+			PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
+	png_write_info(png_ptr, info_ptr);
+
+	std::size_t row_channels = channels.size() / height;
+	std::vector<png_byte> row(row_channels * bit_depth / 8);
+
+	for (unsigned y = 0; y < height; y++) {
+		for (std::size_t c = 0; c < row_channels; c++) {
+			std::uint16_t value = channels[y * row_channels + c];
+
+			if (bit_depth == 16) {
+				row[2 * c] = png_byte(value >> 8);
+				row[2 * c + 1] = png_byte(value & 0xFF);
+			} else {
+				row[c] = png_byte(value);
+			}
+		}
+
+		png_write_row(png_ptr, row.data());
+	}
+
+	png_write_end(png_ptr, nullptr);
+	png_destroy_write_struct(&png_ptr, &info_ptr);
+	std::fclose(file);
+}
+
+TEST(PngLoader, Rgba8) {
+	std::string path = temporaryPath("rheel_test_rgba8.png");
+	writePng(path, 2, 1, PNG_COLOR_TYPE_RGB_ALPHA, 8, { 255, 0, 51, 255, 0, 128, 255, 0 });
+
+	Image image = PngLoader().Load(path);
+	std::filesystem::remove(path);
+
+	ASSERT_EQ(PixelFormat::RGBA8, image.GetFormat());
+	ASSERT_EQ(2u, image.GetWidth());
+	ASSERT_EQ(1u, image.GetHeight());
+
+	std::vector<std::uint8_t> expected{ 255, 0, 51, 255, 0, 128, 255, 0 };
+	EXPECT_TRUE(std::equal(expected.begin(), expected.end(), image.GetData().begin(), image.GetData().end()));
+}
+
+TEST(PngLoader, GrayIsExpanded) {
+	std::string path = temporaryPath("rheel_test_gray.png");
+	writePng(path, 3, 1, PNG_COLOR_TYPE_GRAY, 8, { 0, 100, 255 });
+
+	Image image = PngLoader().Load(path);
+	std::filesystem::remove(path);
+
+	ASSERT_EQ(PixelFormat::RGBA8, image.GetFormat());
+
+	std::vector<std::uint8_t> expected{ 0, 0, 0, 255, 100, 100, 100, 255, 255, 255, 255, 255 };
+	EXPECT_TRUE(std::equal(expected.begin(), expected.end(), image.GetData().begin(), image.GetData().end()));
+}
+
+TEST(PngLoader, SixteenBitKeepsPrecision) {
+	std::string path = temporaryPath("rheel_test_rgb16.png");
+	writePng(path, 1, 2, PNG_COLOR_TYPE_RGB, 16, { 0, 32768, 65535, 1000, 2000, 3000 });
+
+	Image image = PngLoader().Load(path);
+	std::filesystem::remove(path);
+
+	ASSERT_EQ(PixelFormat::RGBA16F, image.GetFormat());
+
+	std::vector<float> rgba = image.GetFloatData();
+	std::vector<float> expected{ 0.0f, 32768.0f / 65535.0f, 1.0f, 1.0f, 1000.0f / 65535.0f, 2000.0f / 65535.0f, 3000.0f / 65535.0f, 1.0f };
+
+	for (std::size_t i = 0; i < expected.size(); i++) {
+		EXPECT_NEAR(expected[i], rgba[i], expected[i] / 1024.0f);
+	}
+}
+
+TEST(PngLoader, InvalidFile) {
+	std::string path = temporaryPath("rheel_test_invalid.png");
+	std::FILE* file = std::fopen(path.c_str(), "wb");
+	std::fputs("not a png file", file);
+	std::fclose(file);
+
+	EXPECT_THROW(PngLoader().Load(path), std::runtime_error);
+	std::filesystem::remove(path);
+}
+
+TEST(PngLoader, TruncatedFile) {
+	std::string path = temporaryPath("rheel_test_truncated.png");
+	writePng(path, 16, 16, PNG_COLOR_TYPE_RGB_ALPHA, 8, std::vector<std::uint16_t>(16 * 16 * 4, 7));
+	std::filesystem::resize_file(path, std::filesystem::file_size(path) / 2);
+
+	EXPECT_THROW(PngLoader().Load(path), std::runtime_error);
+	std::filesystem::remove(path);
+}
+
+TEST(PngLoader, Batch) {
+	constexpr unsigned count = 8;
+	constexpr unsigned size = 64;
+
+	std::vector<std::string> paths;
+
+	for (unsigned i = 0; i < count; i++) {
+		std::vector<std::uint16_t> channels(size * size * 4);
+		for (std::size_t c = 0; c < channels.size(); c++) {
+			channels[c] = (c * 7 + i) % 256;
+		}
+
+		paths.push_back(temporaryPath("rheel_test_batch_" + std::to_string(i) + ".png"));
+		writePng(paths.back(), size, size, PNG_COLOR_TYPE_RGB_ALPHA, 8, channels);
+	}
+
+	png_batch batch = PngLoader().LoadBatch(paths);
+
+	ASSERT_EQ(count, batch.images.size());
+	EXPECT_EQ(count * size * size * 4, batch.decoded_bytes);
+	EXPECT_GT(batch.file_bytes, 0u);
+	EXPECT_GT(batch.throughput, 0.0);
+
+	for (unsigned i = 0; i < count; i++) {
+		EXPECT_EQ(std::uint8_t(i), batch.images[i].GetData()[0]);
+		EXPECT_EQ(std::uint8_t(7 + i), batch.images[i].GetData()[1]);
+	}
+
+	paths.push_back(temporaryPath("rheel_test_batch_missing.png"));
+	EXPECT_THROW(PngLoader().LoadBatch(paths), std::runtime_error);
+
+	for (unsigned i = 0; i < count; i++) {
+		std::filesystem::remove(paths[i]);
+	}
+}
@@ -0,0 +1,139 @@
+/*
+ * Copyright (c) Levi van Rheenen. All rights reserved.
+ */
+
+#include <gtest/gtest.h>
+#include <RheelEngine/Renderer/RendererMap.h>
+
+#include <thread>
+
+using namespace rheel;
+
+// stands in for a model renderer, without OpenGL
+struct test_renderer {
+	explicit test_renderer(int value) :
+			value(value) {}
+
+	void Upload() {
+		uploads++;
+	}
+
+	int value;
+	int uploads = 0;
+	std::vector<int> objects;
+};
+
+TEST(RendererMap, Immediate) {
+	RendererMap<int, test_renderer> map;
+
+	test_renderer& renderer = map.Get(1, false, 10);
+	EXPECT_EQ(10, renderer.value);
+	EXPECT_EQ(1, renderer.uploads);
+	EXPECT_EQ(1u, map.GetRenderers().size());
+
+	// an existing renderer is not created again
+	EXPECT_EQ(&renderer, &map.Get(1, false, 20));
+	EXPECT_EQ(&renderer, &map.Get(1, true, 20));
+	EXPECT_EQ(10, renderer.value);
+}
+
+TEST(RendererMap, DeferredUntilFlush) {
+	RendererMap<int, test_renderer> map;
+
+	// during the simulation, renderers are created without uploading them,
+	// and they can be used right away
+	test_renderer& renderer = map.Get(1, true, 10);
+	renderer.objects.push_back(5);
+
+	EXPECT_EQ(0, renderer.uploads);
+	EXPECT_TRUE(map.GetRenderers().empty());
+	EXPECT_EQ(&renderer, &map.Get(1, true, 20));
+
+	map.Flush();
+
+	// the renderer joins the map, with the objects that were added
+	ASSERT_EQ(1u, map.GetRenderers().size());
+	EXPECT_EQ(&renderer, &map.GetRenderers().at(1));
+	EXPECT_EQ(1, renderer.uploads);
+	EXPECT_EQ(std::vector<int>{ 5 }, renderer.objects);
+
+	map.Flush();
+	EXPECT_EQ(1, renderer.uploads);
+}
+
+TEST(RendererMap, ImmediateAfterDeferred) {
+	RendererMap<int, test_renderer> map;
+	test_renderer& renderer = map.Get(1, true, 10);
+
+	// outside of the simulation, a renderer that was kept aside is uploaded
+	// right away
+	EXPECT_EQ(&renderer, &map.Get(1, false, 20));
+	EXPECT_EQ(1, renderer.uploads);
+	EXPECT_EQ(1u, map.GetRenderers().size());
+}
+
+TEST(RendererMap, Erase) {
+	RendererMap<int, test_renderer> map;
+	map.Get(1, false, 10);
+	map.Get(2, true, 20);
+
+	EXPECT_TRUE(map.Erase(1, false));
+	EXPECT_TRUE(map.Erase(2, false));
+	EXPECT_FALSE(map.Erase(3, false));
+
+	map.Flush();
+	EXPECT_TRUE(map.GetRenderers().empty());
+}
+
+TEST(RendererMap, DeferredErase) {
+	RendererMap<int, test_renderer> map;
+	test_renderer& old_renderer = map.Get(1, false, 10);
+
+	// the render thread can still use the erased renderer until the next
+	// flush, but a new renderer for the same key does not get the old one
+	EXPECT_TRUE(map.Erase(1, true));
+	EXPECT_FALSE(map.Erase(1, true));
+	EXPECT_EQ(&old_renderer, &map.GetRenderers().at(1));
+
+	test_renderer& new_renderer = map.Get(1, true, 20);
+	EXPECT_EQ(20, new_renderer.value);
+
+	map.Flush();
+
+	ASSERT_EQ(1u, map.GetRenderers().size());
+	EXPECT_EQ(&new_renderer, &map.GetRenderers().at(1));
+	EXPECT_EQ(1, new_renderer.uploads);
+}
+
+TEST(RendererMap, ImmediateAfterDeferredErase) {
+	RendererMap<int, test_renderer> map;
+	map.Get(1, false, 10);
+	map.Erase(1, true);
+
+	EXPECT_EQ(20, map.Get(1, false, 20).value);
+	EXPECT_EQ(1u, map.GetRenderers().size());
+}
+
+TEST(RendererMap, ConcurrentDeferred) {
+	RendererMap<int, test_renderer> map;
+	std::vector<std::thread> threads;
+
+	for (int t = 0; t < 4; t++) {
+		threads.emplace_back([&map]() {
+			for (int i = 0; i < 100; i++) {
+				EXPECT_EQ(i, map.Get(i, true, i).value);
+			}
+		});
+	}
+
+	for (auto& thread : threads) {
+		thread.join();
+	}
+
+	map.Flush();
+	EXPECT_EQ(100u, map.GetRenderers().size());
+
+	for (const auto&[key, renderer] : map.GetRenderers()) {
+		EXPECT_EQ(1, renderer.uploads);
+	}
+}
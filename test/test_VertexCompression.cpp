@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) Levi van Rheenen. All rights reserved.
+ */
+
+#include <gtest/gtest.h>
+#include <RheelEngine/Assets/VertexCompression.h>
+
+#include <random>
+
+using namespace rheel;
+
+TEST(VertexCompression, IsHalfTheSize) {
+	EXPECT_EQ(16u, sizeof(compact_vertex));
+	EXPECT_EQ(2 * sizeof(compact_vertex), sizeof(model_vertex));
+}
+
+TEST(VertexCompression, RoundTrip) {
+	model_bounds bounds{ { -10.0f, 2.0f, -0.5f }, { 30.0f, 3.0f, 0.5f } };
+	vec3 size = bounds.max - bounds.min;
+
+	std::mt19937 random(17);
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+	std::normal_distribution<float> normal_distribution;
+
+	std::vector<model_vertex> vertices;
+
+	for (int i = 0; i < 1000; i++) {
+		vec3 position = bounds.min + size * vec3(unit(random), unit(random), unit(random));
+		vec3 normal = glm::normalize(vec3(normal_distribution(random), normal_distribution(random), normal_distribution(random)));
+		vec2 texture(4.0f * unit(random), unit(random));
+
+		vertices.push_back({ position, normal, texture });
+	}
+
+	// the poles and the edges of the octahedron
+	vertices.push_back({ bounds.min, { 0.0f, 0.0f, 1.0f }, { 0.0f, 0.0f } });
+	vertices.push_back({ bounds.max, { 0.0f, 0.0f, -1.0f }, { 1.0f, 1.0f } });
+	vertices.push_back({ bounds.min, { 1.0f, 0.0f, 0.0f }, { 0.0f, 0.0f } });
+	vertices.push_back({ bounds.max, { 0.0f, -1.0f, 0.0f }, { 1.0f, 1.0f } });
+
+	std::vector<compact_vertex> compressed = VertexCompression::Compress(vertices, bounds);
+	ASSERT_EQ(vertices.size(), compressed.size());
+
+	for (std::size_t i = 0; i < vertices.size(); i++) {
+		model_vertex decompressed = VertexCompression::Decompress(compressed[i], bounds);
+
+		for (int k = 0; k < 3; k++) {
+			EXPECT_NEAR(vertices[i].position[k], decompressed.position[k], size[k] / 65534.0f);
+		}
+
+		// the encoded normal is off by about 0.01 degrees at most
+		EXPECT_LT(glm::length(vertices[i].normal - decompressed.normal), 0.0002f);
+
+		EXPECT_NEAR(vertices[i].texture.x, decompressed.texture.x, 0.002f);
+		EXPECT_NEAR(vertices[i].texture.y, decompressed.texture.y, 0.0005f);
+	}
+}
+
+TEST(VertexCompression, FlatBounds) {
+	model_bounds bounds{ { 0.0f, 1.0f, 0.0f }, { 8.0f, 1.0f, 8.0f } };
+
+	EXPECT_EQ(vec3(4.0f, 1.0f, 4.0f), VertexCompression::GetPositionOffset(bounds));
+	EXPECT_EQ(vec3(4.0f, 1.0f, 4.0f), VertexCompression::GetPositionScale(bounds));
+
+	std::vector<model_vertex> vertices{ { { 2.0f, 1.0f, 6.0f }, { 0.0f, 1.0f, 0.0f }, { 0.0f, 0.0f } } };
+	model_vertex decompressed = VertexCompression::Decompress(VertexCompression::Compress(vertices, bounds)[0], bounds);
+
+	EXPECT_NEAR(2.0f, decompressed.position.x, 1e-3f);
+	EXPECT_EQ(1.0f, decompressed.position.y);
+	EXPECT_NEAR(6.0f, decompressed.position.z, 1e-3f);
+}
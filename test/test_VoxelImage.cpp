@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) Levi van Rheenen. All rights reserved.
+ */
+
+#include <gtest/gtest.h>
+#include <RheelEngine/Assets/VoxelImage.h>
+
+using namespace rheel;
+
+TEST(VoxelImage, EmptyImage) {
+	VoxelImage image(40, 20, 10);
+
+	EXPECT_EQ(40u, image.GetWidth());
+	EXPECT_EQ(20u, image.GetHeight());
+	EXPECT_EQ(10u, image.GetDepth());
+	EXPECT_EQ(uvec3(3, 2, 1), image.GetChunkCount());
+
+	EXPECT_EQ(0, image.GetIndex(39, 19, 9));
+	EXPECT_EQ(0.0f, image.At(39, 19, 9).Alpha());
+	EXPECT_EQ(nullptr, image.GetChunk(2, 1, 0));
+}
+
+TEST(VoxelImage, SetAndGet) {
+	VoxelImage image(40, 20, 10);
+	Color red(255, 0, 0);
+	Color green(0, 255, 0);
+
+	image.Set(1, 2, 3, red);
+	image.Set(33, 17, 9, green);
+	image.Set(34, 17, 9, red);
+
+	EXPECT_EQ(red, image.At(1, 2, 3));
+	EXPECT_EQ(green, image.At(33, 17, 9));
+	EXPECT_EQ(red, image.At(34, 17, 9));
+	EXPECT_EQ(0.0f, image.At(2, 2, 3).Alpha());
+
+	// equal colors share a palette entry
+	EXPECT_EQ(1, image.GetIndex(1, 2, 3));
+	EXPECT_EQ(2, image.GetIndex(33, 17, 9));
+	EXPECT_EQ(1, image.GetIndex(34, 17, 9));
+
+	// transparent colors are empty voxels
+	image.Set(1, 2, 3, Color(255, 0, 0, 0));
+	EXPECT_EQ(0, image.GetIndex(1, 2, 3));
+
+	const std::uint8_t* chunk = image.GetChunk(2, 1, 0);
+	ASSERT_NE(nullptr, chunk);
+	EXPECT_EQ(2, chunk[1 + 1 * 16 + 9 * 16 * 16]);
+	EXPECT_EQ(1, chunk[2 + 1 * 16 + 9 * 16 * 16]);
+}
+
+TEST(VoxelImage, OnlyAllocatesUsedChunks) {
+	VoxelImage image(256, 256, 256);
+	std::size_t empty_memory = image.GetMemoryUsage();
+
+	EXPECT_LT(empty_memory, 64u * 1024u);
+
+	for (unsigned z = 0; z < 16; z++) {
+		for (unsigned y = 0; y < 16; y++) {
+			for (unsigned x = 0; x < 16; x++) {
+				image.SetIndex(x + 64, y + 128, z + 16, 7);
+			}
+		}
+	}
+
+	// setting empty voxels in empty chunks allocates nothing
+	image.SetIndex(200, 200, 200, 0);
+
+	EXPECT_EQ(empty_memory + 16u * 16u * 16u, image.GetMemoryUsage());
+	EXPECT_EQ(7, image.GetIndex(79, 143, 31));
+	EXPECT_EQ(0, image.GetIndex(80, 143, 31));
+}
+
+TEST(VoxelImage, Palette) {
+	std::array<Color, 256> palette;
+	palette[0] = Color(255, 255, 255);
+	palette[5] = Color(0, 0, 255);
+
+	VoxelImage image(4, 4, 4, palette);
+	image.SetIndex(3, 3, 3, 5);
+
+	EXPECT_EQ(0.0f, image.GetPalette()[0].Alpha());
+	EXPECT_EQ(Color(0, 0, 255), image.At(3, 3, 3));
+
+	image.SetPaletteColor(5, Color(0, 255, 255));
+	EXPECT_EQ(Color(0, 255, 255), image.At(3, 3, 3));
+
+	EXPECT_THROW(image.SetPaletteColor(0, Color(0, 0, 0)), std::invalid_argument);
+}
+
+TEST(VoxelImage, PaletteFull) {
+	VoxelImage image(16, 16, 1);
+
+	for (int i = 0; i < 255; i++) {
+		image.Set(i % 16, i / 16, 0, Color(i, 0, 0));
+	}
+
+	EXPECT_EQ(255, image.GetIndex(14, 15, 0));
+	EXPECT_THROW(image.Set(15, 15, 0, Color(0, 0, 255)), std::runtime_error);
+
+	// existing colors can still be used
+	image.Set(15, 15, 0, Color(3, 0, 0));
+	EXPECT_EQ(4, image.GetIndex(15, 15, 0));
+}
+
+TEST(VoxelImage, FromColors) {
+	std::vector<Color> voxels(8);
+	voxels[1] = Color(10, 20, 30);
+	voxels[6] = Color(10, 20, 30);
+	voxels[7] = Color(40, 50, 60);
+
+	VoxelImage image(2, 2, 2, voxels);
+
+	EXPECT_EQ(0, image.GetIndex(0, 0, 0));
+	EXPECT_EQ(Color(10, 20, 30), image.At(1, 0, 0));
+	EXPECT_EQ(Color(10, 20, 30), image.At(0, 1, 1));
+	EXPECT_EQ(Color(40, 50, 60), image.At(1, 1, 1));
+	EXPECT_EQ(image.GetIndex(1, 0, 0), image.GetIndex(0, 1, 1));
+}
@@ -0,0 +1,249 @@
+/*
+ * Copyright (c) Levi van Rheenen. All rights reserved.
+ */
+
+#include <gtest/gtest.h>
+#include <RheelEngine/Assets/Loaders/VoxelLoader.h>
+
+#include <fstream>
+#include <filesystem>
+
+using namespace rheel;
+
+static void append(std::vector<std::byte>& bytes, const std::string& id) {
+	for (char c : id) {
+		bytes.push_back(std::byte(c));
+	}
+}
+
+static void append(std::vector<std::byte>& bytes, std::int32_t value) {
+	for (int i = 0; i < 4; i++) {
+		bytes.push_back(std::byte((std::uint32_t(value) >> (8 * i)) & 0xFF));
+	}
+}
+
+/*
+ * Writes the chunks of a .vox file, in the format of MagicaVoxel.
+ */
+class VoxWriter {
+
+public:
+	void Int(std::int32_t value) {
+		append(_content, value);
+	}
+
+	void String(const std::string& value) {
+		Int(std::int32_t(value.size()));
+		append(_content, value);
+	}
+
+	void Dict(const std::vector<std::pair<std::string, std::string>>& entries) {
+		Int(std::int32_t(entries.size()));
+
+		for (const auto& [key, value] : entries) {
+			String(key);
+			String(value);
+		}
+	}
+
+	// adds a chunk with the values written since the previous chunk
+	void Chunk(const std::string& id) {
+		append(_chunks, id);
+		append(_chunks, std::int32_t(_content.size()));
+		append(_chunks, 0);
+		_chunks.insert(_chunks.end(), _content.begin(), _content.end());
+		_content.clear();
+	}
+
+	void Model(unsigned x, unsigned y, unsigned z, const std::vector<std::array<std::uint8_t, 4>>& voxels) {
+		Int(x);
+		Int(y);
+		Int(z);
+		Chunk("SIZE");
+
+		Int(std::int32_t(voxels.size()));
+
+		for (const auto& voxel : voxels) {
+			for (std::uint8_t b : voxel) {
+				_content.push_back(std::byte(b));
+			}
+		}
+
+		Chunk("XYZI");
+	}
+
+	void Transform(int id, int child, const std::string& translation, const std::string& rotation = "") {
+		Int(id);
+		Dict({});
+		Int(child);
+		Int(-1);
+		Int(0);
+		Int(1);
+
+		std::vector<std::pair<std::string, std::string>> frame{ { "_t", translation } };
+		if (!rotation.empty()) {
+			frame.emplace_back("_r", rotation);
+		}
+
+		Dict(frame);
+		Chunk("nTRN");
+	}
+
+	void Group(int id, const std::vector<int>& children) {
+		Int(id);
+		Dict({});
+		Int(std::int32_t(children.size()));
+
+		for (int child : children) {
+			Int(child);
+		}
+
+		Chunk("nGRP");
+	}
+
+	void Shape(int id, int model) {
+		Int(id);
+		Dict({});
+		Int(1);
+		Int(model);
+		Dict({});
+		Chunk("nSHP");
+	}
+
+	std::vector<std::byte> File() const {
+		std::vector<std::byte> file;
+		append(file, "VOX ");
+		append(file, 150);
+		append(file, "MAIN");
+		append(file, 0);
+		append(file, std::int32_t(_chunks.size()));
+		file.insert(file.end(), _chunks.begin(), _chunks.end());
+
+		return file;
+	}
+
+private:
+	std::vector<std::byte> _content;
+	std::vector<std::byte> _chunks;
+
+};
+
+static void writePalette(VoxWriter& writer) {
+	for (int i = 0; i < 255; i++) {
+		writer.Int(std::int32_t(0xFF000000u | unsigned(i)));
+	}
+
+	writer.Chunk("RGBA");
+}
+
+TEST(VoxelLoader, SingleModel) {
+	VoxWriter writer;
+	writer.Model(4, 3, 2, { { 0, 0, 0, 5 }, { 3, 2, 1, 7 } });
+	writePalette(writer);
+
+	VoxelImage image = VoxelLoader().Decode(writer.File());
+
+	// y and z are swapped
+	ASSERT_EQ(4u, image.GetWidth());
+	ASSERT_EQ(2u, image.GetHeight());
+	ASSERT_EQ(3u, image.GetDepth());
+	EXPECT_EQ(5, image.GetIndex(0, 0, 0));
+	EXPECT_EQ(7, image.GetIndex(3, 1, 2));
+	EXPECT_EQ(0, image.GetIndex(1, 0, 0));
+
+	// palette entry i is color i - 1 of the file
+	EXPECT_NEAR(4.0f / 255.0f, image.GetPalette()[5].Red(), 1e-5f);
+	EXPECT_EQ(1.0f, image.GetPalette()[5].Alpha());
+}
+
+TEST(VoxelLoader, PackedModels) {
+	VoxWriter writer;
+	writer.Int(2);
+	writer.Chunk("PACK");
+	writer.Model(2, 2, 2, { { 1, 1, 1, 1 } });
+	writer.Model(3, 1, 1, { { 2, 0, 0, 2 } });
+	writePalette(writer);
+
+	std::vector<VoxelImage> models = VoxelLoader().DecodeModels(writer.File());
+
+	ASSERT_EQ(2u, models.size());
+	EXPECT_EQ(1, models[0].GetIndex(1, 1, 1));
+	EXPECT_EQ(3u, models[1].GetWidth());
+	EXPECT_EQ(2, models[1].GetIndex(2, 0, 0));
+}
+
+TEST(VoxelLoader, SceneGraph) {
+	VoxWriter writer;
+	writer.Model(2, 2, 2, { { 0, 0, 0, 1 } });
+	writer.Model(1, 1, 1, { { 0, 0, 0, 2 } });
+	writer.Transform(0, 1, "0 0 0");
+	writer.Group(1, { 2, 4 });
+	writer.Transform(2, 3, "0 0 0");
+	writer.Shape(3, 0);
+	writer.Transform(4, 5, "5 0 3");
+	writer.Shape(5, 1);
+
+	VoxelImage scene = VoxelLoader().Decode(writer.File());
+
+	// model 0 spans [-1, 0] around its center, model 1 is at (5, 0, 3)
+	ASSERT_EQ(7u, scene.GetWidth());
+	ASSERT_EQ(5u, scene.GetHeight());
+	ASSERT_EQ(2u, scene.GetDepth());
+	EXPECT_EQ(1, scene.GetIndex(0, 0, 0));
+	EXPECT_EQ(2, scene.GetIndex(6, 4, 1));
+}
+
+TEST(VoxelLoader, Rotation) {
+	VoxWriter writer;
+	writer.Model(3, 1, 1, { { 0, 0, 0, 1 }, { 2, 0, 0, 2 } });
+	writer.Transform(0, 1, "0 0 0");
+	writer.Group(1, { 2, 4 });
+
+	// x' = -y, y' = x: a quarter turn around z
+	writer.Transform(2, 3, "0 0 0", std::to_string(1 | (0 << 2) | (1 << 4)));
+	writer.Shape(3, 0);
+	writer.Transform(4, 5, "4 4 0");
+	writer.Shape(5, 0);
+
+	VoxelImage scene = VoxelLoader().Decode(writer.File());
+
+	// the rotated model is along y in the .vox format, so along z here
+	ASSERT_EQ(6u, scene.GetWidth());
+	ASSERT_EQ(1u, scene.GetHeight());
+	ASSERT_EQ(6u, scene.GetDepth());
+	EXPECT_EQ(1, scene.GetIndex(0, 0, 0));
+	EXPECT_EQ(2, scene.GetIndex(0, 0, 2));
+	EXPECT_EQ(1, scene.GetIndex(3, 0, 5));
+}
+
+TEST(VoxelLoader, InvalidFiles) {
+	VoxWriter empty;
+	EXPECT_THROW(VoxelLoader().Decode(empty.File()), std::runtime_error);
+
+	VoxWriter outside;
+	outside.Model(2, 2, 2, { { 2, 0, 0, 1 } });
+	EXPECT_THROW(VoxelLoader().Decode(outside.File()), std::runtime_error);
+
+	VoxWriter truncated;
+	truncated.Model(2, 2, 2, { { 0, 0, 0, 1 } });
+	std::vector<std::byte> data = truncated.File();
+	data.resize(data.size() - 2);
+	EXPECT_THROW(VoxelLoader().Decode(data), std::runtime_error);
+
+	std::vector<std::byte> header{ std::byte('R'), std::byte('I'), std::byte('F'), std::byte('F') };
+	EXPECT_THROW(VoxelLoader().Decode(header), std::runtime_error);
+}
+
+TEST(VoxelLoader, LoadFromFile) {
+	VoxWriter writer;
+	writer.Model(1, 1, 1, { { 0, 0, 0, 3 } });
+	std::vector<std::byte> data = writer.File();
+
+	std::string path = (std::filesystem::temp_directory_path() / "test_VoxelLoader.vox").string();
+	std::ofstream(path, std::ios::binary).write(reinterpret_cast<const char*>(data.data()), std::streamsize(data.size()));
+
+	VoxelImage image = VoxelLoader().Load(path);
+	EXPECT_EQ(3, image.GetIndex(0, 0, 0));
+
+	std::filesystem::remove(path);
+}
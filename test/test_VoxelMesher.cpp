@@ -0,0 +1,159 @@
+/*
+ * Copyright (c) Levi van Rheenen. All rights reserved.
+ */
+
+#include <gtest/gtest.h>
+#include <RheelEngine/Assets/VoxelMesher.h>
+
+using namespace rheel;
+
+static voxel_mesh meshChunk(const VoxelImage& image, uvec3 chunk) {
+	return VoxelMesher::Mesh(VoxelMesher::CopyChunk(image, chunk), chunk);
+}
+
+// the total area of the faces of the mesh with the given normal
+static float area(const voxel_mesh& mesh, vec3 normal) {
+	float total = 0.0f;
+
+	for (std::size_t i = 0; i < mesh.indices.size(); i += 3) {
+		vec3 p0 = mesh.vertices[mesh.indices[i]].position;
+		vec3 p1 = mesh.vertices[mesh.indices[i + 1]].position;
+		vec3 p2 = mesh.vertices[mesh.indices[i + 2]].position;
+		vec3 cross = glm::cross(p1 - p0, p2 - p0);
+
+		// the winding of each triangle matches its normal
+		EXPECT_GT(glm::dot(cross, mesh.vertices[mesh.indices[i]].normal), 0.0f);
+
+		if (mesh.vertices[mesh.indices[i]].normal == normal) {
+			total += 0.5f * glm::length(cross);
+		}
+	}
+
+	return total;
+}
+
+TEST(VoxelMesher, SingleVoxel) {
+	VoxelImage image(16, 16, 16);
+	image.SetIndex(3, 4, 5, 9);
+
+	voxel_mesh mesh = meshChunk(image, uvec3(0, 0, 0));
+
+	ASSERT_EQ(24u, mesh.vertices.size());
+	ASSERT_EQ(36u, mesh.indices.size());
+
+	for (const auto& vertex : mesh.vertices) {
+		EXPECT_GE(vertex.position.x, 3.0f);
+		EXPECT_LE(vertex.position.x, 4.0f);
+		EXPECT_GE(vertex.position.y, 4.0f);
+		EXPECT_LE(vertex.position.y, 5.0f);
+		EXPECT_GE(vertex.position.z, 5.0f);
+		EXPECT_LE(vertex.position.z, 6.0f);
+
+		// palette entry 9, not occluded
+		EXPECT_EQ(9.5f / 256.0f, vertex.texture.x);
+		EXPECT_EQ(3.5f / 4.0f, vertex.texture.y);
+	}
+
+	EXPECT_EQ(1.0f, area(mesh, { 1.0f, 0.0f, 0.0f }));
+	EXPECT_EQ(1.0f, area(mesh, { 0.0f, -1.0f, 0.0f }));
+	EXPECT_EQ(1.0f, area(mesh, { 0.0f, 0.0f, 1.0f }));
+}
+
+TEST(VoxelMesher, MergesFaces) {
+	VoxelImage image(16, 16, 16);
+
+	for (unsigned z = 0; z < 16; z++) {
+		for (unsigned x = 0; x < 16; x++) {
+			image.SetIndex(x, 7, z, 1);
+		}
+	}
+
+	voxel_mesh mesh = meshChunk(image, uvec3(0, 0, 0));
+
+	// one quad per side
+	EXPECT_EQ(24u, mesh.vertices.size());
+	EXPECT_EQ(256.0f, area(mesh, { 0.0f, 1.0f, 0.0f }));
+	EXPECT_EQ(16.0f, area(mesh, { -1.0f, 0.0f, 0.0f }));
+}
+
+TEST(VoxelMesher, DoesNotMergeColors) {
+	VoxelImage image(16, 16, 16);
+	image.SetIndex(0, 0, 0, 1);
+	image.SetIndex(1, 0, 0, 2);
+
+	voxel_mesh mesh = meshChunk(image, uvec3(0, 0, 0));
+
+	// the faces between the voxels are culled
+	EXPECT_EQ(10u * 4u, mesh.vertices.size());
+	EXPECT_EQ(2.0f, area(mesh, { 0.0f, 1.0f, 0.0f }));
+}
+
+TEST(VoxelMesher, CullsAcrossChunks) {
+	VoxelImage image(32, 16, 16);
+
+	for (unsigned x = 0; x < 32; x++) {
+		image.SetIndex(x, 0, 0, 1);
+	}
+
+	voxel_mesh left = meshChunk(image, uvec3(0, 0, 0));
+	voxel_mesh right = meshChunk(image, uvec3(1, 0, 0));
+
+	EXPECT_EQ(20u, left.vertices.size());
+	EXPECT_EQ(1.0f, area(left, { -1.0f, 0.0f, 0.0f }));
+	EXPECT_EQ(0.0f, area(left, { 1.0f, 0.0f, 0.0f }));
+	EXPECT_EQ(16.0f, area(left, { 0.0f, 1.0f, 0.0f }));
+
+	EXPECT_EQ(20u, right.vertices.size());
+	EXPECT_EQ(0.0f, area(right, { -1.0f, 0.0f, 0.0f }));
+	EXPECT_EQ(1.0f, area(right, { 1.0f, 0.0f, 0.0f }));
+
+	for (const auto& vertex : right.vertices) {
+		EXPECT_GE(vertex.position.x, 16.0f);
+	}
+}
+
+TEST(VoxelMesher, AmbientOcclusion) {
+	VoxelImage image(16, 16, 16);
+
+	// a 3 x 3 floor with a voxel on top of the center
+	for (unsigned z = 0; z < 3; z++) {
+		for (unsigned x = 0; x < 3; x++) {
+			image.SetIndex(x, 0, z, 1);
+		}
+	}
+
+	image.SetIndex(1, 1, 1, 1);
+
+	voxel_mesh mesh = meshChunk(image, uvec3(0, 0, 0));
+	EXPECT_EQ(9.0f, area(mesh, { 0.0f, 1.0f, 0.0f }));
+
+	// the floor corners next to the voxel are darker, the outer ones are not
+	for (const auto& vertex : mesh.vertices) {
+		if (vertex.normal != vec3(0.0f, 1.0f, 0.0f) || vertex.position.y != 1.0f) {
+			continue;
+		}
+
+		bool touches_voxel = vertex.position.x >= 1.0f && vertex.position.x <= 2.0f &&
+				vertex.position.z >= 1.0f && vertex.position.z <= 2.0f;
+
+		float occlusion = vertex.texture.y * 4.0f - 0.5f;
+		EXPECT_EQ(touches_voxel ? 2.0f : 3.0f, occlusion);
+	}
+}
+
+TEST(VoxelMesher, PaletteTexture) {
+	VoxelImage image(1, 1, 1);
+	image.Set(0, 0, 0, Color(200, 100, 50));
+
+	Image texture = VoxelMesher::CreatePaletteTexture(image);
+
+	ASSERT_EQ(256u, texture.GetWidth());
+	ASSERT_EQ(4u, texture.GetHeight());
+	EXPECT_NEAR(200.0f / 255.0f, texture.GetPixel(1, 3).Red(), 1e-3f);
+	EXPECT_NEAR(100.0f / 255.0f, texture.GetPixel(1, 3).Green(), 1e-3f);
+	EXPECT_NEAR(50.0f / 255.0f, texture.GetPixel(1, 3).Blue(), 1e-3f);
+	EXPECT_EQ(0.0f, texture.GetPixel(0, 3).Alpha());
+	EXPECT_LT(texture.GetPixel(1, 0).Red(), texture.GetPixel(1, 1).Red());
+	EXPECT_LT(texture.GetPixel(1, 1).Red(), texture.GetPixel(1, 2).Red());
+	EXPECT_LT(texture.GetPixel(1, 2).Red(), texture.GetPixel(1, 3).Red());
+}
@@ -0,0 +1,63 @@
+/*
+ * Copyright (c) Levi van Rheenen. All rights reserved.
+ */
+
+#include <gtest/gtest.h>
+#include <RheelEngine/Assets/VoxelMesher.h>
+
+#include <chrono>
+#include <cmath>
+
+using namespace rheel;
+
+static constexpr unsigned benchmark_size = 128;
+
+/*
+ * Creates rolling hills of benchmark_size^2 voxels wide, with a few layers of
+ * different colors, and some floating blocks.
+ */
+static VoxelImage create_terrain() {
+	VoxelImage image(benchmark_size, benchmark_size / 2, benchmark_size);
+
+	for (unsigned z = 0; z < benchmark_size; z++) {
+		for (unsigned x = 0; x < benchmark_size; x++) {
+			float height = 24.0f + 10.0f * std::sin(float(x) * 0.07f) * std::cos(float(z) * 0.05f) + 4.0f * std::sin(float(x + z) * 0.21f);
+
+			for (unsigned y = 0; y < unsigned(height); y++) {
+				std::uint8_t layer = unsigned(height) - y <= 1 ? 1 : (unsigned(height) - y <= 4 ? 2 : 3);
+				image.SetIndex(x, y, z, layer);
+			}
+
+			if ((x / 8 + z / 8) % 5 == 0 && x % 8 < 3 && z % 8 < 3) {
+				image.SetIndex(x, 50, z, 4);
+			}
+		}
+	}
+
+	return image;
+}
+
+TEST(VoxelMesherBenchmark, MeshTerrain) {
+	VoxelImage image = create_terrain();
+	uvec3 chunks = image.GetChunkCount();
+
+	std::size_t triangles = 0;
+	auto start = std::chrono::steady_clock::now();
+
+	for (unsigned z = 0; z < chunks.z; z++) {
+		for (unsigned y = 0; y < chunks.y; y++) {
+			for (unsigned x = 0; x < chunks.x; x++) {
+				voxel_mesh mesh = VoxelMesher::Mesh(VoxelMesher::CopyChunk(image, uvec3(x, y, z)), uvec3(x, y, z));
+				triangles += mesh.indices.size() / 3;
+			}
+		}
+	}
+
+	std::chrono::duration<double> duration = std::chrono::steady_clock::now() - start;
+	double voxels = double(image.GetWidth()) * image.GetHeight() * image.GetDepth();
+
+	EXPECT_GT(triangles, 0u);
+
+	std::cout << "Meshing " << chunks.x * chunks.y * chunks.z << " chunks: " << triangles << " triangles, "
+			  << duration.count() * 1000.0 << " ms, " << voxels / duration.count() / 1e6 << " million voxels/s" << std::endl;
+}
@@ -0,0 +1,154 @@
+/*
+ * Copyright (c) Levi van Rheenen. All rights reserved.
+ */
+
+#include <gtest/gtest.h>
+#include <RheelEngine/Assets/Loaders/WaveLoader.h>
+
+#include <filesystem>
+#include <fstream>
+
+using namespace rheel;
+
+static void append(std::vector<std::byte>& bytes, const std::string& id) {
+	for (char c : id) {
+		bytes.push_back(std::byte(c));
+	}
+}
+
+static void append(std::vector<std::byte>& bytes, std::uint32_t value, std::size_t size) {
+	for (std::size_t i = 0; i < size; i++) {
+		bytes.push_back(std::byte((value >> (8 * i)) & 0xFF));
+	}
+}
+
+/*
+ * Creates a wave file with the given format chunk contents, followed by the
+ * other chunks and the samples.
+ */
+static std::vector<std::byte> createWave(std::uint16_t format, std::uint16_t channels, std::uint32_t frequency,
+		std::uint16_t bits, const std::vector<std::byte>& samples, const std::vector<std::byte>& other_chunks = {}) {
+
+	std::vector<std::byte> chunks;
+
+	append(chunks, "fmt ");
+	append(chunks, 16, 4);
+	append(chunks, format, 2);
+	append(chunks, channels, 2);
+	append(chunks, frequency, 4);
+	append(chunks, frequency * channels * bits / 8, 4);
+	append(chunks, channels * bits / 8, 2);
+	append(chunks, bits, 2);
+
+	chunks.insert(chunks.end(), other_chunks.begin(), other_chunks.end());
+
+	append(chunks, "data");
+	append(chunks, std::uint32_t(samples.size()), 4);
+	chunks.insert(chunks.end(), samples.begin(), samples.end());
+
+	std::vector<std::byte> file;
+	append(file, "RIFF");
+	append(file, std::uint32_t(chunks.size() + 4), 4);
+	append(file, "WAVE");
+	file.insert(file.end(), chunks.begin(), chunks.end());
+
+	return file;
+}
+
+static std::vector<std::byte> samples(std::size_t count) {
+	std::vector<std::byte> bytes;
+
+	for (std::size_t i = 0; i < count; i++) {
+		bytes.push_back(std::byte(i));
+	}
+
+	return bytes;
+}
+
+TEST(WaveLoader, Formats) {
+	std::vector<std::byte> mono_8 = createWave(1, 1, 8000, 8, samples(10));
+	std::vector<std::byte> mono_16 = createWave(1, 1, 22050, 16, samples(10));
+	std::vector<std::byte> stereo_8 = createWave(1, 2, 44100, 8, samples(10));
+	std::vector<std::byte> stereo_16 = createWave(1, 2, 48000, 16, samples(12));
+
+	wave_data wave = WaveLoader::Parse(mono_8);
+	EXPECT_EQ(InternalSoundFormat::MONO_8, wave.format);
+	EXPECT_EQ(8000, wave.sample_frequency);
+	EXPECT_EQ(1u, wave.block_align);
+	EXPECT_EQ(10u, wave.samples.size());
+
+	EXPECT_EQ(InternalSoundFormat::MONO_16, WaveLoader::Parse(mono_16).format);
+	EXPECT_EQ(InternalSoundFormat::STEREO_8, WaveLoader::Parse(stereo_8).format);
+
+	wave = WaveLoader::Parse(stereo_16);
+	EXPECT_EQ(InternalSoundFormat::STEREO_16, wave.format);
+	EXPECT_EQ(48000, wave.sample_frequency);
+	EXPECT_EQ(4u, wave.block_align);
+	EXPECT_EQ(12u, wave.samples.size());
+}
+
+TEST(WaveLoader, SamplesAreInPlace) {
+	std::vector<std::byte> file = createWave(1, 1, 8000, 16, samples(8));
+	wave_data wave = WaveLoader::Parse(file);
+
+	EXPECT_EQ(file.data() + file.size() - 8, wave.samples.data());
+	EXPECT_EQ(std::byte(7), wave.samples[7]);
+}
+
+TEST(WaveLoader, SkipsOtherChunks) {
+	// an odd-sized chunk is followed by a padding byte
+	std::vector<std::byte> list;
+	append(list, "LIST");
+	append(list, 3, 4);
+	append(list, "abc");
+	list.push_back(std::byte(0));
+
+	wave_data wave = WaveLoader::Parse(createWave(1, 1, 8000, 8, samples(5), list));
+	ASSERT_EQ(5u, wave.samples.size());
+	EXPECT_EQ(std::byte(0), wave.samples[0]);
+	EXPECT_EQ(std::byte(4), wave.samples[4]);
+}
+
+TEST(WaveLoader, CutsOffTruncatedSamples) {
+	std::vector<std::byte> file = createWave(1, 2, 8000, 16, samples(16));
+	file.resize(file.size() - 3);
+
+	// only whole samples of both channels are used
+	EXPECT_EQ(12u, WaveLoader::Parse(file).samples.size());
+}
+
+TEST(WaveLoader, UnsupportedFiles) {
+	// IEEE float samples
+	EXPECT_THROW(WaveLoader::Parse(createWave(3, 1, 8000, 32, samples(8))), std::runtime_error);
+
+	// 24 bit samples
+	EXPECT_THROW(WaveLoader::Parse(createWave(1, 1, 8000, 24, samples(9))), std::runtime_error);
+
+	// more than two channels
+	EXPECT_THROW(WaveLoader::Parse(createWave(1, 6, 8000, 16, samples(12))), std::runtime_error);
+
+	// not a wave file
+	std::vector<std::byte> file = createWave(1, 1, 8000, 8, samples(4));
+	file[8] = std::byte('A');
+	EXPECT_THROW(WaveLoader::Parse(file), std::runtime_error);
+
+	// no data chunk
+	file = createWave(1, 1, 8000, 8, {});
+	file.resize(file.size() - 8);
+	EXPECT_THROW(WaveLoader::Parse(file), std::runtime_error);
+}
+
+TEST(WaveLoader, Load) {
+	std::vector<std::byte> file = createWave(1, 1, 11025, 16, samples(6));
+
+	std::string path = (std::filesystem::temp_directory_path() / "test_WaveLoader.wav").string();
+	std::ofstream(path, std::ios::binary).write(reinterpret_cast<const char*>(file.data()), std::streamsize(file.size()));
+
+	Sound sound = WaveLoader().Load(path);
+	EXPECT_EQ(InternalSoundFormat::MONO_16, sound.GetFormat());
+	EXPECT_EQ(11025, sound.GetSampleFrequency());
+	ASSERT_EQ(6u, sound.GetRawSampleSize());
+	EXPECT_EQ(5, sound.GetRawSampleData()[5]);
+
+	std::filesystem::remove(path);
+}
@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) Levi van Rheenen. All rights reserved.
+ */
+
+/*
+ * Packs all files in a directory into a pack file (.rpak), which can be
+ * mounted with VirtualFileSystem::Mount() to load the assets from it. The
+ * names of the files in the pack file are their paths relative to the
+ * directory.
+ *
+ * With --compress, files are compressed with zlib, except binary meshes,
+ * which are used in place from the mapped pack file, and PNG images, which are
+ * compressed already.
+ *
+ * Usage: AssetPacker [--compress] <input directory> <output.rpak>
+ */
+
+#include <RheelEngine/Util/PackFile.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+using namespace rheel;
+
+static bool should_compress(const std::filesystem::path& path) {
+	std::string extension = path.extension().string();
+	return extension != ".rmesh" && extension != ".png";
+}
+
+int main(int argc, char* argv[]) {
+	std::vector<std::string> arguments(argv + 1, argv + argc);
+
+	bool compress = !arguments.empty() && arguments[0] == "--compress";
+	if (compress) {
+		arguments.erase(arguments.begin());
+	}
+
+	if (arguments.size() != 2) {
+		std::cerr << "Usage: " << argv[0] << " [--compress] <input directory> <output.rpak>" << std::endl;
+		return 1;
+	}
+
+	std::filesystem::path input = arguments[0];
+	std::filesystem::path output = arguments[1];
+
+	try {
+		std::vector<std::filesystem::path> paths;
+		std::error_code error;
+
+		for (const auto& entry : std::filesystem::recursive_directory_iterator(input)) {
+			if (entry.is_regular_file() && !std::filesystem::equivalent(entry.path(), output, error)) {
+				paths.push_back(entry.path());
+			}
+		}
+
+		// sort the files, so the pack file does not depend on the order of the
+		// directory listing
+		std::sort(paths.begin(), paths.end());
+
+		std::vector<pack_file_input> files;
+		std::size_t total_size = 0;
+
+		for (const auto& path : paths) {
+			std::ifstream file(path, std::ios::binary);
+			std::vector<std::byte> data(std::filesystem::file_size(path));
+
+			if (!file.read(reinterpret_cast<char*>(data.data()), std::streamsize(data.size()))) {
+				throw std::runtime_error("Could not read " + path.string());
+			}
+
+			total_size += data.size();
+			files.push_back(pack_file_input{
+					std::filesystem::relative(path, input).generic_string(),
+					std::move(data),
+					compress && should_compress(path)
+			});
+		}
+
+		PackFile::Write(files, output.string());
+
+		std::cout << input.string() << " -> " << output.string() << ": "
+				<< files.size() << " files, "
+				<< total_size << " bytes packed into "
+				<< std::filesystem::file_size(output) << " bytes" << std::endl;
+	} catch (const std::exception& e) {
+		std::cerr << "Could not pack " << input.string() << ": " << e.what() << std::endl;
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,72 @@
+/*
+ * Copyright (c) Levi van Rheenen. All rights reserved.
+ */
+
+/*
+ * Converts collada (.dae) model files to the engine-native binary mesh format
+ * (.rmesh), which can be loaded by AssetLoader::mesh without parsing.
+ *
+ * Usage: MeshConverter [--lods <count>] <input.dae> [output.rmesh]
+ *
+ * With --lods, up to count levels of detail are generated and stored in the
+ * mesh, including the full detail level.
+ */
+
+#include <RheelEngine/Assets/Loaders/ColladaLoader.h>
+#include <RheelEngine/Assets/Loaders/MeshLoader.h>
+#include <RheelEngine/Assets/MeshOptimizer.h>
+#include <RheelEngine/Assets/MeshSimplifier.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <iostream>
+
+using namespace rheel;
+
+int main(int argc, char* argv[]) {
+	unsigned lod_count = 1;
+	int first = 1;
+
+	if (argc > 2 && std::string(argv[1]) == "--lods") {
+		lod_count = std::max(std::atoi(argv[2]), 1);
+		first = 3;
+	}
+
+	if (argc - first < 1 || argc - first > 2) {
+		std::cerr << "Usage: " << argv[0] << " [--lods <count>] <input.dae> [output.rmesh]" << std::endl;
+		return 1;
+	}
+
+	std::filesystem::path input = argv[first];
+	std::filesystem::path output = argc - first == 2 ? std::filesystem::path(argv[first + 1]) : std::filesystem::path(input).replace_extension(".rmesh");
+
+	try {
+		Model model = ColladaLoader().Load(input.string());
+
+		if (lod_count > 1) {
+			model = MeshSimplifier::GenerateLods(model, lod_count);
+
+			for (const auto& lod : model.GetLods()) {
+				std::cout << "LOD: " << lod.index_count / 3 << " triangles, error " << lod.error << std::endl;
+			}
+		}
+
+		MeshLoader::Write(model, output.string());
+
+		// the collada loader optimizes the mesh, so these are the statistics
+		// of the optimized mesh
+		mesh_statistics statistics = MeshOptimizer::Analyze(model);
+
+		std::cout << input.string() << " -> " << output.string() << ": "
+				<< model.GetVertices().size() << " vertices, "
+				<< model.GetIndices().size() << " indices, "
+				<< "ACMR " << statistics.acmr << ", "
+				<< "ATVR " << statistics.atvr << ", "
+				<< "overfetch " << statistics.overfetch << std::endl;
+	} catch (const std::exception& e) {
+		std::cerr << "Could not convert " << input.string() << ": " << e.what() << std::endl;
+		return 1;
+	}
+
+	return 0;
+}